@@ -278,6 +278,14 @@ void sandbox_set_enable_memio(bool enable)
 	state->allow_memio = enable;
 }
 
+void sandbox_set_mtest_fault(ulong addr, ulong bits)
+{
+	struct sandbox_state *state = state_get_current();
+
+	state->mtest_fault_addr = addr;
+	state->mtest_fault_bits = bits;
+}
+
 void sandbox_set_enable_pci_map(int enable)
 {
 	enable_pci_map = enable;
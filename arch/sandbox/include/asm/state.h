@@ -107,6 +107,8 @@ struct sandbox_state {
 	struct list_head mapmem_head;	/* struct sandbox_mapmem_entry */
 	bool hwspinlock;		/* Hardware Spinlock status */
 	bool allow_memio;		/* Allow readl() etc. to work */
+	ulong mtest_fault_addr;		/* Word which mtest sees corrupted */
+	ulong mtest_fault_bits;		/* Bits flipped in it, 0 for none */
 
 	/*
 	 * This struct is getting large.
@@ -90,10 +90,46 @@ void sandbox_i2c_eeprom_set_offset_len(struct udevice *dev, int offset_len);
 void sandbox_i2c_eeprom_set_chip_addr_offset_mask(struct udevice *dev,
 						  uint mask);
 
+/**
+ * sandbox_i2c_eeprom_set_busy() - make the EEPROM busy after each write
+ *
+ * After a write of data, the EEPROM NACKs the next @polls transfers, as a
+ * real one does during its internal write cycle. This also clears the count
+ * returned by sandbox_i2c_eeprom_get_nacks().
+ *
+ * @dev:	EEPROM emulator device
+ * @polls:	Number of transfers to NACK, 0 for none, -1 to stay busy
+ */
+void sandbox_i2c_eeprom_set_busy(struct udevice *dev, int polls);
+
+/**
+ * sandbox_i2c_eeprom_get_nacks() - get the transfers NACKed while busy
+ *
+ * @dev:	EEPROM emulator device
+ * Return: number of transfers NACKed since sandbox_i2c_eeprom_set_busy()
+ */
+uint sandbox_i2c_eeprom_get_nacks(struct udevice *dev);
+
 uint sanbox_i2c_eeprom_get_prev_addr(struct udevice *dev);
 
 uint sanbox_i2c_eeprom_get_prev_offset(struct udevice *dev);
 
+/**
+ * sandbox_i2c_pmic_get_writes() - get the register writes seen by a PMIC
+ *
+ * This returns the writes made since the previous call, in the order they
+ * reached the emulator, and then clears the record. Only the first 16 are
+ * recorded.
+ *
+ * @emul:	PMIC emulator device
+ * @regs:	returns the first register of each write
+ * @lens:	returns the number of registers of each write
+ * @max:	maximum number of writes to return
+ * Return: number of writes returned
+ */
+int sandbox_i2c_pmic_get_writes(struct udevice *emul, u8 *regs, u8 *lens,
+				int max);
+
 /**
  * sandbox_i2c_rtc_set_offset() - set the time offset from system/base time
  *
@@ -243,6 +279,14 @@ int sandbox_get_pch_spi_protect(struct udevice *dev);
  */
 int sandbox_get_pci_ep_irq_count(struct udevice *dev);
 
+/**
+ * sandbox_pci_get_link_polls() - Get the number of link_up() calls
+ *
+ * @bus: "sandbox,pcie" controller to check
+ * Return: number of times the PCI uclass has checked the link
+ */
+int sandbox_pci_get_link_polls(struct udevice *bus);
+
 /**
  * sandbox_pci_read_bar() - Read the BAR value for a read_config operation
  *
@@ -269,6 +313,17 @@ uint sandbox_pci_read_bar(u32 barval, int type, uint size);
  */
 void sandbox_set_enable_memio(bool enable);
 
+/**
+ * sandbox_set_mtest_fault() - Make mtest see a faulty memory word
+ *
+ * After each fill pass of the fast mtest engine, the word at @addr has @bits
+ * flipped, so that the test reports an error there.
+ *
+ * @addr: Bus address of the word to corrupt
+ * @bits: Bits to flip, or 0 to disable the fault
+ */
+void sandbox_set_mtest_fault(ulong addr, ulong bits);
+
 /**
  * sandbox_cros_ec_set_test_flags() - Set behaviour for testing purposes
  *
@@ -8,8 +8,11 @@
 #include <errno.h>
 #include <image.h>
 #include <log.h>
+#include <asm/global_data.h>
 #include <linux/libfdt.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 ulong fdt_getprop_u32(const void *fdt, int node, const char *prop)
 {
 	const u32 *cell;
@@ -29,7 +32,8 @@ __weak int board_fit_config_name_match(const char *name)
 
 /*
  * Iterate over all /configurations subnodes and call a platform specific
- * function to find the matching configuration.
+ * function to find the matching configuration. With SPL_FIT_COMPAT_SELECT,
+ * first try the compatible index of the FIT.
  * Returns the node offset or a negative error number.
  */
 int fit_find_config_node(const void *fdt)
@@ -47,6 +51,20 @@ int fit_find_config_node(const void *fdt)
 		return -EINVAL;
 	}
 
+	if (CONFIG_IS_ENABLED(FIT_COMPAT_SELECT) && gd_fdt_blob()) {
+		const char *compat;
+
+		compat = fdt_getprop(gd_fdt_blob(), 0, "compatible", &len);
+		if (compat) {
+			node = fit_conf_find_compat_index(fdt, compat, len);
+			if (node >= 0) {
+				debug("Selecting config '%s' by compatible\n",
+				      fdt_get_name(fdt, node, NULL));
+				return node;
+			}
+		}
+	}
+
 	dflt_conf_name = fdt_getprop(fdt, conf, "default", &len);
 
 	for (node = fdt_first_subnode(fdt, conf);
@@ -18,6 +18,13 @@
 
 #define FDT_MAX_DEPTH	32
 
+/* FNV-1a, used to hash node paths */
+#define FDT_PATH_HASH_INIT	2166136261U
+#define FDT_PATH_HASH_PRIME	16777619U
+
+/* Number of property names whose exclusion is remembered */
+#define FDT_EXC_CACHE_SIZE	16
+
 static int str_in_list(const char *str, char * const list[], int count)
 {
 	int i;
@@ -29,11 +36,69 @@ static int str_in_list(const char *str, char * const list[], int count)
 	return 0;
 }
 
+static uint32_t fdt_path_hash(uint32_t hash, const char *str, int len)
+{
+	while (len--) {
+		hash ^= (unsigned char)*str++;
+		hash *= FDT_PATH_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+/**
+ * fdt_inc_table_size() - Get the size of the include hash table
+ *
+ * @inc_count:	Number of node paths to include
+ * Return: number of slots, a power of two with at least half of them free
+ */
+static int fdt_inc_table_size(int inc_count)
+{
+	int size = 8;
+
+	while (size < inc_count * 2)
+		size <<= 1;
+
+	return size;
+}
+
+/**
+ * fdt_path_included() - Check whether a node path is in the include list
+ *
+ * @path:	Path to check
+ * @hash:	Hash of @path
+ * @inc:	List of node paths to include
+ * @table:	Hash table of @inc, holding the index + 1 of each entry
+ * @hashes:	Hash of each entry in @inc
+ * @mask:	Number of slots in @table - 1
+ * Return: true if @path is included
+ */
+static bool fdt_path_included(const char *path, uint32_t hash,
+			      char * const inc[], const int table[],
+			      const uint32_t hashes[], int mask)
+{
+	int slot, idx;
+
+	for (slot = hash & mask; (idx = table[slot]); slot = (slot + 1) & mask) {
+		if (hashes[idx - 1] == hash && !strcmp(inc[idx - 1], path))
+			return true;
+	}
+
+	return false;
+}
+
 int fdt_find_regions(const void *fdt, char * const inc[], int inc_count,
 		     char * const exc_prop[], int exc_prop_count,
 		     struct fdt_region region[], int max_regions,
 		     char *path, int path_len, int add_string_tab)
 {
+	int table_size = fdt_inc_table_size(inc_count);
+	int inc_table[table_size];
+	uint32_t inc_hash[inc_count + 1];
+	uint32_t hash_stack[FDT_MAX_DEPTH];
+	int len_stack[FDT_MAX_DEPTH];
+	int exc_off[FDT_EXC_CACHE_SIZE];
+	bool exc_val[FDT_EXC_CACHE_SIZE];
 	int stack[FDT_MAX_DEPTH] = { 0 };
 	char *end;
 	int nextoffset = 0;
@@ -44,6 +109,27 @@ int fdt_find_regions(const void *fdt, char * const inc[], int inc_count,
 	int want = 0;
 	int base = fdt_off_dt_struct(fdt);
 	bool expect_end = false;
+	int i;
+
+	/*
+	 * Build a hash table of the include list, so that each node needs
+	 * just one lookup instead of comparing its path with every entry.
+	 * Excluded properties are remembered by name offset, since a FIT
+	 * uses the same few property names over and over.
+	 */
+	memset(inc_table, '\0', sizeof(inc_table));
+	for (i = 0; i < inc_count; i++) {
+		int slot;
+
+		inc_hash[i] = fdt_path_hash(FDT_PATH_HASH_INIT, inc[i],
+					    strlen(inc[i]));
+		for (slot = inc_hash[i] & (table_size - 1); inc_table[slot];
+		     slot = (slot + 1) & (table_size - 1))
+			;
+		inc_table[slot] = i + 1;
+	}
+	for (i = 0; i < FDT_EXC_CACHE_SIZE; i++)
+		exc_off[i] = -1;
 
 	end = path;
 	*end = '\0';
@@ -53,6 +139,7 @@ int fdt_find_regions(const void *fdt, char * const inc[], int inc_count,
 		const char *str;
 		int include = 0;
 		int stop_at = 0;
+		int nameoff;
 		int offset;
 		int len;
 
@@ -68,11 +155,19 @@ int fdt_find_regions(const void *fdt, char * const inc[], int inc_count,
 		case FDT_PROP:
 			include = want >= 2;
 			stop_at = offset;
-			prop = fdt_get_property_by_offset(fdt, offset, NULL);
-			str = fdt_string(fdt, fdt32_to_cpu(prop->nameoff));
-			if (!str)
-				return -FDT_ERR_BADSTRUCTURE;
-			if (str_in_list(str, exc_prop, exc_prop_count))
+			/* fdt_next_tag() has already checked the property */
+			prop = fdt_offset_ptr(fdt, offset, sizeof(*prop));
+			nameoff = fdt32_to_cpu(prop->nameoff);
+			i = nameoff % FDT_EXC_CACHE_SIZE;
+			if (exc_off[i] != nameoff) {
+				str = fdt_string(fdt, nameoff);
+				if (!str)
+					return -FDT_ERR_BADSTRUCTURE;
+				exc_off[i] = nameoff;
+				exc_val[i] = str_in_list(str, exc_prop,
+							 exc_prop_count);
+			}
+			if (exc_val[i])
 				include = 0;
 			break;
 
@@ -85,7 +180,9 @@ int fdt_find_regions(const void *fdt, char * const inc[], int inc_count,
 			depth++;
 			if (depth == FDT_MAX_DEPTH)
 				return -FDT_ERR_BADSTRUCTURE;
-			name = fdt_get_name(fdt, offset, &len);
+			/* fdt_next_tag() has checked that the name is terminated */
+			name = fdt_offset_ptr(fdt, offset + FDT_TAGSIZE, 1);
+			len = strlen(name);
 
 			/* The root node must have an empty name */
 			if (!depth && *name)
@@ -96,10 +193,25 @@ int fdt_find_regions(const void *fdt, char * const inc[], int inc_count,
 				*end++ = '/';
 			strcpy(end, name);
 			end += len;
+
+			/* Hash the path, continuing from the parent's hash */
+			len_stack[depth] = end - path;
+			if (depth)
+				hash_stack[depth] = fdt_path_hash(
+					hash_stack[depth - 1],
+					path + len_stack[depth - 1],
+					len_stack[depth] - len_stack[depth - 1]);
+			else
+				hash_stack[depth] = fdt_path_hash(
+					FDT_PATH_HASH_INIT, path,
+					len_stack[depth]);
 			stack[depth] = want;
 			if (want == 1)
 				stop_at = offset;
-			if (str_in_list(path, inc, inc_count))
+			if (inc_count &&
+			    fdt_path_included(path, hash_stack[depth], inc,
+					      inc_table, inc_hash,
+					      table_size - 1))
 				want = 2;
 			else if (want)
 				want--;
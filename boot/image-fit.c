@@ -1725,6 +1725,11 @@ int fit_check_format(const void *fit, ulong size)
  * copied into the configuration node in the FIT image. This is required to
  * match configurations with compressed FDTs.
  *
+ * If the FIT has a compatible index (see mkimage -I) and
+ * CONFIG_FIT_BEST_MATCH_INDEX is enabled, that is used instead, so that the
+ * FDTs do not need to be examined. If there is no match in the index, all
+ * configurations are checked as above.
+ *
  * returns:
  *     offset to the configuration to use if one was found
  *     -1 otherwise
@@ -1751,6 +1756,15 @@ int fit_conf_find_compat(const void *fit, const void *fdt)
 		return -1;
 	}
 
+	if (IS_ENABLED(CONFIG_FIT_BEST_MATCH_INDEX)) {
+		noffset = fit_conf_find_compat_index(fit, fdt_compat,
+						     fdt_compat_len);
+		if (noffset >= 0)
+			return noffset;
+		debug("No match in compatible index (%d), checking all\n",
+		      noffset);
+	}
+
 	/*
 	 * Loop over the configurations in the FIT image.
 	 */
@@ -1831,6 +1845,44 @@ int fit_conf_find_compat(const void *fit, const void *fdt)
 	return best_match_offset;
 }
 
+int fit_conf_find_compat_index(const void *fit, const char *compat,
+			       int compat_len)
+{
+	const char *index, *end, *entry, *conf_name;
+	int confs_noffset, noffset, len, cur_len;
+
+	confs_noffset = fdt_path_offset(fit, FIT_CONFS_PATH);
+	if (confs_noffset < 0)
+		return -ENOENT;
+	index = fdt_getprop(fit, confs_noffset, FIT_COMPAT_INDEX_PROP, &len);
+	if (!index)
+		return -ENOENT;
+	if (len <= 0 || index[len - 1])
+		return -EINVAL;
+	end = index + len;
+
+	/* Try each string in turn, since the first one is the best match */
+	for (; compat_len > 0; compat_len -= cur_len, compat += cur_len) {
+		cur_len = strnlen(compat, compat_len) + 1;
+		for (entry = index; entry < end;
+		     entry = conf_name + strlen(conf_name) + 1) {
+			conf_name = entry + strlen(entry) + 1;
+			if (conf_name >= end)
+				return -EINVAL;
+			if (strcmp(entry, compat))
+				continue;
+			debug("Compatible '%s' selects '%s'\n", compat,
+			      conf_name);
+			noffset = fdt_subnode_offset(fit, confs_noffset,
+						     conf_name);
+
+			return noffset < 0 ? -ENOENT : noffset;
+		}
+	}
+
+	return -ENOENT;
+}
+
 int fit_conf_get_node(const void *fit, const char *conf_uname)
 {
 	int noffset, confs_noffset;
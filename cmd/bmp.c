@@ -243,9 +243,12 @@ int bmp_display(ulong addr, int x, int y)
 	struct bmp_image *bmp = map_sysmem(addr, 0);
 	void *bmp_alloc_addr = NULL;
 	unsigned long len;
+	bool qoi;
 
-	if (!((bmp->header.signature[0]=='B') &&
-	      (bmp->header.signature[1]=='M')))
+	/* QOI images are decoded straight into the frame buffer */
+	qoi = IS_ENABLED(CONFIG_VIDEO_QOI) && video_qoi_is_image(bmp);
+	if (!qoi && !((bmp->header.signature[0]=='B') &&
+		      (bmp->header.signature[1]=='M')))
 		bmp = gunzip_bmp(addr, &len, &bmp_alloc_addr);
 
 	if (!bmp) {
@@ -264,7 +267,10 @@ int bmp_display(ulong addr, int x, int y)
 		    y == BMP_ALIGN_CENTER)
 			align = true;
 
-		ret = video_bmp_display(dev, addr, x, y, align);
+		if (qoi)
+			ret = video_qoi_display(dev, addr, x, y, align);
+		else
+			ret = video_bmp_display(dev, addr, x, y, align);
 	}
 #elif defined(CONFIG_LCD)
 	ret = lcd_display_bitmap(addr, x, y);
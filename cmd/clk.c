@@ -58,11 +58,25 @@ static void show_clks(struct udevice *dev, int depth, int last_flag)
 	}
 }
 
+#if CONFIG_IS_ENABLED(CLK_RATE_STATS)
+static void show_clk_rate_stats(const struct clk_rate_stats *stats)
+{
+	printf("\nRate queries: %lu, cached: %lu, invalidated: %lu\n",
+	       stats->queries, stats->hits, stats->invalidations);
+}
+#endif
+
 int __weak soc_clk_dump(void)
 {
 	struct udevice *dev;
 	struct uclass *uc;
 	int ret;
+#if CONFIG_IS_ENABLED(CLK_RATE_STATS)
+	struct clk_rate_stats stats;
+
+	/* Take the counters before the dump queries all rates itself */
+	clk_get_rate_stats(&stats);
+#endif
 
 	ret = uclass_get(UCLASS_CLK, &uc);
 	if (ret)
@@ -74,6 +88,10 @@ int __weak soc_clk_dump(void)
 	uclass_foreach_dev(dev, uc)
 		show_clks(dev, -1, 0);
 
+#if CONFIG_IS_ENABLED(CLK_RATE_STATS)
+	show_clk_rate_stats(&stats);
+#endif
+
 	return 0;
 }
 #else
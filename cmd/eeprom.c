@@ -34,6 +34,14 @@
 #define	EEPROM_PAGE_SIZE	(1 << CONFIG_SYS_EEPROM_PAGE_WRITE_BITS)
 #define	EEPROM_PAGE_OFFSET(x)	((x) & (EEPROM_PAGE_SIZE - 1))
 
+/* Range addressed without changing the address selector bits, see below */
+#if CONFIG_SYS_I2C_EEPROM_ADDR_LEN == 1
+#define	EEPROM_BLOCK_SIZE	0x100
+#else
+#define	EEPROM_BLOCK_SIZE	0x10000
+#endif
+#define	EEPROM_BLOCK_OFFSET(x)	((x) & (EEPROM_BLOCK_SIZE - 1))
+
 #if CONFIG_IS_ENABLED(DM_I2C)
 static int eeprom_i2c_bus;
 #endif
@@ -84,7 +92,7 @@ static int eeprom_addr(unsigned dev_addr, unsigned offset, uchar *addr)
 	return alen;
 }
 
-static int eeprom_len(unsigned offset, unsigned end)
+static int eeprom_len(unsigned offset, unsigned end, bool read)
 {
 	unsigned len = end - offset;
 
@@ -97,7 +105,14 @@ static int eeprom_len(unsigned offset, unsigned end)
 	unsigned blk_off = offset & 0xff;
 	unsigned maxlen = EEPROM_PAGE_SIZE - EEPROM_PAGE_OFFSET(blk_off);
 
-	if (maxlen > I2C_RXTX_LEN)
+	/*
+	 * Sequential reads are not bounded by the write page, only by the
+	 * block selected through the chip address. Driver model I2C has no
+	 * transfer buffer limit, so read a whole block in one transfer.
+	 */
+	if (CONFIG_IS_ENABLED(DM_I2C) && read)
+		maxlen = EEPROM_BLOCK_SIZE - EEPROM_BLOCK_OFFSET(offset);
+	else if (maxlen > I2C_RXTX_LEN)
 		maxlen = I2C_RXTX_LEN;
 
 	if (len > maxlen)
@@ -156,7 +171,7 @@ static int eeprom_rw(unsigned dev_addr, unsigned offset, uchar *buffer,
 	while (offset < end) {
 		alen = eeprom_addr(dev_addr, offset, addr);
 
-		len = eeprom_len(offset, end);
+		len = eeprom_len(offset, end, read);
 
 		rcode = eeprom_rw_block(offset, addr, alen, buffer, len, read);
 
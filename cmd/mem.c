@@ -24,10 +24,15 @@
 #include <watchdog.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
+#ifdef CONFIG_SANDBOX
+#include <asm/state.h>
+#endif
 #include <linux/bitops.h>
 #include <linux/compiler.h>
 #include <linux/ctype.h>
 #include <linux/delay.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -1057,6 +1062,239 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+/* Mismatches printed per iteration; the rest are only counted */
+#define MTEST_FAST_REPORT	16
+/* Words handled between watchdog and ctrl-c checks */
+#define MTEST_FAST_CHUNK	(SZ_1M / sizeof(ulong))
+#define MTEST_FAST_DIGITS	((int)sizeof(ulong) * 2)
+
+struct mtest_fast {
+	ulong *buf;		/* mapped start of the range */
+	ulong start;		/* bus address of @buf */
+	ulong words;		/* number of words tested, a multiple of 8 */
+	ulong errs;		/* mismatches found in this iteration */
+	u64 bytes;		/* bytes written and read, for the rate */
+};
+
+/*
+ * Store a pair of words. On arm64 use a non-temporal store pair so that a
+ * large range streams through to DRAM instead of evicting the caches.
+ */
+static inline void mtest_fast_store(ulong *p, ulong a, ulong b)
+{
+#ifdef CONFIG_ARM64
+	asm volatile("stnp %1, %2, [%0]" : : "r"(p), "r"(a), "r"(b)
+		     : "memory");
+#else
+	p[0] = a;
+	p[1] = b;
+#endif
+}
+
+static void mtest_fast_error(struct mtest_fast *mt, ulong i, ulong found,
+			     ulong expected)
+{
+	if (mt->errs++ >= MTEST_FAST_REPORT)
+		return;
+	/* The first report of an iteration ends the 'Iteration:' line */
+	printf("%sMem error @ 0x%08lx: found %0*lx, expected %0*lx, bits %0*lx\n",
+	       mt->errs == 1 ? "\n" : "", mt->start + i * sizeof(ulong),
+	       MTEST_FAST_DIGITS, found, MTEST_FAST_DIGITS, expected,
+	       MTEST_FAST_DIGITS, found ^ expected);
+}
+
+/* On sandbox, corrupt the word selected by sandbox_set_mtest_fault() */
+static void mtest_fast_inject(struct mtest_fast *mt)
+{
+#ifdef CONFIG_SANDBOX
+	struct sandbox_state *state = state_get_current();
+	ulong i;
+
+	if (!state->mtest_fault_bits || state->mtest_fault_addr < mt->start)
+		return;
+	i = (state->mtest_fault_addr - mt->start) / sizeof(ulong);
+	if (i < mt->words)
+		mt->buf[i] ^= state->mtest_fault_bits;
+#endif
+}
+
+static bool mtest_fast_abort(void)
+{
+	WATCHDOG_RESET();
+
+	return ctrlc();
+}
+
+/*
+ * Address-in-address: each word holds its own bus address, optionally
+ * inverted. This catches address lines which are stuck or shorted.
+ */
+static int mtest_fast_addr(struct mtest_fast *mt, ulong invert)
+{
+	ulong *buf = mt->buf;
+	ulong i, n, addr;
+
+	for (i = 0; i < mt->words; i = n) {
+		n = min(i + MTEST_FAST_CHUNK, mt->words);
+		addr = mt->start + i * sizeof(ulong);
+		for (; i < n; i += 2, addr += 2 * sizeof(ulong))
+			mtest_fast_store(&buf[i], addr ^ invert,
+					 (addr + sizeof(ulong)) ^ invert);
+		if (mtest_fast_abort())
+			return -1;
+	}
+	mtest_fast_inject(mt);
+	barrier();
+
+	for (i = 0; i < mt->words; i = n) {
+		n = min(i + MTEST_FAST_CHUNK, mt->words);
+		addr = mt->start + i * sizeof(ulong);
+		for (; i < n; i++, addr += sizeof(ulong)) {
+			if (buf[i] != (addr ^ invert))
+				mtest_fast_error(mt, i, buf[i], addr ^ invert);
+		}
+		if (mtest_fast_abort())
+			return -1;
+	}
+	mt->bytes += 2 * mt->words * sizeof(ulong);
+
+	return 0;
+}
+
+/*
+ * Moving inversions: fill with @pattern, then check and invert each word
+ * going up, then check and restore each word going down. The two sweep
+ * directions expose coupling faults between neighbouring cells.
+ */
+static int mtest_fast_mi(struct mtest_fast *mt, ulong pattern)
+{
+	ulong *buf = mt->buf;
+	ulong i, n;
+
+	for (i = 0; i < mt->words; i = n) {
+		n = min(i + MTEST_FAST_CHUNK, mt->words);
+		for (; i < n; i += 2)
+			mtest_fast_store(&buf[i], pattern, pattern);
+		if (mtest_fast_abort())
+			return -1;
+	}
+	mtest_fast_inject(mt);
+	barrier();
+
+	for (i = 0; i < mt->words; i = n) {
+		n = min(i + MTEST_FAST_CHUNK, mt->words);
+		for (; i < n; i++) {
+			if (buf[i] != pattern)
+				mtest_fast_error(mt, i, buf[i], pattern);
+			buf[i] = ~pattern;
+		}
+		if (mtest_fast_abort())
+			return -1;
+	}
+	barrier();
+
+	for (i = mt->words; i > 0; i = n) {
+		n = i > MTEST_FAST_CHUNK ? i - MTEST_FAST_CHUNK : 0;
+		while (i-- > n) {
+			if (buf[i] != ~pattern)
+				mtest_fast_error(mt, i, buf[i], ~pattern);
+			buf[i] = pattern;
+		}
+		if (mtest_fast_abort())
+			return -1;
+	}
+	mt->bytes += 5 * mt->words * sizeof(ulong);
+
+	return 0;
+}
+
+/* xorshift64*, which is plenty for a test pattern and cheap per word */
+static inline ulong mtest_fast_rand(u64 *state)
+{
+	u64 x = *state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	x *= 0x2545f4914f6cdd1dULL;
+
+	return sizeof(ulong) == sizeof(u64) ? (ulong)x : (ulong)(x >> 32);
+}
+
+/*
+ * Random data from a seeded generator, so that a failure can be
+ * reproduced by passing the same seed again.
+ */
+static int mtest_fast_random(struct mtest_fast *mt, ulong seed)
+{
+	ulong *buf = mt->buf;
+	ulong i, n, val;
+	u64 state;
+
+	state = seed | (u64)~seed << 32;
+	for (i = 0; i < mt->words; i = n) {
+		n = min(i + MTEST_FAST_CHUNK, mt->words);
+		for (; i < n; i += 2) {
+			val = mtest_fast_rand(&state);
+			mtest_fast_store(&buf[i], val, mtest_fast_rand(&state));
+		}
+		if (mtest_fast_abort())
+			return -1;
+	}
+	mtest_fast_inject(mt);
+	barrier();
+
+	state = seed | (u64)~seed << 32;
+	for (i = 0; i < mt->words; i = n) {
+		n = min(i + MTEST_FAST_CHUNK, mt->words);
+		for (; i < n; i++) {
+			val = mtest_fast_rand(&state);
+			if (buf[i] != val)
+				mtest_fast_error(mt, i, buf[i], val);
+		}
+		if (mtest_fast_abort())
+			return -1;
+	}
+	mt->bytes += 2 * mt->words * sizeof(ulong);
+
+	return 0;
+}
+
+/*
+ * Streaming test using whole-word accesses without per-access volatile
+ * semantics, so the compiler can unroll and the CPU can keep its write
+ * buffers full. Each iteration runs the address, moving-inversions and
+ * random tests; @pattern seeds the random test and picks the
+ * moving-inversions pattern together with @iteration.
+ */
+static ulong mem_test_fast(vu_long *buf, ulong start_addr, ulong end_addr,
+			   ulong pattern, int iteration)
+{
+	struct mtest_fast mt = {
+		.buf = (ulong *)buf,
+		.start = start_addr,
+		.words = ((end_addr - start_addr) / sizeof(ulong)) & ~7UL,
+	};
+	ulong seed = pattern + iteration;
+	ulong walk = 1UL << (iteration % BITS_PER_LONG);
+	ulong us, mbps;
+
+	us = timer_get_us();
+	if (mtest_fast_addr(&mt, 0) || mtest_fast_addr(&mt, ~0UL) ||
+	    mtest_fast_mi(&mt, walk) || mtest_fast_mi(&mt, ~walk) ||
+	    mtest_fast_random(&mt, seed))
+		return -1UL;
+	us = max(timer_get_us() - us, 1UL);
+
+	/* bytes per microsecond is MB/s */
+	mbps = div_u64(mt.bytes, us);
+	printf("Iteration: %6d  seed %08lx  %lu.%03lu GB/s\r", iteration + 1,
+	       seed, mbps / 1000, mbps % 1000);
+
+	return mt.errs;
+}
+
 /*
  * Perform a memory test. A more complete alternative test can be
  * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
@@ -1121,6 +1359,9 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 				count += errs;
 				errs = mem_test_bitflip(buf, start, end);
 			}
+		} else if (IS_ENABLED(CONFIG_SYS_MEMTEST_FAST)) {
+			errs = mem_test_fast(buf, start, end, pattern,
+					     iteration);
 		} else {
 			errs = mem_test_quick(buf, start, end, pattern,
 					      iteration);
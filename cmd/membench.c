@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Memory bandwidth and latency benchmark
+ *
+ * The bandwidth part follows the four STREAM kernels (copy, scale, add and
+ * triad) on 64-bit integers, since U-Boot is built without floating point.
+ * The latency part chases pointers through a random cycle of cache lines,
+ * doubling the working set each step so that the cache levels and DRAM show
+ * up as plateaus in the results.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <cpu_func.h>
+#include <env.h>
+#include <mapmem.h>
+#include <rand.h>
+#include <time.h>
+#include <watchdog.h>
+#include <linux/compiler.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
+
+/* Number of times each kernel is run; the best time is reported */
+#define MEMBENCH_REPEAT		5
+/* Cache line size assumed for the latency test */
+#define MEMBENCH_LINE		64
+/* Smallest working set for the latency test */
+#define MEMBENCH_LAT_MIN	SZ_4K
+/* Dependent loads per latency measurement */
+#define MEMBENCH_LAT_LOADS	(1 << 20)
+
+#define MEMBENCH_SCALAR		3
+
+enum {
+	MEMBENCH_COPY,
+	MEMBENCH_SCALE,
+	MEMBENCH_ADD,
+	MEMBENCH_TRIAD,
+
+	MEMBENCH_COUNT,
+};
+
+static const struct {
+	const char *name;
+	int words;	/* words moved per element */
+} membench_kernel[MEMBENCH_COUNT] = {
+	[MEMBENCH_COPY]		= { "copy", 2 },
+	[MEMBENCH_SCALE]	= { "scale", 2 },
+	[MEMBENCH_ADD]		= { "add", 3 },
+	[MEMBENCH_TRIAD]	= { "triad", 3 },
+};
+
+static void membench_run(int kernel, u64 *a, u64 *b, u64 *c, ulong n)
+{
+	ulong i;
+
+	switch (kernel) {
+	case MEMBENCH_COPY:
+		for (i = 0; i < n; i++)
+			c[i] = a[i];
+		break;
+	case MEMBENCH_SCALE:
+		for (i = 0; i < n; i++)
+			b[i] = MEMBENCH_SCALAR * c[i];
+		break;
+	case MEMBENCH_ADD:
+		for (i = 0; i < n; i++)
+			c[i] = a[i] + b[i];
+		break;
+	case MEMBENCH_TRIAD:
+		for (i = 0; i < n; i++)
+			a[i] = b[i] + MEMBENCH_SCALAR * c[i];
+		break;
+	}
+	barrier();
+}
+
+/**
+ * membench_bandwidth() - Run the STREAM kernels
+ *
+ * @buf: Buffer to use, split into three arrays
+ * @size: Size of @buf in bytes
+ * @mbps: Returns the best rate of each kernel in MB/s
+ * Return: 0 if OK, -EINTR if interrupted
+ */
+static int membench_bandwidth(void *buf, ulong size, ulong mbps[])
+{
+	ulong n = size / 3 / sizeof(u64);
+	u64 *a = buf, *b = a + n, *c = b + n;
+	ulong start, us;
+	int kernel, rep;
+	ulong i;
+
+	for (i = 0; i < n; i++) {
+		a[i] = 1;
+		b[i] = 2;
+		c[i] = 0;
+	}
+
+	for (kernel = 0; kernel < MEMBENCH_COUNT; kernel++) {
+		ulong best = ~0UL;
+		u64 bytes = (u64)n * membench_kernel[kernel].words *
+			    sizeof(u64);
+
+		for (rep = 0; rep < MEMBENCH_REPEAT; rep++) {
+			WATCHDOG_RESET();
+			if (ctrlc())
+				return -EINTR;
+			start = timer_get_us();
+			membench_run(kernel, a, b, c, n);
+			us = timer_get_us() - start;
+			best = min(best, max(us, 1UL));
+		}
+		/* bytes per microsecond is MB/s */
+		mbps[kernel] = div_u64(bytes, best);
+	}
+
+	return 0;
+}
+
+/*
+ * Link the cache lines of @buf into a single random cycle (Sattolo's
+ * algorithm), so that each load depends on the previous one and the
+ * hardware prefetchers cannot guess the next line. The second word of each
+ * line holds the permutation while it is being built.
+ */
+static void **membench_chain(void *buf, ulong size)
+{
+	ulong lines = size / MEMBENCH_LINE;
+	ulong i, j, tmp;
+
+#define LINE(i)		((ulong *)((char *)buf + (i) * MEMBENCH_LINE))
+	for (i = 0; i < lines; i++)
+		LINE(i)[1] = i;
+	for (i = lines - 1; i > 0; i--) {
+		j = rand() % i;
+		tmp = LINE(i)[1];
+		LINE(i)[1] = LINE(j)[1];
+		LINE(j)[1] = tmp;
+	}
+	for (i = 0; i < lines; i++)
+		*(void **)LINE(LINE(i)[1]) = LINE(LINE((i + 1) % lines)[1]);
+#undef LINE
+
+	return buf;
+}
+
+/**
+ * membench_latency() - Measure the load-to-use latency for a working set
+ *
+ * @buf: Buffer to use
+ * @size: Working-set size in bytes
+ * Return: average latency in picoseconds
+ */
+static ulong membench_latency(void *buf, ulong size)
+{
+	void * volatile sink;
+	void **p;
+	ulong start, us;
+	ulong i;
+
+	p = membench_chain(buf, size);
+
+	/* warm up, so a cached working set really is in the cache */
+	for (i = 0; i < size / MEMBENCH_LINE; i++)
+		p = *p;
+
+	start = timer_get_us();
+	for (i = 0; i < MEMBENCH_LAT_LOADS; i++)
+		p = *p;
+	us = timer_get_us() - start;
+	sink = p;
+	(void)sink;
+
+	return div_u64((u64)us * 1000000, MEMBENCH_LAT_LOADS);
+}
+
+static int membench(void *buf, ulong size, bool set_env)
+{
+	ulong mbps[MEMBENCH_COUNT];
+	char name[32];
+	ulong ws, ps;
+	int kernel;
+	int ret;
+
+	ret = membench_bandwidth(buf, size, mbps);
+	if (ret)
+		return ret;
+
+	printf("Kernel   Rate (MB/s)\n");
+	for (kernel = 0; kernel < MEMBENCH_COUNT; kernel++) {
+		printf("%-8s %11lu\n", membench_kernel[kernel].name,
+		       mbps[kernel]);
+		if (set_env) {
+			snprintf(name, sizeof(name), "membench_%s",
+				 membench_kernel[kernel].name);
+			env_set_ulong(name, mbps[kernel]);
+		}
+	}
+
+	printf("\nWorking set  Latency (ns)\n");
+	for (ws = MEMBENCH_LAT_MIN; ws <= size; ws <<= 1) {
+		WATCHDOG_RESET();
+		if (ctrlc())
+			return -EINTR;
+		ps = membench_latency(buf, ws);
+		printf("%8lu KiB  %8lu.%03lu\n", ws / SZ_1K, ps / 1000,
+		       ps % 1000);
+		if (set_env) {
+			snprintf(name, sizeof(name), "membench_lat_%lu",
+				 ws / SZ_1K);
+			env_set_ulong(name, ps);
+		}
+	}
+
+	return 0;
+}
+
+static int do_membench(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	bool set_env = false, uncached = false;
+	ulong addr, size;
+	void *buf;
+	int ret;
+
+	while (argc > 1 && argv[1][0] == '-') {
+		if (!strcmp(argv[1], "-e"))
+			set_env = true;
+		else if (!strcmp(argv[1], "-u"))
+			uncached = true;
+		else
+			return CMD_RET_USAGE;
+		argc--;
+		argv++;
+	}
+	if (argc != 3)
+		return CMD_RET_USAGE;
+
+	addr = hextoul(argv[1], NULL);
+	size = hextoul(argv[2], NULL);
+	if (size < MEMBENCH_LAT_MIN) {
+		printf("Size must be at least %#x bytes\n", MEMBENCH_LAT_MIN);
+		return CMD_RET_FAILURE;
+	}
+
+	buf = map_sysmem(addr, size);
+#ifdef CONFIG_SANDBOX
+	if (uncached) {
+		puts("Uncached runs are not supported on sandbox\n");
+		unmap_sysmem(buf);
+		return CMD_RET_FAILURE;
+	}
+	ret = membench(buf, size, set_env);
+#else
+	if (uncached && dcache_status()) {
+		dcache_disable();
+		ret = membench(buf, size, set_env);
+		dcache_enable();
+	} else {
+		ret = membench(buf, size, set_env);
+	}
+#endif
+	unmap_sysmem(buf);
+	if (ret == -EINTR)
+		puts("\nInterrupted\n");
+
+	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(
+	membench,	5,	0,	do_membench,
+	"measure memory bandwidth and latency",
+	"[-e] [-u] addr size\n"
+	"    - run the STREAM kernels and a pointer-chasing latency test\n"
+	"      over 'size' bytes at 'addr'\n"
+	"    -e: also store the results in membench_* variables\n"
+	"    -u: run with the data cache disabled"
+);
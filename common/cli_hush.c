@@ -84,6 +84,7 @@
 #include <cli.h>
 #include <cli_hush.h>
 #include <command.h>        /* find_cmd */
+#include <bootstage.h>
 #include <asm/global_data.h>
 #endif
 #ifndef __U_BOOT__
@@ -374,8 +375,12 @@ static inline void debug_printf(const char *format, ...) { }
 #define final_printf debug_printf
 
 #ifdef __U_BOOT__
+/* Set while parsing a script for the cache, which reports errors itself */
+static bool syntax_quiet;
+
 static void syntax_err(void) {
-	 printf("syntax error\n");
+	if (!syntax_quiet)
+		printf("syntax error\n");
 }
 #else
 static void __syntax(char *file, int line) {
@@ -1539,6 +1544,7 @@ static int run_pipe_real(struct pipe *pi)
 	struct child_prog *child;
 	struct built_in_command *x;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1551,6 +1557,7 @@ static int run_pipe_real(struct pipe *pi)
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1617,6 +1624,11 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/*
+		 * Count the substitutions left in a local, since the pipe may
+		 * run again, e.g. in a loop or from the parse cache
+		 */
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1625,11 +1637,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -3186,9 +3198,16 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 		update_ifs_map();
 		if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING)) mapset((uchar *)";$&|", 0);
 		inp->promptmode=1;
+#ifdef __U_BOOT__
+		if (inp->peek == static_peek)
+			bootstage_start(BOOTSTAGE_ID_ACCUM_HUSH_PARSE,
+					"hush_parse");
+#endif
 		rcode = parse_stream(&temp, &ctx, inp,
 				     flag & FLAG_CONT_ON_NEWLINE ? -1 : '\n');
 #ifdef __U_BOOT__
+		if (inp->peek == static_peek)
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_HUSH_PARSE);
 		if (rcode == 1) flag_repeat = 0;
 #endif
 		if (rcode != 1 && ctx.old_flag != 0) {
@@ -3242,6 +3261,209 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #endif /* __U_BOOT__ */
 }
 
+#if defined(__U_BOOT__) && CONFIG_IS_ENABLED(HUSH_PARSE_CACHE)
+/*
+ * Cache of parsed scripts, so that a script which is run many times, e.g. by
+ * 'run' or 'source', or a command which is re-parsed after variable
+ * substitution, is only parsed once.
+ *
+ * Parsing depends only on the text of the script, the flags and IFS, so
+ * scripts are looked up by a hash of the text and then compared in full.
+ *
+ * A cached script is parsed as a whole before any of it runs, whereas hush
+ * normally parses and runs one line at a time. The only state which affects
+ * parsing is the IFS environment variable, so the cache is not used if IFS is
+ * set, nor for scripts which mention IFS and so may set it part-way through.
+ * A script with a syntax error is not cached, so its first lines still run
+ * before the error is reported.
+ */
+struct parse_cache {
+	char *text;		/* copy of the script, NULL if entry is unused */
+	uint hash;		/* hash of @text */
+	int flag;		/* FLAG_... values used to parse it */
+	struct pipe **lists;	/* parsed pipe lists, run one after another */
+	int count;		/* number of pipe lists */
+	bool busy;		/* script is running */
+	ulong last_used;	/* value of parse_cache_seq when last used */
+};
+
+static struct parse_cache parse_cache[CONFIG_HUSH_PARSE_CACHE_SIZE];
+static ulong parse_cache_seq;
+static ulong parse_cache_hits, parse_cache_misses;
+
+void hush_parse_cache_stats(ulong *hits, ulong *misses)
+{
+	*hits = parse_cache_hits;
+	*misses = parse_cache_misses;
+}
+
+static uint parse_cache_hash(const char *s, int flag)
+{
+	uint hash = 2166136261U ^ flag;
+
+	while (*s) {
+		hash ^= (uchar)*s++;
+		hash *= 16777619;
+	}
+
+	return hash;
+}
+
+static void parse_cache_free(struct parse_cache *pc)
+{
+	int i;
+
+	for (i = 0; i < pc->count; i++)
+		free_pipe_list(pc->lists[i], 0);
+	free(pc->lists);
+	free(pc->text);
+	memset(pc, '\0', sizeof(*pc));
+}
+
+/**
+ * parse_cache_get() - Find a script in the cache, or a slot to put it in
+ *
+ * @s:		Script to look for
+ * @flag:	FLAG_... values to use for parsing
+ * @hash:	Hash of @s and @flag
+ * Return: entry holding the script, or an empty entry (with a NULL text),
+ *	or NULL if the script is already running or all entries are in use
+ */
+static struct parse_cache *parse_cache_get(const char *s, int flag, uint hash)
+{
+	struct parse_cache *pc, *victim = NULL;
+
+	for (pc = parse_cache; pc < parse_cache + ARRAY_SIZE(parse_cache);
+	     pc++) {
+		if (pc->text && pc->hash == hash && pc->flag == flag &&
+		    !strcmp(pc->text, s))
+			return pc->busy ? NULL : pc;
+		if (!pc->busy && (!victim || !pc->text ||
+				  (victim->text &&
+				   pc->last_used < victim->last_used)))
+			victim = pc;
+	}
+	if (victim && victim->text)
+		parse_cache_free(victim);
+
+	return victim;
+}
+
+/**
+ * parse_cache_parse() - Parse a complete script
+ *
+ * This parses a script in the same way as parse_stream_outer(), but without
+ * running anything.
+ *
+ * @s:		Script to parse, ending in a newline
+ * @flag:	FLAG_... values to use
+ * @pc:		Cache entry to hold the resulting pipe lists
+ * Return: 0 if OK, -EINVAL on a syntax error
+ */
+static int parse_cache_parse(const char *s, int flag, struct parse_cache *pc)
+{
+	o_string temp = NULL_O_STRING;
+	struct in_str input;
+	struct p_context ctx;
+	int rcode;
+
+	setup_string_in_str(&input, s);
+	bootstage_start(BOOTSTAGE_ID_ACCUM_HUSH_PARSE, "hush_parse");
+	syntax_quiet = true;
+	do {
+		ctx.type = flag;
+		initialize_context(&ctx);
+		update_ifs_map();
+		if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING))
+			mapset((uchar *)";$&|", 0);
+		input.promptmode = 1;
+		rcode = parse_stream(&temp, &ctx, &input,
+				     flag & FLAG_CONT_ON_NEWLINE ? -1 : '\n');
+		if (rcode == 1 || ctx.old_flag) {
+			if (ctx.old_flag)
+				free(ctx.stack);
+			b_free(&temp);
+			free_pipe_list(ctx.list_head, 0);
+			syntax_quiet = false;
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_HUSH_PARSE);
+			return -EINVAL;
+		}
+		done_word(&temp, &ctx);
+		done_pipe(&ctx, PIPE_SEQ);
+		b_free(&temp);
+		pc->lists = xrealloc(pc->lists,
+				     (pc->count + 1) * sizeof(*pc->lists));
+		pc->lists[pc->count++] = ctx.list_head;
+	} while (rcode != -1 && !(flag & FLAG_EXIT_FROM_LOOP) && b_peek(&input));
+	syntax_quiet = false;
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_HUSH_PARSE);
+
+	return 0;
+}
+
+/**
+ * parse_cache_run() - Parse and run a script, using the cache
+ *
+ * @s:		Script to run, ending in a newline
+ * @flag:	FLAG_... values to use
+ * Return: 0 or 1, as for parse_stream_outer(), or -1 if the cache cannot be
+ *	used, in which case the caller must parse the script itself
+ */
+static int parse_cache_run(const char *s, int flag)
+{
+	struct parse_cache *pc;
+	int code = 1;
+	uint hash;
+	int i;
+
+	if (env_get("IFS") || strstr(s, "IFS"))
+		return -1;
+	hash = parse_cache_hash(s, flag);
+	pc = parse_cache_get(s, flag, hash);
+	if (!pc)
+		return -1;
+	if (pc->text) {
+		parse_cache_hits++;
+	} else {
+		parse_cache_misses++;
+		if (parse_cache_parse(s, flag, pc)) {
+			/* let the caller parse it again, to report the error */
+			parse_cache_free(pc);
+			return -1;
+		}
+		pc->text = strdup(s);
+		if (!pc->text) {
+			parse_cache_free(pc);
+			return -1;
+		}
+		pc->hash = hash;
+		pc->flag = flag;
+	}
+
+	pc->busy = true;
+	pc->last_used = ++parse_cache_seq;
+	for (i = 0; i < pc->count; i++) {
+		code = run_list_real(pc->lists[i]);
+		if (code == -2) {	/* exit */
+			code = 0;
+			break;
+		}
+		if (code == -1)
+			flag_repeat = 0;
+	}
+	pc->busy = false;
+
+	/*
+	 * A loop which is cut short leaves its pipes modified, so don't keep
+	 * them
+	 */
+	if (i < pc->count || had_ctrlc())
+		parse_cache_free(pc);
+
+	return code != 0 ? 1 : 0;
+}
+#endif
+
 #ifndef __U_BOOT__
 static int parse_string_outer(const char *s, int flag)
 #else
@@ -3260,11 +3482,24 @@ int parse_string_outer(const char *s, int flag)
 		p = xmalloc(strlen(s) + 2);
 		strcpy(p, s);
 		strcat(p, "\n");
+#if CONFIG_IS_ENABLED(HUSH_PARSE_CACHE)
+		rcode = parse_cache_run(p, flag);
+		if (rcode < 0) {
+			setup_string_in_str(&input, p);
+			rcode = parse_stream_outer(&input, flag);
+		}
+#else
 		setup_string_in_str(&input, p);
 		rcode = parse_stream_outer(&input, flag);
+#endif
 		free(p);
 		return rcode;
 	} else {
+#if CONFIG_IS_ENABLED(HUSH_PARSE_CACHE)
+		rcode = parse_cache_run(s, flag);
+		if (rcode >= 0)
+			return rcode;
+#endif
 #endif
 	setup_string_in_str(&input, s);
 	return parse_stream_outer(&input, flag);
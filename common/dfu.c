@@ -40,6 +40,7 @@ int run_usb_dnl_gadget(int usbctrl_index, char *usb_dnl_gadget)
 #ifdef CONFIG_DFU_TIMEOUT
 	unsigned long start_time = get_timer(0);
 #endif
+	dfu_set_deferred_write(true);
 
 	while (1) {
 		if (g_dnl_detach()) {
@@ -98,6 +99,15 @@ int run_usb_dnl_gadget(int usbctrl_index, char *usb_dnl_gadget)
 		}
 #endif
 
+		if (dfu_get_pending_write()) {
+			/*
+			 * Complete the transfer that filled the buffer before
+			 * writing it. Errors are reported by the next DNLOAD.
+			 */
+			usb_gadget_handle_interrupts(usbctrl_index);
+			dfu_write_pending();
+		}
+
 		if (dfu_reinit_needed)
 			goto exit;
 
@@ -105,6 +115,7 @@ int run_usb_dnl_gadget(int usbctrl_index, char *usb_dnl_gadget)
 		usb_gadget_handle_interrupts(usbctrl_index);
 	}
 exit:
+	dfu_set_deferred_write(false);
 	g_dnl_unregister();
 	usb_gadget_release(usbctrl_index);
 
@@ -20,8 +20,10 @@
 #include <spi_flash.h>
 #include <splash.h>
 #include <usb.h>
+#include <video.h>
 #include <virtio.h>
 #include <asm/global_data.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -65,15 +67,16 @@ static int splash_nand_read_raw(u32 bmp_load_addr, int offset, size_t read_size)
 }
 #endif
 
-static int splash_storage_read_raw(struct splash_location *location,
-			       u32 bmp_load_addr, size_t read_size)
+static int splash_storage_read_raw_at(struct splash_location *location,
+				      u32 bmp_load_addr, u32 skip,
+				      size_t read_size)
 {
 	u32 offset;
 
 	if (!location)
 		return -EINVAL;
 
-	offset = location->offset;
+	offset = location->offset + skip;
 	switch (location->storage) {
 	case SPLASH_STORAGE_NAND:
 		return splash_nand_read_raw(bmp_load_addr, offset, read_size);
@@ -86,6 +89,39 @@ static int splash_storage_read_raw(struct splash_location *location,
 	return -EINVAL;
 }
 
+static int splash_storage_read_raw(struct splash_location *location,
+			       u32 bmp_load_addr, size_t read_size)
+{
+	return splash_storage_read_raw_at(location, bmp_load_addr, 0,
+					  read_size);
+}
+
+/*
+ * QOI images do not record their size. Read them in growing chunks until the
+ * end of the image has been found, @read bytes are already loaded.
+ */
+static int splash_load_raw_qoi(struct splash_location *location,
+			       u32 bmp_load_addr, size_t read)
+{
+	void *img = (void *)(uintptr_t)bmp_load_addr;
+	size_t next;
+	long size;
+	int res;
+
+	while ((size = video_qoi_get_size(img, read)) == -EAGAIN) {
+		next = max_t(size_t, read * 2, SZ_64K);
+		if (bmp_load_addr + next >= gd->start_addr_sp)
+			return -EFAULT;
+		res = splash_storage_read_raw_at(location, bmp_load_addr + read,
+						 read, next - read);
+		if (res < 0)
+			return res;
+		read = next;
+	}
+
+	return size < 0 ? size : 0;
+}
+
 static int splash_load_raw(struct splash_location *location, u32 bmp_load_addr)
 {
 	struct bmp_header *bmp_hdr;
@@ -100,6 +136,13 @@ static int splash_load_raw(struct splash_location *location, u32 bmp_load_addr)
 		return res;
 
 	bmp_hdr = (struct bmp_header *)(uintptr_t)bmp_load_addr;
+	if (IS_ENABLED(CONFIG_VIDEO_QOI) && video_qoi_is_image(bmp_hdr)) {
+		res = splash_load_raw_qoi(location, bmp_load_addr,
+					  bmp_header_size);
+		if (res == -EFAULT)
+			goto splash_address_too_high;
+		return res;
+	}
 	bmp_size = le32_to_cpu(bmp_hdr->file_size);
 
 	if (bmp_load_addr + bmp_size >= gd->start_addr_sp)
@@ -226,6 +269,7 @@ static inline int splash_umount_ubifs(void)
 #endif
 
 #define SPLASH_SOURCE_DEFAULT_FILE_NAME		"splash.bmp"
+#define SPLASH_SOURCE_QOI_FILE_NAME		"splash.qoi"
 
 static int splash_load_fs(struct splash_location *location, u32 bmp_load_addr)
 {
@@ -257,6 +301,13 @@ static int splash_load_fs(struct splash_location *location, u32 bmp_load_addr)
 	if (res)
 		goto out;
 
+	/* Prefer a QOI image, it is much smaller and faster to display */
+	if (IS_ENABLED(CONFIG_VIDEO_QOI) && !env_get("splashfile")) {
+		if (fs_exists(SPLASH_SOURCE_QOI_FILE_NAME))
+			splash_file = SPLASH_SOURCE_QOI_FILE_NAME;
+		splash_select_fs_dev(location);
+	}
+
 	res = fs_size(splash_file, &bmp_size);
 	if (res) {
 		printf("Error (%d): cannot determine file size\n", res);
@@ -240,6 +240,7 @@ void part_init(struct blk_desc *dev_desc)
 	struct part_driver *entry;
 
 	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+	gpt_cache_invalidate(dev_desc);
 
 	dev_desc->part_type = PART_TYPE_UNKNOWN;
 	for (entry = drv; entry != drv + n_ents; entry++) {
@@ -679,6 +680,9 @@ int part_get_info_by_name_type(struct blk_desc *dev_desc, const char *name,
 		return -ENOSYS;
 	}
 
+	if (part_drv->get_info_by_name)
+		return part_drv->get_info_by_name(dev_desc, name, info);
+
 	for (i = 1; i < part_drv->max_entries; i++) {
 		ret = part_drv->get_info(dev_desc, i, info);
 		if (ret != 0) {
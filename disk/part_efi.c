@@ -23,6 +23,7 @@
 #include <malloc.h>
 #include <memalign.h>
 #include <part_efi.h>
+#include <sort.h>
 #include <dm/ofnode.h>
 #include <linux/compiler.h>
 #include <linux/ctype.h>
@@ -190,6 +191,233 @@ static void prepare_backup_gpt_header(gpt_header *gpt_h)
 }
 
 #if CONFIG_IS_ENABLED(EFI_PARTITION)
+/*
+ * GPT cache
+ *
+ * Reading a partition means reading and checking the GPT header and the whole
+ * partition entry array, and looking up a partition by name used to do this
+ * for every partition number. So the valid GPTs of the last few devices used
+ * are kept here, keyed on the device and its hardware partition. An entry is
+ * dropped by part_init() and when the GPT areas of the device are written.
+ */
+#define GPT_CACHE_ENTRIES	4
+
+/**
+ * struct gpt_cache_name - Entry in the name index of a cached GPT
+ *
+ * @name:	Partition name, as returned in struct disk_partition
+ * @part:	Partition number (1 = first)
+ */
+struct gpt_cache_name {
+	char name[PART_NAME_LEN];
+	int part;
+};
+
+/**
+ * struct gpt_cache_node - Valid GPT read from a block device
+ *
+ * @if_type:	Interface type of the device
+ * @devnum:	Device number
+ * @hwpart:	Hardware partition the GPT was read from
+ * @lba:	Number of blocks of the device
+ * @blksz:	Block size of the device
+ * @gpt_head:	GPT header (the backup one if the primary is invalid)
+ * @gpt_pte:	Partition table entries
+ * @names:	Name index, sorted by name and then partition number, or NULL
+ *		if not built yet
+ * @name_count:	Number of entries in @names
+ */
+struct gpt_cache_node {
+	enum if_type if_type;
+	int devnum;
+	int hwpart;
+	lbaint_t lba;
+	ulong blksz;
+	gpt_header *gpt_head;
+	gpt_entry *gpt_pte;
+	struct gpt_cache_name *names;
+	int name_count;
+};
+
+/* Cached GPTs, most recently used first */
+static struct gpt_cache_node *gpt_cache[GPT_CACHE_ENTRIES];
+
+static void gpt_cache_free(struct gpt_cache_node *node)
+{
+	if (!node)
+		return;
+	free(node->names);
+	free(node->gpt_pte);
+	free(node->gpt_head);
+	free(node);
+}
+
+static bool gpt_cache_match(struct gpt_cache_node *node,
+			    struct blk_desc *dev_desc)
+{
+	return node->if_type == dev_desc->if_type &&
+	       node->devnum == dev_desc->devnum &&
+	       node->hwpart == dev_desc->hwpart &&
+	       node->lba == dev_desc->lba &&
+	       node->blksz == dev_desc->blksz;
+}
+
+/**
+ * gpt_cache_get() - Get the valid GPT of a block device
+ *
+ * The GPT is read and checked with find_valid_gpt() unless it is cached
+ * already. Release it with gpt_cache_put() when done.
+ *
+ * @dev_desc:	Block device descriptor
+ * Return: GPT, or NULL if there is no valid GPT or no memory
+ */
+static struct gpt_cache_node *gpt_cache_get(struct blk_desc *dev_desc)
+{
+	struct gpt_cache_node *node;
+	int i;
+
+	if (CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)) {
+		for (i = 0; i < GPT_CACHE_ENTRIES && gpt_cache[i]; i++) {
+			node = gpt_cache[i];
+			if (gpt_cache_match(node, dev_desc)) {
+				/* maintain MRU ordering */
+				memmove(&gpt_cache[1], &gpt_cache[0],
+					i * sizeof(node));
+				gpt_cache[0] = node;
+				return node;
+			}
+		}
+	}
+
+	node = calloc(1, sizeof(*node));
+	if (!node)
+		return NULL;
+	node->gpt_head = malloc_cache_aligned(PAD_TO_BLOCKSIZE(sizeof(gpt_header),
+							       dev_desc));
+	if (!node->gpt_head) {
+		free(node);
+		return NULL;
+	}
+
+	/* This function validates AND fills in the GPT header and PTE */
+	if (find_valid_gpt(dev_desc, node->gpt_head, &node->gpt_pte) != 1) {
+		/* the PTEs are not allocated on failure */
+		free(node->gpt_head);
+		free(node);
+		return NULL;
+	}
+	node->if_type = dev_desc->if_type;
+	node->devnum = dev_desc->devnum;
+	node->hwpart = dev_desc->hwpart;
+	node->lba = dev_desc->lba;
+	node->blksz = dev_desc->blksz;
+
+	if (CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)) {
+		gpt_cache_free(gpt_cache[GPT_CACHE_ENTRIES - 1]);
+		memmove(&gpt_cache[1], &gpt_cache[0],
+			(GPT_CACHE_ENTRIES - 1) * sizeof(node));
+		gpt_cache[0] = node;
+	}
+
+	return node;
+}
+
+/**
+ * gpt_cache_put() - Release a GPT obtained with gpt_cache_get()
+ *
+ * @node:	GPT to release
+ */
+static void gpt_cache_put(struct gpt_cache_node *node)
+{
+	if (!CONFIG_IS_ENABLED(EFI_PARTITION_CACHE))
+		gpt_cache_free(node);
+}
+
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+static void gpt_cache_remove(int i)
+{
+	gpt_cache_free(gpt_cache[i]);
+	memmove(&gpt_cache[i], &gpt_cache[i + 1],
+		(GPT_CACHE_ENTRIES - 1 - i) * sizeof(gpt_cache[0]));
+	gpt_cache[GPT_CACHE_ENTRIES - 1] = NULL;
+}
+
+void gpt_cache_invalidate(struct blk_desc *dev_desc)
+{
+	struct gpt_cache_node *node;
+	int i = 0;
+
+	while (i < GPT_CACHE_ENTRIES && gpt_cache[i]) {
+		node = gpt_cache[i];
+		if (node->if_type == dev_desc->if_type &&
+		    node->devnum == dev_desc->devnum)
+			gpt_cache_remove(i);
+		else
+			i++;
+	}
+}
+
+void gpt_cache_write(struct blk_desc *dev_desc, lbaint_t start,
+		     lbaint_t blkcnt)
+{
+	struct gpt_cache_node *node;
+	int i;
+
+	for (i = 0; i < GPT_CACHE_ENTRIES && gpt_cache[i]; i++) {
+		node = gpt_cache[i];
+		if (!gpt_cache_match(node, dev_desc))
+			continue;
+		if (start < le64_to_cpu(node->gpt_head->first_usable_lba) ||
+		    start + blkcnt >
+		    le64_to_cpu(node->gpt_head->last_usable_lba) + 1)
+			gpt_cache_remove(i);
+		break;
+	}
+}
+
+static int gpt_cache_name_cmp(const void *a, const void *b)
+{
+	const struct gpt_cache_name *na = a, *nb = b;
+	int ret;
+
+	ret = strcmp(na->name, nb->name);
+
+	return ret ? ret : na->part - nb->part;
+}
+
+/**
+ * gpt_cache_index_names() - Build the name index of a cached GPT
+ *
+ * This covers the same partitions as the scan in
+ * part_get_info_by_name_type(), i.e. those before the first unused entry.
+ *
+ * @node:	Cached GPT
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+static int gpt_cache_index_names(struct gpt_cache_node *node)
+{
+	struct gpt_cache_name *names;
+	int count, i;
+
+	count = min_t(int, le32_to_cpu(node->gpt_head->num_partition_entries),
+		      GPT_ENTRY_NUMBERS - 1);
+	names = malloc(max(count, 1) * sizeof(*names));
+	if (!names)
+		return -ENOMEM;
+
+	for (i = 0; i < count && is_pte_valid(&node->gpt_pte[i]); i++) {
+		snprintf(names[i].name, sizeof(names[i].name), "%s",
+			 print_efiname(&node->gpt_pte[i]));
+		names[i].part = i + 1;
+	}
+	qsort(names, i, sizeof(*names), gpt_cache_name_cmp);
+	node->names = names;
+	node->name_count = i;
+
+	return 0;
+}
+#endif /* EFI_PARTITION_CACHE */
+
 /*
  * Public Functions (include/part.h)
  */
@@ -200,32 +428,33 @@ static void prepare_backup_gpt_header(gpt_header *gpt_h)
  */
 int get_disk_guid(struct blk_desc * dev_desc, char *guid)
 {
-	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, dev_desc->blksz);
-	gpt_entry *gpt_pte = NULL;
+	struct gpt_cache_node *node;
 	unsigned char *guid_bin;
 
-	/* This function validates AND fills in the GPT header and PTE */
-	if (find_valid_gpt(dev_desc, gpt_head, &gpt_pte) != 1)
+	node = gpt_cache_get(dev_desc);
+	if (!node)
 		return -EINVAL;
 
-	guid_bin = gpt_head->disk_guid.b;
+	guid_bin = node->gpt_head->disk_guid.b;
 	uuid_bin_to_str(guid_bin, guid, UUID_STR_FORMAT_GUID);
 
-	/* Remember to free pte */
-	free(gpt_pte);
+	gpt_cache_put(node);
 	return 0;
 }
 
 void part_print_efi(struct blk_desc *dev_desc)
 {
-	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, dev_desc->blksz);
-	gpt_entry *gpt_pte = NULL;
+	struct gpt_cache_node *node;
+	gpt_header *gpt_head;
+	gpt_entry *gpt_pte;
 	int i = 0;
 	unsigned char *uuid;
 
-	/* This function validates AND fills in the GPT header and PTE */
-	if (find_valid_gpt(dev_desc, gpt_head, &gpt_pte) != 1)
+	node = gpt_cache_get(dev_desc);
+	if (!node)
 		return;
+	gpt_head = node->gpt_head;
+	gpt_pte = node->gpt_pte;
 
 	debug("%s: gpt-entry at %p\n", __func__, gpt_pte);
 
@@ -253,16 +482,14 @@ void part_print_efi(struct blk_desc *dev_desc)
 		printf("\tguid:\t%pUl\n", uuid);
 	}
 
-	/* Remember to free pte */
-	free(gpt_pte);
-	return;
+	gpt_cache_put(node);
 }
 
 int part_get_info_efi(struct blk_desc *dev_desc, int part,
 		      struct disk_partition *info)
 {
-	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, dev_desc->blksz);
-	gpt_entry *gpt_pte = NULL;
+	struct gpt_cache_node *node;
+	gpt_entry *gpt_pte;
 
 	/* "part" argument must be at least 1 */
 	if (part < 1) {
@@ -270,15 +497,16 @@ int part_get_info_efi(struct blk_desc *dev_desc, int part,
 		return -1;
 	}
 
-	/* This function validates AND fills in the GPT header and PTE */
-	if (find_valid_gpt(dev_desc, gpt_head, &gpt_pte) != 1)
+	node = gpt_cache_get(dev_desc);
+	if (!node)
 		return -1;
+	gpt_pte = node->gpt_pte;
 
-	if (part > le32_to_cpu(gpt_head->num_partition_entries) ||
+	if (part > le32_to_cpu(node->gpt_head->num_partition_entries) ||
 	    !is_pte_valid(&gpt_pte[part - 1])) {
 		debug("%s: *** ERROR: Invalid partition number %d ***\n",
 			__func__, part);
-		free(gpt_pte);
+		gpt_cache_put(node);
 		return -1;
 	}
 
@@ -305,11 +533,46 @@ int part_get_info_efi(struct blk_desc *dev_desc, int part,
 	debug("%s: start 0x" LBAF ", size 0x" LBAF ", name %s\n", __func__,
 	      info->start, info->size, info->name);
 
-	/* Remember to free pte */
-	free(gpt_pte);
+	gpt_cache_put(node);
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+static int part_get_info_by_name_efi(struct blk_desc *dev_desc,
+				     const char *name,
+				     struct disk_partition *info)
+{
+	struct gpt_cache_node *node;
+	struct gpt_cache_name *names;
+	int lo, hi, mid;
+
+	node = gpt_cache_get(dev_desc);
+	if (!node)
+		return -ENOENT;
+	if (!node->names && gpt_cache_index_names(node))
+		return -ENOMEM;
+
+	/* Find the first (lowest-numbered) partition with this name */
+	names = node->names;
+	lo = 0;
+	hi = node->name_count;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (strcmp(names[mid].name, name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == node->name_count || strcmp(names[lo].name, name))
+		return -ENOENT;
+
+	if (part_get_info_efi(dev_desc, names[lo].part, info))
+		return -ENOENT;
+
+	return names[lo].part;
+}
+#endif
+
 static int part_test_efi(struct blk_desc *dev_desc)
 {
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(legacy_mbr, legacymbr, 1, dev_desc->blksz);
@@ -371,6 +634,8 @@ int write_gpt_table(struct blk_desc *dev_desc,
 	u32 calc_crc32;
 
 	debug("max lba: %x\n", (u32) dev_desc->lba);
+	gpt_cache_invalidate(dev_desc);
+
 	/* Setup the Protective MBR */
 	if (set_protective_mbr(dev_desc) < 0)
 		goto err;
@@ -1117,6 +1382,9 @@ U_BOOT_PART_TYPE(a_efi) = {
 	.part_type	= PART_TYPE_EFI,
 	.max_entries	= GPT_ENTRY_NUMBERS,
 	.get_info	= part_get_info_ptr(part_get_info_efi),
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+	.get_info_by_name = part_get_info_by_name_efi,
+#endif
 	.print		= part_print_ptr(part_print_efi),
 	.test		= part_test_efi,
 };
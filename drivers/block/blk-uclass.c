@@ -467,6 +467,7 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	gpt_cache_write(block_dev, start, blkcnt);
 	return ops->write(dev, start, blkcnt, buffer);
 }
 
@@ -480,6 +481,7 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	gpt_cache_write(block_dev, start, blkcnt);
 	return ops->erase(dev, start, blkcnt);
 }
 
@@ -35,6 +35,25 @@ struct clk *dev_get_clk_ptr(struct udevice *dev)
 	return (struct clk *)dev_get_uclass_priv(dev);
 }
 
+#if CONFIG_IS_ENABLED(CLK_RATE_STATS)
+/* Clock rates are queried before relocation, keep this out of .bss */
+static struct clk_rate_stats clk_rate_stats __section(".data");
+
+#define clk_stats_inc(_field)	(clk_rate_stats._field++)
+
+void clk_get_rate_stats(struct clk_rate_stats *stats)
+{
+	*stats = clk_rate_stats;
+}
+
+void clk_reset_rate_stats(void)
+{
+	memset(&clk_rate_stats, '\0', sizeof(clk_rate_stats));
+}
+#else
+#define clk_stats_inc(_field)
+#endif
+
 #if CONFIG_IS_ENABLED(OF_PLATDATA)
 int clk_get_by_phandle(struct udevice *dev, const struct phandle_1_arg *cells,
 		       struct clk *clk)
@@ -501,7 +520,8 @@ int clk_free(struct clk *clk)
 ulong clk_get_rate(struct clk *clk)
 {
 	const struct clk_ops *ops;
-	int ret;
+	struct clk *clkp;
+	ulong rate;
 
 	debug("%s(clk=%p)\n", __func__, clk);
 	if (!clk_valid(clk))
@@ -511,11 +531,28 @@ ulong clk_get_rate(struct clk *clk)
 	if (!ops->get_rate)
 		return -ENOSYS;
 
-	ret = ops->get_rate(clk);
-	if (ret)
-		return log_ret(ret);
+	/*
+	 * Clocks registered with the framework (CCF and fixed-rate clocks)
+	 * keep their last rate, which is dropped by clk_clean_rate_cache()
+	 * whenever it may change.
+	 */
+	clk_stats_inc(queries);
+	clkp = dev_get_clk_ptr(clk->dev);
+	if (clkp && (clkp->flags & CLK_GET_RATE_NOCACHE))
+		clkp = NULL;
+	if (clkp && clkp->rate) {
+		clk_stats_inc(hits);
+		return clkp->rate;
+	}
 
-	return 0;
+	rate = ops->get_rate(clk);
+	if (IS_ERR_VALUE(rate))
+		return log_ret(rate);
+
+	if (clkp)
+		clkp->rate = rate;
+
+	return rate;
 }
 
 struct clk *clk_get_parent(struct clk *clk)
@@ -539,7 +576,6 @@ struct clk *clk_get_parent(struct clk *clk)
 
 long long clk_get_parent_rate(struct clk *clk)
 {
-	const struct clk_ops *ops;
 	struct clk *pclk;
 
 	debug("%s(clk=%p)\n", __func__, clk);
@@ -550,15 +586,7 @@ long long clk_get_parent_rate(struct clk *clk)
 	if (IS_ERR(pclk))
 		return -ENODEV;
 
-	ops = clk_dev_ops(pclk->dev);
-	if (!ops->get_rate)
-		return -ENOSYS;
-
-	/* Read the 'rate' if not already set or if proper flag set*/
-	if (!pclk->rate || pclk->flags & CLK_GET_RATE_NOCACHE)
-		pclk->rate = clk_get_rate(pclk);
-
-	return pclk->rate;
+	return clk_get_rate(pclk);
 }
 
 ulong clk_round_rate(struct clk *clk, ulong rate)
@@ -584,14 +612,27 @@ static void clk_clean_rate_cache(struct clk *clk)
 	if (!clk)
 		return;
 
+	if (clk->rate)
+		clk_stats_inc(invalidations);
 	clk->rate = 0;
 
 	list_for_each_entry(child_dev, &clk->dev->child_head, sibling_node) {
+		if (device_get_uclass_id(child_dev) != UCLASS_CLK)
+			continue;
 		clkp = dev_get_clk_ptr(child_dev);
 		clk_clean_rate_cache(clkp);
 	}
 }
 
+/* Drop the cached rate of a clock and of all clocks fed by it */
+static void clk_invalidate_rate(struct clk *clk)
+{
+	struct clk *clkp = dev_get_clk_ptr(clk->dev);
+
+	clk->rate = 0;
+	clk_clean_rate_cache(clkp ? clkp : clk);
+}
+
 ulong clk_set_rate(struct clk *clk, ulong rate)
 {
 	const struct clk_ops *ops;
@@ -604,10 +645,12 @@ ulong clk_set_rate(struct clk *clk, ulong rate)
 	if (!ops->set_rate)
 		return -ENOSYS;
 
+	rate = ops->set_rate(clk, rate);
+
 	/* Clean up cached rates for us and all child clocks */
-	clk_clean_rate_cache(clk);
+	clk_invalidate_rate(clk);
 
-	return ops->set_rate(clk, rate);
+	return rate;
 }
 
 int clk_set_parent(struct clk *clk, struct clk *parent)
@@ -630,6 +673,8 @@ int clk_set_parent(struct clk *clk, struct clk *parent)
 	if (CONFIG_IS_ENABLED(CLK_CCF))
 		ret = device_reparent(clk->dev, parent->dev);
 
+	clk_invalidate_rate(clk);
+
 	return ret;
 }
 
@@ -668,6 +713,8 @@ int clk_enable(struct clk *clk)
 				printf("Enable %s failed\n", clk->dev->name);
 				return ret;
 			}
+			/* Gated clocks may report a different rate */
+			clk_invalidate_rate(clkp ? clkp : clk);
 		}
 		if (clkp)
 			clkp->enable_count++;
@@ -723,6 +770,7 @@ int clk_disable(struct clk *clk)
 			ret = ops->disable(clk);
 			if (ret)
 				return ret;
+			clk_invalidate_rate(clkp ? clkp : clk);
 		}
 
 		if (clkp && clkp->dev->parent &&
@@ -14,6 +14,7 @@
 #include <mmc.h>
 #include <fat.h>
 #include <dfu.h>
+#include <div64.h>
 #include <hash.h>
 #include <linux/list.h>
 #include <linux/compiler.h>
@@ -28,6 +29,12 @@ static unsigned long dfu_timeout = 0;
 
 bool dfu_reinit_needed = false;
 
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+/* entity whose full buffer waits for dfu_write_pending() */
+static struct dfu_entity *dfu_pending_write;
+static bool dfu_deferred_write;
+#endif
+
 /*
  * The purpose of the dfu_flush_callback() function is to
  * provide callback for dfu user
@@ -183,6 +190,12 @@ static enum dfu_device_type dfu_buf_device_type;
 
 unsigned char *dfu_free_buf(void)
 {
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+	if (dfu_pending_write) {
+		dfu_pending_write->p_size = 0;
+		dfu_pending_write = NULL;
+	}
+#endif
 	free(dfu_buf);
 	dfu_buf = NULL;
 	return dfu_buf;
@@ -240,37 +253,150 @@ static char *dfu_get_hash_algo(void)
 	return NULL;
 }
 
+static int dfu_write_medium_buf(struct dfu_entity *dfu, void *buf,
+				long w_size)
+{
+	ulong start;
+	int ret;
+
+	if (dfu_hash_algo)
+		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc,
+					   buf, w_size, 0);
+
+	start = get_timer(0);
+	ret = dfu->write_medium(dfu, dfu->offset, buf, &w_size);
+	if (ret)
+		debug("%s: Write error!\n", __func__);
+	dfu->stats.write_ms += get_timer(start);
+	dfu->stats.bytes += w_size;
+
+	/* update offset */
+	dfu->offset += w_size;
+
+	puts("#");
+
+	return ret;
+}
+
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+void dfu_set_deferred_write(bool enable)
+{
+	if (!enable)
+		dfu_write_pending();
+	dfu_deferred_write = enable;
+}
+
+struct dfu_entity *dfu_get_pending_write(void)
+{
+	return dfu_pending_write;
+}
+
+unsigned int dfu_get_pending_write_ms(struct dfu_entity *dfu)
+{
+	if (dfu != dfu_pending_write || !dfu->stats.bytes)
+		return 0;
+
+	/* estimate from the throughput of the medium so far */
+	return lldiv((u64)dfu->p_size * dfu->stats.write_ms,
+		     dfu->stats.bytes);
+}
+
+int dfu_write_pending(void)
+{
+	struct dfu_entity *dfu = dfu_pending_write;
+	int ret;
+
+	if (!dfu)
+		return 0;
+
+	dfu_pending_write = NULL;
+	ret = dfu_write_medium_buf(dfu, dfu->i_buf_start, dfu->p_size);
+	dfu->p_size = 0;
+
+	/* point back */
+	dfu->i_buf = dfu->i_buf_start;
+	if (ret && !dfu->w_err)
+		dfu->w_err = ret;
+
+	return ret;
+}
+
+/*
+ * Leave the full buffer to dfu_write_pending(). It must be written before
+ * more data can be stored, which dfu_write() makes sure of.
+ */
+static int dfu_write_buffer_defer(struct dfu_entity *dfu)
+{
+	dfu->p_size = dfu->i_buf - dfu->i_buf_start;
+	if (dfu->p_size)
+		dfu_pending_write = dfu;
+
+	return 0;
+}
+#endif
+
 static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 {
 	long w_size;
 	int ret;
 
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+	/* a deferred buffer of another entity comes first */
+	ret = dfu_write_pending();
+	if (ret)
+		return ret;
+#endif
+
 	/* flush size? */
 	w_size = dfu->i_buf - dfu->i_buf_start;
 	if (w_size == 0)
 		return 0;
 
-	if (dfu_hash_algo)
-		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc,
-					   dfu->i_buf_start, w_size, 0);
-
-	ret = dfu->write_medium(dfu, dfu->offset, dfu->i_buf_start, &w_size);
-	if (ret)
-		debug("%s: Write error!\n", __func__);
+	ret = dfu_write_medium_buf(dfu, dfu->i_buf_start, w_size);
 
 	/* point back */
 	dfu->i_buf = dfu->i_buf_start;
 
-	/* update offset */
-	dfu->offset += w_size;
+	return ret;
+}
 
-	puts("#");
+/*
+ * Write out a full buffer, either now or, with deferred writing, from
+ * dfu_write_pending() once the transfer that filled it has completed.
+ */
+static int dfu_write_buffer_full(struct dfu_entity *dfu)
+{
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+	if (dfu_deferred_write)
+		return dfu_write_buffer_defer(dfu);
+#endif
+	return dfu_write_buffer_drain(dfu);
+}
 
-	return ret;
+static void dfu_show_stats(struct dfu_entity *dfu)
+{
+	ulong total_ms = get_timer(dfu->stats.start);
+
+	if (!dfu->stats.bytes)
+		return;
+
+	printf("\nDFU %s: %llu bytes in %lu ms (%llu KiB/s), medium %llu KiB/s\n",
+	       dfu->name, dfu->stats.bytes, total_ms,
+	       lldiv(dfu->stats.bytes, max(total_ms, 1UL)) * 1000 / 1024,
+	       lldiv(dfu->stats.bytes, max(dfu->stats.write_ms, 1UL)) *
+	       1000 / 1024);
 }
 
 void dfu_transaction_cleanup(struct dfu_entity *dfu)
 {
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+	/* drop a buffer that was not written, e.g. after an error */
+	if (dfu_pending_write == dfu)
+		dfu_pending_write = NULL;
+	dfu->p_size = 0;
+	dfu->w_err = 0;
+#endif
+
 	/* clear everything */
 	dfu->crc = 0;
 	dfu->offset = 0;
@@ -292,6 +418,10 @@ int dfu_transaction_initiate(struct dfu_entity *dfu, bool read)
 	if (dfu->inited)
 		return 0;
 
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+	/* another entity may still be using the buffer */
+	dfu_write_pending();
+#endif
 	dfu_transaction_cleanup(dfu);
 
 	if (dfu->i_buf_start == NULL)
@@ -306,6 +436,8 @@ int dfu_transaction_initiate(struct dfu_entity *dfu, bool read)
 		debug("%s: %s %lld [B]\n", __func__, dfu->name, dfu->r_left);
 	}
 
+	memset(&dfu->stats, '\0', sizeof(dfu->stats));
+	dfu->stats.start = get_timer(0);
 	dfu->inited = 1;
 	dfu_initiated_callback(dfu);
 
@@ -317,6 +449,10 @@ int dfu_flush(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	int ret = 0;
 
 	ret = dfu_write_buffer_drain(dfu);
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+	if (!ret)
+		ret = dfu->w_err;
+#endif
 	if (ret)
 		return ret;
 
@@ -326,6 +462,7 @@ int dfu_flush(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	if (dfu_hash_algo)
 		printf("\nDFU complete %s: 0x%08x\n", dfu_hash_algo->name,
 		       dfu->crc);
+	dfu_show_stats(dfu);
 
 	dfu_flush_callback(dfu);
 
@@ -346,6 +483,20 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	if (ret < 0)
 		return ret;
 
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+	/*
+	 * The host normally waits in dfuDNBUSY until the buffer is written;
+	 * write it now if it did not. Then check how that went.
+	 */
+	dfu_write_pending();
+	if (dfu->w_err) {
+		ret = dfu->w_err;
+		dfu_transaction_cleanup(dfu);
+		dfu_error_callback(dfu, "DFU write error");
+		return ret;
+	}
+#endif
+
 	if (dfu->i_blk_seq_num != blk_seq_num) {
 		printf("%s: Wrong sequence number! [%d] [%d]\n",
 		       __func__, dfu->i_blk_seq_num, blk_seq_num);
@@ -394,7 +545,8 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 
 	/* if end or if buffer full flush */
 	if (size == 0 || (dfu->i_buf + size) > dfu->i_buf_end) {
-		ret = dfu_write_buffer_drain(dfu);
+		ret = size ? dfu_write_buffer_full(dfu) :
+			     dfu_write_buffer_drain(dfu);
 		if (ret) {
 			dfu_transaction_cleanup(dfu);
 			dfu_error_callback(dfu, "DFU write error");
@@ -29,6 +29,37 @@ static u32 fastboot_bytes_received;
  */
 static u32 fastboot_bytes_expected;
 
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+enum {
+	FASTBOOT_STREAM_OFF,
+	FASTBOOT_STREAM_ARMED,	/* the next download is to be streamed */
+	FASTBOOT_STREAM_ACTIVE,	/* the current download is being streamed */
+	FASTBOOT_STREAM_DONE,	/* waiting for the flash command */
+};
+
+/**
+ * fastboot_stream_state - state of writing a download as it arrives
+ */
+static int fastboot_stream_state;
+
+/**
+ * fastboot_stream_part - partition the download is written to
+ */
+static char fastboot_stream_part[FASTBOOT_COMMAND_LEN];
+
+/**
+ * fastboot_stream_fill - number of bytes waiting in fastboot_buf_addr
+ */
+static u32 fastboot_stream_fill;
+
+/**
+ * fastboot_stream_response - result of writing the download, once known
+ */
+static char fastboot_stream_response[FASTBOOT_RESPONSE_LEN];
+
+static void fastboot_stream_cancel(void);
+#endif
+
 static void okay(char *, char *);
 static void getvar(char *, char *);
 static void download(char *, char *);
@@ -48,6 +79,9 @@ static void oem_partconf(char *, char *);
 #if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_BOOTBUS)
 static void oem_bootbus(char *, char *);
 #endif
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+static void oem_stream(char *, char *);
+#endif
 
 #if CONFIG_IS_ENABLED(FASTBOOT_UUU_SUPPORT)
 static void run_ucmd(char *, char *);
@@ -122,6 +156,12 @@ static const struct {
 		.dispatch = oem_bootbus,
 	},
 #endif
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+	[FASTBOOT_COMMAND_OEM_STREAM] = {
+		.command = "oem stream",
+		.dispatch = oem_stream,
+	},
+#endif
 #if CONFIG_IS_ENABLED(FASTBOOT_UUU_SUPPORT)
 	[FASTBOOT_COMMAND_UCMD] = {
 		.command = "UCmd",
@@ -219,15 +259,136 @@ static void download(char *cmd_parameter, char *response)
 	 *
 	 * where cmd_parameter is an 8 digit hexadecimal number
 	 */
-	if (fastboot_bytes_expected > fastboot_buf_size) {
+	if (fastboot_bytes_expected > fastboot_download_max()) {
 		fastboot_fail(cmd_parameter, response);
+		return;
+	}
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+	if (fastboot_stream_state == FASTBOOT_STREAM_ARMED) {
+		fastboot_stream_state = FASTBOOT_STREAM_OFF;
+		if (fastboot_mmc_stream_start(fastboot_stream_part, response))
+			return;
+		printf("Writing download to '%s'\n", fastboot_stream_part);
+		fastboot_stream_state = FASTBOOT_STREAM_ACTIVE;
+		fastboot_stream_fill = 0;
+		fastboot_stream_response[0] = '\0';
 	} else {
-		printf("Starting download of %d bytes\n",
-		       fastboot_bytes_expected);
-		fastboot_response("DATA", response, "%s", cmd_parameter);
+		fastboot_stream_cancel();
+	}
+#endif
+	printf("Starting download of %d bytes\n", fastboot_bytes_expected);
+	fastboot_response("DATA", response, "%s", cmd_parameter);
+}
+
+/**
+ * fastboot_download_max() - Return the largest download that is accepted
+ *
+ * Return: size of the download buffer, or U32_MAX if the next download is
+ * written to storage as it arrives
+ */
+u32 fastboot_download_max(void)
+{
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+	if (fastboot_stream_state == FASTBOOT_STREAM_ARMED)
+		return U32_MAX;
+#endif
+	return fastboot_buf_size;
+}
+
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+/**
+ * fastboot_stream_write() - Write out the data waiting in fastboot_buf_addr
+ *
+ * @last: true if the download is complete
+ *
+ * Data that cannot be written yet, e.g. a partial sparse chunk header, is
+ * moved to the start of the buffer. After an error all data is dropped and
+ * fastboot_stream_response holds the failure.
+ */
+static void fastboot_stream_write(bool last)
+{
+	long ret;
+
+	if (fastboot_stream_response[0]) {
+		fastboot_stream_fill = 0;
+		return;
 	}
+
+	ret = fastboot_mmc_stream_write(fastboot_buf_addr,
+					fastboot_stream_fill, last,
+					fastboot_stream_response);
+	if (ret < 0) {
+		fastboot_stream_fill = 0;
+		return;
+	}
+
+	fastboot_stream_fill -= ret;
+	memmove(fastboot_buf_addr, fastboot_buf_addr + ret,
+		fastboot_stream_fill);
 }
 
+/**
+ * fastboot_stream_download() - Add received data to the stream buffer
+ *
+ * @fastboot_data: Pointer to received fastboot data
+ * @fastboot_data_len: Length of received fastboot data
+ *
+ * The buffer is written out when the data does not fit, which holds back the
+ * next transfer until there is space.
+ */
+static void fastboot_stream_download(const void *fastboot_data,
+				     unsigned int fastboot_data_len)
+{
+	if (fastboot_stream_fill + fastboot_data_len > fastboot_buf_size)
+		fastboot_stream_write(false);
+	if (fastboot_stream_response[0])
+		return;
+	if (fastboot_stream_fill + fastboot_data_len > fastboot_buf_size) {
+		fastboot_fail("download buffer too small",
+			      fastboot_stream_response);
+		return;
+	}
+
+	memcpy(fastboot_buf_addr + fastboot_stream_fill, fastboot_data,
+	       fastboot_data_len);
+	fastboot_stream_fill += fastboot_data_len;
+}
+
+/**
+ * fastboot_stream_complete() - Finish writing the download to storage
+ *
+ * @response: Pointer to fastboot response buffer
+ */
+static void fastboot_stream_complete(char *response)
+{
+	char ignored[FASTBOOT_RESPONSE_LEN];
+
+	fastboot_stream_write(true);
+	/* This also frees the buffers after an error */
+	fastboot_mmc_stream_finish(fastboot_stream_response[0] ?
+				   ignored : fastboot_stream_response);
+
+	strlcpy(response, fastboot_stream_response, FASTBOOT_RESPONSE_LEN);
+	fastboot_stream_state = FASTBOOT_STREAM_DONE;
+}
+
+/**
+ * fastboot_stream_cancel() - Drop a streamed download that was not flashed
+ *
+ * A download that was cut short is finished here, which frees the buffers
+ * used to write it. The result of a complete download is dropped, since the
+ * following flash command can no longer refer to it.
+ */
+static void fastboot_stream_cancel(void)
+{
+	char ignored[FASTBOOT_RESPONSE_LEN];
+
+	if (fastboot_stream_state == FASTBOOT_STREAM_ACTIVE)
+		fastboot_mmc_stream_finish(ignored);
+	fastboot_stream_state = FASTBOOT_STREAM_OFF;
+}
+#endif
+
 /**
  * fastboot_data_remaining() - return bytes remaining in current transfer
  *
@@ -266,6 +427,11 @@ void fastboot_data_download(const void *fastboot_data,
 			      response);
 		return;
 	}
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+	if (fastboot_stream_state == FASTBOOT_STREAM_ACTIVE)
+		fastboot_stream_download(fastboot_data, fastboot_data_len);
+	else
+#endif
 	/* Download data to fastboot_buf_addr */
 	memcpy(fastboot_buf_addr + fastboot_bytes_received,
 	       fastboot_data, fastboot_data_len);
@@ -282,6 +448,21 @@ void fastboot_data_download(const void *fastboot_data,
 	*response = '\0';
 }
 
+/**
+ * fastboot_data_flush() - Write out received data that is being streamed
+ *
+ * When the current download is being written to storage as it arrives, write
+ * out the data received so far once half of the download buffer is used.
+ */
+void fastboot_data_flush(void)
+{
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+	if (fastboot_stream_state == FASTBOOT_STREAM_ACTIVE &&
+	    fastboot_stream_fill >= fastboot_buf_size / 2)
+		fastboot_stream_write(false);
+#endif
+}
+
 /**
  * fastboot_data_complete() - Mark current transfer complete
  *
@@ -295,6 +476,13 @@ void fastboot_data_complete(char *response)
 	fastboot_okay(NULL, response);
 	printf("\ndownloading of %d bytes finished\n", fastboot_bytes_received);
 	image_size = fastboot_bytes_received;
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+	/* The image is on the storage rather than in the buffer */
+	if (fastboot_stream_state == FASTBOOT_STREAM_ACTIVE) {
+		fastboot_stream_complete(response);
+		image_size = 0;
+	}
+#endif
 	env_set_hex("filesize", image_size);
 	fastboot_bytes_expected = 0;
 	fastboot_bytes_received = 0;
@@ -312,6 +500,18 @@ void fastboot_data_complete(char *response)
  */
 static void flash(char *cmd_parameter, char *response)
 {
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+	if (fastboot_stream_state == FASTBOOT_STREAM_DONE) {
+		fastboot_stream_state = FASTBOOT_STREAM_OFF;
+		if (!cmd_parameter || strcmp(cmd_parameter, fastboot_stream_part))
+			fastboot_fail("image was written to another partition",
+				      response);
+		else
+			strlcpy(response, fastboot_stream_response,
+				FASTBOOT_RESPONSE_LEN);
+		return;
+	}
+#endif
 #if CONFIG_IS_ENABLED(FASTBOOT_FLASH_MMC)
 	fastboot_mmc_flash_write(cmd_parameter, fastboot_buf_addr, image_size,
 				 response);
@@ -514,3 +714,28 @@ static void oem_bootbus(char *cmd_parameter, char *response)
 		fastboot_okay(NULL, response);
 }
 #endif
+
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+/**
+ * oem_stream() - Execute the OEM stream command
+ *
+ * @cmd_parameter: Pointer to partition name
+ * @response: Pointer to fastboot response buffer
+ *
+ * Arrange for the next download to be written to the partition as it is
+ * received. The flash command for the partition then reports the result.
+ */
+static void oem_stream(char *cmd_parameter, char *response)
+{
+	if (!cmd_parameter || !*cmd_parameter) {
+		fastboot_fail("Expected command parameter", response);
+		return;
+	}
+
+	fastboot_stream_cancel();
+	strlcpy(fastboot_stream_part, cmd_parameter,
+		sizeof(fastboot_stream_part));
+	fastboot_stream_state = FASTBOOT_STREAM_ARMED;
+	fastboot_okay(NULL, response);
+}
+#endif
@@ -14,9 +14,11 @@
 #include <image-sparse.h>
 #include <image.h>
 #include <log.h>
+#include <malloc.h>
 #include <part.h>
 #include <mmc.h>
 #include <div64.h>
+#include <asm/cache.h>
 #include <linux/compat.h>
 #include <android_image.h>
 
@@ -168,6 +170,80 @@ static lbaint_t fb_mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+/*
+ * Erase whole erase groups, about FASTBOOT_MAX_BLK_WRITE blocks at a time, so
+ * that progress is reported during a long erase
+ */
+static lbaint_t fb_mmc_sparse_erase(struct sparse_storage *info,
+		lbaint_t blk, lbaint_t blkcnt)
+{
+	struct fb_mmc_sparse *sparse = info->priv;
+	lbaint_t step, cur_blkcnt, blks_erased;
+	lbaint_t blks = 0;
+
+	step = max_t(lbaint_t, FASTBOOT_MAX_BLK_WRITE / info->erase_blks, 1) *
+	       info->erase_blks;
+	while (blks < blkcnt) {
+		cur_blkcnt = min(step, blkcnt - blks);
+		if (fastboot_progress_callback)
+			fastboot_progress_callback("erasing");
+		blks_erased = blk_derase(sparse->dev_desc, blk + blks,
+					 cur_blkcnt);
+		if (IS_ERR_VALUE(blks_erased))
+			return blks_erased;
+		blks += blks_erased;
+		if (blks_erased != cur_blkcnt)
+			break;
+	}
+
+	return blks;
+}
+
+/**
+ * fb_mmc_erases_to_zero() - Check whether erased blocks read back as zero
+ *
+ * @mmc: MMC device
+ * Return: true if erased blocks read as zero, false if as one or unknown
+ */
+static bool fb_mmc_erases_to_zero(struct mmc *mmc)
+{
+	if (IS_SD(mmc))
+		return !(mmc->scr[0] & SD_DATA_STAT_AFTER_ERASE);
+
+	return mmc->ext_csd && !mmc->ext_csd[EXT_CSD_ERASED_MEM_CONT];
+}
+
+static void fb_mmc_sparse_init(struct sparse_storage *sparse,
+			       struct fb_mmc_sparse *sparse_priv,
+			       struct blk_desc *dev_desc,
+			       struct disk_partition *info)
+{
+	struct mmc *mmc __maybe_unused;
+
+	sparse_priv->dev_desc = dev_desc;
+
+	sparse->blksz = info->blksz;
+	sparse->start = info->start;
+	sparse->size = info->size;
+	sparse->write = fb_mmc_sparse_write;
+	sparse->reserve = fb_mmc_sparse_reserve;
+	sparse->erase = NULL;
+	sparse->erase_blks = 0;
+	sparse->mssg = fastboot_fail;
+	sparse->priv = sparse_priv;
+
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	/* Erase zero-filled chunks rather than writing them */
+	mmc = find_mmc_device(dev_desc->devnum);
+	if (mmc && fb_mmc_erases_to_zero(mmc)) {
+		sparse->erase = fb_mmc_sparse_erase;
+		sparse->erase_blks = mmc->erase_grp_size;
+	}
+#endif
+
+	printf("Flashing sparse image at offset " LBAFU "\n", sparse->start);
+}
+
 static void write_raw_image(struct blk_desc *dev_desc,
 			    struct disk_partition *info, const char *part_name,
 			    void *buffer, u32 download_bytes, char *response)
@@ -610,19 +686,7 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 		struct sparse_storage sparse;
 		int err;
 
-		sparse_priv.dev_desc = dev_desc;
-
-		sparse.blksz = info.blksz;
-		sparse.start = info.start;
-		sparse.size = info.size;
-		sparse.write = fb_mmc_sparse_write;
-		sparse.reserve = fb_mmc_sparse_reserve;
-		sparse.mssg = fastboot_fail;
-
-		printf("Flashing sparse image at offset " LBAFU "\n",
-		       sparse.start);
-
-		sparse.priv = &sparse_priv;
+		fb_mmc_sparse_init(&sparse, &sparse_priv, dev_desc, &info);
 		err = write_sparse_image(&sparse, cmd, download_buffer,
 					 response);
 		if (!err)
@@ -633,6 +697,223 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 	}
 }
 
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+/**
+ * struct fb_mmc_stream - Image being written while it is downloaded
+ *
+ * @dev_desc: Device being written
+ * @info: Partition being written
+ * @started: true once the type of the image is known
+ * @is_sparse: true if the image is a sparse image
+ * @blk: Next block to write, for a raw image
+ * @bytes: Number of bytes received, for a raw image
+ * @sparse_priv: Sparse storage private data
+ * @sparse: Sparse storage
+ * @ss: Sparse image parser state
+ */
+static struct fb_mmc_stream {
+	struct blk_desc *dev_desc;
+	struct disk_partition info;
+	bool started;
+	bool is_sparse;
+	lbaint_t blk;
+	u64 bytes;
+	struct fb_mmc_sparse sparse_priv;
+	struct sparse_storage sparse;
+	struct sparse_stream ss;
+} fb_mmc_stream;
+
+/**
+ * fb_mmc_stream_supported() - Check whether a target can be streamed
+ *
+ * The special targets need the whole image before anything is written.
+ *
+ * @cmd: Named partition to write image to
+ * Return: true if the image can be written as it downloads
+ */
+static bool fb_mmc_stream_supported(const char *cmd)
+{
+#ifdef CONFIG_FASTBOOT_MMC_BOOT_SUPPORT
+	if (!strcmp(cmd, CONFIG_FASTBOOT_MMC_BOOT1_NAME) ||
+	    !strcmp(cmd, CONFIG_FASTBOOT_MMC_BOOT2_NAME))
+		return false;
+#endif
+#if CONFIG_IS_ENABLED(EFI_PARTITION)
+	if (!strcmp(cmd, CONFIG_FASTBOOT_GPT_NAME))
+		return false;
+#endif
+#if CONFIG_IS_ENABLED(DOS_PARTITION)
+	if (!strcmp(cmd, CONFIG_FASTBOOT_MBR_NAME))
+		return false;
+#endif
+#ifdef CONFIG_ANDROID_BOOT_IMAGE
+	if (!strncasecmp(cmd, "zimage", 6))
+		return false;
+#endif
+
+	return true;
+}
+
+/**
+ * fastboot_mmc_stream_start() - Prepare to write an image as it downloads
+ *
+ * @cmd: Named partition to write image to
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_stream_start(const char *cmd, char *response)
+{
+	struct fb_mmc_stream *st = &fb_mmc_stream;
+	int ret;
+
+	memset(st, '\0', sizeof(*st));
+
+	if (!fb_mmc_stream_supported(cmd)) {
+		fastboot_fail("partition cannot be streamed", response);
+		return -EINVAL;
+	}
+
+#if CONFIG_IS_ENABLED(FASTBOOT_MMC_USER_SUPPORT)
+	if (!strcmp(cmd, CONFIG_FASTBOOT_MMC_USER_NAME)) {
+		st->dev_desc = fastboot_mmc_get_dev(response);
+		if (!st->dev_desc)
+			return -ENODEV;
+
+		strlcpy((char *)&st->info.name, cmd, sizeof(st->info.name));
+		st->info.size	= st->dev_desc->lba;
+		st->info.blksz	= st->dev_desc->blksz;
+	}
+#endif
+
+	if (!st->info.name[0]) {
+		ret = fastboot_mmc_get_part_info(cmd, &st->dev_desc, &st->info,
+						 response);
+		if (ret < 0)
+			return ret;
+	}
+	st->blk = st->info.start;
+
+	return 0;
+}
+
+/**
+ * fb_mmc_stream_raw() - Write the next part of a raw image
+ *
+ * @data: Image data
+ * @len: Number of bytes at @data
+ * @last: true if this is the end of the image
+ * @response: Pointer to fastboot response buffer
+ * Return: number of bytes used, or -1 on error
+ */
+static long fb_mmc_stream_raw(void *data, size_t len, bool last,
+			      char *response)
+{
+	struct fb_mmc_stream *st = &fb_mmc_stream;
+	lbaint_t blkcnt, blks;
+	size_t tail;
+	char *buf;
+
+	blkcnt = lldiv(len, st->info.blksz);
+	tail = last ? len - blkcnt * st->info.blksz : 0;
+	if (st->blk + blkcnt + !!tail > st->info.start + st->info.size) {
+		pr_err("too large for partition: '%s'\n", st->info.name);
+		fastboot_fail("too large for partition", response);
+		return -1;
+	}
+
+	blks = fb_mmc_blk_write(st->dev_desc, st->blk, blkcnt, data);
+	if (blks != blkcnt)
+		goto err;
+	st->blk += blkcnt;
+
+	/* Pad the last block of the image with zeroes */
+	if (tail) {
+		buf = memalign(ARCH_DMA_MINALIGN, st->info.blksz);
+		if (!buf) {
+			fastboot_fail("out of memory", response);
+			return -1;
+		}
+		memcpy(buf, data + blkcnt * st->info.blksz, tail);
+		memset(buf + tail, '\0', st->info.blksz - tail);
+		blks = fb_mmc_blk_write(st->dev_desc, st->blk, 1, buf);
+		free(buf);
+		if (blks != 1)
+			goto err;
+		st->blk++;
+	}
+	st->bytes += blkcnt * st->info.blksz + tail;
+
+	return blkcnt * st->info.blksz + tail;
+
+err:
+	pr_err("failed writing to device %d\n", st->dev_desc->devnum);
+	fastboot_fail("failed writing to device", response);
+	return -1;
+}
+
+/**
+ * fastboot_mmc_stream_write() - Write the next part of a streamed image
+ *
+ * Only part of @data may be used, e.g. when it ends in the middle of a block
+ * or a sparse chunk header. The caller must pass the rest again with the
+ * following data.
+ *
+ * @data: Image data
+ * @len: Number of bytes at @data
+ * @last: true if this is the end of the image
+ * @response: Pointer to fastboot response buffer
+ * Return: number of bytes used, or -1 on error
+ */
+long fastboot_mmc_stream_write(void *data, size_t len, bool last,
+			       char *response)
+{
+	struct fb_mmc_stream *st = &fb_mmc_stream;
+
+	if (!st->started) {
+		if (len < sizeof(sparse_header_t) && !last)
+			return 0;
+		st->started = true;
+		st->is_sparse = len >= sizeof(sparse_header_t) &&
+				is_sparse_image(data);
+		if (st->is_sparse) {
+			fb_mmc_sparse_init(&st->sparse, &st->sparse_priv,
+					   st->dev_desc, &st->info);
+			sparse_stream_start(&st->ss, &st->sparse,
+					    (char *)st->info.name);
+		} else {
+			puts("Flashing Raw Image\n");
+		}
+	}
+
+	if (st->is_sparse)
+		return sparse_stream_write(&st->ss, data, len, response);
+
+	return fb_mmc_stream_raw(data, len, last, response);
+}
+
+/**
+ * fastboot_mmc_stream_finish() - Finish writing a streamed image
+ *
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -1 on error
+ */
+int fastboot_mmc_stream_finish(char *response)
+{
+	struct fb_mmc_stream *st = &fb_mmc_stream;
+
+	if (st->is_sparse) {
+		if (sparse_stream_finish(&st->ss, response))
+			return -1;
+	} else {
+		printf("........ wrote %llu bytes to '%s'\n", st->bytes,
+		       st->info.name);
+	}
+	fastboot_okay(NULL, response);
+
+	return 0;
+}
+#endif
+
 /**
  * fastboot_mmc_flash_erase() - Erase eMMC for fastboot
  *
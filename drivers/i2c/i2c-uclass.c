@@ -296,6 +296,57 @@ static int i2c_probe_chip(struct udevice *bus, uint chip_addr,
 	return ops->xfer(bus, msg, 1);
 }
 
+/*
+ * Poll a chip which is busy with an internal write cycle (e.g. an EEPROM)
+ * until it ACKs its address again. This is usually much quicker than the
+ * worst-case write time given in the datasheet.
+ */
+static int i2c_wait_write_done(struct udevice *dev, uint timeout_ms)
+{
+	struct dm_i2c_chip *chip = dev_get_parent_plat(dev);
+	struct udevice *bus = dev_get_parent(dev);
+	ulong start;
+
+	/*
+	 * Use the same probe as 'i2c probe', since some controllers cannot
+	 * send a zero-length write and provide probe_chip() instead
+	 */
+	start = get_timer(0);
+	do {
+		if (!i2c_probe_chip(bus, chip->chip_addr, chip->flags))
+			return 0;
+		udelay(100);
+	} while (get_timer(start) < timeout_ms);
+
+	return -ETIMEDOUT;
+}
+
+int dm_i2c_write_pages(struct udevice *dev, uint offset, const uint8_t *buffer,
+		       int len, uint pagesize, uint timeout_ms)
+{
+	int ret;
+
+	if (!pagesize || (pagesize & (pagesize - 1)))
+		return -EINVAL;
+
+	while (len > 0) {
+		int chunk = min_t(int, len, pagesize - (offset & (pagesize - 1)));
+
+		ret = dm_i2c_write(dev, offset, buffer, chunk);
+		if (ret)
+			return ret;
+		ret = i2c_wait_write_done(dev, timeout_ms);
+		if (ret)
+			return ret;
+
+		offset += chunk;
+		buffer += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
 static int i2c_bind_driver(struct udevice *bus, uint chip_addr, uint offset_len,
 			   struct udevice **devp)
 {
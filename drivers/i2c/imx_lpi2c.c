@@ -17,6 +17,7 @@
 #include <dm/device_compat.h>
 
 #define LPI2C_FIFO_SIZE 4
+#define LPI2C_RX_CHUNK 256
 #define LPI2C_NACK_TOUT_MS 1
 #define LPI2C_TIMEOUT_MS 100
 
@@ -100,18 +101,24 @@ static int bus_i2c_send(struct udevice *bus, u8 *txbuf, int len)
 	struct imx_lpi2c_bus *i2c_bus = dev_get_priv(bus);
 	struct imx_lpi2c_reg *regs = (struct imx_lpi2c_reg *)(i2c_bus->base);
 	lpi2c_status_t result = LPI2C_SUCESS;
+	int space;
 
 	/* empty tx */
 	if (!len)
 		return result;
 
-	while (len--) {
+	while (len) {
 		result = bus_i2c_wait_for_tx_ready(regs);
 		if (result) {
 			debug("i2c: send wait for tx ready: %d\n", result);
 			return result;
 		}
-		writel(*txbuf++, &regs->mtdr);
+		/* top up the tx fifo rather than waiting for each byte */
+		space = LPI2C_FIFO_SIZE - LPI2C_MFSR_TXCOUNT(readl(&regs->mfsr));
+		while (space-- > 0 && len) {
+			writel(*txbuf++, &regs->mtdr);
+			len--;
+		}
 	}
 
 	return result;
@@ -122,40 +129,61 @@ static int bus_i2c_receive(struct udevice *bus, u8 *rxbuf, int len)
 	struct imx_lpi2c_bus *i2c_bus = dev_get_priv(bus);
 	struct imx_lpi2c_reg *regs = (struct imx_lpi2c_reg *)(i2c_bus->base);
 	lpi2c_status_t result = LPI2C_SUCESS;
+	int requested = 0;
+	ulong start_time;
 	u32 val;
-	ulong start_time = get_timer(0);
+	int count;
 
 	/* empty read */
 	if (!len)
 		return result;
 
-	result = bus_i2c_wait_for_tx_ready(regs);
-	if (result) {
-		debug("i2c: receive wait fot tx ready: %d\n", result);
-		return result;
-	}
-
 	/* clear all status flags */
 	writel(0x7f00, &regs->msr);
-	/* send receive command */
-	val = LPI2C_MTDR_CMD(0x1) | LPI2C_MTDR_DATA(len - 1);
-	writel(val, &regs->mtdr);
 
-	while (len--) {
-		do {
-			result = imx_lpci2c_check_clear_error(regs);
+	start_time = get_timer(0);
+	while (len) {
+		/*
+		 * A receive command covers at most LPI2C_RX_CHUNK bytes, so
+		 * queue the next one once the previous has been drained. The
+		 * bus may pause between the two.
+		 */
+		if (!requested) {
+			result = bus_i2c_wait_for_tx_ready(regs);
 			if (result) {
-				debug("i2c: receive check clear error: %d\n",
+				debug("i2c: receive wait fot tx ready: %d\n",
 				      result);
 				return result;
 			}
+			requested = min(len, LPI2C_RX_CHUNK);
+			val = LPI2C_MTDR_CMD(0x1) |
+			      LPI2C_MTDR_DATA(requested - 1);
+			writel(val, &regs->mtdr);
+		}
+
+		result = imx_lpci2c_check_clear_error(regs);
+		if (result) {
+			debug("i2c: receive check clear error: %d\n", result);
+			return result;
+		}
+
+		/* drain everything the rx fifo holds in one go */
+		count = (readl(&regs->mfsr) & LPI2C_MFSR_RXCOUNT_MASK) >>
+			LPI2C_MFSR_RXCOUNT_SHIFT;
+		if (!count) {
 			if (get_timer(start_time) > LPI2C_TIMEOUT_MS) {
 				debug("i2c: receive mrdr: timeout\n");
 				return -1;
 			}
+			continue;
+		}
+		while (count-- && len) {
 			val = readl(&regs->mrdr);
-		} while (val & LPI2C_MRDR_RXEMPTY_MASK);
-		*rxbuf++ = LPI2C_MRDR_DATA(val);
+			*rxbuf++ = LPI2C_MRDR_DATA(val);
+			requested--;
+			len--;
+		}
+		start_time = get_timer(0);
 	}
 
 	return result;
@@ -7,7 +7,6 @@
 
 #include <common.h>
 #include <eeprom.h>
-#include <linux/delay.h>
 #include <linux/err.h>
 #include <linux/kernel.h>
 #include <dm.h>
@@ -15,6 +14,9 @@
 #include <i2c.h>
 #include <i2c_eeprom.h>
 
+/* Worst-case self-timed write cycle of the supported EEPROMs, with margin */
+#define I2C_EEPROM_WRITE_TIMEOUT_MS	20
+
 struct i2c_eeprom_drv_data {
 	u32 size; /* size in bytes */
 	u32 pagesize; /* page size in bytes */
@@ -63,23 +65,9 @@ static int i2c_eeprom_std_write(struct udevice *dev, int offset,
 				const uint8_t *buf, int size)
 {
 	struct i2c_eeprom *priv = dev_get_priv(dev);
-	int ret;
-
-	while (size > 0) {
-		int write_size = min_t(int, size, priv->pagesize);
-
-		ret = dm_i2c_write(dev, offset, buf, write_size);
-		if (ret)
-			return ret;
 
-		offset += write_size;
-		buf += write_size;
-		size -= write_size;
-
-		udelay(10000);
-	}
-
-	return 0;
+	return dm_i2c_write_pages(dev, offset, buf, size, priv->pagesize,
+				  I2C_EEPROM_WRITE_TIMEOUT_MS);
 }
 
 static int i2c_eeprom_std_size(struct udevice *dev)
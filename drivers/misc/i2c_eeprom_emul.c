@@ -25,12 +25,15 @@ struct sandbox_i2c_flash_plat_data {
 	int offset_len;		/* Length of an offset in bytes */
 	int size;		/* Size of data buffer */
 	uint chip_addr_offset_mask; /* mask of addr bits used for offset */
+	int busy_polls;		/* transfers NACKed after a write, -1 for all */
 };
 
 struct sandbox_i2c_flash {
 	uint8_t *data;
 	uint prev_addr;		/* slave address of previous access */
 	uint prev_offset;	/* offset of previous access */
+	int busy;		/* transfers still to NACK, -1 for all */
+	uint nacks;		/* number of transfers NACKed while busy */
 };
 
 void sandbox_i2c_eeprom_set_test_mode(struct udevice *dev,
@@ -56,6 +59,23 @@ void sandbox_i2c_eeprom_set_chip_addr_offset_mask(struct udevice *dev,
 	plat->chip_addr_offset_mask = mask;
 }
 
+void sandbox_i2c_eeprom_set_busy(struct udevice *dev, int polls)
+{
+	struct sandbox_i2c_flash_plat_data *plat = dev_get_plat(dev);
+	struct sandbox_i2c_flash *priv = dev_get_priv(dev);
+
+	plat->busy_polls = polls;
+	priv->busy = 0;
+	priv->nacks = 0;
+}
+
+uint sandbox_i2c_eeprom_get_nacks(struct udevice *dev)
+{
+	struct sandbox_i2c_flash *priv = dev_get_priv(dev);
+
+	return priv->nacks;
+}
+
 uint sanbox_i2c_eeprom_get_prev_addr(struct udevice *dev)
 {
 	struct sandbox_i2c_flash *priv = dev_get_priv(dev);
@@ -80,6 +100,14 @@ static int sandbox_i2c_eeprom_xfer(struct udevice *emul, struct i2c_msg *msg,
 	debug("\n%s\n", __func__);
 	debug_buffer(0, priv->data, 1, 16, 0);
 
+	/* Like a real EEPROM, do not ACK while a write cycle is running */
+	if (priv->busy) {
+		if (priv->busy > 0)
+			priv->busy--;
+		priv->nacks++;
+		return -EREMOTEIO;
+	}
+
 	/* store addr for testing visibity */
 	priv->prev_addr = msg->addr;
 
@@ -138,6 +166,8 @@ static int sandbox_i2c_eeprom_xfer(struct udevice *emul, struct i2c_msg *msg,
 			} else {
 				memcpy(priv->data + offset, ptr, len);
 			}
+			if (len)
+				priv->busy = plat->busy_polls;
 		}
 	}
 	debug_buffer(0, priv->data, 1, 16, 0);
@@ -163,6 +193,7 @@ static int sandbox_i2c_eeprom_of_to_plat(struct udevice *dev)
 	plat->test_mode = SIE_TEST_MODE_NONE;
 	plat->offset_len = 1;
 	plat->chip_addr_offset_mask = 0;
+	plat->busy_polls = 0;
 
 	return 0;
 }
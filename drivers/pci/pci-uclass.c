@@ -13,6 +13,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <pci.h>
+#include <time.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <dm/device-internal.h>
@@ -27,6 +28,12 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/*
+ * Set while pci_init() probes the controllers, so that the bus scan of those
+ * which support link_up() waits until all of them have been probed
+ */
+static bool pci_defer_scan __section(".data");
+
 int pci_get_bus(int busnum, struct udevice **busp)
 {
 	int ret;
@@ -76,9 +83,15 @@ pci_dev_t dm_pci_get_bdf(const struct udevice *dev)
 /**
  * pci_get_bus_max() - returns the bus number of the last active bus
  *
+ * Bus numbers kept free for controllers whose bus scan is pending count as
+ * active, so that they are not given to another bus. When working out the
+ * last bus behind a bridge of @ctlr, those kept by other controllers are not
+ * behind the bridge and are left out.
+ *
+ * @ctlr: Controller whose buses are being counted, or NULL for all
  * Return: last bus number, or -1 if no active buses
  */
-static int pci_get_bus_max(void)
+static int pci_get_bus_max(struct udevice *ctlr)
 {
 	struct udevice *bus;
 	struct uclass *uc;
@@ -86,8 +99,13 @@ static int pci_get_bus_max(void)
 
 	ret = uclass_get(UCLASS_PCI, &uc);
 	uclass_foreach_dev(bus, uc) {
+		struct pci_controller *hose = dev_get_uclass_priv(bus);
+
 		if (dev_seq(bus) > ret)
 			ret = dev_seq(bus);
+		if (hose && hose->reserved_busno > ret &&
+		    (!ctlr || bus == ctlr))
+			ret = hose->reserved_busno;
 	}
 
 	debug("%s: ret=%d\n", __func__, ret);
@@ -97,7 +115,7 @@ static int pci_get_bus_max(void)
 
 int pci_last_busno(void)
 {
-	return pci_get_bus_max();
+	return pci_get_bus_max(NULL);
 }
 
 int pci_get_ff(enum pci_size_t size)
@@ -627,6 +645,7 @@ int pci_generic_mmap_read_config(
 
 int dm_pci_hose_probe_bus(struct udevice *bus)
 {
+	struct pci_controller *parent_hose;
 	u8 header_type;
 	int sub_bus;
 	int ret;
@@ -643,13 +662,20 @@ int dm_pci_hose_probe_bus(struct udevice *bus)
 		return log_msg_ret("probe", -EINVAL);
 	}
 
+	parent_hose = dev_get_uclass_priv(bus->parent);
 	ea_pos = dm_pci_find_capability(bus, PCI_CAP_ID_EA);
 	if (ea_pos) {
 		dm_pci_read_config8(bus, ea_pos + sizeof(u32) + sizeof(u8),
 				    &reg);
 		sub_bus = reg;
+	} else if (parent_hose->reserved_busno) {
+		/* Use the number kept free while the bus scan was pending */
+		sub_bus = parent_hose->reserved_busno;
+		parent_hose->reserved_busno = 0;
+		if (dev_seq(bus) == -1)
+			bus->seq_ = sub_bus;
 	} else {
-		sub_bus = pci_get_bus_max() + 1;
+		sub_bus = pci_get_bus_max(NULL) + 1;
 	}
 	debug("%s: bus = %d/%s\n", __func__, sub_bus, bus->name);
 	dm_pciauto_prescan_setup_bridge(bus, sub_bus);
@@ -662,7 +688,7 @@ int dm_pci_hose_probe_bus(struct udevice *bus)
 	}
 
 	if (!ea_pos)
-		sub_bus = pci_get_bus_max();
+		sub_bus = pci_get_bus_max(parent_hose->ctlr);
 
 	dm_pciauto_postscan_setup_bridge(bus, sub_bus);
 
@@ -839,18 +865,67 @@ __weak extern void board_pci_fixup_dev(struct udevice *bus, struct udevice *dev)
 {
 }
 
+/**
+ * pci_bus_max_devices() - Get the number of device numbers to scan on a bus
+ *
+ * A PCIe Root Port or Downstream Port has a point-to-point link below it, so
+ * only device 0 can be present on its secondary bus, and nothing at all while
+ * its link is down. Scanning the other device numbers just costs config
+ * accesses which end with an unsupported request (or a timeout on some
+ * controllers). ARI devices may use more than eight functions, so all device
+ * numbers are still scanned when ARI support is enabled.
+ *
+ * @bus: Bus to scan
+ * Return: number of device numbers to scan, starting with device 0
+ */
+static int pci_bus_max_devices(struct udevice *bus)
+{
+	u16 flags, lnksta;
+	u32 lnkcap;
+	int type;
+	int pos;
+
+	if (IS_ENABLED(CONFIG_PCI_ARID) || !device_is_on_pci_bus(bus))
+		return PCI_MAX_PCI_DEVICES;
+
+	pos = dm_pci_find_capability(bus, PCI_CAP_ID_EXP);
+	if (!pos)
+		return PCI_MAX_PCI_DEVICES;
+
+	dm_pci_read_config16(bus, pos + PCI_EXP_FLAGS, &flags);
+	type = (flags & PCI_EXP_FLAGS_TYPE) >> 4;
+	if (type != PCI_EXP_TYPE_ROOT_PORT && type != PCI_EXP_TYPE_DOWNSTREAM)
+		return PCI_MAX_PCI_DEVICES;
+
+	dm_pci_read_config32(bus, pos + PCI_EXP_LNKCAP, &lnkcap);
+	if (lnkcap & PCI_EXP_LNKCAP_DLLLARC) {
+		dm_pci_read_config16(bus, pos + PCI_EXP_LNKSTA, &lnksta);
+		if (!(lnksta & PCI_EXP_LNKSTA_DLLLA)) {
+			debug("%s: bus %d/%s: link down\n", __func__,
+			      dev_seq(bus), bus->name);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
 int pci_bind_bus_devices(struct udevice *bus)
 {
 	ulong vendor, device;
 	ulong header_type;
 	pci_dev_t bdf, end;
 	bool found_multi;
+	int max_devs;
 	int ari_off;
 	int ret;
 
+	max_devs = pci_bus_max_devices(bus);
+	if (!max_devs)
+		return 0;
+
 	found_multi = false;
-	end = PCI_BDF(dev_seq(bus), PCI_MAX_PCI_DEVICES - 1,
-		      PCI_MAX_PCI_FUNCTIONS - 1);
+	end = PCI_BDF(dev_seq(bus), max_devs - 1, PCI_MAX_PCI_FUNCTIONS - 1);
 	for (bdf = PCI_BDF(dev_seq(bus), 0, 0); bdf <= end;
 	     bdf += PCI_BDF(0, 0, 1)) {
 		struct pci_child_plat *pplat;
@@ -916,6 +991,7 @@ int pci_bind_bus_devices(struct udevice *bus)
 		pplat->vendor = vendor;
 		pplat->device = device;
 		pplat->class = class;
+		pplat->header_type = header_type;
 
 		if (IS_ENABLED(CONFIG_PCI_ARID)) {
 			ari_off = dm_pci_find_ext_capability(dev,
@@ -1070,7 +1146,8 @@ static int pci_uclass_pre_probe(struct udevice *bus)
 		ret = uclass_get(UCLASS_PCI, &uc);
 		if (ret)
 			return ret;
-		bus->seq_ = uclass_find_next_free_seq(uc);
+		bus->seq_ = max(uclass_find_next_free_seq(uc),
+				pci_get_bus_max(NULL) + 1);
 	}
 
 	/* For bridges, use the top-level PCI controller */
@@ -1096,7 +1173,7 @@ static int pci_uclass_pre_probe(struct udevice *bus)
 	return 0;
 }
 
-static int pci_uclass_post_probe(struct udevice *bus)
+static int pci_scan_bus(struct udevice *bus)
 {
 	struct pci_controller *hose = dev_get_uclass_priv(bus);
 	int ret;
@@ -1138,6 +1215,110 @@ static int pci_uclass_post_probe(struct udevice *bus)
 	return 0;
 }
 
+/**
+ * pci_wait_links() - Wait for the links of controllers whose scan is pending
+ *
+ * This polls all the controllers together, so that the total wait is that of
+ * the slowest link (or CONFIG_PCI_LINK_TIMEOUT_MS if a link stays down),
+ * rather than the sum of them.
+ */
+static void pci_wait_links(void)
+{
+	struct pci_controller *hose;
+	struct udevice *bus;
+	struct uclass *uc;
+	bool waiting;
+	ulong start;
+	int ret;
+
+	if (uclass_get(UCLASS_PCI, &uc))
+		return;
+
+	start = get_timer(0);
+	do {
+		waiting = false;
+		uclass_foreach_dev(bus, uc) {
+			hose = dev_get_uclass_priv(bus);
+			if (!hose || !hose->scan_pending || hose->link_checked)
+				continue;
+
+			ret = pci_get_ops(bus)->link_up(bus);
+			if (ret) {
+				if (ret < 0)
+					log_debug("%s: link error %d\n",
+						  bus->name, ret);
+				hose->link_checked = true;
+			} else {
+				waiting = true;
+			}
+		}
+		if (waiting)
+			udelay(100);
+	} while (waiting && get_timer(start) < CONFIG_PCI_LINK_TIMEOUT_MS);
+
+	uclass_foreach_dev(bus, uc) {
+		hose = dev_get_uclass_priv(bus);
+		if (hose && hose->scan_pending && !hose->link_checked) {
+			log_debug("%s: link down\n", bus->name);
+			hose->link_checked = true;
+		}
+	}
+}
+
+static int pci_uclass_post_probe(struct udevice *bus)
+{
+	struct pci_controller *hose = dev_get_uclass_priv(bus);
+
+	if (!device_is_on_pci_bus(bus) && pci_get_ops(bus)->link_up) {
+		hose->scan_pending = true;
+		hose->link_checked = false;
+
+		/*
+		 * Let pci_init() scan the bus once all controllers are probed.
+		 * The first bus number after the controller is kept for the
+		 * bus behind its root port, since controllers such as
+		 * DesignWare ones use type 0 accesses for that bus only.
+		 */
+		if (pci_defer_scan) {
+			hose->reserved_busno = pci_get_bus_max(NULL) + 1;
+			return 0;
+		}
+		pci_wait_links();
+		hose->scan_pending = false;
+	}
+
+	return pci_scan_bus(bus);
+}
+
+/**
+ * pci_scan_pending() - Scan the buses whose scan was deferred by pci_init()
+ *
+ * The buses are scanned in the order their controllers were probed, once the
+ * links of all of them are up or have timed out.
+ */
+static void pci_scan_pending(void)
+{
+	struct pci_controller *hose;
+	struct udevice *bus;
+	struct uclass *uc;
+	int ret;
+
+	pci_wait_links();
+
+	if (uclass_get(UCLASS_PCI, &uc))
+		return;
+	uclass_foreach_dev(bus, uc) {
+		hose = dev_get_uclass_priv(bus);
+		if (!hose || !hose->scan_pending)
+			continue;
+		hose->scan_pending = false;
+		ret = pci_scan_bus(bus);
+		hose->reserved_busno = 0;
+		if (ret)
+			log_err("PCI: Cannot scan bus %s: %d\n", bus->name, ret);
+	}
+}
+
 static int pci_uclass_child_post_bind(struct udevice *dev)
 {
 	struct pci_child_plat *pplat;
@@ -1153,6 +1334,9 @@ static int pci_uclass_child_post_bind(struct udevice *dev)
 	/* Extract the devfn from fdt_pci_addr */
 	pplat->devfn = pci_get_devfn(dev);
 
+	/* Not known until the device is found by a bus scan */
+	pplat->header_type = 0xff;
+
 	return 0;
 }
 
@@ -1818,6 +2002,7 @@ int pci_sriov_init(struct udevice *pdev, int vf_en)
 		pplat->vendor = vendor;
 		pplat->device = device;
 		pplat->class = class;
+		pplat->header_type = 0xff;
 		pplat->is_virtfn = true;
 		pplat->pfdev = pdev;
 		pplat->virtid = vf * vf_stride + vf_offset;
@@ -1900,12 +2085,18 @@ int pci_init(void)
 	/*
 	 * Enumerate all known controller devices. Enumeration has the side-
 	 * effect of probing them, so PCIe devices will be enumerated too.
+	 * Controllers which report their link state are scanned afterwards,
+	 * so that their links can come up at the same time.
 	 */
+	pci_defer_scan = true;
 	for (uclass_first_device_check(UCLASS_PCI, &bus);
 	     bus;
 	     uclass_next_device_check(&bus)) {
 		;
 	}
+	pci_defer_scan = false;
+
+	pci_scan_pending();
 
 	return 0;
 }
@@ -21,6 +21,25 @@
 #define CONFIG_SYS_PCI_CACHE_LINE_SIZE	8
 #endif
 
+/*
+ * Get the header type and class of a device, using the values read when its
+ * bus was scanned if there are any
+ */
+static void dm_pciauto_get_type(struct udevice *dev, u8 *header_type,
+				u16 *class)
+{
+	struct pci_child_plat *pplat = dev_get_parent_plat(dev);
+
+	if (pplat->header_type != 0xff) {
+		*header_type = pplat->header_type;
+		*class = pplat->class >> 8;
+		return;
+	}
+
+	dm_pci_read_config8(dev, PCI_HEADER_TYPE, header_type);
+	dm_pci_read_config16(dev, PCI_CLASS_DEVICE, class);
+}
+
 static void dm_pciauto_setup_device(struct udevice *dev,
 				    struct pci_region *mem,
 				    struct pci_region *prefetch,
@@ -42,7 +61,7 @@ static void dm_pciauto_setup_device(struct udevice *dev,
 	cmdstat = (cmdstat & ~(PCI_COMMAND_IO | PCI_COMMAND_MEMORY)) |
 			PCI_COMMAND_MASTER;
 
-	dm_pci_read_config8(dev, PCI_HEADER_TYPE, &header_type);
+	dm_pciauto_get_type(dev, &header_type, &class);
 	header_type &= 0x7f;
 
 	switch (header_type) {
@@ -172,7 +191,6 @@ static void dm_pciauto_setup_device(struct udevice *dev,
 	}
 
 	/* PCI_COMMAND_IO must be set for VGA device */
-	dm_pci_read_config16(dev, PCI_CLASS_DEVICE, &class);
 	if (class == PCI_CLASS_DISPLAY_VGA)
 		cmdstat |= PCI_COMMAND_IO;
 
@@ -524,7 +542,8 @@ int dm_pciauto_config_device(struct udevice *dev)
 	struct pci_region *pci_prefetch;
 	struct pci_region *pci_io;
 	unsigned int sub_bus = PCI_BUS(dm_pci_get_bdf(dev));
-	unsigned short class;
+	u16 class;
+	u8 header_type;
 	struct udevice *ctlr = pci_get_controller(dev);
 	struct pci_controller *ctlr_hose = dev_get_uclass_priv(ctlr);
 	int ret;
@@ -533,7 +552,7 @@ int dm_pciauto_config_device(struct udevice *dev)
 	pci_prefetch = ctlr_hose->pci_prefetch;
 	pci_io = ctlr_hose->pci_io;
 
-	dm_pci_read_config16(dev, PCI_CLASS_DEVICE, &class);
+	dm_pciauto_get_type(dev, &header_type, &class);
 
 	switch (class) {
 	case PCI_CLASS_BRIDGE_PCI:
@@ -9,17 +9,28 @@
 #include <fdtdec.h>
 #include <log.h>
 #include <pci.h>
+#include <asm/test.h>
 
 #define FDT_DEV_INFO_CELLS	4
 #define FDT_DEV_INFO_SIZE	(FDT_DEV_INFO_CELLS * sizeof(u32))
 
 #define SANDBOX_PCI_DEVFN(d, f)	((d << 3) | f)
 
+/**
+ * struct sandbox_pci_priv - private data for a sandbox PCI controller
+ *
+ * @vendev: Vendor and device IDs of devices without an emulator, by devfn
+ * @link_up_polls: Number of link_up() calls before the link comes up, or 0
+ *	if it never does ("sandbox,pcie" only)
+ * @link_polls: Number of link_up() calls so far
+ */
 struct sandbox_pci_priv {
 	struct {
 		u16 vendor;
 		u16 device;
 	} vendev[256];
+	uint link_up_polls;
+	uint link_polls;
 };
 
 static int sandbox_pci_write_config(struct udevice *bus, pci_dev_t devfn,
@@ -84,6 +95,9 @@ static int sandbox_pci_probe(struct udevice *dev)
 	u8 pdev, pfn, devfn;
 	int len;
 
+	priv->link_up_polls = dev_read_u32_default(dev, "sandbox,link-up-polls",
+						   0);
+
 	cell = ofnode_get_property(dev_ofnode(dev), "sandbox,dev-info", &len);
 	if (!cell)
 		return 0;
@@ -112,6 +126,22 @@ static int sandbox_pci_probe(struct udevice *dev)
 	return 0;
 }
 
+static int sandbox_pcie_link_up(struct udevice *bus)
+{
+	struct sandbox_pci_priv *priv = dev_get_priv(bus);
+
+	priv->link_polls++;
+
+	return priv->link_up_polls && priv->link_polls >= priv->link_up_polls;
+}
+
+int sandbox_pci_get_link_polls(struct udevice *bus)
+{
+	struct sandbox_pci_priv *priv = dev_get_priv(bus);
+
+	return priv->link_polls;
+}
+
 static const struct dm_pci_ops sandbox_pci_ops = {
 	.read_config = sandbox_pci_read_config,
 	.write_config = sandbox_pci_write_config,
@@ -134,3 +164,26 @@ U_BOOT_DRIVER(pci_sandbox) = {
 	.child_post_bind = dm_scan_fdt_dev,
 	.per_child_plat_auto	= sizeof(struct pci_child_plat),
 };
+
+static const struct dm_pci_ops sandbox_pcie_ops = {
+	.read_config = sandbox_pci_read_config,
+	.write_config = sandbox_pci_write_config,
+	.link_up = sandbox_pcie_link_up,
+};
+
+static const struct udevice_id sandbox_pcie_ids[] = {
+	{ .compatible = "sandbox,pcie" },
+	{ }
+};
+
+/* Same as above, but the uclass waits for the link before the bus scan */
+U_BOOT_DRIVER(pcie_sandbox) = {
+	.name	= "pcie_sandbox",
+	.id	= UCLASS_PCI,
+	.of_match = sandbox_pcie_ids,
+	.ops	= &sandbox_pcie_ops,
+	.probe	= sandbox_pci_probe,
+	.priv_auto	= sizeof(struct sandbox_pci_priv),
+	.child_post_bind = dm_scan_fdt_dev,
+	.per_child_plat_auto	= sizeof(struct pci_child_plat),
+};
@@ -71,7 +71,6 @@ struct meson_pcie {
 #define PCIE_CFG_STATUS17		0x44
 #define PM_CURRENT_STATE(x)		(((x) >> 7) & 0x1)
 
-#define WAIT_LINKUP_TIMEOUT		4000
 #define PORT_CLK_RATE			100000000UL
 #define MAX_PAYLOAD_SIZE		256
 #define MAX_READ_REQ_SIZE		256
@@ -136,52 +135,41 @@ static inline void meson_pcie_enable_ltssm(struct meson_pcie *priv)
 	meson_cfg_writel(priv, val, PCIE_CFG0);
 }
 
-static int meson_pcie_wait_link_up(struct meson_pcie *priv)
+/**
+ * meson_pcie_link_up() - Check whether the link is up
+ *
+ * @dev: A pointer to the device being operated on
+ *
+ * Return: 1 if the link is up, 0 if not
+ */
+static int meson_pcie_link_up(struct udevice *dev)
 {
-	u32 speed_okay = 0;
-	u32 cnt = 0;
-	u32 state12, state17, smlh_up, ltssm_up, rdlh_up;
-
-	do {
-		state12 = meson_cfg_readl(priv, PCIE_CFG_STATUS12);
-		state17 = meson_cfg_readl(priv, PCIE_CFG_STATUS17);
-		smlh_up = IS_SMLH_LINK_UP(state12);
-		rdlh_up = IS_RDLH_LINK_UP(state12);
-		ltssm_up = IS_LTSSM_UP(state12);
-
-		if (PM_CURRENT_STATE(state17) < PCIE_GEN3)
-			speed_okay = 1;
-
-		if (smlh_up)
-			debug("%s: smlh_link_up is on\n", __func__);
-		if (rdlh_up)
-			debug("%s: rdlh_link_up is on\n", __func__);
-		if (ltssm_up)
-			debug("%s: ltssm_up is on\n", __func__);
-		if (speed_okay)
-			debug("%s: speed_okay\n", __func__);
-
-		if (smlh_up && rdlh_up && ltssm_up && speed_okay)
-			return 0;
-
-		cnt++;
-
-		udelay(10);
-	} while (cnt < WAIT_LINKUP_TIMEOUT);
-
-	printf("%s: error: wait linkup timeout\n", __func__);
-	return -EIO;
+	struct meson_pcie *priv = dev_get_priv(dev);
+	u32 state12, state17;
+
+	state12 = meson_cfg_readl(priv, PCIE_CFG_STATUS12);
+	state17 = meson_cfg_readl(priv, PCIE_CFG_STATUS17);
+
+	if (!IS_SMLH_LINK_UP(state12) || !IS_RDLH_LINK_UP(state12) ||
+	    !IS_LTSSM_UP(state12) || PM_CURRENT_STATE(state17) >= PCIE_GEN3)
+		return 0;
+
+	printf("PCIE-%d: Link up (Gen%d-x%d, Bus%d)\n",
+	       dev_seq(dev), pcie_dw_get_link_speed(&priv->dw),
+	       pcie_dw_get_link_width(&priv->dw), priv->dw.first_busno);
+
+	return 1;
 }
 
 /**
- * meson_pcie_link_up() - Wait for the link to come up
+ * meson_pcie_start_link() - Start training the link
  *
  * @meson_pcie: Pointer to the PCI controller state
  * @cap_speed: Desired link speed
  *
- * Return: 1 (true) for active line and negative (false) for no link (timeout)
+ * The PCI uclass waits for the link to come up, see meson_pcie_link_up()
  */
-static int meson_pcie_link_up(struct meson_pcie *priv, u32 cap_speed)
+static void meson_pcie_start_link(struct meson_pcie *priv, u32 cap_speed)
 {
 	/* DW link configurations */
 	meson_pcie_configure(priv);
@@ -200,8 +188,6 @@ static int meson_pcie_link_up(struct meson_pcie *priv, u32 cap_speed)
 
 	/* Enable LTSSM */
 	meson_pcie_enable_ltssm(priv);
-
-	return meson_pcie_wait_link_up(priv);
 }
 
 static int meson_size_to_payload(int size)
@@ -319,7 +305,7 @@ static int meson_pcie_init_port(struct udevice *dev)
 
 	pcie_dw_setup_host(&priv->dw);
 
-	meson_pcie_link_up(priv, LINK_SPEED_GEN_2);
+	meson_pcie_start_link(priv, LINK_SPEED_GEN_2);
 
 	return 0;
 err_deassert_bulk:
@@ -394,16 +380,14 @@ static int meson_pcie_parse_dt(struct udevice *dev)
  *
  * @dev: A pointer to the device being operated on
  *
- * Probe for an active link on the PCIe bus and configure the controller
- * to enable this port.
+ * Configure the controller to enable this port and start training the link
+ * on the PCIe bus.
  *
  * Return: 0 on success, else -ENODEV
  */
 static int meson_pcie_probe(struct udevice *dev)
 {
 	struct meson_pcie *priv = dev_get_priv(dev);
-	struct udevice *ctlr = pci_get_controller(dev);
-	struct pci_controller *hose = dev_get_uclass_priv(ctlr);
 	int ret = 0;
 
 	priv->dw.first_busno = dev_seq(dev);
@@ -419,11 +403,6 @@ static int meson_pcie_probe(struct udevice *dev)
 		return ret;
 	}
 
-	printf("PCIE-%d: Link up (Gen%d-x%d, Bus%d)\n",
-	       dev_seq(dev), pcie_dw_get_link_speed(&priv->dw),
-	       pcie_dw_get_link_width(&priv->dw),
-	       hose->first_busno);
-
 	return pcie_dw_prog_outbound_atu_unroll(&priv->dw,
 						PCIE_ATU_REGION_INDEX0,
 						PCIE_ATU_TYPE_MEM,
@@ -435,6 +414,7 @@ static int meson_pcie_probe(struct udevice *dev)
 static const struct dm_pci_ops meson_pcie_ops = {
 	.read_config	= pcie_dw_read_config,
 	.write_config	= pcie_dw_write_config,
+	.link_up	= meson_pcie_link_up,
 };
 
 static const struct udevice_id meson_pcie_ids[] = {
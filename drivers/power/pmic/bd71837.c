@@ -49,6 +49,22 @@ static int bd71837_read(struct udevice *dev, uint reg, uint8_t *buff, int len)
 	return 0;
 }
 
+static bool bd71837_reg_volatile(struct udevice *dev, uint reg)
+{
+	switch (reg) {
+	case BD718XX_SWRESET:
+	case BD718XX_RCVNUM:
+	case BD718XX_RESETSRC:
+	case BD718XX_IRQ:
+	case BD718XX_IN_MON:
+	case BD718XX_POW_STATE:
+	case BD718XX_REGLOCK:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static int bd71837_bind(struct udevice *dev)
 {
 	int children;
@@ -93,6 +109,7 @@ static struct dm_pmic_ops bd71837_ops = {
 	.reg_count = bd71837_reg_count,
 	.read = bd71837_read,
 	.write = bd71837_write,
+	.reg_volatile = bd71837_reg_volatile,
 };
 
 static const struct udevice_id bd71837_ids[] = {
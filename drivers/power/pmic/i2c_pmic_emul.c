@@ -12,12 +12,19 @@
 #include <malloc.h>
 #include <power/pmic.h>
 #include <power/sandbox_pmic.h>
+#include <asm/test.h>
+
+/* Number of register writes recorded for sandbox_i2c_pmic_get_writes() */
+#define SANDBOX_PMIC_WRITE_LOG	16
 
 /**
  * struct sandbox_i2c_pmic_plat_data - platform data for the PMIC
  *
  * @rw_reg: PMICs register of the chip I/O transaction
  * @reg:    PMICs registers array
+ * @log_reg: first register of each write, in order
+ * @log_len: number of registers of each write
+ * @log_count: number of writes recorded in @log_reg and @log_len
  */
 struct sandbox_i2c_pmic_plat_data {
 	u8 rw_reg, rw_idx;
@@ -25,8 +32,24 @@ struct sandbox_i2c_pmic_plat_data {
 	u8 trans_len;
 	u8 buf_size;
 	u8 *reg;
+	u8 log_reg[SANDBOX_PMIC_WRITE_LOG];
+	u8 log_len[SANDBOX_PMIC_WRITE_LOG];
+	int log_count;
 };
 
+int sandbox_i2c_pmic_get_writes(struct udevice *emul, u8 *regs, u8 *lens,
+				int max)
+{
+	struct sandbox_i2c_pmic_plat_data *plat = dev_get_plat(emul);
+	int count = min(plat->log_count, max);
+
+	memcpy(regs, plat->log_reg, count);
+	memcpy(lens, plat->log_len, count);
+	plat->log_count = 0;
+
+	return count;
+}
+
 static int sandbox_i2c_pmic_read_data(struct udevice *emul, uchar chip,
 				      uchar *buffer, int len)
 {
@@ -77,6 +100,12 @@ static int sandbox_i2c_pmic_write_data(struct udevice *emul, uchar chip,
 
 	memcpy(plat->reg + plat->rw_idx, buffer, len);
 
+	if (plat->log_count < SANDBOX_PMIC_WRITE_LOG) {
+		plat->log_reg[plat->log_count] = plat->rw_reg;
+		plat->log_len[plat->log_count] = len / plat->trans_len;
+		plat->log_count++;
+	}
+
 	return 0;
 }
 
@@ -51,6 +51,22 @@ static int pca9450_read(struct udevice *dev, uint reg, uint8_t *buff,
 	return 0;
 }
 
+static bool pca9450_reg_volatile(struct udevice *dev, uint reg)
+{
+	switch (reg) {
+	case PCA9450_INT1:
+	case PCA9450_STATUS1:
+	case PCA9450_STATUS2:
+	case PCA9450_PWRON_STAT:
+	case PCA9450_SW_RST:
+	case PCA9450_VRFLT1_STS:
+	case PCA9450_VRFLT2_STS:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static int pca9450_bind(struct udevice *dev)
 {
 	int children;
@@ -78,6 +94,7 @@ static struct dm_pmic_ops pca9450_ops = {
 	.reg_count = pca9450_reg_count,
 	.read = pca9450_read,
 	.write = pca9450_write,
+	.reg_volatile = pca9450_reg_volatile,
 };
 
 static const struct udevice_id pca9450_ids[] = {
@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <dm.h>
 #include <log.h>
+#include <malloc.h>
 #include <vsprintf.h>
 #include <dm/lists.h>
 #include <dm/device-internal.h>
@@ -105,9 +106,311 @@ int pmic_reg_count(struct udevice *dev)
 	return ops->reg_count(dev);
 }
 
+#if CONFIG_IS_ENABLED(PMIC_CACHE)
+/* Per-register state of the cache, see struct uc_pmic_priv */
+#define PMIC_CACHE_VALID	BIT(0)
+#define PMIC_CACHE_DIRTY	BIT(1)
+
+static bool pmic_cache_reg(struct udevice *dev, uint reg)
+{
+	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	return reg < priv->cache_regs && !ops->reg_volatile(dev, reg);
+}
+
+/* Return true if all the registers are held in the cache */
+static bool pmic_cache_range(struct udevice *dev, uint reg, int len)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	int i;
+
+	if (!priv->cache)
+		return false;
+
+	for (i = 0; i < len; i++) {
+		if (!pmic_cache_reg(dev, reg + i))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Write out deferred writes in the order they were made. Consecutive log
+ * entries for consecutive registers are written with one transfer, but
+ * writes are never reordered or merged otherwise.
+ */
+static int pmic_cache_flush(struct udevice *dev)
+{
+	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	struct pmic_cache_entry *log;
+	u8 buf[16];
+	uint i, n;
+	int ret;
+
+	if (!priv->cache_log_len)
+		return 0;
+
+	for (i = 0; i < priv->cache_log_len; i += n) {
+		log = priv->cache_log + i;
+		buf[0] = log[0].val;
+		for (n = 1; i + n < priv->cache_log_len && n < sizeof(buf) &&
+		     log[n].reg == log[0].reg + n; n++)
+			buf[n] = log[n].val;
+
+		ret = ops->write(dev, log[0].reg, buf, n);
+		if (ret) {
+			/* keep what is not written yet for the next flush */
+			priv->cache_log_len -= i;
+			memmove(priv->cache_log, log,
+				priv->cache_log_len * sizeof(*log));
+			return ret;
+		}
+	}
+	priv->cache_log_len = 0;
+	for (i = 0; i < priv->cache_regs; i++)
+		priv->cache_flags[i] &= ~PMIC_CACHE_DIRTY;
+
+	return 0;
+}
+
+/*
+ * Prepare for an access to the device. Pending writes must reach it before
+ * any access to a register outside the cache, e.g. a lock register.
+ */
+static int pmic_cache_prepare(struct udevice *dev, uint reg, int len)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	if (!priv->cache || !priv->cache_log_len ||
+	    pmic_cache_range(dev, reg, len))
+		return 0;
+
+	return pmic_cache_flush(dev);
+}
+
+/* Return true if all registers could be read from the cache */
+static bool pmic_cache_read(struct udevice *dev, uint reg, uint8_t *buffer,
+			    int len)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	int i;
+
+	if (!priv->cache)
+		return false;
+
+	if (!pmic_cache_range(dev, reg, len))
+		return false;
+	for (i = 0; i < len; i++) {
+		if (!(priv->cache_flags[reg + i] & PMIC_CACHE_VALID))
+			return false;
+	}
+	memcpy(buffer, priv->cache + reg, len);
+
+	return true;
+}
+
+/* Store values read from the device, pending writes take precedence */
+static void pmic_cache_fill(struct udevice *dev, uint reg, uint8_t *buffer,
+			    int len)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	int i;
+
+	if (!priv->cache)
+		return;
+
+	for (i = 0; i < len; i++) {
+		if (!pmic_cache_reg(dev, reg + i))
+			continue;
+		if (priv->cache_flags[reg + i] & PMIC_CACHE_DIRTY) {
+			buffer[i] = priv->cache[reg + i];
+		} else {
+			priv->cache[reg + i] = buffer[i];
+			priv->cache_flags[reg + i] = PMIC_CACHE_VALID;
+		}
+	}
+}
+
+/*
+ * Handle a write in the cache. Return 0 if the write was absorbed (the
+ * registers already hold the values, or writes are deferred), 1 if it has
+ * to go to the device, or -ve on error.
+ */
+static int pmic_cache_write(struct udevice *dev, uint reg,
+			    const uint8_t *buffer, int len)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	struct pmic_cache_entry *log;
+	bool same = true;
+	int i, ret;
+
+	if (!pmic_cache_range(dev, reg, len))
+		return 1;
+
+	for (i = 0; i < len; i++) {
+		if (!(priv->cache_flags[reg + i] & PMIC_CACHE_VALID) ||
+		    priv->cache[reg + i] != buffer[i])
+			same = false;
+	}
+	if (same)
+		return 0;
+	if (!priv->cache_defer)
+		return 1;
+
+	if (priv->cache_log_len + len > priv->cache_regs) {
+		ret = pmic_cache_flush(dev);
+		if (ret)
+			return ret;
+	}
+
+	memcpy(priv->cache + reg, buffer, len);
+	memset(priv->cache_flags + reg, PMIC_CACHE_VALID | PMIC_CACHE_DIRTY,
+	       len);
+	log = priv->cache_log + priv->cache_log_len;
+	for (i = 0; i < len; i++) {
+		log[i].reg = reg + i;
+		log[i].val = buffer[i];
+	}
+	priv->cache_log_len += len;
+
+	return 0;
+}
+
+/* Record values written to the device */
+static void pmic_cache_written(struct udevice *dev, uint reg,
+			       const uint8_t *buffer, int len)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	int i;
+
+	if (!priv->cache)
+		return;
+
+	for (i = 0; i < len; i++) {
+		if (!pmic_cache_reg(dev, reg + i))
+			continue;
+		priv->cache[reg + i] = buffer[i];
+		priv->cache_flags[reg + i] = PMIC_CACHE_VALID;
+	}
+}
+
+int pmic_cache_defer(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	if (!priv->cache)
+		return -ENOSYS;
+	priv->cache_defer = true;
+
+	return 0;
+}
+
+int pmic_cache_sync(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	priv->cache_defer = false;
+	if (!priv->cache)
+		return 0;
+
+	return pmic_cache_flush(dev);
+}
+
+void pmic_cache_invalidate(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	priv->cache_defer = false;
+	priv->cache_log_len = 0;
+	if (priv->cache)
+		memset(priv->cache_flags, '\0', priv->cache_regs);
+}
+
+static int pmic_cache_init(struct udevice *dev)
+{
+	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	int count;
+
+	/* Only drivers which describe their volatile registers are cached */
+	if (!ops || !ops->reg_volatile || priv->trans_len != 1)
+		return 0;
+
+	count = pmic_reg_count(dev);
+	if (count <= 0)
+		return 0;
+
+	priv->cache = calloc(2, count);
+	if (!priv->cache)
+		return -ENOMEM;
+	priv->cache_log = calloc(count, sizeof(*priv->cache_log));
+	if (!priv->cache_log) {
+		free(priv->cache);
+		priv->cache = NULL;
+		return -ENOMEM;
+	}
+	priv->cache_flags = priv->cache + count;
+	priv->cache_regs = count;
+
+	return 0;
+}
+
+static void pmic_cache_free(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	free(priv->cache);
+	free(priv->cache_log);
+	priv->cache = NULL;
+	priv->cache_log = NULL;
+	priv->cache_log_len = 0;
+	priv->cache_regs = 0;
+}
+#else
+static inline bool pmic_cache_read(struct udevice *dev, uint reg,
+				   uint8_t *buffer, int len)
+{
+	return false;
+}
+
+static inline int pmic_cache_prepare(struct udevice *dev, uint reg, int len)
+{
+	return 0;
+}
+
+static inline void pmic_cache_fill(struct udevice *dev, uint reg,
+				   uint8_t *buffer, int len)
+{
+}
+
+static inline int pmic_cache_write(struct udevice *dev, uint reg,
+				   const uint8_t *buffer, int len)
+{
+	return 1;
+}
+
+static inline void pmic_cache_written(struct udevice *dev, uint reg,
+				      const uint8_t *buffer, int len)
+{
+}
+
+static inline int pmic_cache_init(struct udevice *dev)
+{
+	return 0;
+}
+
+static inline void pmic_cache_free(struct udevice *dev)
+{
+}
+#endif
+
 int pmic_read(struct udevice *dev, uint reg, uint8_t *buffer, int len)
 {
 	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	int ret;
 
 	if (!buffer)
 		return -EFAULT;
@@ -115,12 +418,23 @@ int pmic_read(struct udevice *dev, uint reg, uint8_t *buffer, int len)
 	if (!ops || !ops->read)
 		return -ENOSYS;
 
-	return ops->read(dev, reg, buffer, len);
+	if (pmic_cache_read(dev, reg, buffer, len))
+		return 0;
+
+	ret = pmic_cache_prepare(dev, reg, len);
+	if (ret)
+		return ret;
+	ret = ops->read(dev, reg, buffer, len);
+	if (!ret)
+		pmic_cache_fill(dev, reg, buffer, len);
+
+	return ret;
 }
 
 int pmic_write(struct udevice *dev, uint reg, const uint8_t *buffer, int len)
 {
 	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	int ret;
 
 	if (!buffer)
 		return -EFAULT;
@@ -128,7 +442,18 @@ int pmic_write(struct udevice *dev, uint reg, const uint8_t *buffer, int len)
 	if (!ops || !ops->write)
 		return -ENOSYS;
 
-	return ops->write(dev, reg, buffer, len);
+	ret = pmic_cache_write(dev, reg, buffer, len);
+	if (ret <= 0)
+		return ret;
+
+	ret = pmic_cache_prepare(dev, reg, len);
+	if (ret)
+		return ret;
+	ret = ops->write(dev, reg, buffer, len);
+	if (!ret)
+		pmic_cache_written(dev, reg, buffer, len);
+
+	return ret;
 }
 
 int pmic_reg_read(struct udevice *dev, uint reg)
@@ -194,9 +519,23 @@ static int pmic_pre_probe(struct udevice *dev)
 	return 0;
 }
 
+static int pmic_post_probe(struct udevice *dev)
+{
+	return pmic_cache_init(dev);
+}
+
+static int pmic_pre_remove(struct udevice *dev)
+{
+	pmic_cache_free(dev);
+
+	return 0;
+}
+
 UCLASS_DRIVER(pmic) = {
 	.id		= UCLASS_PMIC,
 	.name		= "pmic",
 	.pre_probe	= pmic_pre_probe,
+	.post_probe	= pmic_post_probe,
+	.pre_remove	= pmic_pre_remove,
 	.per_device_auto	= sizeof(struct uc_pmic_priv),
 };
@@ -280,7 +280,7 @@ int device_get_supply_regulator(struct udevice *dev, const char *supply_name,
 					    supply_name, devp);
 }
 
-int regulator_autoset(struct udevice *dev)
+static int regulator_do_autoset(struct udevice *dev)
 {
 	struct dm_regulator_uclass_plat *uc_pdata;
 	int ret = 0;
@@ -313,6 +313,31 @@ int regulator_autoset(struct udevice *dev)
 	return ret;
 }
 
+int regulator_autoset(struct udevice *dev)
+{
+	struct dm_regulator_uclass_plat *uc_pdata;
+	struct udevice *pmic = dev_get_parent(dev);
+	int ret, sync_ret;
+
+	/*
+	 * Collect the register updates of the PMIC holding the regulator, so
+	 * that writes to consecutive registers share a bus transfer. They
+	 * still reach the PMIC in program order, e.g. the voltage before the
+	 * enable. A ramp delay must follow the write it waits for, so such
+	 * regulators are set up directly.
+	 */
+	uc_pdata = dev_get_uclass_plat(dev);
+	if (uc_pdata->ramp_delay || !pmic ||
+	    device_get_uclass_id(pmic) != UCLASS_PMIC ||
+	    pmic_cache_defer(pmic))
+		return regulator_do_autoset(dev);
+
+	ret = regulator_do_autoset(dev);
+	sync_ret = pmic_cache_sync(pmic);
+
+	return ret ? ret : sync_ret;
+}
+
 int regulator_unset(struct udevice *dev)
 {
 	struct dm_regulator_uclass_plat *uc_pdata;
@@ -190,6 +190,13 @@ static int handle_getstatus(struct usb_request *req)
 	switch (f_dfu->dfu_state) {
 	case DFU_STATE_dfuDNLOAD_SYNC:
 	case DFU_STATE_dfuDNBUSY:
+		/* busy until a buffer written in the background is done */
+		if (dfu_get_pending_write() == dfu) {
+			f_dfu->dfu_state = DFU_STATE_dfuDNBUSY;
+			dfu_set_poll_timeout(dstat,
+					     dfu_get_pending_write_ms(dfu));
+			break;
+		}
 		f_dfu->dfu_state = DFU_STATE_dfuDNLOAD_IDLE;
 		break;
 	case DFU_STATE_dfuMANIFEST_SYNC:
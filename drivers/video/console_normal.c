@@ -13,43 +13,39 @@
 #include <video_console.h>
 #include <video_font.h>		/* Get font data, width and height */
 
+/**
+ * struct console_normal_priv - Private data for the normal console
+ *
+ * Each glyph row is written with 64-bit stores taken from a table of pixel
+ * patterns. For 16bpp an entry holds four pixels (indexed by a nibble of the
+ * glyph row), for 32bpp two pixels (indexed by two bits).
+ *
+ * @colour_fg:	Foreground colour the table was built for
+ * @colour_bg:	Background colour the table was built for
+ * @bpix:	Pixel depth the table was built for, -1 if not built yet
+ * @pattern:	Pixel patterns
+ */
+struct console_normal_priv {
+	u32 colour_fg;
+	u32 colour_bg;
+	int bpix;
+	u64 pattern[16];
+};
+
 static int console_normal_set_row(struct udevice *dev, uint row, int clr)
 {
 	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
 	void *line, *end;
 	int pixels = VIDEO_FONT_HEIGHT * vid_priv->xsize;
 	int ret;
-	int i;
 
 	line = vid_priv->fb + row * VIDEO_FONT_HEIGHT * vid_priv->line_length;
 	switch (vid_priv->bpix) {
 	case VIDEO_BPP8:
-		if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-			uint8_t *dst = line;
-
-			for (i = 0; i < pixels; i++)
-				*dst++ = clr;
-			end = dst;
-			break;
-		}
 	case VIDEO_BPP16:
-		if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-			uint16_t *dst = line;
-
-			for (i = 0; i < pixels; i++)
-				*dst++ = clr;
-			end = dst;
-			break;
-		}
 	case VIDEO_BPP32:
-		if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-			uint32_t *dst = line;
-
-			for (i = 0; i < pixels; i++)
-				*dst++ = clr;
-			end = dst;
-			break;
-		}
+		end = video_fill_pixels(line, vid_priv->bpix, clr, pixels);
+		break;
 	default:
 		return -ENOSYS;
 	}
@@ -60,6 +56,13 @@ static int console_normal_set_row(struct udevice *dev, uint row, int clr)
 	return 0;
 }
 
+/*
+ * Scrolling moves the rows within the frame buffer. Treating it as a ring
+ * buffer would need the display to scan out from a moving offset, which no
+ * video driver supports, and the frame buffer is also handed to EFI
+ * applications as a linear buffer. CONFIG_CONSOLE_SCROLL_LINES can be raised
+ * to scroll less often.
+ */
 static int console_normal_move_rows(struct udevice *dev, uint rowdst,
 				     uint rowsrc, uint count)
 {
@@ -79,6 +82,100 @@ static int console_normal_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/**
+ * console_normal_get_patterns() - Get the pixel patterns for drawing glyphs
+ *
+ * The table is rebuilt if the colours or the pixel depth have changed.
+ *
+ * @dev:	Console device
+ * Return: table of pixel patterns, NULL if the pixel depth is not supported
+ */
+static const u64 *console_normal_get_patterns(struct udevice *dev)
+{
+	struct console_normal_priv *priv = dev_get_priv(dev);
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	union {
+		u64 word;
+		u16 pix16[4];
+		u32 pix32[2];
+	} pat;
+	int i, bit;
+
+	if (priv->bpix == vid_priv->bpix &&
+	    priv->colour_fg == vid_priv->colour_fg &&
+	    priv->colour_bg == vid_priv->colour_bg)
+		return priv->pattern;
+
+	switch (vid_priv->bpix) {
+	case VIDEO_BPP16:
+		if (!IS_ENABLED(CONFIG_VIDEO_BPP16))
+			return NULL;
+		for (i = 0; i < 16; i++) {
+			for (bit = 0; bit < 4; bit++)
+				pat.pix16[bit] = (i & (8 >> bit)) ?
+					vid_priv->colour_fg :
+					vid_priv->colour_bg;
+			priv->pattern[i] = pat.word;
+		}
+		break;
+	case VIDEO_BPP32:
+		if (!IS_ENABLED(CONFIG_VIDEO_BPP32))
+			return NULL;
+		for (i = 0; i < 4; i++) {
+			for (bit = 0; bit < 2; bit++)
+				pat.pix32[bit] = (i & (2 >> bit)) ?
+					vid_priv->colour_fg :
+					vid_priv->colour_bg;
+			priv->pattern[i] = pat.word;
+		}
+		break;
+	default:
+		return NULL;
+	}
+	priv->bpix = vid_priv->bpix;
+	priv->colour_fg = vid_priv->colour_fg;
+	priv->colour_bg = vid_priv->colour_bg;
+
+	return priv->pattern;
+}
+
+/**
+ * console_normal_putc_fast() - Draw a character using 64-bit stores
+ *
+ * @dev:	Console device
+ * @line:	Frame-buffer address of the top-left pixel, 8-byte aligned
+ * @ch:		Character to draw
+ * Return: 0 if OK, -ENOSYS if the pixel depth is not supported
+ */
+static int console_normal_putc_fast(struct udevice *dev, void *line, char ch)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	const u64 *pattern = console_normal_get_patterns(dev);
+	int row;
+
+	if (!pattern)
+		return -ENOSYS;
+
+	for (row = 0; row < VIDEO_FONT_HEIGHT; row++) {
+		unsigned int idx = (u8)ch * VIDEO_FONT_HEIGHT + row;
+		uchar bits = video_fontdata[idx];
+		u64 *dst = line;
+
+		if (vid_priv->bpix == VIDEO_BPP16) {
+			dst[0] = pattern[bits >> 4];
+			dst[1] = pattern[bits & 0xf];
+		} else {
+			dst[0] = pattern[bits >> 6];
+			dst[1] = pattern[(bits >> 4) & 3];
+			dst[2] = pattern[(bits >> 2) & 3];
+			dst[3] = pattern[bits & 3];
+		}
+		line += vid_priv->line_length;
+	}
+
+	return 0;
+}
+
 static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 				  char ch)
 {
@@ -97,6 +194,13 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 	if (x_frac + VID_TO_POS(vc_priv->x_charsize) > vc_priv->xsize_frac)
 		return -EAGAIN;
 
+	if (VIDEO_FONT_WIDTH == 8 && !((ulong)start & 7) &&
+	    !(vid_priv->line_length & 7) &&
+	    !console_normal_putc_fast(dev, start, ch)) {
+		line = start + VIDEO_FONT_HEIGHT * vid_priv->line_length;
+		goto done;
+	}
+
 	for (row = 0; row < VIDEO_FONT_HEIGHT; row++) {
 		unsigned int idx = (u8)ch * VIDEO_FONT_HEIGHT + row;
 		uchar bits = video_fontdata[idx];
@@ -143,9 +247,16 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 		}
 		line += vid_priv->line_length;
 	}
-	ret = vidconsole_sync_copy(dev, start, line);
-	if (ret)
-		return ret;
+done:
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		/* Only the glyph itself needs to be synced */
+		video_damage(vid, VID_TO_PIXEL(x_frac), y, VIDEO_FONT_WIDTH,
+			     VIDEO_FONT_HEIGHT);
+	} else {
+		ret = vidconsole_sync_copy(dev, start, line);
+		if (ret)
+			return ret;
+	}
 
 	return VID_TO_POS(VIDEO_FONT_WIDTH);
 }
@@ -153,9 +264,11 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 static int console_normal_probe(struct udevice *dev)
 {
 	struct vidconsole_priv *vc_priv = dev_get_uclass_priv(dev);
+	struct console_normal_priv *priv = dev_get_priv(dev);
 	struct udevice *vid_dev = dev->parent;
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid_dev);
 
+	priv->bpix = -1;
 	vc_priv->x_charsize = VIDEO_FONT_WIDTH;
 	vc_priv->y_charsize = VIDEO_FONT_HEIGHT;
 	vc_priv->cols = vid_priv->xsize / VIDEO_FONT_WIDTH;
@@ -175,4 +288,5 @@ U_BOOT_DRIVER(vidconsole_normal) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_normal_ops,
 	.probe	= console_normal_probe,
+	.priv_auto	= sizeof(struct console_normal_priv),
 };
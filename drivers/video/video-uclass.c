@@ -114,34 +114,67 @@ int video_reserve(ulong *addrp)
 	return 0;
 }
 
-int video_clear(struct udevice *dev)
+void *video_fill_pixels(void *dst, enum video_log2_bpp bpix, u32 colour,
+			int count)
 {
-	struct video_priv *priv = dev_get_uclass_priv(dev);
-	int ret;
+	u64 *dst64, pattern;
+	int per_word;
 
-	switch (priv->bpix) {
+	switch (bpix) {
 	case VIDEO_BPP16:
 		if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-			u16 *ppix = priv->fb;
-			u16 *end = priv->fb + priv->fb_size;
+			u16 *ppix = dst;
 
-			while (ppix < end)
-				*ppix++ = priv->colour_bg;
+			per_word = 4;
+			pattern = (u16)colour * 0x0001000100010001ULL;
+			for (; count && ((ulong)ppix & 7); count--)
+				*ppix++ = colour;
+			dst = ppix;
 			break;
 		}
 	case VIDEO_BPP32:
 		if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-			u32 *ppix = priv->fb;
-			u32 *end = priv->fb + priv->fb_size;
+			u32 *ppix = dst;
 
-			while (ppix < end)
-				*ppix++ = priv->colour_bg;
+			per_word = 2;
+			pattern = (u64)colour << 32 | colour;
+			for (; count && ((ulong)ppix & 7); count--)
+				*ppix++ = colour;
+			dst = ppix;
 			break;
 		}
 	default:
-		memset(priv->fb, priv->colour_bg, priv->fb_size);
-		break;
+		count = count * VNBITS(bpix) / 8;
+		memset(dst, colour, count);
+		return dst + count;
 	}
+
+	/* Write aligned 64-bit words, then the remaining pixels */
+	for (dst64 = dst; count >= per_word; count -= per_word)
+		*dst64++ = pattern;
+	dst = dst64;
+	if (per_word == 4) {
+		u16 *ppix = dst;
+
+		while (count--)
+			*ppix++ = colour;
+		return ppix;
+	} else {
+		u32 *ppix = dst;
+
+		while (count--)
+			*ppix++ = colour;
+		return ppix;
+	}
+}
+
+int video_clear(struct udevice *dev)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	int ret;
+
+	video_fill_pixels(priv->fb, priv->bpix, priv->colour_bg,
+			  priv->fb_size * 8 / VNBITS(priv->bpix));
 	ret = video_sync_copy(dev, priv->fb, priv->fb + priv->fb_size);
 	if (ret)
 		return ret;
@@ -175,12 +208,72 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = vid_console_color(priv, back);
 }
 
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_damage *damage = &priv->damage;
+	int xend = min_t(int, x + width, priv->xsize);
+	int yend = min_t(int, y + height, priv->ysize);
+
+	x = max(x, 0);
+	y = max(y, 0);
+	if (x >= xend || y >= yend)
+		return;
+
+	if (damage->yend <= damage->ystart) {
+		damage->xstart = x;
+		damage->ystart = y;
+		damage->xend = xend;
+		damage->yend = yend;
+	} else {
+		damage->xstart = min(damage->xstart, x);
+		damage->ystart = min(damage->ystart, y);
+		damage->xend = max(damage->xend, xend);
+		damage->yend = max(damage->yend, yend);
+	}
+}
+#endif
+
+/**
+ * video_damage_copy() - Update the damaged region of the copy frame buffer
+ *
+ * @priv:	Video device's uclass-private data
+ */
+static void video_damage_copy(struct video_priv *priv)
+{
+	struct video_damage *damage = &priv->damage;
+	long offset, size;
+	int y;
+
+	if (!priv->copy_fb || damage->yend <= damage->ystart)
+		return;
+
+	offset = damage->ystart * priv->line_length +
+		 damage->xstart * VNBYTES(priv->bpix);
+	size = (damage->xend - damage->xstart) * VNBYTES(priv->bpix);
+	if (size == priv->line_length) {
+		/* Whole lines are contiguous so copy them at once */
+		memcpy(priv->copy_fb + offset, priv->fb + offset,
+		       size * (damage->yend - damage->ystart));
+		return;
+	}
+	for (y = damage->ystart; y < damage->yend; y++) {
+		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
+		offset += priv->line_length;
+	}
+}
+
 /* Flush video activity to the caches */
 int video_sync(struct udevice *vid, bool force)
 {
 	struct video_ops *ops = video_get_ops(vid);
+	struct video_priv *priv = dev_get_uclass_priv(vid);
 	int ret;
 
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		video_damage_copy(priv);
+
 	if (ops && ops->video_sync) {
 		ret = ops->video_sync(vid);
 		if (ret)
@@ -193,15 +286,21 @@ int video_sync(struct udevice *vid, bool force)
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-
 	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
+		ulong start = (ulong)priv->fb;
+		ulong end = start + priv->fb_size;
+
+		/* Unless forced, only flush the lines that were changed */
+		if (IS_ENABLED(CONFIG_VIDEO_DAMAGE) && !force) {
+			end = start + priv->damage.yend * priv->line_length;
+			start += priv->damage.ystart * priv->line_length;
+		}
+		if (end > start)
+			flush_dcache_range(ALIGN_DOWN(start,
+						      CONFIG_SYS_CACHELINE_SIZE),
+					   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
 	}
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
 	if (force || get_timer(last_sync) > 10) {
@@ -209,6 +308,8 @@ int video_sync(struct udevice *vid, bool force)
 		last_sync = get_timer(0);
 	}
 #endif
+	memset(&priv->damage, '\0', sizeof(priv->damage));
+
 	return 0;
 }
 
@@ -256,12 +357,23 @@ int video_get_ysize(struct udevice *dev)
 	return priv->ysize;
 }
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
-	if (priv->copy_fb) {
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		long start, end;
+
+		/* Mark the affected lines, the next video_sync() copies them */
+		start = min(from, to) - priv->fb;
+		end = max(from, to) - priv->fb;
+		if (end < -priv->fb_size || start > 2 * priv->fb_size)
+			return -EFAULT;
+		start = max(start, 0L) / priv->line_length;
+		end = DIV_ROUND_UP(max(end, 0L), priv->line_length);
+		video_damage(dev, 0, start, priv->xsize, end - start);
+	} else if (priv->copy_fb) {
 		long offset, size;
 
 		/* Find the offset of the first byte to copy */
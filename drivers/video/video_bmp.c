@@ -196,8 +196,8 @@ static void video_display_rle8_bitmap(struct udevice *dev,
  * @panel_size:	Size of panel in pixels for that axis
  * @picture_size:	Size of bitmap in pixels for that axis
  */
-static void video_splash_align_axis(int *axis, unsigned long panel_size,
-				    unsigned long picture_size)
+void video_splash_align_axis(int *axis, unsigned long panel_size,
+			     unsigned long picture_size)
 {
 	long panel_picture_delta = panel_size - picture_size;
 	long axis_alignment;
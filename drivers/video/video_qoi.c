@@ -0,0 +1,249 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decoder for images in the Quite OK Image format (QOI)
+ *
+ * The image is decoded in a single pass, row by row, straight into the frame
+ * buffer in its native pixel format. No intermediate buffer is needed.
+ *
+ * See https://qoiformat.org/qoi-specification.pdf for the format.
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <log.h>
+#include <mapmem.h>
+#include <splash.h>
+#include <video.h>
+#include <watchdog.h>
+#include <asm/byteorder.h>
+
+#define QOI_MAGIC		"qoif"
+#define QOI_END_SIZE		8
+
+#define QOI_OP_INDEX		0x00	/* 00xxxxxx */
+#define QOI_OP_DIFF		0x40	/* 01xxxxxx */
+#define QOI_OP_LUMA		0x80	/* 10xxxxxx */
+#define QOI_OP_RUN		0xc0	/* 11xxxxxx */
+#define QOI_OP_RGB		0xfe	/* 11111110 */
+#define QOI_OP_RGBA		0xff	/* 11111111 */
+#define QOI_MASK_2		0xc0
+
+/**
+ * struct qoi_header - Header of a QOI image
+ *
+ * @magic:	Magic bytes "qoif"
+ * @width:	Image width in pixels (big endian)
+ * @height:	Image height in pixels (big endian)
+ * @channels:	3 = RGB, 4 = RGBA
+ * @colorspace:	0 = sRGB with linear alpha, 1 = all channels linear
+ */
+struct qoi_header {
+	char magic[4];
+	__be32 width;
+	__be32 height;
+	u8 channels;
+	u8 colorspace;
+} __packed;
+
+/**
+ * struct qoi_rgba - Decoded pixel
+ */
+struct qoi_rgba {
+	u8 r, g, b, a;
+};
+
+/**
+ * struct qoi_state - State of the decoder
+ *
+ * @data:	Next byte of the data stream
+ * @px:		Previous pixel
+ * @run:	Number of remaining repetitions of @px
+ * @index:	Array of previously seen pixels
+ */
+struct qoi_state {
+	const u8 *data;
+	struct qoi_rgba px;
+	int run;
+	struct qoi_rgba index[64];
+};
+
+static inline uint qoi_hash(struct qoi_rgba px)
+{
+	return (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+}
+
+/**
+ * qoi_next() - Decode the next pixel
+ *
+ * @st:		Decoder state
+ * Return: next pixel of the image
+ */
+static inline struct qoi_rgba qoi_next(struct qoi_state *st)
+{
+	const u8 *data = st->data;
+	struct qoi_rgba px = st->px;
+	u8 op;
+
+	if (st->run) {
+		st->run--;
+		return px;
+	}
+
+	op = *data++;
+	if (op == QOI_OP_RGB) {
+		px.r = *data++;
+		px.g = *data++;
+		px.b = *data++;
+	} else if (op == QOI_OP_RGBA) {
+		px.r = *data++;
+		px.g = *data++;
+		px.b = *data++;
+		px.a = *data++;
+	} else {
+		switch (op & QOI_MASK_2) {
+		case QOI_OP_INDEX:
+			px = st->index[op];
+			break;
+		case QOI_OP_DIFF:
+			px.r += ((op >> 4) & 3) - 2;
+			px.g += ((op >> 2) & 3) - 2;
+			px.b += (op & 3) - 2;
+			break;
+		case QOI_OP_LUMA: {
+			int dg = (op & 0x3f) - 32;
+			u8 drb = *data++;
+
+			px.r += dg - 8 + (drb >> 4);
+			px.g += dg;
+			px.b += dg - 8 + (drb & 0xf);
+			break;
+		}
+		case QOI_OP_RUN:
+			st->run = op & 0x3f;
+			break;
+		}
+	}
+	st->index[qoi_hash(px)] = px;
+	st->px = px;
+	st->data = data;
+
+	return px;
+}
+
+static bool qoi_check_header(const struct qoi_header *hdr)
+{
+	return !memcmp(hdr->magic, QOI_MAGIC, sizeof(hdr->magic)) &&
+	       (hdr->channels == 3 || hdr->channels == 4);
+}
+
+bool video_qoi_is_image(const void *data)
+{
+	return qoi_check_header(data);
+}
+
+long video_qoi_get_size(const void *data, ulong avail)
+{
+	const struct qoi_header *hdr = data;
+	const u8 *img = data;
+	ulong pos = sizeof(*hdr);
+	u64 pixels;
+	u8 op;
+
+	if (avail < sizeof(*hdr))
+		return -EAGAIN;
+	if (!qoi_check_header(hdr))
+		return -EINVAL;
+
+	pixels = (u64)be32_to_cpu(hdr->width) * be32_to_cpu(hdr->height);
+	while (pixels) {
+		if (pos >= avail)
+			return -EAGAIN;
+		op = img[pos];
+		if (op == QOI_OP_RGB) {
+			pos += 4;
+		} else if (op == QOI_OP_RGBA) {
+			pos += 5;
+		} else if ((op & QOI_MASK_2) == QOI_OP_LUMA) {
+			pos += 2;
+		} else if ((op & QOI_MASK_2) == QOI_OP_RUN) {
+			pos++;
+			pixels -= min_t(u64, pixels, (op & 0x3f) + 1);
+			continue;
+		} else {
+			pos++;
+		}
+		pixels--;
+	}
+	pos += QOI_END_SIZE;
+	if (pos > avail)
+		return -EAGAIN;
+
+	return pos;
+}
+
+int video_qoi_display(struct udevice *dev, ulong qoi_image, int x, int y,
+		      bool align)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	const struct qoi_header *hdr = map_sysmem(qoi_image, 0);
+	ulong width, height, vis_width, vis_height;
+	struct qoi_state st;
+	uchar *start, *line;
+	struct qoi_rgba px;
+	int row, col;
+	int ret;
+
+	if (!qoi_check_header(hdr)) {
+		printf("Error: no valid QOI image at %lx\n", qoi_image);
+		return -EINVAL;
+	}
+	if (priv->bpix != VIDEO_BPP16 && priv->bpix != VIDEO_BPP32) {
+		printf("Error: %d bit/pixel mode not supported for QOI\n",
+		       VNBITS(priv->bpix));
+		return -EPERM;
+	}
+
+	width = be32_to_cpu(hdr->width);
+	height = be32_to_cpu(hdr->height);
+	if (align) {
+		video_splash_align_axis(&x, priv->xsize, width);
+		video_splash_align_axis(&y, priv->ysize, height);
+	}
+	if (x < 0 || y < 0 || x >= priv->xsize || y >= priv->ysize)
+		return -EINVAL;
+	vis_width = min_t(ulong, width, priv->xsize - x);
+	vis_height = min_t(ulong, height, priv->ysize - y);
+
+	memset(&st, '\0', sizeof(st));
+	st.data = (const u8 *)(hdr + 1);
+	st.px.a = 0xff;
+
+	start = priv->fb + y * priv->line_length + x * VNBYTES(priv->bpix);
+	line = start;
+	for (row = 0; row < vis_height; row++) {
+		u16 *fb16 = (u16 *)line;
+		u32 *fb32 = (u32 *)line;
+
+		WATCHDOG_RESET();
+		for (col = 0; col < width; col++) {
+			px = qoi_next(&st);
+			if (col >= vis_width)
+				continue;
+			if (priv->bpix == VIDEO_BPP16)
+				fb16[col] = (px.r >> 3) << 11 |
+					    (px.g >> 2) << 5 | px.b >> 3;
+			else if (priv->format == VIDEO_X2R10G10B10)
+				fb32[col] = px.r << 22 | px.g << 12 |
+					    px.b << 2;
+			else
+				fb32[col] = px.r << 16 | px.g << 8 | px.b;
+		}
+		line += priv->line_length;
+	}
+
+	ret = video_sync_copy(dev, start, line);
+	if (ret)
+		return log_ret(ret);
+
+	return video_sync(dev, false);
+}
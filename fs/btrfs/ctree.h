@@ -95,6 +95,16 @@ struct btrfs_root {
 	struct rb_node rb_node;
 };
 
+/* Decompressed extents kept for the duration of one filesystem command */
+#define BTRFS_DECOMPRESS_CACHE_SIZE	4
+
+struct btrfs_decompress_cache {
+	/* logical address of the compressed extent, 0 if the slot is free */
+	u64 disk_bytenr;
+	u64 last_used;
+	char *data;
+};
+
 struct btrfs_trans_handle;
 struct btrfs_device;
 struct btrfs_fs_devices;
@@ -123,6 +133,9 @@ struct btrfs_fs_info {
 	u32 nodesize;
 	u32 sectorsize;
 	u32 stripesize;
+
+	struct btrfs_decompress_cache dcache[BTRFS_DECOMPRESS_CACHE_SIZE];
+	u64 dcache_clock;
 };
 
 static inline u32 BTRFS_MAX_ITEM_SIZE(const struct btrfs_fs_info *info)
@@ -899,8 +899,15 @@ FREE_EXTENT_CACHE_BASED_TREE(mapping_cache, free_map_lookup);
 
 void btrfs_cleanup_all_caches(struct btrfs_fs_info *fs_info)
 {
+	int i;
+
 	free_mapping_cache_tree(&fs_info->mapping_tree.cache_tree);
 	extent_io_tree_cleanup(&fs_info->extent_cache);
+	for (i = 0; i < BTRFS_DECOMPRESS_CACHE_SIZE; i++) {
+		free(fs_info->dcache[i].data);
+		fs_info->dcache[i].data = NULL;
+		fs_info->dcache[i].disk_bytenr = 0;
+	}
 }
 
 static int btrfs_scan_fs_devices(struct blk_desc *desc,
@@ -408,12 +408,131 @@ out:
 	return ret;
 }
 
+/*
+ * Read @len bytes at logical address @logical into @dest.
+ *
+ * The range may span several stripes, each of which is read with a single
+ * device read, falling back to the other copies if that fails.
+ */
+static int read_data_range(struct btrfs_fs_info *fs_info, char *dest,
+			   u64 logical, u64 len)
+{
+	u64 read;
+	int num_copies;
+	int ret = 0;
+	int i;
+
+	while (len) {
+		num_copies = btrfs_num_copies(fs_info, logical, len);
+		for (i = 1; i <= num_copies; i++) {
+			read = min_t(u64, len, SZ_1G);
+			ret = read_extent_data(fs_info, dest, logical, &read,
+					       i);
+			if (ret >= 0 && read)
+				break;
+		}
+		if (i > num_copies)
+			return -EIO;
+		dest += read;
+		logical += read;
+		len -= read;
+	}
+	return 0;
+}
+
+/*
+ * Read and decompress the whole compressed extent of @fi into @dest, which
+ * must have room for its ram_bytes.
+ */
+static int read_compressed_extent(struct extent_buffer *leaf,
+				  struct btrfs_file_extent_item *fi,
+				  char *dest)
+{
+	u32 csize = btrfs_file_extent_disk_num_bytes(leaf, fi);
+	u32 dsize = btrfs_file_extent_ram_bytes(leaf, fi);
+	char *cbuf;
+	u32 ret;
+
+	cbuf = malloc_cache_aligned(csize);
+	if (!cbuf)
+		return -ENOMEM;
+	/* For compressed extent, we must read the whole on-disk extent */
+	if (read_data_range(leaf->fs_info, cbuf,
+			    btrfs_file_extent_disk_bytenr(leaf, fi), csize)) {
+		free(cbuf);
+		return -EIO;
+	}
+
+	ret = btrfs_decompress(btrfs_file_extent_compression(leaf, fi), cbuf,
+			       csize, dest, dsize);
+	free(cbuf);
+	if (ret == (u32)-1)
+		return -EIO;
+	/*
+	 * The compressed part ends before sector boundary, the remaining needs
+	 * to be zeroed out.
+	 */
+	if (ret < dsize)
+		memset(dest + ret, 0, dsize - ret);
+	return 0;
+}
+
+/*
+ * Get the decompressed data of the compressed extent of @fi, from the cache
+ * of recently used extents if possible.
+ *
+ * The cache is freed by close_ctree_fs_info(), which runs at the end of every
+ * filesystem command, so it only saves work within one btrfs_file_read(): when
+ * several file extents refer to parts of the same compressed extent, as left
+ * by a partial overwrite or a clone, it is decompressed only once.
+ *
+ * The returned buffer belongs to the cache and is only valid until the next
+ * call.
+ */
+static char *get_decompressed_extent(struct extent_buffer *leaf,
+				     struct btrfs_file_extent_item *fi)
+{
+	struct btrfs_fs_info *fs_info = leaf->fs_info;
+	u64 disk_bytenr = btrfs_file_extent_disk_bytenr(leaf, fi);
+	struct btrfs_decompress_cache *entry = &fs_info->dcache[0];
+	int ret;
+	int i;
+
+	for (i = 0; i < BTRFS_DECOMPRESS_CACHE_SIZE; i++) {
+		if (fs_info->dcache[i].disk_bytenr == disk_bytenr) {
+			entry = &fs_info->dcache[i];
+			entry->last_used = ++fs_info->dcache_clock;
+			return entry->data;
+		}
+		if (fs_info->dcache[i].last_used < entry->last_used)
+			entry = &fs_info->dcache[i];
+	}
+
+	/* Replace the least recently used entry */
+	free(entry->data);
+	entry->disk_bytenr = 0;
+	entry->data = malloc(btrfs_file_extent_ram_bytes(leaf, fi));
+	if (!entry->data)
+		return ERR_PTR(-ENOMEM);
+	ret = read_compressed_extent(leaf, fi, entry->data);
+	if (ret < 0) {
+		free(entry->data);
+		entry->data = NULL;
+		return ERR_PTR(ret);
+	}
+	entry->disk_bytenr = disk_bytenr;
+	entry->last_used = ++fs_info->dcache_clock;
+	return entry->data;
+}
+
 /*
  * Read out regular extent.
  *
  * Truncating should be handled by the caller.
  *
- * @offset and @len should not cross the extent boundary.
+ * @offset and @len should not cross the extent boundary, but need not be
+ * sector aligned. A compressed extent which is read as a whole is
+ * decompressed straight into @dest.
  * Return the number of bytes read.
  * Return <0 for error.
  */
@@ -425,22 +544,13 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	struct btrfs_fs_info *fs_info = leaf->fs_info;
 	struct btrfs_key key;
 	u64 extent_num_bytes;
-	u64 disk_bytenr;
-	u64 read;
-	char *cbuf = NULL;
-	char *dbuf = NULL;
-	u32 csize;
-	u32 dsize;
-	bool finished = false;
-	int num_copies;
-	int i;
+	u64 ram_offset;
+	char *dbuf;
 	int slot = path->slots[0];
 	int ret;
 
 	btrfs_item_key_to_cpu(leaf, &key, slot);
 	extent_num_bytes = btrfs_file_extent_num_bytes(leaf, fi);
-	ASSERT(IS_ALIGNED(offset, fs_info->sectorsize) &&
-	       IS_ALIGNED(len, fs_info->sectorsize));
 	ASSERT(offset >= key.offset &&
 	       offset + len <= key.offset + extent_num_bytes);
 
@@ -451,72 +561,32 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 		return len;
 	}
 
+	ram_offset = btrfs_file_extent_offset(leaf, fi) + offset - key.offset;
 	if (btrfs_file_extent_compression(leaf, fi) == BTRFS_COMPRESS_NONE) {
-		u64 logical;
-
-		logical = btrfs_file_extent_disk_bytenr(leaf, fi) +
-			  btrfs_file_extent_offset(leaf, fi) +
-			  offset - key.offset;
-		read = len;
-
-		num_copies = btrfs_num_copies(fs_info, logical, len);
-		for (i = 1; i <= num_copies; i++) {
-			ret = read_extent_data(fs_info, dest, logical, &read, i);
-			if (ret < 0 || read != len)
-				continue;
-			finished = true;
-			break;
-		}
-		if (!finished)
-			return -EIO;
+		ret = read_data_range(fs_info, dest,
+				btrfs_file_extent_disk_bytenr(leaf, fi) +
+				ram_offset, len);
+		if (ret < 0)
+			return ret;
 		return len;
 	}
 
-	csize = btrfs_file_extent_disk_num_bytes(leaf, fi);
-	dsize = btrfs_file_extent_ram_bytes(leaf, fi);
-	disk_bytenr = btrfs_file_extent_disk_bytenr(leaf, fi);
-	num_copies = btrfs_num_copies(fs_info, disk_bytenr, csize);
+	if (ram_offset + len > btrfs_file_extent_ram_bytes(leaf, fi))
+		return -EUCLEAN;
 
-	cbuf = malloc_cache_aligned(csize);
-	dbuf = malloc_cache_aligned(dsize);
-	if (!cbuf || !dbuf) {
-		ret = -ENOMEM;
-		goto out;
-	}
-	/* For compressed extent, we must read the whole on-disk extent */
-	for (i = 1; i <= num_copies; i++) {
-		read = csize;
-		ret = read_extent_data(fs_info, cbuf, disk_bytenr,
-				       &read, i);
-		if (ret < 0 || read != csize)
-			continue;
-		finished = true;
-		break;
-	}
-	if (!finished) {
-		ret = -EIO;
-		goto out;
+	/* The whole decompressed extent is wanted, skip the copy */
+	if (!ram_offset && len == btrfs_file_extent_ram_bytes(leaf, fi)) {
+		ret = read_compressed_extent(leaf, fi, dest);
+		if (ret < 0)
+			return ret;
+		return len;
 	}
 
-	ret = btrfs_decompress(btrfs_file_extent_compression(leaf, fi), cbuf,
-			       csize, dbuf, dsize);
-	if (ret == (u32)-1) {
-		ret = -EIO;
-		goto out;
-	}
-	/*
-	 * The compressed part ends before sector boundary, the remaining needs
-	 * to be zeroed out.
-	 */
-	if (ret < dsize)
-		memset(dbuf + ret, 0, dsize - ret);
-	/* Then copy the needed part */
-	memcpy(dest, dbuf + btrfs_file_extent_offset(leaf, fi), len);
-	ret = len;
-out:
-	free(cbuf);
-	free(dbuf);
-	return ret;
+	dbuf = get_decompressed_extent(leaf, fi);
+	if (IS_ERR(dbuf))
+		return PTR_ERR(dbuf);
+	memcpy(dest, dbuf + ram_offset, len);
+	return len;
 }
 
 /*
@@ -620,55 +690,77 @@ check_next:
 	return 1;
 }
 
-static int read_and_truncate_page(struct btrfs_path *path,
-				  struct btrfs_file_extent_item *fi,
-				  int start, int len, char *dest)
+/*
+ * A pending read of uncompressed data, which grows as long as the following
+ * extents are contiguous both on disk and in the file.
+ */
+struct read_run {
+	u64 logical;
+	u64 len;
+	char *dest;
+};
+
+static int flush_read_run(struct btrfs_fs_info *fs_info, struct read_run *run)
+{
+	int ret = 0;
+
+	if (run->len)
+		ret = read_data_range(fs_info, run->dest, run->logical,
+				      run->len);
+	run->len = 0;
+	return ret;
+}
+
+/* Copy the part of an inline extent (which always starts at 0) we want */
+static int read_inline_part(struct btrfs_path *path,
+			    struct btrfs_file_extent_item *fi,
+			    u64 file_offset, u64 len, char *dest)
 {
 	struct extent_buffer *leaf = path->nodes[0];
-	struct btrfs_fs_info *fs_info = leaf->fs_info;
-	u64 aligned_start = round_down(start, fs_info->sectorsize);
-	u8 extent_type;
+	u32 size;
 	char *buf;
-	int page_off = start - aligned_start;
-	int page_len = fs_info->sectorsize - page_off;
 	int ret;
 
-	ASSERT(start + len <= aligned_start + fs_info->sectorsize);
-	buf = malloc_cache_aligned(fs_info->sectorsize);
+	size = max_t(u32, btrfs_file_extent_ram_bytes(leaf, fi),
+		     btrfs_file_extent_inline_item_len(leaf,
+				btrfs_item_nr(path->slots[0])));
+	buf = malloc(size);
 	if (!buf)
 		return -ENOMEM;
-
-	extent_type = btrfs_file_extent_type(leaf, fi);
-	if (extent_type == BTRFS_FILE_EXTENT_INLINE) {
-		ret = btrfs_read_extent_inline(path, fi, buf);
-		memcpy(dest, buf + page_off, min(page_len, ret));
-		free(buf);
-		return len;
-	}
-
-	ret = btrfs_read_extent_reg(path, fi,
-			round_down(start, fs_info->sectorsize),
-			fs_info->sectorsize, buf);
-	if (ret < 0) {
-		free(buf);
-		return ret;
-	}
-	memcpy(dest, buf + page_off, page_len);
+	ret = btrfs_read_extent_inline(path, fi, buf);
+	if (ret > 0 && file_offset < ret)
+		memcpy(dest, buf + file_offset, min_t(u64, len,
+						       ret - file_offset));
 	free(buf);
-	return len;
+	return ret < 0 ? ret : 0;
 }
 
+/*
+ * Read @len bytes at @file_offset of inode @ino into @dest.
+ *
+ * Uncompressed extents which are physically contiguous are merged into a
+ * single read straight into @dest, whatever the alignment of the range.
+ * Compressed extents are decompressed into @dest directly when the range
+ * covers them whole, or else through a small cache, so that file extents
+ * sharing one compressed extent decompress it only once.
+ */
 int btrfs_file_read(struct btrfs_root *root, u64 ino, u64 file_offset, u64 len,
 		    char *dest)
 {
 	struct btrfs_fs_info *fs_info = root->fs_info;
 	struct btrfs_file_extent_item *fi;
+	struct extent_buffer *leaf;
 	struct btrfs_path path;
 	struct btrfs_key key;
-	u64 aligned_start = round_down(file_offset, fs_info->sectorsize);
-	u64 aligned_end = round_down(file_offset + len, fs_info->sectorsize);
+	struct read_run run = { 0 };
+	u64 end = file_offset + len;
+	u64 cur = round_down(file_offset, fs_info->sectorsize);
 	u64 next_offset;
-	u64 cur = aligned_start;
+	u64 extent_end;
+	u64 logical;
+	u64 start;
+	u64 count;
+	u8 type;
 	int ret = 0;
 
 	btrfs_init_path(&path);
@@ -676,97 +768,72 @@ int btrfs_file_read(struct btrfs_root *root, u64 ino, u64 file_offset, u64 len,
 	/* Set the whole dest all zero, so we won't need to bother holes */
 	memset(dest, 0, len);
 
-	/* Read out the leading unaligned part */
-	if (aligned_start != file_offset) {
-		ret = lookup_data_extent(root, &path, ino, aligned_start,
-					 &next_offset);
-		if (ret < 0)
-			goto out;
-		if (ret == 0) {
-			/* Read the unaligned part out*/
-			fi = btrfs_item_ptr(path.nodes[0], path.slots[0],
-					struct btrfs_file_extent_item);
-			ret = read_and_truncate_page(&path, fi, file_offset,
-					round_up(file_offset, fs_info->sectorsize) -
-					file_offset, dest);
-			if (ret < 0)
-				goto out;
-			cur += fs_info->sectorsize;
-		} else {
-			/* The whole file is a hole */
-			if (!next_offset) {
-				memset(dest, 0, len);
-				return len;
-			}
-			cur = next_offset;
-		}
-	}
-
-	/* Read the aligned part */
-	while (cur < aligned_end) {
-		u64 extent_num_bytes;
-		u8 type;
-
+	while (cur < end) {
 		btrfs_release_path(&path);
 		ret = lookup_data_extent(root, &path, ino, cur, &next_offset);
 		if (ret < 0)
 			goto out;
 		if (ret > 0) {
-			/* No next, direct exit */
-			if (!next_offset) {
+			/* No next extent, the rest is a hole */
+			if (!next_offset || next_offset <= cur) {
 				ret = 0;
-				goto out;
+				break;
 			}
 			/*
 			 * Find a extent gap, mostly caused by NO_HOLE feature.
 			 * Just to next offset directly.
 			 */
-			if (next_offset > cur) {
-				cur = next_offset;
-				continue;
-			}
+			cur = next_offset;
+			continue;
 		}
-		fi = btrfs_item_ptr(path.nodes[0], path.slots[0],
+		leaf = path.nodes[0];
+		fi = btrfs_item_ptr(leaf, path.slots[0],
 				    struct btrfs_file_extent_item);
-		btrfs_item_key_to_cpu(path.nodes[0], &key, path.slots[0]);
-		type = btrfs_file_extent_type(path.nodes[0], fi);
+		btrfs_item_key_to_cpu(leaf, &key, path.slots[0]);
+		type = btrfs_file_extent_type(leaf, fi);
 		if (type == BTRFS_FILE_EXTENT_INLINE) {
-			ret = btrfs_read_extent_inline(&path, fi, dest);
-			goto out;
+			/* Inline extent should be the only extent */
+			ret = read_inline_part(&path, fi, file_offset, len,
+					       dest);
+			break;
 		}
+
+		extent_end = key.offset + btrfs_file_extent_num_bytes(leaf, fi);
+		start = max(cur, file_offset);
+		count = min(extent_end, end) - start;
+		cur = extent_end;
+
 		/* Skip holes, as we have zeroed the dest */
 		if (type == BTRFS_FILE_EXTENT_PREALLOC ||
-		    btrfs_file_extent_disk_bytenr(path.nodes[0], fi) == 0) {
-			cur = key.offset + btrfs_file_extent_num_bytes(
-					path.nodes[0], fi);
+		    btrfs_file_extent_disk_bytenr(leaf, fi) == 0)
+			continue;
+
+		if (btrfs_file_extent_compression(leaf, fi) !=
+		    BTRFS_COMPRESS_NONE) {
+			ret = btrfs_read_extent_reg(&path, fi, start, count,
+					dest + start - file_offset);
+			if (ret < 0)
+				goto out;
 			continue;
 		}
 
-		/* Read the remaining part of the extent */
-		extent_num_bytes = btrfs_file_extent_num_bytes(path.nodes[0],
-							       fi);
-		ret = btrfs_read_extent_reg(&path, fi, cur,
-				min(extent_num_bytes, aligned_end - cur),
-				dest + cur - file_offset);
+		logical = btrfs_file_extent_disk_bytenr(leaf, fi) +
+			  btrfs_file_extent_offset(leaf, fi) +
+			  start - key.offset;
+		if (run.len && run.logical + run.len == logical &&
+		    run.dest + run.len == dest + start - file_offset) {
+			run.len += count;
+			continue;
+		}
+		ret = flush_read_run(fs_info, &run);
 		if (ret < 0)
 			goto out;
-		cur += min(extent_num_bytes, aligned_end - cur);
-	}
-
-	/* Read the tailing unaligned part*/
-	if (file_offset + len != aligned_end) {
-		btrfs_release_path(&path);
-		ret = lookup_data_extent(root, &path, ino, aligned_end,
-					 &next_offset);
-		/* <0 is error, >0 means no extent */
-		if (ret)
-			goto out;
-		fi = btrfs_item_ptr(path.nodes[0], path.slots[0],
-				    struct btrfs_file_extent_item);
-		ret = read_and_truncate_page(&path, fi, aligned_end,
-				file_offset + len - aligned_end,
-				dest + aligned_end - file_offset);
+		run.logical = logical;
+		run.len = count;
+		run.dest = dest + start - file_offset;
 	}
+	if (ret >= 0)
+		ret = flush_read_run(fs_info, &run);
 out:
 	btrfs_release_path(&path);
 	if (ret < 0)
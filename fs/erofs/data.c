@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * EROFS read-only filesystem: inodes and file data
+ *
+ * Uncompressed data is read straight from the device into the caller's
+ * buffer. Compressed clusters are one block each, so a fully covered extent
+ * is decompressed directly into the destination, and the compressed block
+ * is read into the tail of the destination itself when there is room to
+ * decompress it in place. Images made without zero padding keep the
+ * compressed data at the start of the block instead, followed by unused
+ * bytes, and are decoded from a separate buffer.
+ */
+
+#include <common.h>
+#include <fs_internal.h>
+#include <log.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <linux/kernel.h>
+#include <linux/sizes.h>
+#include <u-boot/lz4.h>
+#include "internal.h"
+
+int erofs_dev_read(void *buf, u64 pos, u64 len)
+{
+	struct blk_desc *desc = sbi.desc;
+	int count;
+
+	while (len) {
+		count = min_t(u64, len, SZ_1G);
+		if (!fs_devread(desc, &sbi.part, pos >> desc->log2blksz,
+				pos & (desc->blksz - 1), count, buf))
+			return -EIO;
+		buf += count;
+		pos += count;
+		len -= count;
+	}
+
+	return 0;
+}
+
+int erofs_read_meta(void *buf, u64 pos, unsigned int len)
+{
+	unsigned int count, off;
+	u64 blk;
+	int ret;
+
+	while (len) {
+		blk = pos >> sbi.blkszbits;
+		off = erofs_blkoff(pos);
+		count = min(len, erofs_blksiz() - off);
+
+		if (blk != sbi.meta_blk) {
+			sbi.meta_blk = ~0ULL;
+			ret = erofs_dev_read(sbi.metabuf, erofs_pos(blk),
+					     erofs_blksiz());
+			if (ret)
+				return ret;
+			sbi.meta_blk = blk;
+		}
+		memcpy(buf, sbi.metabuf + off, count);
+		buf += count;
+		pos += count;
+		len -= count;
+	}
+
+	return 0;
+}
+
+int erofs_read_inode(u64 nid, struct erofs_inode *inode)
+{
+	union {
+		struct erofs_inode_compact c;
+		struct erofs_inode_extended e;
+	} di;
+	u16 ifmt;
+	int ret;
+
+	inode->nid = nid;
+	ret = erofs_read_meta(&di.c, erofs_iloc(inode), sizeof(di.c));
+	if (ret)
+		return ret;
+
+	ifmt = le16_to_cpu(di.c.i_format);
+	inode->datalayout = (ifmt >> EROFS_I_DATALAYOUT_BIT) &
+			    EROFS_I_DATALAYOUT_MASK;
+	if (inode->datalayout >= EROFS_INODE_DATALAYOUT_MAX) {
+		log_debug("nid %llu: unknown data layout %u\n", nid,
+			  inode->datalayout);
+		return -EOPNOTSUPP;
+	}
+
+	if ((ifmt >> EROFS_I_VERSION_BIT) & 1) {
+		ret = erofs_read_meta(&di.e, erofs_iloc(inode), sizeof(di.e));
+		if (ret)
+			return ret;
+		inode->inode_isize = sizeof(di.e);
+		inode->mode = le16_to_cpu(di.e.i_mode);
+		inode->size = le64_to_cpu(di.e.i_size);
+		inode->raw_blkaddr = le32_to_cpu(di.e.i_u.raw_blkaddr);
+	} else {
+		inode->inode_isize = sizeof(di.c);
+		inode->mode = le16_to_cpu(di.c.i_mode);
+		inode->size = le32_to_cpu(di.c.i_size);
+		inode->raw_blkaddr = le32_to_cpu(di.c.i_u.raw_blkaddr);
+	}
+	inode->xattr_isize = erofs_xattr_ibody_size(di.c.i_xattr_icount);
+	inode->z_inited = false;
+
+	return 0;
+}
+
+/*
+ * Map @map->la of a flat inode. The data lives in consecutive blocks from
+ * raw_blkaddr, except that an inline inode keeps its last partial block
+ * right after the inode.
+ */
+static int erofs_map_flat(struct erofs_inode *inode, struct erofs_map *map)
+{
+	u64 nblocks = DIV_ROUND_UP(inode->size, erofs_blksiz());
+	u64 lastblk = nblocks;
+
+	if (inode->datalayout == EROFS_INODE_FLAT_INLINE)
+		lastblk--;
+
+	map->flags = 0;
+	if (map->la < erofs_pos(lastblk)) {
+		map->pa = erofs_pos(inode->raw_blkaddr) + map->la;
+		map->llen = erofs_pos(lastblk) - map->la;
+		return 0;
+	}
+
+	map->pa = erofs_iend(inode) + erofs_blkoff(map->la);
+	map->llen = inode->size - map->la;
+	if (erofs_blkoff(map->pa) + map->llen > erofs_blksiz()) {
+		log_debug("nid %llu: inline data crosses a block\n",
+			  inode->nid);
+		return -EFSCORRUPTED;
+	}
+
+	return 0;
+}
+
+/**
+ * z_erofs_decompress() - Decompress a whole extent
+ *
+ * @map: Extent to decompress
+ * @out: Destination for the @map->llen bytes of the extent
+ * @limit: End of the space after @out which may be used as scratch
+ * Return: 0 if OK, -ve on error
+ */
+static int z_erofs_decompress(struct erofs_map *map, char *out, char *limit)
+{
+	u32 blksz = erofs_blksiz();
+	bool zero_padding = sbi.feature_incompat &
+			    EROFS_FEATURE_INCOMPAT_ZERO_PADDING;
+	u32 margin, pad, rot, count;
+	char *in;
+	int ret;
+
+	if (!(map->flags & EROFS_MAP_ZIPPED)) {
+		if (map->llen > blksz)
+			return -EFSCORRUPTED;
+		rot = map->flags & EROFS_MAP_INTERLACED ?
+			erofs_blkoff(map->la) : 0;
+		count = min_t(u64, map->llen, blksz - rot);
+		ret = erofs_dev_read(out, map->pa + rot, count);
+		if (!ret && count < map->llen)
+			ret = erofs_dev_read(out + count, map->pa,
+					     map->llen - count);
+		return ret;
+	}
+
+	/*
+	 * LZ4 can decompress in place when the input ends far enough past
+	 * the end of the output, so use the destination itself if the space
+	 * after this extent allows it. That needs the input to end the
+	 * block, which only zero padding guarantees.
+	 */
+	margin = (blksz >> 8) + 32;
+	in = sbi.pclusterbuf;
+	if (zero_padding && map->llen + margin >= blksz) {
+		ulong start = ALIGN((ulong)out + map->llen + margin - blksz,
+				    ARCH_DMA_MINALIGN);
+
+		if (start + blksz <= (ulong)limit)
+			in = (char *)start;
+	}
+
+	ret = erofs_dev_read(in, map->pa, blksz);
+	if (ret)
+		return ret;
+
+	if (zero_padding) {
+		/* the compressed data is zero-padded at the start of the block */
+		for (pad = 0; pad < blksz && !in[pad]; pad++)
+			;
+		if (pad == blksz)
+			return -EFSCORRUPTED;
+
+		ret = LZ4_decompress_safe(in + pad, out, blksz - pad,
+					  map->llen);
+	} else {
+		/* the end of the compressed data is unknown, stop at llen */
+		ret = LZ4_decompress_safe_partial(in, out, blksz, map->llen,
+						  map->llen);
+	}
+	if (ret != map->llen) {
+		log_debug("LZ4 error at %llx: %d\n", map->pa, ret);
+		return -EFSCORRUPTED;
+	}
+
+	return 0;
+}
+
+static int z_erofs_pread(struct erofs_inode *inode, char *buf, u64 offset,
+			 u64 len)
+{
+	u64 end = offset + len, pos, skip, count;
+	struct erofs_map map;
+	char *tmp;
+	int ret;
+
+	for (pos = offset; pos < end; pos += count) {
+		map.la = pos;
+		ret = z_erofs_map_blocks(inode, &map);
+		if (ret)
+			return ret;
+
+		skip = pos - map.la;
+		count = min(map.la + map.llen, end) - pos;
+		if (!skip && count == map.llen) {
+			ret = z_erofs_decompress(&map, buf + (pos - offset),
+						 buf + len);
+		} else {
+			/* partially covered extent, decompress it aside */
+			tmp = malloc(map.llen);
+			if (!tmp)
+				return -ENOMEM;
+			ret = z_erofs_decompress(&map, tmp, tmp + map.llen);
+			if (!ret)
+				memcpy(buf + (pos - offset), tmp + skip, count);
+			free(tmp);
+		}
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+int erofs_pread(struct erofs_inode *inode, char *buf, u64 offset, u64 len)
+{
+	struct erofs_map map;
+	u64 pos, count;
+	int ret;
+
+	if (offset > inode->size || len > inode->size - offset)
+		return -EINVAL;
+
+	switch (inode->datalayout) {
+	case EROFS_INODE_FLAT_PLAIN:
+	case EROFS_INODE_FLAT_INLINE:
+		for (pos = offset; pos < offset + len; pos += count) {
+			map.la = pos;
+			ret = erofs_map_flat(inode, &map);
+			if (ret)
+				return ret;
+			count = min(map.llen, offset + len - pos);
+			ret = erofs_dev_read(buf + (pos - offset), map.pa,
+					     count);
+			if (ret)
+				return ret;
+		}
+		return 0;
+	case EROFS_INODE_COMPRESSED_FULL:
+	case EROFS_INODE_COMPRESSED_COMPACT:
+		return z_erofs_pread(inode, buf, offset, len);
+	default:
+		log_debug("nid %llu: data layout %u not supported\n",
+			  inode->nid, inode->datalayout);
+		return -EOPNOTSUPP;
+	}
+}
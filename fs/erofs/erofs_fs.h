@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: GPL-2.0+ OR Apache-2.0 */
+/*
+ * EROFS on-disk format, as used by Linux and erofs-utils
+ *
+ * Only the structures needed by the read-only U-Boot driver are described.
+ */
+
+#ifndef __EROFS_FS_H
+#define __EROFS_FS_H
+
+#include <asm/byteorder.h>
+#include <linux/bitops.h>
+#include <linux/types.h>
+
+#define EROFS_SUPER_OFFSET	1024
+#define EROFS_SUPER_MAGIC_V1	0xe0f5e1e2
+
+#define EROFS_FEATURE_COMPAT_SB_CHKSUM		0x00000001
+
+#define EROFS_FEATURE_INCOMPAT_ZERO_PADDING	0x00000001
+#define EROFS_FEATURE_INCOMPAT_COMPR_CFGS	0x00000002
+#define EROFS_FEATURE_INCOMPAT_BIG_PCLUSTER	0x00000002
+#define EROFS_FEATURE_INCOMPAT_CHUNKED_FILE	0x00000004
+#define EROFS_FEATURE_INCOMPAT_DEVICE_TABLE	0x00000008
+#define EROFS_FEATURE_INCOMPAT_ZTAILPACKING	0x00000010
+#define EROFS_FEATURE_INCOMPAT_FRAGMENTS	0x00000020
+#define EROFS_FEATURE_INCOMPAT_XATTR_PREFIXES	0x00000040
+
+/*
+ * Features which may be present in an image we mount. Files which actually
+ * use big pclusters, chunks, tail packing or fragments are refused on access.
+ */
+#define EROFS_FEATURE_INCOMPAT_SUPP \
+	(EROFS_FEATURE_INCOMPAT_ZERO_PADDING | \
+	 EROFS_FEATURE_INCOMPAT_COMPR_CFGS | \
+	 EROFS_FEATURE_INCOMPAT_CHUNKED_FILE | \
+	 EROFS_FEATURE_INCOMPAT_ZTAILPACKING | \
+	 EROFS_FEATURE_INCOMPAT_FRAGMENTS | \
+	 EROFS_FEATURE_INCOMPAT_XATTR_PREFIXES)
+
+/* 128-byte superblock at EROFS_SUPER_OFFSET */
+struct erofs_super_block {
+	__le32 magic;
+	__le32 checksum;
+	__le32 feature_compat;
+	__u8 blkszbits;
+	__u8 sb_extslots;
+	__le16 root_nid;
+	__le64 inos;
+	__le64 build_time;
+	__le32 build_time_nsec;
+	__le32 blocks;
+	__le32 meta_blkaddr;
+	__le32 xattr_blkaddr;
+	__u8 uuid[16];
+	__u8 volume_name[16];
+	__le32 feature_incompat;
+	__le16 available_compr_algs;
+	__le16 extra_devices;
+	__le16 devt_slotoff;
+	__u8 dirblkbits;
+	__u8 xattr_prefix_count;
+	__le32 xattr_prefix_start;
+	__le64 packed_nid;
+	__u8 reserved2[24];
+} __packed;
+
+/* data layouts, stored in bits 1-3 of i_format */
+enum {
+	EROFS_INODE_FLAT_PLAIN			= 0,
+	EROFS_INODE_COMPRESSED_FULL		= 1,
+	EROFS_INODE_FLAT_INLINE			= 2,
+	EROFS_INODE_COMPRESSED_COMPACT		= 3,
+	EROFS_INODE_CHUNK_BASED			= 4,
+	EROFS_INODE_DATALAYOUT_MAX
+};
+
+#define EROFS_I_VERSION_BIT		0
+#define EROFS_I_DATALAYOUT_BIT		1
+#define EROFS_I_DATALAYOUT_MASK		0x7
+
+#define EROFS_INODE_LAYOUT_COMPACT	0
+#define EROFS_INODE_LAYOUT_EXTENDED	1
+
+#define EROFS_SLOTSIZE_BITS		5
+#define EROFS_ISLOTBITS			EROFS_SLOTSIZE_BITS
+
+/* 32-byte compact inode */
+struct erofs_inode_compact {
+	__le16 i_format;
+	__le16 i_xattr_icount;
+	__le16 i_mode;
+	__le16 i_nlink;
+	__le32 i_size;
+	__le32 i_reserved;
+	union {
+		__le32 compressed_blocks;
+		__le32 raw_blkaddr;
+		__le32 rdev;
+	} i_u;
+	__le32 i_ino;
+	__le16 i_uid;
+	__le16 i_gid;
+	__le32 i_reserved2;
+} __packed;
+
+/* 64-byte extended inode */
+struct erofs_inode_extended {
+	__le16 i_format;
+	__le16 i_xattr_icount;
+	__le16 i_mode;
+	__le16 i_reserved;
+	__le64 i_size;
+	union {
+		__le32 compressed_blocks;
+		__le32 raw_blkaddr;
+		__le32 rdev;
+	} i_u;
+	__le32 i_ino;
+	__le32 i_uid;
+	__le32 i_gid;
+	__le64 i_mtime;
+	__le32 i_mtime_nsec;
+	__le32 i_nlink;
+	__u8 i_reserved2[16];
+} __packed;
+
+/* the inline xattr area starts with a 12-byte header, then 4-byte slots */
+struct erofs_xattr_ibody_header {
+	__le32 h_reserved;
+	__u8 h_shared_count;
+	__u8 h_reserved2[7];
+} __packed;
+
+static inline unsigned int erofs_xattr_ibody_size(__le16 icount)
+{
+	if (!le16_to_cpu(icount))
+		return 0;
+
+	return sizeof(struct erofs_xattr_ibody_header) +
+		(le16_to_cpu(icount) - 1) * sizeof(__u32);
+}
+
+/* file types stored in directory entries */
+enum {
+	EROFS_FT_UNKNOWN,
+	EROFS_FT_REG_FILE,
+	EROFS_FT_DIR,
+	EROFS_FT_CHRDEV,
+	EROFS_FT_BLKDEV,
+	EROFS_FT_FIFO,
+	EROFS_FT_SOCK,
+	EROFS_FT_SYMLINK,
+	EROFS_FT_MAX
+};
+
+#define EROFS_NAME_LEN		255
+
+/*
+ * Each directory block starts with an array of entries; the name offset of
+ * the first entry gives the size of that array. Names are not terminated.
+ */
+struct erofs_dirent {
+	__le64 nid;
+	__le16 nameoff;
+	__u8 file_type;
+	__u8 reserved;
+} __packed;
+
+/* compression algorithms */
+enum {
+	Z_EROFS_COMPRESSION_LZ4		= 0,
+	Z_EROFS_COMPRESSION_LZMA	= 1,
+	Z_EROFS_COMPRESSION_MAX
+};
+
+#define Z_EROFS_ADVISE_COMPACTED_2B		0x0001
+#define Z_EROFS_ADVISE_BIG_PCLUSTER_1		0x0002
+#define Z_EROFS_ADVISE_BIG_PCLUSTER_2		0x0004
+#define Z_EROFS_ADVISE_INLINE_PCLUSTER		0x0008
+#define Z_EROFS_ADVISE_INTERLACED_PCLUSTER	0x0010
+#define Z_EROFS_ADVISE_FRAGMENT_PCLUSTER	0x0020
+
+/* header of the logical cluster indexes, 8-byte aligned after the inode */
+struct z_erofs_map_header {
+	__le16 h_reserved1;
+	__le16 h_idata_size;
+	__le16 h_advise;
+	/* bits 0-3: algorithm of HEAD1 lclusters, bits 4-7: of HEAD2 */
+	__u8 h_algorithmtype;
+	/* bits 0-2: logical cluster bits - block size bits */
+	__u8 h_clusterbits;
+} __packed;
+
+/* the full index array starts this far past the 8-byte aligned inode end */
+#define Z_EROFS_FULL_INDEX_START	(sizeof(struct z_erofs_map_header) + 8)
+
+enum {
+	Z_EROFS_LCLUSTER_TYPE_PLAIN	= 0,
+	Z_EROFS_LCLUSTER_TYPE_HEAD1	= 1,
+	Z_EROFS_LCLUSTER_TYPE_NONHEAD	= 2,
+	Z_EROFS_LCLUSTER_TYPE_HEAD2	= 3,
+	Z_EROFS_LCLUSTER_TYPE_MAX
+};
+
+#define Z_EROFS_LI_LCLUSTER_TYPE_MASK	0x3
+#define Z_EROFS_LI_D0_CBLKCNT		BIT(11)
+
+/* full (non-compacted) logical cluster index */
+struct z_erofs_lcluster_index {
+	__le16 di_advise;
+	/* where the decompressed data of the HEAD/PLAIN lcluster starts */
+	__le16 di_clusterofs;
+	union {
+		/* HEAD/PLAIN: physical block of the pcluster */
+		__le32 blkaddr;
+		/* NONHEAD: distances to the previous and the next HEAD */
+		__le16 delta[2];
+	} di_u;
+} __packed;
+
+#endif /* __EROFS_FS_H */
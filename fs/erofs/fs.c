@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * EROFS read-only filesystem: generic filesystem interface
+ */
+
+#include <common.h>
+#include <erofs.h>
+#include <fs.h>
+#include <log.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <linux/stat.h>
+#include "internal.h"
+
+struct erofs_sb_info sbi;
+
+struct erofs_dir_stream {
+	struct fs_dir_stream fs_dirs;
+	struct fs_dirent dirent;
+	struct erofs_inode inode;
+	struct erofs_dir_iter it;
+};
+
+int erofs_probe(struct blk_desc *fs_dev_desc,
+		struct disk_partition *fs_partition)
+{
+	struct erofs_super_block sb;
+	int ret;
+
+	sbi.desc = fs_dev_desc;
+	sbi.part = *fs_partition;
+
+	ret = erofs_dev_read(&sb, EROFS_SUPER_OFFSET, sizeof(sb));
+	if (ret)
+		goto error;
+	if (le32_to_cpu(sb.magic) != EROFS_SUPER_MAGIC_V1) {
+		ret = -EINVAL;
+		goto error;
+	}
+
+	if (sb.blkszbits < 9 || sb.blkszbits > 16 || sb.dirblkbits) {
+		log_err("EROFS: unsupported block size\n");
+		ret = -EINVAL;
+		goto error;
+	}
+	sbi.feature_incompat = le32_to_cpu(sb.feature_incompat);
+	if (sbi.feature_incompat & ~EROFS_FEATURE_INCOMPAT_SUPP) {
+		log_err("EROFS: unsupported features %x\n",
+			sbi.feature_incompat & ~EROFS_FEATURE_INCOMPAT_SUPP);
+		ret = -EOPNOTSUPP;
+		goto error;
+	}
+
+	sbi.blkszbits = sb.blkszbits;
+	sbi.meta_blkaddr = le32_to_cpu(sb.meta_blkaddr);
+	sbi.root_nid = le16_to_cpu(sb.root_nid);
+	sbi.meta_blk = ~0ULL;
+	sbi.metabuf = malloc_cache_aligned(erofs_blksiz());
+	sbi.pclusterbuf = malloc_cache_aligned(erofs_blksiz());
+	if (!sbi.metabuf || !sbi.pclusterbuf) {
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	return 0;
+
+error:
+	erofs_close();
+	return ret;
+}
+
+void erofs_close(void)
+{
+	free(sbi.metabuf);
+	free(sbi.pclusterbuf);
+	memset(&sbi, 0, sizeof(sbi));
+}
+
+int erofs_opendir(const char *filename, struct fs_dir_stream **dirsp)
+{
+	struct erofs_dir_stream *dirs;
+	int ret;
+
+	dirs = calloc(1, sizeof(*dirs));
+	if (!dirs)
+		return -ENOMEM;
+
+	ret = erofs_lookup(filename, &dirs->inode);
+	if (!ret)
+		ret = erofs_dir_iter_init(&dirs->it, &dirs->inode);
+	if (ret) {
+		free(dirs);
+		return ret;
+	}
+	*dirsp = &dirs->fs_dirs;
+
+	return 0;
+}
+
+int erofs_readdir(struct fs_dir_stream *fs_dirs, struct fs_dirent **dentp)
+{
+	struct erofs_dir_stream *dirs = (struct erofs_dir_stream *)fs_dirs;
+	struct fs_dirent *dent = &dirs->dirent;
+	struct erofs_inode inode;
+	unsigned int namelen;
+	const char *name;
+	u64 nid;
+	u8 ftype;
+	int ret;
+
+	ret = erofs_dir_next(&dirs->it, &name, &namelen, &nid, &ftype);
+	if (ret < 0)
+		return ret;
+	if (!ret)
+		return -ENOENT;
+
+	memset(dent, 0, sizeof(*dent));
+	memcpy(dent->name, name, namelen);
+	switch (ftype) {
+	case EROFS_FT_DIR:
+		dent->type = FS_DT_DIR;
+		break;
+	case EROFS_FT_SYMLINK:
+		dent->type = FS_DT_LNK;
+		break;
+	default:
+		dent->type = FS_DT_REG;
+		break;
+	}
+
+	ret = erofs_read_inode(nid, &inode);
+	if (ret)
+		return ret;
+	dent->size = inode.size;
+	*dentp = dent;
+
+	return 0;
+}
+
+void erofs_closedir(struct fs_dir_stream *fs_dirs)
+{
+	struct erofs_dir_stream *dirs = (struct erofs_dir_stream *)fs_dirs;
+
+	if (!dirs)
+		return;
+
+	erofs_dir_iter_free(&dirs->it);
+	free(dirs);
+}
+
+int erofs_read(const char *filename, void *buf, loff_t offset, loff_t len,
+	       loff_t *actread)
+{
+	struct erofs_inode inode;
+	int ret;
+
+	*actread = 0;
+	ret = erofs_lookup(filename, &inode);
+	if (ret)
+		return ret;
+	if (S_ISDIR(inode.mode))
+		return -EISDIR;
+	if (!S_ISREG(inode.mode))
+		return -EINVAL;
+
+	if (offset > inode.size)
+		return -EINVAL;
+	if (!len || len > inode.size - offset)
+		len = inode.size - offset;
+
+	ret = erofs_pread(&inode, buf, offset, len);
+	if (ret)
+		return ret;
+	*actread = len;
+
+	return 0;
+}
+
+int erofs_size(const char *filename, loff_t *size)
+{
+	struct erofs_inode inode;
+	int ret;
+
+	ret = erofs_lookup(filename, &inode);
+	if (ret)
+		return ret;
+	*size = inode.size;
+
+	return 0;
+}
+
+int erofs_exists(const char *filename)
+{
+	struct erofs_inode inode;
+
+	return !erofs_lookup(filename, &inode);
+}
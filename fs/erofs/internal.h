@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * EROFS read-only filesystem: internal definitions
+ */
+
+#ifndef __EROFS_INTERNAL_H
+#define __EROFS_INTERNAL_H
+
+#include <part.h>
+#include <linux/types.h>
+#include "erofs_fs.h"
+
+#define EFSCORRUPTED	EUCLEAN
+
+/* symlinks followed while resolving a single path */
+#define EROFS_MAX_LINKS	8
+#define EROFS_MAX_LINK_LEN	4096
+
+struct erofs_sb_info {
+	struct blk_desc *desc;
+	struct disk_partition part;
+	u8 blkszbits;
+	u32 meta_blkaddr;
+	u64 root_nid;
+	u32 feature_incompat;
+	/* last metadata block read, for inodes, indexes and directories */
+	u64 meta_blk;
+	u8 *metabuf;
+	/* bounce buffer for a compressed physical cluster */
+	u8 *pclusterbuf;
+};
+
+extern struct erofs_sb_info sbi;
+
+static inline u32 erofs_blksiz(void)
+{
+	return 1U << sbi.blkszbits;
+}
+
+static inline u64 erofs_pos(u64 blkaddr)
+{
+	return blkaddr << sbi.blkszbits;
+}
+
+static inline u32 erofs_blkoff(u64 pos)
+{
+	return pos & (erofs_blksiz() - 1);
+}
+
+struct erofs_inode {
+	u64 nid;
+	u16 mode;
+	u8 datalayout;
+	u8 inode_isize;
+	u16 xattr_isize;
+	u64 size;
+	u32 raw_blkaddr;
+
+	/* compressed inodes only, filled in on first use */
+	bool z_inited;
+	u16 z_advise;
+	u8 z_algorithmtype;
+	u8 z_lclusterbits;
+};
+
+static inline u64 erofs_iloc(const struct erofs_inode *inode)
+{
+	return erofs_pos(sbi.meta_blkaddr) +
+		(inode->nid << EROFS_ISLOTBITS);
+}
+
+/* end of the inode and its inline xattrs, where inline data starts */
+static inline u64 erofs_iend(const struct erofs_inode *inode)
+{
+	return erofs_iloc(inode) + inode->inode_isize + inode->xattr_isize;
+}
+
+static inline bool erofs_inode_is_compressed(const struct erofs_inode *inode)
+{
+	return inode->datalayout == EROFS_INODE_COMPRESSED_FULL ||
+		inode->datalayout == EROFS_INODE_COMPRESSED_COMPACT;
+}
+
+/* the extent is stored compressed */
+#define EROFS_MAP_ZIPPED	BIT(0)
+/* uncompressed extent whose data is rotated by its offset in the block */
+#define EROFS_MAP_INTERLACED	BIT(1)
+
+/**
+ * struct erofs_map - mapping of a logical extent onto the device
+ *
+ * @la: Logical start of the extent in the file
+ * @llen: Logical length of the extent
+ * @pa: Byte address of the data on the device
+ * @flags: EROFS_MAP_...
+ */
+struct erofs_map {
+	u64 la;
+	u64 llen;
+	u64 pa;
+	unsigned int flags;
+};
+
+/* data.c */
+int erofs_dev_read(void *buf, u64 pos, u64 len);
+int erofs_read_meta(void *buf, u64 pos, unsigned int len);
+int erofs_read_inode(u64 nid, struct erofs_inode *inode);
+int erofs_pread(struct erofs_inode *inode, char *buf, u64 offset, u64 len);
+
+/* zmap.c */
+int z_erofs_map_blocks(struct erofs_inode *inode, struct erofs_map *map);
+
+/* namei.c */
+struct erofs_dir_iter {
+	struct erofs_inode *dir;
+	u8 *buf;
+	u64 pos;
+	unsigned int maxsize;
+	unsigned int nent;
+	unsigned int idx;
+};
+
+int erofs_dir_iter_init(struct erofs_dir_iter *it, struct erofs_inode *dir);
+void erofs_dir_iter_free(struct erofs_dir_iter *it);
+int erofs_dir_next(struct erofs_dir_iter *it, const char **name,
+		   unsigned int *namelen, u64 *nid, u8 *ftype);
+int erofs_lookup(const char *path, struct erofs_inode *inode);
+
+#endif /* __EROFS_INTERNAL_H */
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * EROFS read-only filesystem: directories and path lookup
+ */
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <linux/kernel.h>
+#include <linux/stat.h>
+#include "internal.h"
+
+int erofs_dir_iter_init(struct erofs_dir_iter *it, struct erofs_inode *dir)
+{
+	if (!S_ISDIR(dir->mode))
+		return -ENOTDIR;
+
+	memset(it, 0, sizeof(*it));
+	it->dir = dir;
+	it->buf = malloc(erofs_blksiz());
+	if (!it->buf)
+		return -ENOMEM;
+
+	return 0;
+}
+
+void erofs_dir_iter_free(struct erofs_dir_iter *it)
+{
+	free(it->buf);
+	it->buf = NULL;
+}
+
+/* read the next directory block and check its entry table */
+static int erofs_dir_load(struct erofs_dir_iter *it)
+{
+	struct erofs_dirent *de = (struct erofs_dirent *)it->buf;
+	unsigned int nameoff;
+	int ret;
+
+	it->maxsize = min_t(u64, erofs_blksiz(), it->dir->size - it->pos);
+	ret = erofs_pread(it->dir, it->buf, it->pos, it->maxsize);
+	if (ret)
+		return ret;
+
+	nameoff = le16_to_cpu(de->nameoff);
+	if (nameoff < sizeof(*de) || nameoff >= it->maxsize) {
+		log_debug("nid %llu: bad directory block at %llu\n",
+			  it->dir->nid, it->pos);
+		return -EFSCORRUPTED;
+	}
+	it->nent = nameoff / sizeof(*de);
+	it->idx = 0;
+
+	return 0;
+}
+
+/**
+ * erofs_dir_next() - Get the next entry of a directory
+ *
+ * @it: Iterator set up by erofs_dir_iter_init()
+ * @name: Returns the name, which is not nul-terminated
+ * @namelen: Returns the length of @name
+ * @nid: Returns the inode number
+ * @ftype: Returns the EROFS_FT_... type
+ * Return: 1 if an entry was returned, 0 at the end, -ve on error
+ */
+int erofs_dir_next(struct erofs_dir_iter *it, const char **name,
+		   unsigned int *namelen, u64 *nid, u8 *ftype)
+{
+	struct erofs_dirent *de = (struct erofs_dirent *)it->buf;
+	unsigned int nameoff, nameend;
+	int ret;
+
+	if (it->idx == it->nent) {
+		if (it->nent)
+			it->pos += erofs_blksiz();
+		if (it->pos >= it->dir->size)
+			return 0;
+		ret = erofs_dir_load(it);
+		if (ret)
+			return ret;
+	}
+
+	nameoff = le16_to_cpu(de[it->idx].nameoff);
+	if (it->idx + 1 < it->nent)
+		nameend = le16_to_cpu(de[it->idx + 1].nameoff);
+	else
+		nameend = nameoff + strnlen((char *)it->buf + nameoff,
+					    it->maxsize - nameoff);
+	if (nameoff >= nameend || nameend > it->maxsize ||
+	    nameend - nameoff > EROFS_NAME_LEN)
+		return -EFSCORRUPTED;
+
+	*name = (char *)it->buf + nameoff;
+	*namelen = nameend - nameoff;
+	*nid = le64_to_cpu(de[it->idx].nid);
+	*ftype = de[it->idx].file_type;
+	it->idx++;
+
+	return 1;
+}
+
+/* find @name in @dir; entries are sorted, so stop once past it */
+static int erofs_dir_find(struct erofs_inode *dir, const char *name,
+			  unsigned int len, u64 *nid)
+{
+	struct erofs_dir_iter it;
+	unsigned int namelen;
+	const char *dname;
+	u8 ftype;
+	int ret, cmp = 1;
+
+	ret = erofs_dir_iter_init(&it, dir);
+	if (ret)
+		return ret;
+
+	while ((ret = erofs_dir_next(&it, &dname, &namelen, nid, &ftype)) > 0) {
+		cmp = memcmp(dname, name, min(namelen, len));
+		if (!cmp)
+			cmp = namelen - len;
+		if (!cmp) {
+			ret = 0;
+			break;
+		}
+		if (cmp > 0) {
+			ret = -ENOENT;
+			break;
+		}
+	}
+	if (!ret && cmp)
+		ret = -ENOENT;
+	erofs_dir_iter_free(&it);
+
+	return ret;
+}
+
+static int erofs_namei(struct erofs_inode *cur, const char *path, int depth)
+{
+	struct erofs_inode dir, next;
+	const char *end;
+	char *target;
+	unsigned int len;
+	u64 nid;
+	int ret;
+
+	if (*path == '/') {
+		ret = erofs_read_inode(sbi.root_nid, cur);
+		if (ret)
+			return ret;
+	}
+
+	for (; *path; path = end) {
+		while (*path == '/')
+			path++;
+		if (!*path)
+			break;
+		end = strchrnul(path, '/');
+		len = end - path;
+
+		if (!S_ISDIR(cur->mode))
+			return -ENOTDIR;
+		ret = erofs_dir_find(cur, path, len, &nid);
+		if (ret)
+			return ret;
+		ret = erofs_read_inode(nid, &next);
+		if (ret)
+			return ret;
+
+		if (S_ISLNK(next.mode)) {
+			/* resolve the link from the directory holding it */
+			if (depth >= EROFS_MAX_LINKS)
+				return -ELOOP;
+			if (next.size >= EROFS_MAX_LINK_LEN)
+				return -ENAMETOOLONG;
+			target = malloc(next.size + 1);
+			if (!target)
+				return -ENOMEM;
+			ret = erofs_pread(&next, target, 0, next.size);
+			target[next.size] = '\0';
+			dir = *cur;
+			if (!ret)
+				ret = erofs_namei(&dir, target, depth + 1);
+			free(target);
+			if (ret)
+				return ret;
+			next = dir;
+		}
+		*cur = next;
+	}
+
+	return 0;
+}
+
+/**
+ * erofs_lookup() - Find the inode of a path, following symlinks
+ *
+ * @path: Path from the root directory
+ * @inode: Returns the inode
+ * Return: 0 if OK, -ENOENT if not found, other -ve on error
+ */
+int erofs_lookup(const char *path, struct erofs_inode *inode)
+{
+	int ret;
+
+	ret = erofs_read_inode(sbi.root_nid, inode);
+	if (ret)
+		return ret;
+
+	return erofs_namei(inode, path, 0);
+}
@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * EROFS read-only filesystem: compressed extent mapping
+ *
+ * A compressed file is split into logical clusters (lclusters) of one or
+ * more blocks, each described by an index. An extent starts in a HEAD (or
+ * PLAIN, if stored uncompressed) lcluster at its cluster offset and runs
+ * until the next one; NONHEAD lclusters in between point back at their
+ * head. Each extent is stored in a single physical block, which is the only
+ * pcluster size supported here.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <asm/unaligned.h>
+#include <linux/kernel.h>
+#include "internal.h"
+
+struct z_erofs_maprecorder {
+	struct erofs_inode *inode;
+	u64 lcn;
+	u8 type;
+	u16 clusterofs;
+	u16 delta0;
+	u32 pblk;
+};
+
+/* start of the map header and indexes, 8-byte aligned past the inode */
+static u64 z_erofs_mapbase(struct erofs_inode *inode)
+{
+	return ALIGN(erofs_iend(inode), 8);
+}
+
+static int z_erofs_fill_inode(struct erofs_inode *inode)
+{
+	struct z_erofs_map_header h;
+	int ret;
+
+	if (inode->z_inited)
+		return 0;
+
+	ret = erofs_read_meta(&h, z_erofs_mapbase(inode), sizeof(h));
+	if (ret)
+		return ret;
+
+	inode->z_advise = le16_to_cpu(h.h_advise);
+	inode->z_algorithmtype = h.h_algorithmtype;
+	inode->z_lclusterbits = sbi.blkszbits + (h.h_clusterbits & 7);
+
+	if (inode->z_advise & (Z_EROFS_ADVISE_BIG_PCLUSTER_1 |
+			       Z_EROFS_ADVISE_BIG_PCLUSTER_2 |
+			       Z_EROFS_ADVISE_INLINE_PCLUSTER |
+			       Z_EROFS_ADVISE_FRAGMENT_PCLUSTER)) {
+		log_debug("nid %llu: unsupported compression advise %x\n",
+			  inode->nid, inode->z_advise);
+		return -EOPNOTSUPP;
+	}
+	if (inode->datalayout == EROFS_INODE_COMPRESSED_COMPACT &&
+	    (inode->z_lclusterbits != sbi.blkszbits ||
+	     ((inode->z_advise & Z_EROFS_ADVISE_COMPACTED_2B) &&
+	      inode->z_lclusterbits != 12)))
+		return -EOPNOTSUPP;
+
+	inode->z_inited = true;
+
+	return 0;
+}
+
+static int z_erofs_load_full_lcluster(struct z_erofs_maprecorder *m, u64 lcn)
+{
+	struct erofs_inode *inode = m->inode;
+	struct z_erofs_lcluster_index di;
+	int ret;
+
+	ret = erofs_read_meta(&di, z_erofs_mapbase(inode) +
+			      Z_EROFS_FULL_INDEX_START + lcn * sizeof(di),
+			      sizeof(di));
+	if (ret)
+		return ret;
+
+	m->lcn = lcn;
+	m->type = le16_to_cpu(di.di_advise) & Z_EROFS_LI_LCLUSTER_TYPE_MASK;
+	if (m->type == Z_EROFS_LCLUSTER_TYPE_NONHEAD) {
+		m->clusterofs = 1 << inode->z_lclusterbits;
+		m->delta0 = le16_to_cpu(di.di_u.delta[0]);
+		if (m->delta0 & Z_EROFS_LI_D0_CBLKCNT)
+			return -EOPNOTSUPP;
+	} else {
+		m->clusterofs = le16_to_cpu(di.di_clusterofs);
+		m->delta0 = 0;
+		m->pblk = le32_to_cpu(di.di_u.blkaddr);
+	}
+
+	return 0;
+}
+
+static unsigned int decode_compactedbits(unsigned int lobits, const u8 *in,
+					 unsigned int pos, u8 *type)
+{
+	const unsigned int v = get_unaligned_le32(in + pos / 8) >> (pos & 7);
+
+	*type = (v >> lobits) & Z_EROFS_LI_LCLUSTER_TYPE_MASK;
+
+	return v & ((1 << lobits) - 1);
+}
+
+/*
+ * Compact indexes are packed in groups of 2 (4 bytes each) or 16 (2 bytes
+ * each) lclusters, followed by the block address of the group's first
+ * pcluster less one. Heads do not store their block address: it is found
+ * by counting the pclusters before them in the group.
+ */
+static int z_erofs_load_compact_lcluster(struct z_erofs_maprecorder *m,
+					 u64 lcn)
+{
+	struct erofs_inode *inode = m->inode;
+	const unsigned int lclusterbits = inode->z_lclusterbits;
+	const unsigned int lobits = max(lclusterbits, 12U);
+	const u64 ebase = z_erofs_mapbase(inode) +
+			  sizeof(struct z_erofs_map_header);
+	const u64 totalidx = DIV_ROUND_UP(inode->size, 1ULL << lclusterbits);
+	unsigned int compacted_4b_initial, compacted_2b;
+	unsigned int amortizedshift, vcnt, packsize, encodebits;
+	unsigned int lo, nblk;
+	u64 idx = lcn, pos;
+	u8 in[32], type;
+	int i, ret;
+
+	if (lcn >= totalidx)
+		return -EFSCORRUPTED;
+
+	/* 4-byte indexes until the 2-byte packs are 32-byte aligned */
+	compacted_4b_initial = ((32 - ebase % 32) / 4) & 7;
+	if ((inode->z_advise & Z_EROFS_ADVISE_COMPACTED_2B) &&
+	    compacted_4b_initial < totalidx)
+		compacted_2b = rounddown(totalidx - compacted_4b_initial, 16);
+	else
+		compacted_2b = 0;
+
+	pos = ebase;
+	amortizedshift = 2;
+	if (idx >= compacted_4b_initial) {
+		pos += compacted_4b_initial * 4;
+		idx -= compacted_4b_initial;
+		if (idx < compacted_2b) {
+			amortizedshift = 1;
+		} else {
+			pos += compacted_2b * 2;
+			idx -= compacted_2b;
+		}
+	}
+	pos += idx << amortizedshift;
+
+	vcnt = amortizedshift == 1 ? 16 : 2;
+	packsize = vcnt << amortizedshift;
+	encodebits = (packsize - sizeof(__le32)) * 8 / vcnt;
+	ret = erofs_read_meta(in, rounddown(pos, packsize), packsize);
+	if (ret)
+		return ret;
+	i = (pos % packsize) >> amortizedshift;
+
+	m->lcn = lcn;
+	lo = decode_compactedbits(lobits, in, encodebits * i, &type);
+	m->type = type;
+	if (type == Z_EROFS_LCLUSTER_TYPE_NONHEAD) {
+		m->clusterofs = 1 << lclusterbits;
+		if (lo & Z_EROFS_LI_D0_CBLKCNT)
+			return -EOPNOTSUPP;
+		if (i + 1 != vcnt) {
+			m->delta0 = lo;
+			return 0;
+		}
+		/*
+		 * The last lcluster of a pack stores the distance to the next
+		 * head instead, so derive it from the previous lcluster.
+		 */
+		lo = decode_compactedbits(lobits, in, encodebits * (i - 1),
+					  &type);
+		if (type != Z_EROFS_LCLUSTER_TYPE_NONHEAD)
+			lo = 0;
+		m->delta0 = lo + 1;
+		return 0;
+	}
+
+	m->clusterofs = lo;
+	m->delta0 = 0;
+	nblk = 1;
+	while (i > 0) {
+		--i;
+		lo = decode_compactedbits(lobits, in, encodebits * i, &type);
+		if (type == Z_EROFS_LCLUSTER_TYPE_NONHEAD)
+			i -= lo;
+		if (i >= 0)
+			++nblk;
+	}
+	m->pblk = get_unaligned_le32(in + packsize - sizeof(__le32)) + nblk;
+
+	return 0;
+}
+
+static int z_erofs_load_lcluster(struct z_erofs_maprecorder *m, u64 lcn)
+{
+	if (m->inode->datalayout == EROFS_INODE_COMPRESSED_FULL)
+		return z_erofs_load_full_lcluster(m, lcn);
+
+	return z_erofs_load_compact_lcluster(m, lcn);
+}
+
+static u64 z_erofs_lcluster_start(struct z_erofs_maprecorder *m)
+{
+	return (m->lcn << m->inode->z_lclusterbits) | m->clusterofs;
+}
+
+int z_erofs_map_blocks(struct erofs_inode *inode, struct erofs_map *map)
+{
+	struct z_erofs_maprecorder m = { .inode = inode };
+	unsigned int lclusterbits, alg;
+	u64 ofs = map->la, totalidx, lcn, end;
+	u8 headtype;
+	u32 pblk;
+	int ret;
+
+	ret = z_erofs_fill_inode(inode);
+	if (ret)
+		return ret;
+	if (ofs >= inode->size)
+		return -EINVAL;
+
+	lclusterbits = inode->z_lclusterbits;
+	ret = z_erofs_load_lcluster(&m, ofs >> lclusterbits);
+	if (ret)
+		return ret;
+
+	/* walk back to the head of the extent containing ofs */
+	if (m.type != Z_EROFS_LCLUSTER_TYPE_NONHEAD &&
+	    z_erofs_lcluster_start(&m) > ofs)
+		m.delta0 = 1;
+	while (m.type == Z_EROFS_LCLUSTER_TYPE_NONHEAD || m.delta0) {
+		if (!m.delta0 || m.delta0 > m.lcn)
+			return -EFSCORRUPTED;
+		ret = z_erofs_load_lcluster(&m, m.lcn - m.delta0);
+		if (ret)
+			return ret;
+	}
+	map->la = z_erofs_lcluster_start(&m);
+	headtype = m.type;
+	pblk = m.pblk;
+
+	/* and forward to the next head, which ends it */
+	end = inode->size;
+	totalidx = DIV_ROUND_UP(inode->size, 1ULL << lclusterbits);
+	for (lcn = ofs >> lclusterbits; lcn < totalidx; lcn++) {
+		ret = z_erofs_load_lcluster(&m, lcn);
+		if (ret)
+			return ret;
+		if (m.type != Z_EROFS_LCLUSTER_TYPE_NONHEAD &&
+		    z_erofs_lcluster_start(&m) > ofs) {
+			end = min(end, z_erofs_lcluster_start(&m));
+			break;
+		}
+	}
+
+	map->llen = end - map->la;
+	map->pa = erofs_pos(pblk);
+	switch (headtype) {
+	case Z_EROFS_LCLUSTER_TYPE_PLAIN:
+		map->flags = 0;
+		if (inode->z_advise & Z_EROFS_ADVISE_INTERLACED_PCLUSTER)
+			map->flags |= EROFS_MAP_INTERLACED;
+		return 0;
+	case Z_EROFS_LCLUSTER_TYPE_HEAD1:
+		alg = inode->z_algorithmtype & 0xf;
+		break;
+	default:
+		alg = inode->z_algorithmtype >> 4;
+		break;
+	}
+	if (alg != Z_EROFS_COMPRESSION_LZ4) {
+		log_debug("nid %llu: compression algorithm %u not supported\n",
+			  inode->nid, alg);
+		return -EOPNOTSUPP;
+	}
+	map->flags = EROFS_MAP_ZIPPED;
+
+	return 0;
+}
@@ -116,6 +116,7 @@
 #include <flash.h>
 #include <malloc.h>
 #include <div64.h>
+#include <sort.h>
 #include <linux/compiler.h>
 #include <linux/stat.h>
 #include <linux/time.h>
@@ -653,11 +654,88 @@ jffs2_free_cache(struct part_info *part)
 		pL = (struct b_lists *)part->jffs2_priv;
 		free_nodes(&pL->frag);
 		free_nodes(&pL->dir);
+		free(pL->frag_index);
 		free(pL->readbuf);
 		free(pL);
+		part->jffs2_priv = NULL;
 	}
 }
 
+/* Order fragments by inode, then version, then position on flash */
+static int compare_frag_index(const void *a, const void *b)
+{
+	const struct b_node *x = *(const struct b_node **)a;
+	const struct b_node *y = *(const struct b_node **)b;
+
+	if (x->ino != y->ino)
+		return x->ino < y->ino ? -1 : 1;
+	if (x->version != y->version)
+		return x->version < y->version ? -1 : 1;
+	if (x->offset != y->offset)
+		return x->offset < y->offset ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Build a sorted array of the fragment list, so that reading a file only
+ * visits its own fragments, already in the order they must be applied.
+ */
+static int
+jffs2_1pass_index_frags(struct b_lists *pL)
+{
+	struct b_node **index;
+	struct b_node *b;
+	u32 i = 0;
+
+	/* No file data at all, e.g. a file system with only directories */
+	if (!pL->frag.listCount) {
+		pL->frag_index = NULL;
+		return 0;
+	}
+
+	index = malloc(pL->frag.listCount * sizeof(*index));
+	if (!index)
+		return -ENOMEM;
+	for (b = pL->frag.listHead; b != NULL; b = b->next)
+		index[i++] = b;
+	qsort(index, i, sizeof(*index), compare_frag_index);
+	pL->frag_index = index;
+
+	return 0;
+}
+
+/*
+ * Find the fragments of an inode in the index. Returns the number found and
+ * sets @firstp to the oldest one.
+ */
+static u32
+jffs2_1pass_find_frags(struct b_lists *pL, u32 inode, struct b_node ***firstp)
+{
+	struct b_node **index = pL->frag_index;
+	u32 lo = 0, hi = pL->frag.listCount;
+	u32 mid, n;
+
+	if (!index) {
+		*firstp = NULL;
+		return 0;
+	}
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (index[mid]->ino < inode)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (n = 0; lo + n < pL->frag.listCount; n++) {
+		if (index[lo + n]->ino != inode)
+			break;
+	}
+	*firstp = &index[lo];
+
+	return n;
+}
+
 static u32
 jffs_init_1pass_list(struct part_info *part)
 {
@@ -677,18 +755,20 @@ jffs_init_1pass_list(struct part_info *part)
 	return 0;
 }
 
-/* find the inode from the slashless name given a parent */
+/* read the data of an inode into dest, or just get its size if dest is NULL */
 static long
 jffs2_1pass_read_inode(struct b_lists *pL, u32 inode, char *dest)
 {
+	struct b_node **frags;
 	struct b_node *b;
 	struct jffs2_raw_inode *jNode;
 	u32 totalSize = 0;
-	u32 latestVersion = 0;
+	u32 nfrags, n;
 	uchar *lDest;
 	uchar *src;
 	int i;
-	u32 counter = 0;
+
+	nfrags = jffs2_1pass_find_frags(pL, inode, &frags);
 
 	/* Find file size before loading any data, so fragments that
 	 * start past the end of file can be ignored. A fragment
@@ -697,19 +777,10 @@ jffs2_1pass_read_inode(struct b_lists *pL, u32 inode, char *dest)
 	 * This shouldn't cause trouble when loading kernel images, so
 	 * we will live with it.
 	 */
-	int latestOffset = -1;
-	for (b = pL->frag.listHead; b != NULL; b = b->next) {
-		if (inode == b->ino) {
-			/* get actual file length from the newest node */
-			if (b->version >= latestVersion) {
-				latestVersion = b->version;
-				latestOffset = b->offset;
-			}
-		}
-	}
-
-	if (latestOffset >= 0) {
-		jNode = (struct jffs2_raw_inode *)get_fl_mem(latestOffset,
+	if (nfrags) {
+		/* get actual file length from the newest node */
+		jNode = (struct jffs2_raw_inode *)get_fl_mem(
+			frags[nfrags - 1]->offset,
 			sizeof(struct jffs2_raw_inode), pL->readbuf);
 		totalSize = jNode->isize;
 		put_fl_mem(jNode, pL->readbuf);
@@ -722,99 +793,73 @@ jffs2_1pass_read_inode(struct b_lists *pL, u32 inode, char *dest)
 	if (!dest)
 		return totalSize;
 
-	for (b = pL->frag.listHead; b != NULL; b = b->next) {
-		if (inode == b->ino) {
-			/*
-			 * Copy just the node and not the data at this point,
-			 * since we don't yet know if we need this data.
-			 */
-			jNode = (struct jffs2_raw_inode *)get_fl_mem(b->offset,
-					sizeof(struct jffs2_raw_inode),
-					pL->readbuf);
-#if 0
-			putLabeledWord("\r\n\r\nread_inode: totlen = ", jNode->totlen);
-			putLabeledWord("read_inode: inode = ", jNode->ino);
-			putLabeledWord("read_inode: version = ", jNode->version);
-			putLabeledWord("read_inode: isize = ", jNode->isize);
-			putLabeledWord("read_inode: offset = ", jNode->offset);
-			putLabeledWord("read_inode: csize = ", jNode->csize);
-			putLabeledWord("read_inode: dsize = ", jNode->dsize);
-			putLabeledWord("read_inode: compr = ", jNode->compr);
-			putLabeledWord("read_inode: usercompr = ", jNode->usercompr);
-			putLabeledWord("read_inode: flags = ", jNode->flags);
-#endif
+	/*
+	 * Fragments are in version order, so newer data is copied over any
+	 * older data it overlaps.
+	 */
+	for (n = 0; n < nfrags; n++) {
+		b = frags[n];
 
-			if(dest) {
-				/*
-				 * Now that the inode has been checked,
-				 * read the entire inode, including data.
-				 */
-				put_fl_mem(jNode, pL->readbuf);
-				jNode = (struct jffs2_raw_inode *)
-					get_node_mem(b->offset, pL->readbuf);
-				src = ((uchar *)jNode) +
-					sizeof(struct jffs2_raw_inode);
-				/* ignore data behind latest known EOF */
-				if (jNode->offset > totalSize) {
-					put_fl_mem(jNode, pL->readbuf);
-					continue;
-				}
-				if (b->datacrc == CRC_UNKNOWN)
-					b->datacrc = data_crc(jNode) ?
-						CRC_OK : CRC_BAD;
-				if (b->datacrc == CRC_BAD) {
-					put_fl_mem(jNode, pL->readbuf);
-					continue;
-				}
+		/*
+		 * Copy just the node and not the data at this point,
+		 * since we don't yet know if we need this data.
+		 */
+		jNode = (struct jffs2_raw_inode *)get_fl_mem(b->offset,
+				sizeof(struct jffs2_raw_inode), pL->readbuf);
+		/* ignore data behind latest known EOF */
+		if (jNode->offset > totalSize) {
+			put_fl_mem(jNode, pL->readbuf);
+			continue;
+		}
 
-				lDest = (uchar *) (dest + jNode->offset);
-#if 0
-				putLabeledWord("read_inode: src = ", src);
-				putLabeledWord("read_inode: dest = ", lDest);
-#endif
-				switch (jNode->compr) {
-				case JFFS2_COMPR_NONE:
-					ldr_memcpy(lDest, src, jNode->dsize);
-					break;
-				case JFFS2_COMPR_ZERO:
-					for (i = 0; i < jNode->dsize; i++)
-						*(lDest++) = 0;
-					break;
-				case JFFS2_COMPR_RTIME:
-					rtime_decompress(src, lDest, jNode->csize, jNode->dsize);
-					break;
-				case JFFS2_COMPR_DYNRUBIN:
-					/* this is slow but it works */
-					dynrubin_decompress(src, lDest, jNode->csize, jNode->dsize);
-					break;
-				case JFFS2_COMPR_ZLIB:
-					zlib_decompress(src, lDest, jNode->csize, jNode->dsize);
-					break;
-#if defined(CONFIG_JFFS2_LZO)
-				case JFFS2_COMPR_LZO:
-					lzo_decompress(src, lDest, jNode->csize, jNode->dsize);
-					break;
-#endif
-				default:
-					/* unknown */
-					putLabeledWord("UNKNOWN COMPRESSION METHOD = ", jNode->compr);
-					put_fl_mem(jNode, pL->readbuf);
-					return -1;
-					break;
-				}
-			}
+		/*
+		 * Now that the inode has been checked,
+		 * read the entire inode, including data.
+		 */
+		put_fl_mem(jNode, pL->readbuf);
+		jNode = (struct jffs2_raw_inode *)get_node_mem(b->offset,
+							       pL->readbuf);
+		src = ((uchar *)jNode) + sizeof(struct jffs2_raw_inode);
+		if (b->datacrc == CRC_UNKNOWN)
+			b->datacrc = data_crc(jNode) ? CRC_OK : CRC_BAD;
+		if (b->datacrc == CRC_BAD) {
+			put_fl_mem(jNode, pL->readbuf);
+			continue;
+		}
 
-#if 0
-			putLabeledWord("read_inode: totalSize = ", totalSize);
+		lDest = (uchar *) (dest + jNode->offset);
+		switch (jNode->compr) {
+		case JFFS2_COMPR_NONE:
+			ldr_memcpy(lDest, src, jNode->dsize);
+			break;
+		case JFFS2_COMPR_ZERO:
+			for (i = 0; i < jNode->dsize; i++)
+				*(lDest++) = 0;
+			break;
+		case JFFS2_COMPR_RTIME:
+			rtime_decompress(src, lDest, jNode->csize, jNode->dsize);
+			break;
+		case JFFS2_COMPR_DYNRUBIN:
+			/* this is slow but it works */
+			dynrubin_decompress(src, lDest, jNode->csize, jNode->dsize);
+			break;
+		case JFFS2_COMPR_ZLIB:
+			zlib_decompress(src, lDest, jNode->csize, jNode->dsize);
+			break;
+#if defined(CONFIG_JFFS2_LZO)
+		case JFFS2_COMPR_LZO:
+			lzo_decompress(src, lDest, jNode->csize, jNode->dsize);
+			break;
 #endif
+		default:
+			/* unknown */
+			putLabeledWord("UNKNOWN COMPRESSION METHOD = ", jNode->compr);
 			put_fl_mem(jNode, pL->readbuf);
+			return -1;
 		}
-		counter++;
+		put_fl_mem(jNode, pL->readbuf);
 	}
 
-#if 0
-	putLabeledWord("read_inode: returning = ", totalSize);
-#endif
 	return totalSize;
 }
 
@@ -957,10 +1002,10 @@ jffs2_1pass_list_inodes(struct b_lists * pL, u32 pino)
 
 	for (b = pL->dir.listHead; b; b = b->next) {
 		if (pino == b->pino) {
-			u32 i_version = 0;
-			int i_offset = -1;
+			u32 i_offset;
 			struct jffs2_raw_inode *jNode = NULL;
-			struct b_node *b2;
+			struct b_node **frags;
+			u32 nfrags;
 
 			jDir = (struct jffs2_raw_dirent *)
 				get_node_mem(b->offset, pL->readbuf);
@@ -994,15 +1039,10 @@ jffs2_1pass_list_inodes(struct b_lists * pL, u32 pino)
 				continue;
 			}
 
-			for (b2 = pL->frag.listHead; b2; b2 = b2->next) {
-				if (b2->ino == jDir->ino &&
-				    b2->version >= i_version) {
-					i_version = b2->version;
-					i_offset = b2->offset;
-				}
-			}
-
-			if (i_version >= 0) {
+			/* the newest fragment has the current attributes */
+			nfrags = jffs2_1pass_find_frags(pL, jDir->ino, &frags);
+			if (nfrags) {
+				i_offset = frags[nfrags - 1]->offset;
 				if (jDir->type == DT_LNK)
 					jNode = get_node_mem(i_offset, NULL);
 				else
@@ -1080,9 +1120,10 @@ static u32
 jffs2_1pass_resolve_inode(struct b_lists * pL, u32 ino)
 {
 	struct b_node *b;
-	struct b_node *b2;
+	struct b_node **frags;
 	struct jffs2_raw_dirent *jDir;
 	struct jffs2_raw_inode *jNode;
+	u32 nfrags;
 	u8 jDirFoundType = 0;
 	u32 jDirFoundIno = 0;
 	u32 jDirFoundPino = 0;
@@ -1121,25 +1162,13 @@ jffs2_1pass_resolve_inode(struct b_lists * pL, u32 ino)
 		return jDirFoundIno;
 
 	/* it's a soft link so we follow it again. */
-	b2 = pL->frag.listHead;
-	while (b2) {
-		jNode = (struct jffs2_raw_inode *) get_node_mem(b2->offset,
-								pL->readbuf);
-		if (jNode->ino == jDirFoundIno) {
-			src = (unsigned char *)jNode + sizeof(struct jffs2_raw_inode);
-
-#if 0
-			putLabeledWord("\t\t dsize = ", jNode->dsize);
-			putstr("\t\t target = ");
-			putnstr(src, jNode->dsize);
-			putstr("\r\n");
-#endif
-			strncpy(tmp, (char *)src, jNode->dsize);
-			tmp[jNode->dsize] = '\0';
-			put_fl_mem(jNode, pL->readbuf);
-			break;
-		}
-		b2 = b2->next;
+	nfrags = jffs2_1pass_find_frags(pL, jDirFoundIno, &frags);
+	if (nfrags) {
+		jNode = (struct jffs2_raw_inode *)
+			get_node_mem(frags[nfrags - 1]->offset, pL->readbuf);
+		src = (unsigned char *)jNode + sizeof(struct jffs2_raw_inode);
+		strncpy(tmp, (char *)src, jNode->dsize);
+		tmp[jNode->dsize] = '\0';
 		put_fl_mem(jNode, pL->readbuf);
 	}
 	/* ok so the name of the new file to find is in tmp */
@@ -1263,8 +1292,9 @@ static u16 sum_get_unaligned16(u16 *ptr)
 
 static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 				struct jffs2_raw_summary *summary,
-				struct b_lists *pL)
+				struct b_lists *pL, u32 *max_totlen)
 {
+	u32 totlen;
 	void *sp;
 	int i, pass;
 	struct b_node *b;
@@ -1294,6 +1324,10 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 						b->ino = sum_get_unaligned32(
 							&spi->inode);
 						b->datacrc = CRC_UNKNOWN;
+						totlen = sum_get_unaligned32(
+							&spi->totlen);
+						if (*max_totlen < totlen)
+							*max_totlen = totlen;
 					}
 
 					sp += JFFS2_SUMMARY_INODE_SIZE;
@@ -1316,6 +1350,10 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 						b->pino = sum_get_unaligned32(
 							&spd->pino);
 						b->datacrc = CRC_UNKNOWN;
+						totlen = sum_get_unaligned32(
+							&spd->totlen);
+						if (*max_totlen < totlen)
+							*max_totlen = totlen;
 					}
 
 					sp += JFFS2_SUMMARY_DIRENT_SIZE(
@@ -1340,10 +1378,11 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 	return 0;
 }
 
-/* Process the summary node - called from jffs2_scan_eraseblock() */
-int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
-			   struct jffs2_raw_summary *summary, uint32_t sumsize,
-			   struct b_lists *pL)
+/* Process the summary node - called from jffs2_1pass_build_lists() */
+static int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
+				  struct jffs2_raw_summary *summary,
+				  uint32_t sumsize, struct b_lists *pL,
+				  u32 *max_totlen)
 {
 	struct jffs2_unknown_node crcnode;
 	int ret, __maybe_unused ofs;
@@ -1390,7 +1429,8 @@ int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
 	if (summary->cln_mkr)
 		dbg_summary("Summary : CLEANMARKER node \n");
 
-	ret = jffs2_sum_process_sum_data(part, offset, summary, pL);
+	ret = jffs2_sum_process_sum_data(part, offset, summary, pL,
+					 max_totlen);
 	if (ret == -EBADMSG)
 		return 0;
 	if (ret)
@@ -1535,7 +1575,11 @@ jffs2_1pass_build_lists(struct part_info * part)
 				buf_len, buf_len, buf + buf_size - buf_len);
 
 		sm = (void *)buf + buf_size - sizeof(*sm);
-		if (sm->magic == JFFS2_SUM_MAGIC) {
+		/* A summary that does not fit in the block is ignored */
+		if (sm->magic == JFFS2_SUM_MAGIC &&
+		    sm->offset < part->sector_size &&
+		    part->sector_size - sm->offset >=
+		    JFFS2_SUMMARY_FRAME_SIZE) {
 			sumlen = part->sector_size - sm->offset;
 			sumptr = buf + buf_size - sumlen;
 
@@ -1565,7 +1609,7 @@ jffs2_1pass_build_lists(struct part_info * part)
 
 		if (sumptr) {
 			ret = jffs2_sum_scan_sumnode(part, sector_ofs, sumptr,
-					sumlen, pL);
+					sumlen, pL, &max_totlen);
 
 			if (buf_size && sumlen > buf_size)
 				free(sumptr);
@@ -1823,6 +1867,11 @@ jffs2_1pass_build_lists(struct part_info * part)
 	sort_list(&pL->frag);
 	sort_list(&pL->dir);
 #endif
+	if (jffs2_1pass_index_frags(pL)) {
+		putstr("Can't get memory for fragment index!\n");
+		jffs2_free_cache(part);
+		return 0;
+	}
 	putstr("\b\b done.\r\n");		/* close off the dots */
 
 	/* We don't care if malloc failed - then each read operation will
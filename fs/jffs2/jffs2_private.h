@@ -31,6 +31,8 @@ struct b_lists {
 	struct b_list dir;
 	struct b_list frag;
 	void *readbuf;
+	/* frag nodes sorted by inode, then version (oldest first) */
+	struct b_node **frag_index;
 };
 
 struct b_compr_info {
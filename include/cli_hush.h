@@ -20,6 +20,14 @@ int set_local_var(const char *s, int flg_export);
 void unset_local_var(const char *name);
 char *get_local_var(const char *s);
 
+/**
+ * hush_parse_cache_stats() - Get the number of lookups in the parse cache
+ *
+ * @hits: Returns the number of scripts which were found already parsed
+ * @misses: Returns the number of scripts which had to be parsed
+ */
+void hush_parse_cache_stats(ulong *hits, ulong *misses);
+
 #if defined(CONFIG_HUSH_INIT_VAR)
 extern int hush_init_var (void);
 #endif
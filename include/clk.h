@@ -394,6 +394,34 @@ int clk_free(struct clk *clk);
  */
 ulong clk_get_rate(struct clk *clk);
 
+/**
+ * struct clk_rate_stats - Statistics of the clock rate cache
+ *
+ * @queries:		Number of clk_get_rate() calls
+ * @hits:		Number of queries answered from a cached rate
+ * @invalidations:	Number of cached rates dropped after a clock was
+ *			reconfigured
+ */
+struct clk_rate_stats {
+	ulong queries;
+	ulong hits;
+	ulong invalidations;
+};
+
+#if CONFIG_IS_ENABLED(CLK_RATE_STATS)
+/**
+ * clk_get_rate_stats() - Get statistics of the clock rate cache
+ *
+ * @stats:	Returns the current statistics
+ */
+void clk_get_rate_stats(struct clk_rate_stats *stats);
+
+/**
+ * clk_reset_rate_stats() - Reset statistics of the clock rate cache
+ */
+void clk_reset_rate_stats(void);
+#endif
+
 /**
  * clk_get_parent() - Get current clock's parent.
  *
@@ -107,6 +107,19 @@ struct virt_internal_data {
 #define DFU_MANIFEST_POLL_TIMEOUT	DFU_DEFAULT_POLL_TIMEOUT
 #endif
 
+/**
+ * struct dfu_stats - throughput of a DFU write transaction
+ *
+ * @bytes:	number of bytes written to the medium
+ * @write_ms:	time spent writing to the medium, in ms
+ * @start:	timer value at the start of the transaction
+ */
+struct dfu_stats {
+	u64 bytes;
+	ulong write_ms;
+	ulong start;
+};
+
 struct dfu_entity {
 	char			name[DFU_NAME_SIZE];
 	int                     alt;
@@ -151,6 +164,12 @@ struct dfu_entity {
 
 	u32 bad_skip;	/* for nand use */
 
+	/* size of the full buffer waiting to be written, if deferred */
+	long p_size;
+	int w_err;	/* error from writing it */
+
+	struct dfu_stats stats;
+
 	unsigned int inited:1;
 };
 
@@ -417,6 +436,68 @@ static inline void dfu_set_defer_flush(struct dfu_entity *dfu)
 	dfu_defer_flush = dfu;
 }
 
+#ifdef CONFIG_DFU_DEFERRED_WRITE
+/**
+ * dfu_set_deferred_write() - enable writing a full buffer later
+ *
+ * When enabled, dfu_write() does not write a full buffer to the medium but
+ * leaves it to dfu_write_pending(), so that the USB transfer which filled it
+ * can complete first. The caller must then call dfu_write_pending()
+ * regularly; the next dfu_write() writes the buffer itself if that has not
+ * happened yet. Disabling it writes out the pending buffer.
+ *
+ * @enable:	true to enable
+ */
+void dfu_set_deferred_write(bool enable);
+
+/**
+ * dfu_get_pending_write() - get the entity with a buffer waiting to be written
+ *
+ * Return:	dfu entity, or NULL if there is nothing to write
+ */
+struct dfu_entity *dfu_get_pending_write(void);
+
+/**
+ * dfu_get_pending_write_ms() - estimate the time to write the pending buffer
+ *
+ * The estimate is based on the throughput of the medium in the current
+ * transaction.
+ *
+ * @dfu:	dfu entity
+ * Return:	time in ms, or 0 if nothing is pending for @dfu or unknown
+ */
+unsigned int dfu_get_pending_write_ms(struct dfu_entity *dfu);
+
+/**
+ * dfu_write_pending() - write the buffer waiting to be written
+ *
+ * An error is also reported by the next dfu_write() or dfu_flush() for the
+ * entity.
+ *
+ * Return:	0 on success, other value on failure
+ */
+int dfu_write_pending(void);
+#else
+static inline void dfu_set_deferred_write(bool enable)
+{
+}
+
+static inline struct dfu_entity *dfu_get_pending_write(void)
+{
+	return NULL;
+}
+
+static inline unsigned int dfu_get_pending_write_ms(struct dfu_entity *dfu)
+{
+	return 0;
+}
+
+static inline int dfu_write_pending(void)
+{
+	return 0;
+}
+#endif
+
 /**
  * dfu_write_from_mem_addr() - write data from memory to DFU managed medium
  *
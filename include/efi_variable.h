@@ -145,6 +145,20 @@ struct efi_var_file {
  */
 efi_status_t efi_var_to_file(void);
 
+/**
+ * efi_var_to_file_update() - persist update of a non-volatile variable
+ *
+ * With CONFIG_EFI_VARIABLE_FILE_JOURNAL=y only a record describing the
+ * variable is appended to file ubootefi.var. Otherwise all non-volatile
+ * variables are written via efi_var_to_file().
+ *
+ * @variable_name:	name of the updated variable
+ * @vendor:		GUID of the updated variable
+ * Return:		status code
+ */
+efi_status_t efi_var_to_file_update(const u16 *variable_name,
+				    const efi_guid_t *vendor);
+
 /**
  * efi_var_collect() - collect variables in buffer
  *
@@ -172,6 +186,21 @@ efi_status_t __maybe_unused efi_var_collect(struct efi_var_file **bufp, loff_t *
  */
 efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe);
 
+/**
+ * efi_var_restore_records() - restore EFI variables from a file's records
+ *
+ * The records, each a struct efi_var_file, are restored in order, so later
+ * ones replace the variables set by earlier ones. A record holding a variable
+ * without data deletes it. Secure boot related and volatile variables are
+ * skipped, as with efi_var_restore() when @safe is false.
+ *
+ * @buf:	contents of file ubootefi.var
+ * @len:	length of the file
+ * Return:	number of bytes restored, less than @len if the file ends in an
+ *		invalid or incomplete record
+ */
+loff_t efi_var_restore_records(struct efi_var_file *buf, loff_t len);
+
 /**
  * efi_var_from_file() - read variables from file
  *
@@ -33,4 +33,12 @@ extern void (*fastboot_progress_callback)(const char *msg);
  */
 void fastboot_getvar(char *cmd_parameter, char *response);
 
+/**
+ * fastboot_download_max() - Return the largest download that is accepted
+ *
+ * Return: size of the download buffer, or U32_MAX if the next download is
+ * written to storage as it arrives
+ */
+u32 fastboot_download_max(void);
+
 #endif
@@ -32,6 +32,36 @@ int fastboot_mmc_get_part_info(const char *part_name,
  */
 void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 			      u32 download_bytes, char *response);
+
+/**
+ * fastboot_mmc_stream_start() - Prepare to write an image as it downloads
+ *
+ * @cmd: Named partition to write image to
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve on error
+ */
+int fastboot_mmc_stream_start(const char *cmd, char *response);
+
+/**
+ * fastboot_mmc_stream_write() - Write the next part of a streamed image
+ *
+ * @data: Image data
+ * @len: Number of bytes at @data
+ * @last: true if this is the end of the image
+ * @response: Pointer to fastboot response buffer
+ * Return: number of bytes used, or -1 on error
+ */
+long fastboot_mmc_stream_write(void *data, size_t len, bool last,
+			       char *response);
+
+/**
+ * fastboot_mmc_stream_finish() - Finish writing a streamed image
+ *
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -1 on error
+ */
+int fastboot_mmc_stream_finish(char *response);
+
 /**
  * fastboot_mmc_flash_erase() - Erase eMMC for fastboot
  *
@@ -119,6 +119,11 @@ struct fdt_region_state {
  *
  * The device tree header is not included in the list.
  *
+ * The tree is scanned once. Node paths are looked up in a hash table built
+ * from @inc, so the time taken does not depend on the number of nodes
+ * included. Since the table is on the stack, @inc_count should be kept to a
+ * few hundred.
+ *
  * @fdt:	Device tree to check
  * @inc:	List of node paths to included
  * @inc_count:	Number of node paths in list
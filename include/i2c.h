@@ -203,6 +203,27 @@ int dm_i2c_read(struct udevice *dev, uint offset, uint8_t *buffer, int len);
 int dm_i2c_write(struct udevice *dev, uint offset, const uint8_t *buffer,
 		 int len);
 
+/**
+ * dm_i2c_write_pages() - write bytes to a paged I2C chip such as an EEPROM
+ *
+ * The data is split at page boundaries, since a write that runs over the
+ * end of a page wraps around to its start on these chips. After each page
+ * the chip is probed, as by 'i2c probe', until it ACKs again, which is
+ * normally much sooner than the worst-case write cycle time.
+ *
+ * @dev:	Chip to write to
+ * @offset:	Offset within chip to start writing
+ * @buffer:	Buffer containing data to write
+ * @len:	Number of bytes to write
+ * @pagesize:	Page size of the chip in bytes, must be a power of two
+ * @timeout_ms:	Maximum time to wait for each page to be written
+ *
+ * Return: 0 on success, -EINVAL if @pagesize is invalid, -ETIMEDOUT if the
+ * chip did not complete a page write in time, other -ve on failure
+ */
+int dm_i2c_write_pages(struct udevice *dev, uint offset, const uint8_t *buffer,
+		       int len, uint pagesize, uint timeout_ms);
+
 /**
  * dm_i2c_probe() - probe a particular chip address
  *
@@ -24,9 +24,57 @@ struct sparse_storage {
 				 lbaint_t blk,
 				 lbaint_t blkcnt);
 
+	/*
+	 * Optional: erase blocks so that they read back as zero. Only whole
+	 * erase groups of @erase_blks blocks are passed in.
+	 */
+	lbaint_t	(*erase)(struct sparse_storage *info,
+				 lbaint_t blk,
+				 lbaint_t blkcnt);
+	lbaint_t	erase_blks;
+
 	void		(*mssg)(const char *str, char *response);
 };
 
+/**
+ * struct sparse_stream - Sparse image being written as it arrives
+ *
+ * @info:	Storage to write to
+ * @part_name:	Name of the partition, for messages
+ * @state:	Parser state
+ * @header:	Sparse file header
+ * @chunk:	Number of chunks processed
+ * @left:	Bytes left of the current RAW data, or to skip
+ * @blk:	Next block to write, following any data in @buf
+ * @bytes_written: Number of bytes written
+ * @total_blocks: Number of sparse blocks processed
+ * @buf:	Bounce buffer for RAW data which is not aligned for DMA
+ * @buf_blks:	Size of @buf in blocks
+ * @pend_blk:	Block to write the data in @buf to
+ * @pend_count:	Number of blocks of data in @buf
+ * @fill_buf:	Buffer for writing FILL chunks
+ * @fill_blks:	Size of @fill_buf in blocks
+ * @fill_val:	Value @fill_buf is filled with
+ */
+struct sparse_stream {
+	struct sparse_storage	*info;
+	const char		*part_name;
+	int			state;
+	sparse_header_t		header;
+	uint32_t		chunk;
+	uint64_t		left;
+	lbaint_t		blk;
+	uint64_t		bytes_written;
+	uint32_t		total_blocks;
+	char			*buf;
+	lbaint_t		buf_blks;
+	lbaint_t		pend_blk;
+	lbaint_t		pend_count;
+	uint32_t		*fill_buf;
+	lbaint_t		fill_blks;
+	uint32_t		fill_val;
+};
+
 static inline int is_sparse_image(void *buf)
 {
 	sparse_header_t *s_header = (sparse_header_t *)buf;
@@ -40,3 +88,44 @@ static inline int is_sparse_image(void *buf)
 
 int write_sparse_image(struct sparse_storage *info, const char *part_name,
 		       void *data, char *response);
+
+/**
+ * sparse_stream_start() - Start writing a sparse image piece by piece
+ *
+ * @ss:		Stream state to set up
+ * @info:	Storage to write to
+ * @part_name:	Name of the partition, for messages
+ */
+void sparse_stream_start(struct sparse_stream *ss, struct sparse_storage *info,
+			 const char *part_name);
+
+/**
+ * sparse_stream_write() - Write the next piece of a sparse image
+ *
+ * Headers are only processed once they are complete and RAW data is written
+ * in whole storage blocks, so not all of @data may be used. The caller must
+ * pass the rest again, followed by more data. Data after the last chunk is
+ * an error.
+ *
+ * @ss:		Stream state
+ * @data:	Next part of the image
+ * @len:	Number of bytes at @data, or SIZE_MAX if the image is complete
+ *		but its length is unknown, in which case nothing after the last
+ *		chunk is looked at
+ * @response:	Pointer to fastboot response buffer, for errors
+ * Return: number of bytes used, or -1 on error
+ */
+long sparse_stream_write(struct sparse_stream *ss, const void *data,
+			 size_t len, char *response);
+
+/**
+ * sparse_stream_finish() - Finish writing a sparse image
+ *
+ * This writes out any buffered data, checks that the whole image was seen
+ * and frees the buffers. It must be called even after an error.
+ *
+ * @ss:		Stream state
+ * @response:	Pointer to fastboot response buffer, for errors
+ * Return: 0 if OK, -1 on error
+ */
+int sparse_stream_finish(struct sparse_stream *ss, char *response);
@@ -938,6 +938,7 @@ int booti_setup(ulong image, ulong *relocated_addr, ulong *size,
 #define FIT_FDT_PROP		"fdt"
 #define FIT_LOADABLE_PROP	"loadables"
 #define FIT_DEFAULT_PROP	"default"
+#define FIT_COMPAT_INDEX_PROP	"compat-index"
 #define FIT_SETUP_PROP		"setup"
 #define FIT_FPGA_PROP		"fpga"
 #define FIT_FIRMWARE_PROP	"firmware"
@@ -1021,6 +1022,19 @@ int fit_cipher_data(const char *keydir, void *keydest, void *fit,
 		    const char *comment, int require_keys,
 		    const char *engine_id, const char *cmdname);
 
+/**
+ * fit_add_compat_index() - Add a compatible index to the configurations
+ *
+ * This adds a FIT_COMPAT_INDEX_PROP property to the /configurations node,
+ * containing pairs of strings: a compatible string and the name of the first
+ * configuration which supports it. See fit_conf_find_compat() for how the
+ * compatible strings of a configuration are found.
+ *
+ * @fit:	Pointer to the FIT format image header
+ * Return: 0 if OK, -ENOSPC if the FIT needs to be enlarged, other -ve on error
+ */
+int fit_add_compat_index(void *fit);
+
 #define NODE_MAX_NAME_LEN	80
 
 /**
@@ -1110,6 +1124,21 @@ int fit_check_format(const void *fit, ulong size);
 
 int fit_conf_find_compat(const void *fit, const void *fdt);
 
+/**
+ * fit_conf_find_compat_index() - Look up a configuration in the compat index
+ *
+ * This uses the FIT_COMPAT_INDEX_PROP property added by mkimage to find the
+ * configuration for the first of the given compatible strings that has one.
+ *
+ * @fit:	Pointer to the FIT format image header
+ * @compat:	List of compatible strings to look for, most specific first
+ * @compat_len:	Length of @compat in bytes
+ * Return: offset of the configuration node, -ENOENT if the FIT has no index
+ *	or none of the strings are in it, -EINVAL if the index is invalid
+ */
+int fit_conf_find_compat_index(const void *fit, const char *compat,
+			       int compat_len);
+
 /**
  * fit_conf_get_node - get node offset for configuration of a given unit name
  * @fit: pointer to the FIT format image header
@@ -320,6 +320,20 @@ struct part_driver {
 	int (*get_info)(struct blk_desc *dev_desc, int part,
 			struct disk_partition *info);
 
+	/**
+	 * get_info_by_name() - Find a partition by name (optional)
+	 *
+	 * If this is not provided, get_info() is called for each partition
+	 * number in turn until the name matches.
+	 *
+	 * @dev_desc:	Block device descriptor
+	 * @name:	Partition name to look for
+	 * @info:	Returns partition information
+	 * @return partition number (1 = first), or -ENOENT if not found
+	 */
+	int (*get_info_by_name)(struct blk_desc *dev_desc, const char *name,
+				struct disk_partition *info);
+
 	/**
 	 * print() - Print partition information
 	 *
@@ -469,6 +483,35 @@ int get_disk_guid(struct blk_desc *dev_desc, char *guid);
 
 #endif
 
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+/**
+ * gpt_cache_invalidate() - Drop the cached GPTs of a block device
+ *
+ * This drops the GPTs read from all hardware partitions of the device. It
+ * must be called when the medium may have changed.
+ *
+ * @dev_desc:	Block device descriptor
+ */
+void gpt_cache_invalidate(struct blk_desc *dev_desc);
+
+/**
+ * gpt_cache_write() - Note a write to a block device
+ *
+ * The cached GPT of the device is dropped if the blocks written overlap the
+ * GPT header or partition entries, i.e. lie outside the usable area.
+ *
+ * @dev_desc:	Block device descriptor
+ * @start:	First block written
+ * @blkcnt:	Number of blocks written
+ */
+void gpt_cache_write(struct blk_desc *dev_desc, lbaint_t start,
+		     lbaint_t blkcnt);
+#else
+static inline void gpt_cache_invalidate(struct blk_desc *dev_desc) {}
+static inline void gpt_cache_write(struct blk_desc *dev_desc, lbaint_t start,
+				   lbaint_t blkcnt) {}
+#endif
+
 #if CONFIG_IS_ENABLED(DOS_PARTITION)
 /**
  * is_valid_dos_buf() - Ensure that a DOS MBR image is valid
@@ -713,11 +713,21 @@ extern void pci_cfgfunc_config_device(struct pci_controller* hose, pci_dev_t dev
  *	before relocation also. Some platforms set up static configuration in
  *	TPL/SPL to reduce code size and boot time, since these phases only know
  *	about a small subset of PCI devices. This is normally false.
+ * @scan_pending: true if the controller has been probed but its bus has not
+ *	been scanned yet, because pci_init() first waits for the links of all
+ *	controllers to come up (see link_up() in struct dm_pci_ops)
+ * @link_checked: true once link_up() has reported the link state of a
+ *	controller whose scan is pending
+ * @reserved_busno: Bus number kept for the first bus behind a controller
+ *	whose scan is pending, or 0 if none
  */
 struct pci_controller {
 	struct udevice *bus;
 	struct udevice *ctlr;
 	bool skip_auto_config_until_reloc;
+	bool scan_pending;
+	bool link_checked;
+	int reserved_busno;
 
 	int first_busno;
 	int last_busno;
@@ -939,6 +949,8 @@ struct udevice;
  * @vendor:	PCI vendor ID (see pci_ids.h)
  * @device:	PCI device ID (see pci_ids.h)
  * @class:	PCI class, 3 bytes: (base, sub, prog-if)
+ * @header_type: PCI header type read when the bus was scanned, or 0xff if
+ *	the device was not found by a bus scan
  * @is_virtfn:	True for Virtual Function device
  * @pfdev:	Handle to Physical Function device
  * @virtid:	Virtual Function Index
@@ -948,6 +960,7 @@ struct pci_child_plat {
 	unsigned short vendor;
 	unsigned short device;
 	unsigned int class;
+	u8 header_type;
 
 	/* Variables for CONFIG_PCI_SRIOV */
 	bool is_virtfn;
@@ -989,6 +1002,21 @@ struct dm_pci_ops {
 	 */
 	int (*write_config)(struct udevice *bus, pci_dev_t bdf, uint offset,
 			    ulong value, enum pci_size_t size);
+	/**
+	 * link_up() - Check whether the link of a PCIe controller is up
+	 *
+	 * This method is optional. A driver which provides it should start
+	 * link training in its probe() method without waiting for it to
+	 * complete. The uclass then waits for the link before scanning the
+	 * bus, up to CONFIG_PCI_LINK_TIMEOUT_MS, and pci_init() does this for
+	 * all controllers at once so that their links train in parallel.
+	 *
+	 * This is called repeatedly until it returns a non-zero value.
+	 *
+	 * @bus:	Controller to check
+	 * @return 1 if the link is up, 0 if not (yet), -ve on error
+	 */
+	int (*link_up)(struct udevice *bus);
 };
 
 /* Get access to a PCI bus' operations */
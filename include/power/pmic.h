@@ -12,6 +12,7 @@
 
 #include <dm/ofnode.h>
 #include <i2c.h>
+#include <linux/errno.h>
 #include <linux/list.h>
 #include <power/power_chrg.h>
 
@@ -160,12 +161,19 @@ struct pmic {
  * @reg_count: device's register count
  * @read:      read 'len' bytes at "reg" and store it into the 'buffer'
  * @write:     write 'len' bytes from the 'buffer' to the register at 'reg' address
+ * @reg_volatile: (optional) return true if the register can change without
+ *             being written, or if writing it has side effects (status,
+ *             interrupt, reset and lock registers). Drivers providing this
+ *             get a register cache (CONFIG_PMIC_CACHE) for the other
+ *             registers, and their write() must accept runs of consecutive
+ *             registers.
  */
 struct dm_pmic_ops {
 	int (*reg_count)(struct udevice *dev);
 	int (*read)(struct udevice *dev, uint reg, uint8_t *buffer, int len);
 	int (*write)(struct udevice *dev, uint reg, const uint8_t *buffer,
 		     int len);
+	bool (*reg_volatile)(struct udevice *dev, uint reg);
 };
 
 /**
@@ -299,13 +307,93 @@ int pmic_reg_write(struct udevice *dev, uint reg, uint value);
  */
 int pmic_clrsetbits(struct udevice *dev, uint reg, uint clr, uint set);
 
+#if CONFIG_IS_ENABLED(PMIC_CACHE)
+/**
+ * pmic_cache_defer() - start collecting writes to cached PMIC registers
+ *
+ * Writes to non-volatile registers only update the register cache until
+ * pmic_cache_sync() is called, so that several writes to consecutive
+ * registers result in a single transfer. Pending writes are written out
+ * before any access to a volatile register, so a lock or reset register
+ * always sees the writes made before it.
+ *
+ * @dev:	PMIC device
+ * Return: 0 on success, -ENOSYS if the PMIC has no register cache
+ */
+int pmic_cache_defer(struct udevice *dev);
+
+/**
+ * pmic_cache_sync() - write out deferred register writes
+ *
+ * Pending writes reach the device in the order they were made, so e.g. a
+ * voltage set before an enable is still written first. Consecutive writes
+ * to consecutive registers are combined into one multi-byte transfer. This
+ * also ends the deferral started by pmic_cache_defer().
+ *
+ * @dev:	PMIC device
+ * Return: 0 on success or negative value of errno.
+ */
+int pmic_cache_sync(struct udevice *dev);
+
+/**
+ * pmic_cache_invalidate() - drop all cached PMIC register values
+ *
+ * Use this when the registers may have changed behind the back of the
+ * driver, e.g. after a reset of the PMIC. Pending deferred writes are
+ * discarded.
+ *
+ * @dev:	PMIC device
+ */
+void pmic_cache_invalidate(struct udevice *dev);
+#else
+static inline int pmic_cache_defer(struct udevice *dev)
+{
+	return -ENOSYS;
+}
+
+static inline int pmic_cache_sync(struct udevice *dev)
+{
+	return 0;
+}
+
+static inline void pmic_cache_invalidate(struct udevice *dev)
+{
+}
+#endif
+
+/**
+ * struct pmic_cache_entry - a deferred write to a cached PMIC register
+ *
+ * @reg:	register number
+ * @val:	value written
+ */
+struct pmic_cache_entry {
+	uint reg;
+	u8 val;
+};
+
 /*
  * This structure holds the private data for PMIC uclass
  * For now we store information about the number of bytes
  * being sent at once to the device.
+ *
+ * With CONFIG_PMIC_CACHE, it also holds the register cache of PMICs with
+ * single byte registers whose driver provides dm_pmic_ops.reg_volatile:
+ * @cache holds @cache_regs register values, followed by @cache_flags which
+ * tells for each register if the value is valid and if it is still to be
+ * written to the device. @cache_log holds the @cache_log_len deferred
+ * register writes in the order they were made.
  */
 struct uc_pmic_priv {
 	uint trans_len;
+#if CONFIG_IS_ENABLED(PMIC_CACHE)
+	u8 *cache;
+	u8 *cache_flags;
+	uint cache_regs;
+	bool cache_defer;
+	struct pmic_cache_entry *cache_log;
+	uint cache_log_len;
+#endif
 };
 
 #endif /* DM_PMIC */
@@ -16,7 +16,7 @@
 #define SANDBOX_LDO_COUNT	2
 /*
  * Sandbox PMIC registers:
- * We have only 12 significant registers, but we alloc 16 for padding.
+ * We have only 13 significant registers, but we alloc 16 for padding.
  */
 enum {
 	SANDBOX_PMIC_REG_BUCK1_UV = 0,
@@ -36,6 +36,9 @@ enum {
 	SANDBOX_PMIC_REG_LDO2_UA,
 	SANDBOX_PMIC_REG_LDO2_OM,
 
+	/* Volatile register, never cached */
+	SANDBOX_PMIC_REG_STATUS,
+
 	SANDBOX_PMIC_REG_COUNT = 16,
 };
 
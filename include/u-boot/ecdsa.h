@@ -65,6 +65,25 @@ int ecdsa_verify(struct image_sign_info *info,
 		 uint8_t *sig, uint sig_len);
 /** @} */
 
+struct ecdsa_public_key;
+
+/**
+ * ecdsa_verify_sw() - Verify an ECDSA signature in software
+ *
+ * Supports the prime256v1 (P-256) and secp384r1 (P-384) curves.
+ *
+ * @pubkey:	Public key and curve
+ * @hash:	Hash of the signed data
+ * @hash_len:	Length of the hash in bytes
+ * @signature:	Signature as raw (R, S) pair, each the size of the curve
+ * @sig_len:	Length of the signature in bytes
+ * Return: 0 if the signature is valid, -EPERM if it is not, other -ve value
+ *	on invalid key or arguments
+ */
+int ecdsa_verify_sw(const struct ecdsa_public_key *pubkey, const void *hash,
+		    size_t hash_len, const void *signature, size_t sig_len);
+
 #define ECDSA256_BYTES	(256 / 8)
+#define ECDSA384_BYTES	(384 / 8)
 
 #endif
@@ -21,4 +21,42 @@
  */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
+/**
+ * LZ4_decompress_safe() - Decompress a raw LZ4 block
+ *
+ * Unlike ulz4fn() this takes a single block without the frame header. The
+ * whole input must be consumed and the output never overruns @maxOutputSize.
+ * The input may sit at the end of the output buffer for in-place
+ * decompression, provided it is at least (@inputSize >> 8) + 32 bytes past
+ * the end of the decompressed data.
+ *
+ * @source: Compressed block
+ * @dest: Destination for uncompressed data
+ * @inputSize: Exact size of the compressed block
+ * @maxOutputSize: Size of the destination buffer
+ * Return: number of bytes written to @dest, or a negative value if the block
+ *	is malformed
+ */
+int LZ4_decompress_safe(const char *source, char *dest, int inputSize,
+			int maxOutputSize);
+
+/**
+ * LZ4_decompress_safe_partial() - Decompress the start of a raw LZ4 block
+ *
+ * This stops once @targetOutputSize bytes have been decoded, so @inputSize
+ * may cover more than the compressed block, e.g. when the block is followed
+ * by padding of unknown length. Decoding may go past @targetOutputSize but
+ * never past @maxOutputSize. The input must not overlap the output.
+ *
+ * @source: Compressed block
+ * @dest: Destination for uncompressed data
+ * @inputSize: Size of the input, which may extend past the compressed block
+ * @targetOutputSize: Number of bytes wanted
+ * @maxOutputSize: Size of the destination buffer
+ * Return: number of bytes written to @dest, or a negative value if the block
+ *	is malformed
+ */
+int LZ4_decompress_safe_partial(const char *source, char *dest, int inputSize,
+				int targetOutputSize, int maxOutputSize);
+
 #endif
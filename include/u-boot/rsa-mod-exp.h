@@ -23,7 +23,8 @@ struct key_prop {
 	const void *rr;		/* R^2 can be treated as byte array */
 	const void *modulus;	/* modulus as byte array */
 	const void *public_exponent; /* public exponent as byte array */
-	uint32_t n0inv;		/* -1 / modulus[0] mod 2^32 */
+	uint32_t n0inv;		/* -1 / modulus[0] mod 2^32, unused by
+				 * rsa_mod_exp_sw() */
 	int num_bits;		/* Key length in bits */
 	uint32_t exp_len;	/* Exponent length in number of uint8_t */
 };
@@ -73,6 +73,24 @@ enum video_format {
 	VIDEO_X2R10G10B10,
 };
 
+/**
+ * struct video_damage - Region of the frame buffer changed since the last sync
+ *
+ * The region is empty if @yend is not greater than @ystart. All coordinates
+ * are in pixels within the frame buffer, the end values are exclusive.
+ *
+ * @xstart:	Left edge of the region
+ * @ystart:	Top edge of the region
+ * @xend:	Right edge of the region
+ * @yend:	Bottom edge of the region
+ */
+struct video_damage {
+	int xstart;
+	int ystart;
+	int xend;
+	int yend;
+};
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
@@ -97,6 +115,9 @@ enum video_format {
  *		the LCD is updated
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
+ * @damage:	Region changed since the last video_sync(), only maintained with
+ *		CONFIG_VIDEO_DAMAGE. It is still valid while the driver's
+ *		video_sync() method is called.
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -121,6 +142,7 @@ struct video_priv {
 	bool flush_dcache;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+	struct video_damage damage;
 };
 
 /**
@@ -180,6 +202,42 @@ int video_clear(struct udevice *dev);
  */
 int video_sync(struct udevice *vid, bool force);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * video_damage() - Mark a region of the frame buffer as changed
+ *
+ * The region is added to the damage of the device. The next video_sync()
+ * updates the copy frame buffer and flushes the data cache only for the
+ * damaged region. The region is clipped to the display.
+ *
+ * @vid:	Device whose frame buffer has been updated
+ * @x:		Left edge of the region in pixels
+ * @y:		Top edge of the region in pixels
+ * @width:	Width of the region in pixels
+ * @height:	Height of the region in pixels
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
+/**
+ * video_fill_pixels() - Fill a run of pixels with a colour
+ *
+ * This uses word-sized stores where the alignment of @dst allows it.
+ *
+ * @dst:	First pixel to fill
+ * @bpix:	Encoded bits per pixel (enum video_log2_bpp)
+ * @colour:	Pixel value to write
+ * @count:	Number of pixels to fill
+ * Return: pointer to the byte following the last filled pixel
+ */
+void *video_fill_pixels(void *dst, enum video_log2_bpp bpix, u32 colour,
+			int count);
+
 /**
  * video_sync_all() - Sync all devices' frame buffers with there hardware
  *
@@ -207,6 +265,55 @@ void video_sync_all(void);
 int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 		      bool align);
 
+/**
+ * video_splash_align_axis() - Align a single coordinate
+ *
+ * See video_bmp_display() for the meaning of @axis.
+ *
+ * @axis:	Input and output coordinate
+ * @panel_size:	Size of panel in pixels for that axis
+ * @picture_size:	Size of image in pixels for that axis
+ */
+void video_splash_align_axis(int *axis, unsigned long panel_size,
+			     unsigned long picture_size);
+
+/**
+ * video_qoi_display() - Display a QOI image
+ *
+ * The image is decoded directly into the frame buffer. Alpha is ignored.
+ *
+ * @dev:	Device to display the image on
+ * @qoi_image:	Address of the QOI image to display
+ * @x:		X position in pixels from the left
+ * @y:		Y position in pixels from the top
+ * @align:	true to adjust the coordinates as described for
+ *		video_bmp_display()
+ * Return: 0 if OK, -ve on error
+ */
+int video_qoi_display(struct udevice *dev, ulong qoi_image, int x, int y,
+		      bool align);
+
+/**
+ * video_qoi_is_image() - Check for the header of a QOI image
+ *
+ * @data:	Start of the image, at least 14 bytes must be readable
+ * Return: true if @data holds a QOI header
+ */
+bool video_qoi_is_image(const void *data);
+
+/**
+ * video_qoi_get_size() - Get the size of a QOI image
+ *
+ * QOI images do not record their size. It is found by walking the encoded
+ * data until all pixels are covered.
+ *
+ * @data:	Start of the image
+ * @avail:	Number of bytes available at @data
+ * Return: size of the image including the end marker, -EAGAIN if more than
+ *	@avail bytes are needed to tell, -EINVAL if this is not a QOI image
+ */
+long video_qoi_get_size(const void *data, ulong avail);
+
 /**
  * video_get_xsize() - Get the width of the display in pixels
  *
@@ -239,13 +346,16 @@ void video_set_flush_dcache(struct udevice *dev, bool flush);
  */
 void video_set_default_colors(struct udevice *dev, bool invert);
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 /**
  * vidconsole_sync_copy() - Sync back to the copy framebuffer
  *
  * This ensures that the copy framebuffer has the same data as the framebuffer
  * for a particular region. It should be called after the framebuffer is updated
  *
+ * With CONFIG_VIDEO_DAMAGE the rows containing the region are marked as
+ * damaged instead and copied by the next video_sync().
+ *
  * @from and @to can be in either order. The region between them is synced.
  *
  * @dev: Vidconsole device being updated
@@ -0,0 +1,685 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Software ECDSA signature verification for the NIST P-256 and P-384 curves
+ *
+ * Field elements are kept in the Montgomery domain as little endian arrays of
+ * word-size limbs. Field additions, subtractions and multiplications do not
+ * branch on their operands. Point arithmetic uses Jacobian coordinates and
+ * the two scalar multiplications of the verification are interleaved
+ * (Shamir's trick). Only public data (key, signature and hash) is processed,
+ * so the scalar multiplication itself is not constant-time.
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <log.h>
+#include <crypto/ecdsa-uclass.h>
+#include <linux/errno.h>
+#include <u-boot/ecdsa.h>
+
+#ifdef __SIZEOF_INT128__
+typedef u64 ec_limb;
+typedef unsigned __int128 ec_dlimb;
+#else
+typedef u32 ec_limb;
+typedef u64 ec_dlimb;
+#endif
+
+#define EC_LIMB_BITS	(sizeof(ec_limb) * 8)
+#define EC_MAX_BYTES	ECDSA384_BYTES
+#define EC_MAX_LIMBS	(EC_MAX_BYTES / sizeof(ec_limb))
+
+/**
+ * struct ec_curve - short Weierstrass curve y^2 = x^3 - 3x + b over GF(p)
+ *
+ * All values are big endian byte strings of @bytes bytes.
+ *
+ * @name:	Curve name as found in the "ecdsa,curve" key property
+ * @bytes:	Size of the field elements and of the group order
+ * @p:		Field prime
+ * @n:		Order of the base point
+ * @b:		Curve constant b
+ * @gx:		x coordinate of the base point
+ * @gy:		y coordinate of the base point
+ */
+struct ec_curve {
+	const char *name;
+	uint bytes;
+	const u8 *p;
+	const u8 *n;
+	const u8 *b;
+	const u8 *gx;
+	const u8 *gy;
+};
+
+static const u8 p256_p[] = {
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x01,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+static const u8 p256_n[] = {
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84,
+	0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51,
+};
+
+static const u8 p256_b[] = {
+	0x5a, 0xc6, 0x35, 0xd8, 0xaa, 0x3a, 0x93, 0xe7,
+	0xb3, 0xeb, 0xbd, 0x55, 0x76, 0x98, 0x86, 0xbc,
+	0x65, 0x1d, 0x06, 0xb0, 0xcc, 0x53, 0xb0, 0xf6,
+	0x3b, 0xce, 0x3c, 0x3e, 0x27, 0xd2, 0x60, 0x4b,
+};
+
+static const u8 p256_gx[] = {
+	0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47,
+	0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+	0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0,
+	0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96,
+};
+
+static const u8 p256_gy[] = {
+	0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b,
+	0x8e, 0xe7, 0xeb, 0x4a, 0x7c, 0x0f, 0x9e, 0x16,
+	0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce,
+	0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5,
+};
+
+static const u8 p384_p[] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+};
+
+static const u8 p384_n[] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xc7, 0x63, 0x4d, 0x81, 0xf4, 0x37, 0x2d, 0xdf,
+	0x58, 0x1a, 0x0d, 0xb2, 0x48, 0xb0, 0xa7, 0x7a,
+	0xec, 0xec, 0x19, 0x6a, 0xcc, 0xc5, 0x29, 0x73,
+};
+
+static const u8 p384_b[] = {
+	0xb3, 0x31, 0x2f, 0xa7, 0xe2, 0x3e, 0xe7, 0xe4,
+	0x98, 0x8e, 0x05, 0x6b, 0xe3, 0xf8, 0x2d, 0x19,
+	0x18, 0x1d, 0x9c, 0x6e, 0xfe, 0x81, 0x41, 0x12,
+	0x03, 0x14, 0x08, 0x8f, 0x50, 0x13, 0x87, 0x5a,
+	0xc6, 0x56, 0x39, 0x8d, 0x8a, 0x2e, 0xd1, 0x9d,
+	0x2a, 0x85, 0xc8, 0xed, 0xd3, 0xec, 0x2a, 0xef,
+};
+
+static const u8 p384_gx[] = {
+	0xaa, 0x87, 0xca, 0x22, 0xbe, 0x8b, 0x05, 0x37,
+	0x8e, 0xb1, 0xc7, 0x1e, 0xf3, 0x20, 0xad, 0x74,
+	0x6e, 0x1d, 0x3b, 0x62, 0x8b, 0xa7, 0x9b, 0x98,
+	0x59, 0xf7, 0x41, 0xe0, 0x82, 0x54, 0x2a, 0x38,
+	0x55, 0x02, 0xf2, 0x5d, 0xbf, 0x55, 0x29, 0x6c,
+	0x3a, 0x54, 0x5e, 0x38, 0x72, 0x76, 0x0a, 0xb7,
+};
+
+static const u8 p384_gy[] = {
+	0x36, 0x17, 0xde, 0x4a, 0x96, 0x26, 0x2c, 0x6f,
+	0x5d, 0x9e, 0x98, 0xbf, 0x92, 0x92, 0xdc, 0x29,
+	0xf8, 0xf4, 0x1d, 0xbd, 0x28, 0x9a, 0x14, 0x7c,
+	0xe9, 0xda, 0x31, 0x13, 0xb5, 0xf0, 0xb8, 0xc0,
+	0x0a, 0x60, 0xb1, 0xce, 0x1d, 0x7e, 0x81, 0x9d,
+	0x7a, 0x43, 0x1d, 0x7c, 0x90, 0xea, 0x0e, 0x5f,
+};
+
+static const struct ec_curve ec_curves[] = {
+	{
+		.name = "prime256v1",
+		.bytes = ECDSA256_BYTES,
+		.p = p256_p,
+		.n = p256_n,
+		.b = p256_b,
+		.gx = p256_gx,
+		.gy = p256_gy,
+	},
+	{
+		.name = "secp384r1",
+		.bytes = ECDSA384_BYTES,
+		.p = p384_p,
+		.n = p384_n,
+		.b = p384_b,
+		.gx = p384_gx,
+		.gy = p384_gy,
+	},
+};
+
+/**
+ * struct ec_mod - Montgomery arithmetic modulo an odd prime
+ *
+ * The prime must use all bits of its top limb, so that R mod m is R - m.
+ *
+ * @len:	Number of limbs in all numbers using this modulus
+ * @n0inv:	-1 / m[0] mod 2^EC_LIMB_BITS
+ * @m:		Modulus
+ * @one:	R mod m, i.e. 1 in the Montgomery domain
+ * @rr:		R^2 mod m, used to convert numbers to the Montgomery domain
+ */
+struct ec_mod {
+	uint len;
+	ec_limb n0inv;
+	ec_limb m[EC_MAX_LIMBS];
+	ec_limb one[EC_MAX_LIMBS];
+	ec_limb rr[EC_MAX_LIMBS];
+};
+
+/**
+ * struct ec_point - point in Jacobian coordinates, (X / Z^2, Y / Z^3)
+ *
+ * Coordinates are in the Montgomery domain of the field. Z is zero for the
+ * point at infinity.
+ */
+struct ec_point {
+	ec_limb x[EC_MAX_LIMBS];
+	ec_limb y[EC_MAX_LIMBS];
+	ec_limb z[EC_MAX_LIMBS];
+};
+
+/**
+ * struct ec_ctx - state of one signature verification
+ *
+ * @p:		Field arithmetic
+ * @n:		Scalar arithmetic, modulo the group order
+ * @b:		Curve constant b, in the Montgomery domain of the field
+ */
+struct ec_ctx {
+	struct ec_mod p;
+	struct ec_mod n;
+	ec_limb b[EC_MAX_LIMBS];
+};
+
+static void bn_from_bytes(ec_limb *out, uint len, const u8 *in, uint in_len)
+{
+	uint i;
+
+	memset(out, 0, len * sizeof(ec_limb));
+	for (i = 0; i < in_len; i++)
+		out[i / sizeof(ec_limb)] |= (ec_limb)in[in_len - 1 - i] <<
+					    (8 * (i % sizeof(ec_limb)));
+}
+
+static int bn_cmp(const ec_limb *a, const ec_limb *b, uint len)
+{
+	int i;
+
+	for (i = len - 1; i >= 0; i--) {
+		if (a[i] != b[i])
+			return a[i] > b[i] ? 1 : -1;
+	}
+
+	return 0;
+}
+
+static bool bn_is_zero(const ec_limb *a, uint len)
+{
+	ec_limb acc = 0;
+	uint i;
+
+	for (i = 0; i < len; i++)
+		acc |= a[i];
+
+	return !acc;
+}
+
+/* r = a + b, returns the carry */
+static ec_limb bn_add(ec_limb *r, const ec_limb *a, const ec_limb *b,
+		      uint len)
+{
+	ec_dlimb acc = 0;
+	uint i;
+
+	for (i = 0; i < len; i++) {
+		acc += (ec_dlimb)a[i] + b[i];
+		r[i] = (ec_limb)acc;
+		acc >>= EC_LIMB_BITS;
+	}
+
+	return (ec_limb)acc;
+}
+
+/* r = a - b, returns the borrow */
+static ec_limb bn_sub(ec_limb *r, const ec_limb *a, const ec_limb *b,
+		      uint len)
+{
+	ec_limb borrow = 0;
+	uint i;
+
+	for (i = 0; i < len; i++) {
+		ec_dlimb acc = (ec_dlimb)a[i] - b[i] - borrow;
+
+		r[i] = (ec_limb)acc;
+		borrow = (ec_limb)(acc >> EC_LIMB_BITS) & 1;
+	}
+
+	return borrow;
+}
+
+/* r = mask ? a : b, where mask is all ones or all zeroes */
+static void bn_select(ec_limb *r, ec_limb mask, const ec_limb *a,
+		      const ec_limb *b, uint len)
+{
+	uint i;
+
+	for (i = 0; i < len; i++)
+		r[i] = (a[i] & mask) | (b[i] & ~mask);
+}
+
+static void mod_add(const struct ec_mod *mod, ec_limb *r, const ec_limb *a,
+		    const ec_limb *b)
+{
+	ec_limb sum[EC_MAX_LIMBS], diff[EC_MAX_LIMBS];
+	ec_limb carry, borrow;
+
+	carry = bn_add(sum, a, b, mod->len);
+	borrow = bn_sub(diff, sum, mod->m, mod->len);
+	/* Keep the difference if the sum overflowed or is not below m */
+	bn_select(r, -(carry | (borrow ^ 1)), diff, sum, mod->len);
+}
+
+static void mod_sub(const struct ec_mod *mod, ec_limb *r, const ec_limb *a,
+		    const ec_limb *b)
+{
+	ec_limb diff[EC_MAX_LIMBS], mask[EC_MAX_LIMBS];
+	ec_limb borrow;
+	uint i;
+
+	borrow = bn_sub(diff, a, b, mod->len);
+	for (i = 0; i < mod->len; i++)
+		mask[i] = mod->m[i] & -borrow;
+	bn_add(r, diff, mask, mod->len);
+}
+
+/**
+ * mod_mul() - Montgomery multiplication, r = a * b / R mod m
+ *
+ * The operands must be below m. @r may point to either of them.
+ */
+static void mod_mul(const struct ec_mod *mod, ec_limb *r, const ec_limb *a,
+		    const ec_limb *b)
+{
+	const uint len = mod->len;
+	ec_limb t[EC_MAX_LIMBS + 2], diff[EC_MAX_LIMBS];
+	ec_limb borrow;
+	ec_dlimb acc;
+	ec_limb q;
+	uint i, j;
+
+	memset(t, 0, sizeof(t));
+	for (i = 0; i < len; i++) {
+		acc = 0;
+		for (j = 0; j < len; j++) {
+			acc += (ec_dlimb)a[j] * b[i] + t[j];
+			t[j] = (ec_limb)acc;
+			acc >>= EC_LIMB_BITS;
+		}
+		acc += t[len];
+		t[len] = (ec_limb)acc;
+		t[len + 1] = (ec_limb)(acc >> EC_LIMB_BITS);
+
+		q = t[0] * mod->n0inv;
+		acc = (ec_dlimb)q * mod->m[0] + t[0];
+		acc >>= EC_LIMB_BITS;
+		for (j = 1; j < len; j++) {
+			acc += (ec_dlimb)q * mod->m[j] + t[j];
+			t[j - 1] = (ec_limb)acc;
+			acc >>= EC_LIMB_BITS;
+		}
+		acc += t[len];
+		t[len - 1] = (ec_limb)acc;
+		t[len] = t[len + 1] + (ec_limb)(acc >> EC_LIMB_BITS);
+	}
+
+	/* t < 2m here, subtract m once if needed */
+	borrow = bn_sub(diff, t, mod->m, len);
+	bn_select(r, -(t[len] | (borrow ^ 1)), diff, t, len);
+}
+
+/* r = a^e in the Montgomery domain, for a public exponent e */
+static void mod_pow(const struct ec_mod *mod, ec_limb *r, const ec_limb *a,
+		    const ec_limb *e)
+{
+	ec_limb acc[EC_MAX_LIMBS];
+	int i;
+
+	memcpy(acc, mod->one, sizeof(acc));
+	for (i = mod->len * EC_LIMB_BITS - 1; i >= 0; i--) {
+		mod_mul(mod, acc, acc, acc);
+		if ((e[i / EC_LIMB_BITS] >> (i % EC_LIMB_BITS)) & 1)
+			mod_mul(mod, acc, acc, a);
+	}
+	memcpy(r, acc, sizeof(acc));
+}
+
+/* r = 1 / a, computed as a^(m - 2) since m is prime */
+static void mod_inv(const struct ec_mod *mod, ec_limb *r, const ec_limb *a)
+{
+	ec_limb two[EC_MAX_LIMBS] = { 2 };
+	ec_limb e[EC_MAX_LIMBS];
+
+	bn_sub(e, mod->m, two, mod->len);
+	mod_pow(mod, r, a, e);
+}
+
+static void mod_to_mont(const struct ec_mod *mod, ec_limb *r,
+			const ec_limb *a)
+{
+	mod_mul(mod, r, a, mod->rr);
+}
+
+static int mod_init(struct ec_mod *mod, const u8 *m, uint bytes)
+{
+	ec_limb zero[EC_MAX_LIMBS] = { 0 };
+	ec_limb inv = 1;
+	uint i;
+
+	mod->len = bytes / sizeof(ec_limb);
+	bn_from_bytes(mod->m, mod->len, m, bytes);
+	if (!(mod->m[0] & 1) || !(mod->m[mod->len - 1] >> (EC_LIMB_BITS - 1)))
+		return -EINVAL;
+
+	/* Newton iteration, each step doubles the number of correct bits */
+	for (i = 0; i < 6; i++)
+		inv *= 2 - mod->m[0] * inv;
+	mod->n0inv = -inv;
+
+	bn_sub(mod->one, zero, mod->m, mod->len);
+	memcpy(mod->rr, mod->one, sizeof(mod->rr));
+	for (i = 0; i < mod->len * EC_LIMB_BITS; i++)
+		mod_add(mod, mod->rr, mod->rr, mod->rr);
+
+	return 0;
+}
+
+/* Check y^2 = x^3 - 3x + b for an affine point in the Montgomery domain */
+static bool ec_on_curve(const struct ec_ctx *ctx, const ec_limb *x,
+			const ec_limb *y)
+{
+	const struct ec_mod *p = &ctx->p;
+	ec_limb lhs[EC_MAX_LIMBS], rhs[EC_MAX_LIMBS], t[EC_MAX_LIMBS];
+
+	mod_mul(p, lhs, y, y);
+	mod_mul(p, rhs, x, x);
+	mod_mul(p, rhs, rhs, x);
+	mod_add(p, t, x, x);
+	mod_add(p, t, t, x);
+	mod_sub(p, rhs, rhs, t);
+	mod_add(p, rhs, rhs, ctx->b);
+
+	return !bn_cmp(lhs, rhs, p->len);
+}
+
+/* r = 2 * a, using the dbl-2001-b formulas for a = -3 */
+static void ec_double(const struct ec_ctx *ctx, struct ec_point *r,
+		      const struct ec_point *a)
+{
+	const struct ec_mod *p = &ctx->p;
+	ec_limb delta[EC_MAX_LIMBS], gamma[EC_MAX_LIMBS], beta[EC_MAX_LIMBS];
+	ec_limb alpha[EC_MAX_LIMBS], t[EC_MAX_LIMBS];
+
+	mod_mul(p, delta, a->z, a->z);
+	mod_mul(p, gamma, a->y, a->y);
+	mod_mul(p, beta, a->x, gamma);
+
+	mod_sub(p, t, a->x, delta);
+	mod_add(p, alpha, a->x, delta);
+	mod_mul(p, alpha, alpha, t);
+	mod_add(p, t, alpha, alpha);
+	mod_add(p, alpha, alpha, t);
+
+	/* Z3 = (Y1 + Z1)^2 - gamma - delta */
+	mod_add(p, r->z, a->y, a->z);
+	mod_mul(p, r->z, r->z, r->z);
+	mod_sub(p, r->z, r->z, gamma);
+	mod_sub(p, r->z, r->z, delta);
+
+	/* X3 = alpha^2 - 8 * beta */
+	mod_add(p, beta, beta, beta);
+	mod_add(p, beta, beta, beta);
+	mod_add(p, t, beta, beta);
+	mod_mul(p, r->x, alpha, alpha);
+	mod_sub(p, r->x, r->x, t);
+
+	/* Y3 = alpha * (4 * beta - X3) - 8 * gamma^2 */
+	mod_mul(p, gamma, gamma, gamma);
+	mod_add(p, gamma, gamma, gamma);
+	mod_add(p, gamma, gamma, gamma);
+	mod_add(p, gamma, gamma, gamma);
+	mod_sub(p, t, beta, r->x);
+	mod_mul(p, r->y, alpha, t);
+	mod_sub(p, r->y, r->y, gamma);
+}
+
+/*
+ * r = a + (x, y) for an affine point (x, y), using the madd-2004-hmv
+ * formulas. @r may point to @a.
+ */
+static void ec_add_affine(const struct ec_ctx *ctx, struct ec_point *r,
+			  const struct ec_point *a, const ec_limb *x,
+			  const ec_limb *y)
+{
+	const struct ec_mod *p = &ctx->p;
+	const uint len = p->len;
+	ec_limb z1z1[EC_MAX_LIMBS], h[EC_MAX_LIMBS], hh[EC_MAX_LIMBS];
+	ec_limb hhh[EC_MAX_LIMBS], s[EC_MAX_LIMBS], v[EC_MAX_LIMBS];
+	ec_limb t[EC_MAX_LIMBS];
+
+	if (bn_is_zero(a->z, len)) {
+		memcpy(r->x, x, sizeof(r->x));
+		memcpy(r->y, y, sizeof(r->y));
+		memcpy(r->z, p->one, sizeof(r->z));
+		return;
+	}
+
+	mod_mul(p, z1z1, a->z, a->z);
+	mod_mul(p, h, x, z1z1);
+	mod_sub(p, h, h, a->x);
+	mod_mul(p, s, y, a->z);
+	mod_mul(p, s, s, z1z1);
+	mod_sub(p, s, s, a->y);
+
+	if (bn_is_zero(h, len)) {
+		if (bn_is_zero(s, len))
+			ec_double(ctx, r, a);
+		else
+			memset(r->z, 0, sizeof(r->z));
+		return;
+	}
+
+	mod_mul(p, hh, h, h);
+	mod_mul(p, hhh, h, hh);
+	mod_mul(p, v, a->x, hh);
+
+	/* Z3 = Z1 * H, Y1 * HHH is kept in hh before Y1 is overwritten */
+	mod_mul(p, r->z, a->z, h);
+	mod_mul(p, hh, a->y, hhh);
+
+	/* X3 = S^2 - HHH - 2 * V */
+	mod_mul(p, r->x, s, s);
+	mod_sub(p, r->x, r->x, hhh);
+	mod_add(p, t, v, v);
+	mod_sub(p, r->x, r->x, t);
+
+	/* Y3 = S * (V - X3) - Y1 * HHH */
+	mod_sub(p, t, v, r->x);
+	mod_mul(p, r->y, s, t);
+	mod_sub(p, r->y, r->y, hh);
+}
+
+/* Convert a point to affine coordinates, returns false for infinity */
+static bool ec_to_affine(const struct ec_ctx *ctx, ec_limb *x, ec_limb *y,
+			 const struct ec_point *a)
+{
+	const struct ec_mod *p = &ctx->p;
+	ec_limb zinv[EC_MAX_LIMBS], t[EC_MAX_LIMBS];
+
+	if (bn_is_zero(a->z, p->len))
+		return false;
+
+	mod_inv(p, zinv, a->z);
+	mod_mul(p, t, zinv, zinv);
+	mod_mul(p, x, a->x, t);
+	mod_mul(p, t, t, zinv);
+	mod_mul(p, y, a->y, t);
+
+	return true;
+}
+
+static int ecdsa_verify_raw(const struct ec_curve *curve,
+			    const struct ecdsa_public_key *pubkey,
+			    const u8 *hash, uint hash_len, const u8 *sig)
+{
+	const uint bytes = curve->bytes;
+	struct ec_ctx ctx;
+	struct ec_mod *p = &ctx.p, *n = &ctx.n;
+	ec_limb r[EC_MAX_LIMBS], s[EC_MAX_LIMBS], e[EC_MAX_LIMBS];
+	ec_limb u1[EC_MAX_LIMBS], u2[EC_MAX_LIMBS];
+	ec_limb tab_x[3][EC_MAX_LIMBS], tab_y[3][EC_MAX_LIMBS];
+	bool tab_valid[3];
+	struct ec_point acc;
+	uint len, i;
+	int ret;
+
+	ret = mod_init(p, curve->p, bytes);
+	if (!ret)
+		ret = mod_init(n, curve->n, bytes);
+	if (ret)
+		return ret;
+	len = p->len;
+
+	bn_from_bytes(r, len, sig, bytes);
+	bn_from_bytes(s, len, sig + bytes, bytes);
+	if (bn_is_zero(r, len) || bn_cmp(r, n->m, len) >= 0 ||
+	    bn_is_zero(s, len) || bn_cmp(s, n->m, len) >= 0)
+		return -EPERM;
+
+	/* Table of G, Q and G + Q for the interleaved multiplication */
+	bn_from_bytes(tab_x[0], len, curve->gx, bytes);
+	bn_from_bytes(tab_y[0], len, curve->gy, bytes);
+	bn_from_bytes(tab_x[1], len, pubkey->x, bytes);
+	bn_from_bytes(tab_y[1], len, pubkey->y, bytes);
+	if (bn_cmp(tab_x[1], p->m, len) >= 0 ||
+	    bn_cmp(tab_y[1], p->m, len) >= 0)
+		return -EINVAL;
+	for (i = 0; i < 2; i++) {
+		mod_to_mont(p, tab_x[i], tab_x[i]);
+		mod_to_mont(p, tab_y[i], tab_y[i]);
+	}
+	bn_from_bytes(ctx.b, len, curve->b, bytes);
+	mod_to_mont(p, ctx.b, ctx.b);
+	if (!ec_on_curve(&ctx, tab_x[1], tab_y[1])) {
+		debug("%s: public key is not on curve %s\n", __func__,
+		      curve->name);
+		return -EINVAL;
+	}
+
+	memset(&acc, 0, sizeof(acc));
+	ec_add_affine(&ctx, &acc, &acc, tab_x[0], tab_y[0]);
+	ec_add_affine(&ctx, &acc, &acc, tab_x[1], tab_y[1]);
+	tab_valid[0] = true;
+	tab_valid[1] = true;
+	tab_valid[2] = ec_to_affine(&ctx, tab_x[2], tab_y[2], &acc);
+
+	/* e is the leftmost bits of the hash, reduced modulo n */
+	bn_from_bytes(e, len, hash, min(hash_len, bytes));
+	if (bn_cmp(e, n->m, len) >= 0)
+		bn_sub(e, e, n->m, len);
+
+	/* u1 = e / s, u2 = r / s; multiplying by a Montgomery w cancels R */
+	mod_to_mont(n, s, s);
+	mod_inv(n, s, s);
+	mod_mul(n, u1, e, s);
+	mod_mul(n, u2, r, s);
+
+	memset(&acc, 0, sizeof(acc));
+	for (i = len * EC_LIMB_BITS; i-- > 0;) {
+		uint idx;
+
+		ec_double(&ctx, &acc, &acc);
+		idx = ((u1[i / EC_LIMB_BITS] >> (i % EC_LIMB_BITS)) & 1) |
+		      ((u2[i / EC_LIMB_BITS] >> (i % EC_LIMB_BITS)) & 1) << 1;
+		if (idx && tab_valid[idx - 1])
+			ec_add_affine(&ctx, &acc, &acc, tab_x[idx - 1],
+				      tab_y[idx - 1]);
+	}
+	if (bn_is_zero(acc.z, len))
+		return -EPERM;
+
+	/*
+	 * Check x(acc) mod n == r without an inversion: compare X with
+	 * r * Z^2, and also with (r + n) * Z^2 when r + n is below p.
+	 */
+	mod_mul(p, acc.z, acc.z, acc.z);
+	for (i = 0; i < 2; i++) {
+		ec_limb t[EC_MAX_LIMBS];
+
+		if (i && (bn_add(r, r, n->m, len) || bn_cmp(r, p->m, len) >= 0))
+			break;
+		mod_to_mont(p, t, r);
+		mod_mul(p, t, t, acc.z);
+		if (!bn_cmp(t, acc.x, len))
+			return 0;
+	}
+
+	return -EPERM;
+}
+
+int ecdsa_verify_sw(const struct ecdsa_public_key *pubkey, const void *hash,
+		    size_t hash_len, const void *signature, size_t sig_len)
+{
+	const struct ec_curve *curve = NULL;
+	uint i;
+
+	for (i = 0; i < ARRAY_SIZE(ec_curves); i++) {
+		if (!strcmp(pubkey->curve_name, ec_curves[i].name)) {
+			curve = &ec_curves[i];
+			break;
+		}
+	}
+	if (!curve || pubkey->size_bits != curve->bytes * 8) {
+		debug("%s: unsupported curve '%s'\n", __func__,
+		      pubkey->curve_name);
+		return -EINVAL;
+	}
+	if (sig_len != curve->bytes * 2)
+		return -EINVAL;
+
+	return ecdsa_verify_raw(curve, pubkey, hash, hash_len, signature);
+}
+
+static int ecdsa_sw_verify(struct udevice *dev,
+			   const struct ecdsa_public_key *pubkey,
+			   const void *hash, size_t hash_len,
+			   const void *signature, size_t sig_len)
+{
+	int ret;
+
+	ret = ecdsa_verify_sw(pubkey, hash, hash_len, signature, sig_len);
+	if (ret)
+		debug("%s: ECDSA failed to verify: %d\n", __func__, ret);
+
+	return ret;
+}
+
+static const struct ecdsa_ops ecdsa_ops_sw = {
+	.verify	= ecdsa_sw_verify,
+};
+
+U_BOOT_DRIVER(ecdsa_sw) = {
+	.name	= "ecdsa_sw",
+	.id	= UCLASS_ECDSA,
+	.ops	= &ecdsa_ops_sw,
+	.flags	= DM_FLAG_PRE_RELOC,
+};
+
+U_BOOT_DRVINFO(ecdsa_sw) = {
+	.name = "ecdsa_sw",
+};
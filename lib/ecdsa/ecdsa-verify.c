@@ -22,6 +22,8 @@ static int ecdsa_key_size(const char *curve_name)
 {
 	if (!strcmp(curve_name, "prime256v1"))
 		return 256;
+	else if (!strcmp(curve_name, "secp384r1"))
+		return 384;
 	else
 		return 0;
 }
@@ -122,6 +124,12 @@ U_BOOT_CRYPTO_ALGO(ecdsa) = {
 	.verify = ecdsa_verify,
 };
 
+U_BOOT_CRYPTO_ALGO(ecdsa384) = {
+	.name = "ecdsa384",
+	.key_len = ECDSA384_BYTES,
+	.verify = ecdsa_verify,
+};
+
 /*
  * uclass definition for ECDSA API
  *
@@ -26,6 +26,12 @@
 
 static const efi_guid_t shim_lock_guid = SHIM_LOCK_GUID;
 
+/*
+ * Current size of file ubootefi.var. Zero if unknown, in which case the next
+ * update rewrites the complete file.
+ */
+static loff_t __maybe_unused efi_var_file_len;
+
 /**
  * efi_set_blk_dev_to_system_partition() - select EFI system partition
  *
@@ -141,9 +147,12 @@ efi_status_t efi_var_to_file(void)
 	if (ret != EFI_SUCCESS)
 		goto error;
 
+	efi_var_file_len = 0;
 	r = fs_write(EFI_VAR_FILE_NAME, map_to_sysmem(buf), 0, len, &actlen);
 	if (r || len != actlen)
 		ret = EFI_DEVICE_ERROR;
+	else
+		efi_var_file_len = len;
 
 error:
 	if (ret != EFI_SUCCESS)
@@ -155,6 +164,77 @@ error:
 #endif
 }
 
+/**
+ * efi_var_to_file_journal() - append a variable update to the file
+ *
+ * A record with the current value of the variable is appended to file
+ * ubootefi.var. A record with zero data length marks a deleted variable.
+ * If the file would outgrow the variable buffer or the size of the file is
+ * unknown, the file is compacted by rewriting it via efi_var_to_file().
+ *
+ * @variable_name:	name of the updated variable
+ * @vendor:		GUID of the updated variable
+ * Return:		status code
+ */
+static efi_status_t __maybe_unused
+efi_var_to_file_journal(const u16 *variable_name, const efi_guid_t *vendor)
+{
+	struct efi_var_file *buf;
+	struct efi_var_entry *var;
+	size_t name_len, len;
+	loff_t actlen;
+	efi_status_t ret;
+	int r;
+
+	var = efi_var_mem_find(vendor, variable_name, NULL);
+	name_len = (u16_strlen(variable_name) + 1) * sizeof(u16);
+	len = ALIGN(sizeof(struct efi_var_file) + sizeof(struct efi_var_entry) +
+		    name_len + (var ? var->length : 0), 8);
+	if (!efi_var_file_len || efi_var_file_len + len > EFI_VAR_BUF_SIZE)
+		return efi_var_to_file();
+
+	buf = calloc(1, len);
+	if (!buf)
+		return EFI_OUT_OF_RESOURCES;
+	if (var) {
+		memcpy(buf->var, var, sizeof(struct efi_var_entry) + name_len +
+		       var->length);
+	} else {
+		buf->var->attr = EFI_VARIABLE_NON_VOLATILE;
+		guidcpy(&buf->var->guid, vendor);
+		memcpy(buf->var->name, variable_name, name_len);
+	}
+	buf->magic = EFI_VAR_FILE_MAGIC;
+	buf->length = len;
+	buf->crc32 = crc32(0, (u8 *)buf->var,
+			   len - sizeof(struct efi_var_file));
+
+	ret = efi_set_blk_dev_to_system_partition();
+	if (ret == EFI_SUCCESS) {
+		r = fs_write(EFI_VAR_FILE_NAME, map_to_sysmem(buf),
+			     efi_var_file_len, len, &actlen);
+		if (r || len != actlen)
+			ret = EFI_DEVICE_ERROR;
+	}
+	free(buf);
+	if (ret != EFI_SUCCESS) {
+		log_debug("Appending to %s failed\n", EFI_VAR_FILE_NAME);
+		return efi_var_to_file();
+	}
+	efi_var_file_len += len;
+
+	return EFI_SUCCESS;
+}
+
+efi_status_t efi_var_to_file_update(const u16 *variable_name,
+				    const efi_guid_t *vendor)
+{
+	if (IS_ENABLED(CONFIG_EFI_VARIABLE_FILE_JOURNAL))
+		return efi_var_to_file_journal(variable_name, vendor);
+
+	return efi_var_to_file();
+}
+
 efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 {
 	struct efi_var_entry *var, *last_var;
@@ -185,6 +265,8 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 		     !guidcmp(&var->guid, &shim_lock_guid) ||
 		     !(var->attr & EFI_VARIABLE_NON_VOLATILE)))
 			continue;
+		/* Later records replace earlier ones */
+		efi_var_mem_del(efi_var_mem_find(&var->guid, var->name, NULL));
 		if (!var->length)
 			continue;
 		ret = efi_var_mem_ins(var->name, &var->guid, var->attr,
@@ -196,11 +278,30 @@ efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 	return EFI_SUCCESS;
 }
 
+loff_t efi_var_restore_records(struct efi_var_file *buf, loff_t len)
+{
+	struct efi_var_file *rec;
+	loff_t pos;
+
+	for (pos = 0; pos + sizeof(struct efi_var_file) <= len;
+	     pos += rec->length) {
+		rec = (struct efi_var_file *)((u8 *)buf + pos);
+		if (rec->length < sizeof(struct efi_var_file) ||
+		    rec->length > len - pos ||
+		    efi_var_restore(rec, false) != EFI_SUCCESS)
+			break;
+	}
+
+	return pos;
+}
+
 /**
  * efi_var_from_file() - read variables from file
  *
  * File ubootefi.var is read from the EFI system partitions and the variables
- * stored in the file are created.
+ * stored in the file are created. The file consists of a snapshot of all
+ * variables optionally followed by journal records which are replayed in
+ * order. An incomplete record at the end of the file is ignored.
  *
  * In case the file does not exist yet or a variable cannot be set EFI_SUCCESS
  * is returned.
@@ -211,7 +312,7 @@ efi_status_t efi_var_from_file(void)
 {
 #ifdef CONFIG_EFI_VARIABLE_FILE_STORE
 	struct efi_var_file *buf;
-	loff_t len;
+	loff_t len, pos;
 	efi_status_t ret;
 	int r;
 
@@ -230,8 +331,11 @@ efi_status_t efi_var_from_file(void)
 		log_err("Failed to load EFI variables\n");
 		goto error;
 	}
-	if (buf->length != len || efi_var_restore(buf, false) != EFI_SUCCESS)
+	pos = efi_var_restore_records(buf, len);
+	if (!pos)
 		log_err("Invalid EFI variables file\n");
+	/* Compact the file on the next update if it could not be replayed */
+	efi_var_file_len = pos == len ? len : 0;
 error:
 	free(buf);
 #endif
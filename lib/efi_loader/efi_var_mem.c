@@ -8,16 +8,146 @@
 #include <common.h>
 #include <efi_loader.h>
 #include <efi_variable.h>
+#include <linux/log2.h>
 #include <u-boot/crc.h>
 
 /*
- * The variables efi_var_file and efi_var_entry must be static to avoid
+ * Number of slots in the hash index of the variable store. Each variable
+ * occupies at least 40 bytes of the buffer so the index is never more than
+ * 80 % full and linear probing always terminates. The number is a power of
+ * two so that a hash is reduced to a slot with a mask.
+ */
+#define EFI_VAR_IDX_SLOTS roundup_pow_of_two(EFI_VAR_BUF_SIZE / 32)
+#define EFI_VAR_IDX_MASK (EFI_VAR_IDX_SLOTS - 1)
+
+/**
+ * struct efi_var_idx_slot - slot of the variable hash index
+ *
+ * Offsets are used instead of pointers so that the index stays valid after
+ * SetVirtualAddressMap().
+ *
+ * @hash:	hash of GUID and name of the variable
+ * @offset:	offset of the variable in efi_var_buf, 0 if the slot is empty
+ */
+struct efi_var_idx_slot {
+	u32 hash;
+	u32 offset;
+};
+
+/*
+ * The variables efi_var_file and efi_var_idx must be static to avoid
  * referencing them via the global offset table (section .got). The GOT
  * is neither mapped as EfiRuntimeServicesData nor do we support its
  * relocation during SetVirtualAddressMap().
  */
 static struct efi_var_file __efi_runtime_data *efi_var_buf;
-static struct efi_var_entry __efi_runtime_data *efi_current_var;
+static struct efi_var_idx_slot __efi_runtime_data *efi_var_idx;
+
+/**
+ * efi_var_mem_hash() - hash GUID and name of a variable
+ *
+ * @guid:	GUID of the variable
+ * @name:	name of the variable
+ * Return:	FNV-1a hash
+ */
+static u32 __efi_runtime efi_var_mem_hash(const efi_guid_t *guid,
+					  const u16 *name)
+{
+	const u8 *pos = (const u8 *)guid;
+	u32 hash = 2166136261U;
+	int i;
+
+	for (i = 0; i < sizeof(efi_guid_t); ++i)
+		hash = (hash ^ pos[i]) * 16777619U;
+	for (; *name; ++name)
+		hash = (hash ^ *name) * 16777619U;
+
+	return hash;
+}
+
+/**
+ * efi_var_idx_add() - add a variable to the hash index
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_idx_add(struct efi_var_entry *var)
+{
+	u32 hash = efi_var_mem_hash(&var->guid, var->name);
+	u32 i;
+
+	for (i = hash & EFI_VAR_IDX_MASK; efi_var_idx[i].offset;
+	     i = (i + 1) & EFI_VAR_IDX_MASK)
+		;
+	efi_var_idx[i].hash = hash;
+	efi_var_idx[i].offset = (uintptr_t)var - (uintptr_t)efi_var_buf;
+}
+
+/**
+ * efi_var_idx_del() - remove a variable from the hash index
+ *
+ * The slot of the variable is freed by shifting back the following entries
+ * of its probe sequence. The offsets of all variables located behind the
+ * deleted one are reduced by the size of the deleted variable.
+ *
+ * @var:	variable in efi_var_buf
+ * @size:	number of bytes occupied by the variable
+ */
+static void __efi_runtime efi_var_idx_del(struct efi_var_entry *var,
+					  u32 size)
+{
+	u32 offset = (uintptr_t)var - (uintptr_t)efi_var_buf;
+	u32 i, j, home;
+
+	for (i = efi_var_mem_hash(&var->guid, var->name) & EFI_VAR_IDX_MASK;
+	     efi_var_idx[i].offset != offset;
+	     i = (i + 1) & EFI_VAR_IDX_MASK) {
+		if (!efi_var_idx[i].offset)
+			return;
+	}
+
+	for (;;) {
+		efi_var_idx[i].offset = 0;
+		for (j = (i + 1) & EFI_VAR_IDX_MASK;;
+		     j = (j + 1) & EFI_VAR_IDX_MASK) {
+			if (!efi_var_idx[j].offset)
+				goto shift;
+			home = efi_var_idx[j].hash & EFI_VAR_IDX_MASK;
+			/* Entry j may move to i if its home is not in (i, j] */
+			if (i <= j ? (i < home && home <= j) :
+				     (i < home || home <= j))
+				continue;
+			break;
+		}
+		efi_var_idx[i] = efi_var_idx[j];
+		i = j;
+	}
+shift:
+	for (i = 0; i < EFI_VAR_IDX_SLOTS; ++i) {
+		if (efi_var_idx[i].offset > offset)
+			efi_var_idx[i].offset -= size;
+	}
+}
+
+/**
+ * efi_var_idx_rebuild() - recreate the hash index from efi_var_buf
+ */
+static void efi_var_idx_rebuild(void)
+{
+	struct efi_var_entry *var, *last;
+	u16 *data;
+
+	memset(efi_var_idx, 0, EFI_VAR_IDX_SLOTS * sizeof(*efi_var_idx));
+	last = (struct efi_var_entry *)
+	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	for (var = efi_var_buf->var; var < last;
+	     var = (struct efi_var_entry *)
+		   ALIGN((uintptr_t)data + var->length, 8)) {
+		for (data = var->name; *data; ++data)
+			;
+		++data;
+		efi_var_idx_add(var);
+	}
+}
 
 /**
  * efi_var_mem_compare() - compare GUID and name with a variable
@@ -54,9 +184,6 @@ efi_var_mem_compare(struct efi_var_entry *var, const efi_guid_t *guid,
 		*next = (struct efi_var_entry *)
 			ALIGN((uintptr_t)data + var->length, 8);
 
-	if (match)
-		efi_current_var = var;
-
 	return match;
 }
 
@@ -65,6 +192,7 @@ struct efi_var_entry __efi_runtime
 		  struct efi_var_entry **next)
 {
 	struct efi_var_entry *var, *last;
+	u32 hash, i;
 
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
@@ -77,28 +205,17 @@ struct efi_var_entry __efi_runtime
 		}
 		return NULL;
 	}
-	if (efi_current_var &&
-	    efi_var_mem_compare(efi_current_var, guid, name, next)) {
-		if (next && *next >= last)
-			*next = NULL;
-		return efi_current_var;
-	}
-
-	var = efi_var_buf->var;
-	if (var < last) {
-		for (; var;) {
-			struct efi_var_entry *pos;
-			bool match;
-
-			match = efi_var_mem_compare(var, guid, name, &pos);
-			if (pos >= last)
-				pos = NULL;
-			if (match) {
-				if (next)
-					*next = pos;
-				return var;
-			}
-			var = pos;
+	hash = efi_var_mem_hash(guid, name);
+	for (i = hash & EFI_VAR_IDX_MASK; efi_var_idx[i].offset;
+	     i = (i + 1) & EFI_VAR_IDX_MASK) {
+		if (efi_var_idx[i].hash != hash)
+			continue;
+		var = (struct efi_var_entry *)
+		      ((uintptr_t)efi_var_buf + efi_var_idx[i].offset);
+		if (efi_var_mem_compare(var, guid, name, next)) {
+			if (next && *next >= last)
+				*next = NULL;
+			return var;
 		}
 	}
 	if (next)
@@ -116,14 +233,13 @@ void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
-	if (var <= efi_current_var)
-		efi_current_var = NULL;
 
 	for (data = var->name; *data; ++data)
 		;
 	++data;
 	next = (struct efi_var_entry *)
 	       ALIGN((uintptr_t)data + var->length, 8);
+	efi_var_idx_del(var, (uintptr_t)next - (uintptr_t)var);
 	efi_var_buf->length -= (uintptr_t)next - (uintptr_t)var;
 
 	/* efi_memcpy_runtime() can be used because next >= var. */
@@ -164,6 +280,7 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 			   sizeof(u16) * var_name_len);
 	efi_memcpy_runtime(data, data1, size1);
 	efi_memcpy_runtime((u8 *)data + size1, data2, size2);
+	efi_var_idx_add(var);
 
 	var = (struct efi_var_entry *)
 	      ALIGN((uintptr_t)data + var->length, 8);
@@ -238,7 +355,7 @@ static void EFIAPI __efi_runtime
 efi_var_mem_notify_virtual_address_map(struct efi_event *event, void *context)
 {
 	efi_convert_pointer(0, (void **)&efi_var_buf);
-	efi_current_var = NULL;
+	efi_convert_pointer(0, (void **)&efi_var_idx);
 }
 
 efi_status_t efi_var_mem_init(void)
@@ -247,14 +364,20 @@ efi_status_t efi_var_mem_init(void)
 	efi_status_t ret;
 	struct efi_event *event;
 
+	size_t size;
+
+	/* The hash index is placed behind the variable buffer */
+	size = ALIGN(EFI_VAR_BUF_SIZE, 8) +
+	       EFI_VAR_IDX_SLOTS * sizeof(struct efi_var_idx_slot);
 	ret = efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
 				 EFI_RUNTIME_SERVICES_DATA,
-				 efi_size_in_pages(EFI_VAR_BUF_SIZE),
-				 &memory);
+				 efi_size_in_pages(size), &memory);
 	if (ret != EFI_SUCCESS)
 		return ret;
 	efi_var_buf = (struct efi_var_file *)(uintptr_t)memory;
-	memset(efi_var_buf, 0, EFI_VAR_BUF_SIZE);
+	efi_var_idx = (struct efi_var_idx_slot *)
+		      ((uintptr_t)memory + ALIGN(EFI_VAR_BUF_SIZE, 8));
+	memset(efi_var_buf, 0, size);
 	efi_var_buf->magic = EFI_VAR_FILE_MAGIC;
 	efi_var_buf->length = (uintptr_t)efi_var_buf->var -
 			      (uintptr_t)efi_var_buf;
@@ -350,4 +473,5 @@ efi_get_next_variable_name_mem(efi_uintn_t *variable_name_size,
 void efi_var_buf_update(struct efi_var_file *var_buf)
 {
 	memcpy(efi_var_buf, var_buf, EFI_VAR_BUF_SIZE);
+	efi_var_idx_rebuild();
 }
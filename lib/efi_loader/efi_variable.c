@@ -337,7 +337,7 @@ efi_status_t efi_set_variable_int(const u16 *variable_name,
 	/* Write non-volatile EFI variables to file */
 	if (attributes & EFI_VARIABLE_NON_VOLATILE &&
 	    ret == EFI_SUCCESS && efi_obj_list_initialized == EFI_SUCCESS)
-		efi_var_to_file();
+		efi_var_to_file_update(variable_name, vendor);
 
 	return EFI_SUCCESS;
 }
@@ -50,97 +50,318 @@
 
 static void default_log(const char *ignored, char *response) {}
 
-static lbaint_t write_sparse_chunk_raw(struct sparse_storage *info,
-				       lbaint_t blk, lbaint_t blkcnt,
-				       void *data,
-				       char *response)
+enum {
+	SPARSE_STREAM_HEADER,	/* waiting for the file header */
+	SPARSE_STREAM_CHUNK,	/* waiting for a chunk header */
+	SPARSE_STREAM_RAW,	/* writing the data of a RAW chunk */
+	SPARSE_STREAM_SKIP,	/* skipping bytes */
+	SPARSE_STREAM_DONE,	/* all chunks processed */
+	SPARSE_STREAM_ERROR,
+};
+
+static lbaint_t write_sparse_blocks(struct sparse_storage *info,
+				    lbaint_t blk, lbaint_t blkcnt,
+				    const void *data, char *response)
 {
-	lbaint_t n = blkcnt, write_blks, blks = 0, aligned_buf_blks = 100;
-	uint32_t *aligned_buf = NULL;
-
-	if (CONFIG_IS_ENABLED(SYS_DCACHE_OFF)) {
-		write_blks = info->write(info, blk, n, data);
-		if (write_blks < n)
-			goto write_fail;
+	lbaint_t write_blks;
 
+	/* write_blks might be > blkcnt due to NAND bad-blocks */
+	write_blks = info->write(info, blk, blkcnt, data);
+	if (IS_ERR_VALUE(write_blks)) {
+		printf("%s: Write failed, block #" LBAFU " [" LBAFU "] (%lld)\n",
+		       __func__, blk, blkcnt, (long long)write_blks);
+		info->mssg("flash write failure", response);
 		return write_blks;
 	}
+	if (write_blks < blkcnt) {
+		printf("%s: Write failed, block #" LBAFU " [" LBAFU "]\n",
+		       __func__, blk, blkcnt);
+		info->mssg("flash write failure(incomplete)", response);
+		return -1;
+	}
+
+	return write_blks;
+}
+
+/* Write out the data in the bounce buffer and update ss->blk to follow it */
+static int flush_sparse_pending(struct sparse_stream *ss, char *response)
+{
+	lbaint_t blks;
+
+	if (!ss->pend_count)
+		return 0;
+
+	blks = write_sparse_blocks(ss->info, ss->pend_blk, ss->pend_count,
+				   ss->buf, response);
+	if (IS_ERR_VALUE(blks))
+		return -1;
+	ss->blk = ss->pend_blk + blks;
+	ss->pend_count = 0;
+
+	return 0;
+}
+
+/*
+ * Write part of a RAW chunk. Data which is aligned for DMA is written
+ * straight from the image. Other data is copied to the bounce buffer, where
+ * it is merged with the following chunks.
+ */
+static int write_sparse_chunk_raw(struct sparse_stream *ss, lbaint_t blkcnt,
+				  const void *data, char *response)
+{
+	struct sparse_storage *info = ss->info;
+	lbaint_t blks, n;
+
+	if (CONFIG_IS_ENABLED(SYS_DCACHE_OFF) ||
+	    IS_ALIGNED((ulong)data, ARCH_DMA_MINALIGN)) {
+		if (flush_sparse_pending(ss, response))
+			return -1;
+		blks = write_sparse_blocks(info, ss->blk, blkcnt, data,
+					   response);
+		if (IS_ERR_VALUE(blks))
+			return -1;
+		ss->blk += blks;
 
-	aligned_buf = memalign(ARCH_DMA_MINALIGN, info->blksz * aligned_buf_blks);
-	if (!aligned_buf) {
-		info->mssg("Malloc failed for: CHUNK_TYPE_RAW", response);
-		return -ENOMEM;
+		return 0;
 	}
 
-	while (blkcnt > 0) {
-		n = min(aligned_buf_blks, blkcnt);
-		memcpy(aligned_buf, data, n * info->blksz);
-
-		/* write_blks might be > n due to NAND bad-blocks */
-		write_blks = info->write(info, blk + blks, n, aligned_buf);
-		if (write_blks < n) {
-			free(aligned_buf);
-			goto write_fail;
+	if (!ss->buf) {
+		ss->buf_blks = max_t(lbaint_t, 1,
+				     CONFIG_IMAGE_SPARSE_BOUNCEBUF_SIZE /
+				     info->blksz);
+		ss->buf = memalign(ARCH_DMA_MINALIGN,
+				   ss->buf_blks * info->blksz);
+		if (!ss->buf) {
+			info->mssg("Malloc failed for: CHUNK_TYPE_RAW",
+				   response);
+			return -1;
 		}
+	}
 
-		blks += write_blks;
+	while (blkcnt > 0) {
+		if (!ss->pend_count)
+			ss->pend_blk = ss->blk;
+		n = min(ss->buf_blks - ss->pend_count, blkcnt);
+		memcpy(ss->buf + ss->pend_count * info->blksz, data,
+		       n * info->blksz);
+		ss->pend_count += n;
+		ss->blk += n;
 		data += n * info->blksz;
 		blkcnt -= n;
+		if (ss->pend_count == ss->buf_blks &&
+		    flush_sparse_pending(ss, response))
+			return -1;
 	}
 
-	free(aligned_buf);
-	return blks;
+	return 0;
+}
 
-write_fail:
-	if (IS_ERR_VALUE(write_blks)) {
-		printf("%s: Write failed, block #" LBAFU " [" LBAFU "] (%lld)\n",
-		       __func__, blk + blks, n, (long long)write_blks);
-		info->mssg("flash write failure", response);
-		return write_blks;
+/* Write blocks from the fill buffer, which holds fill_blks filled blocks */
+static int write_sparse_fill(struct sparse_stream *ss, lbaint_t blkcnt,
+			     char *response)
+{
+	lbaint_t blks, n;
+
+	while (blkcnt > 0) {
+		n = min(ss->fill_blks, blkcnt);
+		blks = write_sparse_blocks(ss->info, ss->blk, n, ss->fill_buf,
+					   response);
+		if (IS_ERR_VALUE(blks))
+			return -1;
+		ss->blk += blks;
+		blkcnt -= n;
 	}
 
-	/* write_blks < n */
-	printf("%s: Write failed, block #" LBAFU " [" LBAFU "]\n",
-	       __func__, blk + blks, n);
-	info->mssg("flash write failure(incomplete)", response);
-	return -1;
+	return 0;
 }
 
-int write_sparse_image(struct sparse_storage *info,
-		       const char *part_name, void *data, char *response)
+/*
+ * Write a FILL chunk. A chunk filled with zero is erased instead, as far as
+ * it covers whole erase groups, if the storage supports this.
+ */
+static int write_sparse_chunk_fill(struct sparse_stream *ss, lbaint_t blkcnt,
+				   uint32_t fill_val, char *response)
 {
-	lbaint_t blk;
-	lbaint_t blkcnt;
-	lbaint_t blks;
-	uint64_t bytes_written = 0;
-	unsigned int chunk;
-	unsigned int offset;
+	struct sparse_storage *info = ss->info;
+	lbaint_t head, mid, blks;
+	u32 rem;
+	int i;
+
+	if (!ss->fill_buf) {
+		ss->fill_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+		ss->fill_buf = (uint32_t *)
+			       memalign(ARCH_DMA_MINALIGN,
+					ROUNDUP(info->blksz * ss->fill_blks,
+						ARCH_DMA_MINALIGN));
+		if (!ss->fill_buf) {
+			info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
+				   response);
+			return -1;
+		}
+		ss->fill_val = ~fill_val;
+	}
+
+	/* The buffer is only refilled when the value changes */
+	if (fill_val != ss->fill_val) {
+		for (i = 0;
+		     i < (info->blksz * ss->fill_blks / sizeof(fill_val));
+		     i++)
+			ss->fill_buf[i] = fill_val;
+		ss->fill_val = fill_val;
+	}
+
+	if (fill_val || !info->erase || !info->erase_blks)
+		return write_sparse_fill(ss, blkcnt, response);
+
+	/* Write the blocks before and after the whole erase groups */
+	div_u64_rem(ss->blk, info->erase_blks, &rem);
+	head = rem ? min(info->erase_blks - rem, blkcnt) : 0;
+	mid = lldiv(blkcnt - head, info->erase_blks) * info->erase_blks;
+
+	if (write_sparse_fill(ss, head, response))
+		return -1;
+	if (mid) {
+		blks = info->erase(info, ss->blk, mid);
+		if (IS_ERR_VALUE(blks) || blks < mid) {
+			printf("%s: Erase failed, block #" LBAFU " [" LBAFU "]\n",
+			       __func__, ss->blk, mid);
+			info->mssg("flash erase failure", response);
+			return -1;
+		}
+		ss->blk += blks;
+	}
+
+	return write_sparse_fill(ss, blkcnt - head - mid, response);
+}
+
+/*
+ * Process a chunk header, plus the fill value of a FILL chunk. Return the
+ * number of bytes used, 0 if more data is needed, or -1 on error.
+ */
+static long sparse_stream_chunk(struct sparse_stream *ss, const void *data,
+				size_t len, char *response)
+{
+	sparse_header_t *sparse_header = &ss->header;
+	struct sparse_storage *info = ss->info;
+	chunk_header_t *chunk_header;
 	uint64_t chunk_data_sz;
-	uint32_t *fill_buf = NULL;
+	size_t hdr_sz;
+	lbaint_t blkcnt;
 	uint32_t fill_val;
-	sparse_header_t *sparse_header;
-	chunk_header_t *chunk_header;
-	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
 
-	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+	hdr_sz = max_t(size_t, sparse_header->chunk_hdr_sz,
+		       sizeof(chunk_header_t));
+	if (len < hdr_sz)
+		return 0;
+	chunk_header = (chunk_header_t *)data;
+
+	if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
+		debug("=== Chunk Header ===\n");
+		debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
+		debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
+		debug("total_size: 0x%x\n", chunk_header->total_sz);
+	}
 
-	/* Read and skip over sparse image header */
-	sparse_header = (sparse_header_t *)data;
+	chunk_data_sz = ((u64)sparse_header->blk_sz) * chunk_header->chunk_sz;
+	blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, info->blksz);
+	switch (chunk_header->chunk_type) {
+	case CHUNK_TYPE_RAW:
+		if (chunk_header->total_sz !=
+		    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
+			info->mssg("Bogus chunk size for chunk type Raw",
+				   response);
+			return -1;
+		}
 
-	data += sparse_header->file_hdr_sz;
-	if (sparse_header->file_hdr_sz > sizeof(sparse_header_t)) {
-		/*
-		 * Skip the remaining bytes in a header that is longer than
-		 * we expected.
-		 */
-		data += (sparse_header->file_hdr_sz - sizeof(sparse_header_t));
+		if (ss->blk + blkcnt > info->start + info->size) {
+			printf("%s: Request would exceed partition size!\n",
+			       __func__);
+			info->mssg("Request would exceed partition size!",
+				   response);
+			return -1;
+		}
+
+		ss->bytes_written += ((u64)blkcnt) * info->blksz;
+		ss->total_blocks += chunk_header->chunk_sz;
+		ss->left = chunk_data_sz;
+		ss->state = SPARSE_STREAM_RAW;
+		break;
+
+	case CHUNK_TYPE_FILL:
+		if (chunk_header->total_sz !=
+		    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
+			info->mssg("Bogus chunk size for chunk type FILL",
+				   response);
+			return -1;
+		}
+
+		if (len < hdr_sz + sizeof(uint32_t))
+			return 0;
+		fill_val = *(uint32_t *)(data + hdr_sz);
+		hdr_sz += sizeof(uint32_t);
+
+		if (ss->blk + blkcnt > info->start + info->size) {
+			printf("%s: Request would exceed partition size!\n",
+			       __func__);
+			info->mssg("Request would exceed partition size!",
+				   response);
+			return -1;
+		}
+
+		if (flush_sparse_pending(ss, response) ||
+		    write_sparse_chunk_fill(ss, blkcnt, fill_val, response))
+			return -1;
+
+		ss->bytes_written += ((u64)blkcnt) * info->blksz;
+		ss->total_blocks += DIV_ROUND_UP_ULL(chunk_data_sz,
+						     sparse_header->blk_sz);
+		break;
+
+	case CHUNK_TYPE_DONT_CARE:
+		if (flush_sparse_pending(ss, response))
+			return -1;
+		ss->blk += info->reserve(info, ss->blk, blkcnt);
+		ss->total_blocks += chunk_header->chunk_sz;
+		break;
+
+	case CHUNK_TYPE_CRC32:
+		if (chunk_header->total_sz !=
+		    sparse_header->chunk_hdr_sz) {
+			info->mssg("Bogus chunk size for chunk type Dont Care",
+				   response);
+			return -1;
+		}
+		ss->total_blocks += chunk_header->chunk_sz;
+		ss->left = chunk_data_sz;
+		ss->state = SPARSE_STREAM_SKIP;
+		break;
+
+	default:
+		printf("%s: Unknown chunk type: %x\n", __func__,
+		       chunk_header->chunk_type);
+		info->mssg("Unknown chunk type", response);
+		return -1;
 	}
 
-	if (!info->mssg)
-		info->mssg = default_log;
+	ss->chunk++;
+
+	return hdr_sz;
+}
+
+/*
+ * Process the file header. Return the number of bytes used, 0 if more data
+ * is needed, or -1 on error.
+ */
+static long sparse_stream_header(struct sparse_stream *ss, const void *data,
+				 size_t len, char *response)
+{
+	sparse_header_t *sparse_header = &ss->header;
+	struct sparse_storage *info = ss->info;
+	unsigned int offset;
+
+	if (len < sizeof(sparse_header_t))
+		return 0;
+	memcpy(sparse_header, data, sizeof(sparse_header_t));
 
 	debug("=== Sparse Image Header ===\n");
 	debug("magic: 0x%x\n", sparse_header->magic);
@@ -166,153 +387,147 @@ int write_sparse_image(struct sparse_storage *info,
 
 	puts("Flashing Sparse Image\n");
 
-	/* Start processing chunks */
-	blk = info->start;
-	for (chunk = 0; chunk < sparse_header->total_chunks; chunk++) {
-		/* Read and skip over chunk header */
-		chunk_header = (chunk_header_t *)data;
-		data += sizeof(chunk_header_t);
-
-		if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
-			debug("=== Chunk Header ===\n");
-			debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
-			debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
-			debug("total_size: 0x%x\n", chunk_header->total_sz);
-		}
-
-		if (sparse_header->chunk_hdr_sz > sizeof(chunk_header_t)) {
-			/*
-			 * Skip the remaining bytes in a header that is longer
-			 * than we expected.
-			 */
-			data += (sparse_header->chunk_hdr_sz -
-				 sizeof(chunk_header_t));
-		}
-
-		chunk_data_sz = ((u64)sparse_header->blk_sz) * chunk_header->chunk_sz;
-		blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, info->blksz);
-		switch (chunk_header->chunk_type) {
-		case CHUNK_TYPE_RAW:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
-				info->mssg("Bogus chunk size for chunk type Raw",
-					   response);
-				return -1;
-			}
-
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				info->mssg("Request would exceed partition size!",
-					   response);
-				return -1;
-			}
-
-			blks = write_sparse_chunk_raw(info, blk, blkcnt,
-						      data, response);
-			if (blks < 0)
-				return -1;
-
-			blk += blks;
-			bytes_written += ((u64)blkcnt) * info->blksz;
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
-			break;
+	/* Skip the remaining bytes in a header that is longer than expected */
+	if (sparse_header->file_hdr_sz > sizeof(sparse_header_t)) {
+		ss->left = sparse_header->file_hdr_sz - sizeof(sparse_header_t);
+		ss->state = SPARSE_STREAM_SKIP;
+	} else {
+		ss->state = SPARSE_STREAM_CHUNK;
+	}
 
-		case CHUNK_TYPE_FILL:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
-				info->mssg("Bogus chunk size for chunk type FILL", response);
-				return -1;
-			}
+	return sizeof(sparse_header_t);
+}
 
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
-				info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
-					   response);
-				return -1;
-			}
+void sparse_stream_start(struct sparse_stream *ss, struct sparse_storage *info,
+			 const char *part_name)
+{
+	memset(ss, '\0', sizeof(*ss));
+	ss->info = info;
+	ss->part_name = part_name;
+	ss->blk = info->start;
+	ss->state = SPARSE_STREAM_HEADER;
 
-			fill_val = *(uint32_t *)data;
-			data = (char *)data + sizeof(uint32_t);
+	if (!info->mssg)
+		info->mssg = default_log;
+}
 
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
+static void sparse_stream_free(struct sparse_stream *ss)
+{
+	free(ss->fill_buf);
+	ss->fill_buf = NULL;
+	free(ss->buf);
+	ss->buf = NULL;
+}
 
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				info->mssg("Request would exceed partition size!",
-					   response);
-				return -1;
-			}
+long sparse_stream_write(struct sparse_stream *ss, const void *data,
+			 size_t len, char *response)
+{
+	struct sparse_storage *info = ss->info;
+	size_t done = 0;
+	lbaint_t blkcnt;
+	long ret;
 
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					info->mssg("flash write failure",
+	while (done < len) {
+		switch (ss->state) {
+		case SPARSE_STREAM_HEADER:
+			ret = sparse_stream_header(ss, data + done, len - done,
 						   response);
-					free(fill_buf);
-					return -1;
-				}
-				blk += blks;
-				i += j;
+			break;
+		case SPARSE_STREAM_CHUNK:
+			if (ss->chunk == ss->header.total_chunks) {
+				ss->state = SPARSE_STREAM_DONE;
+				continue;
 			}
-			bytes_written += ((u64)blkcnt) * info->blksz;
-			total_blocks += DIV_ROUND_UP_ULL(chunk_data_sz,
-							 sparse_header->blk_sz);
-			free(fill_buf);
+			ret = sparse_stream_chunk(ss, data + done, len - done,
+						  response);
 			break;
-
-		case CHUNK_TYPE_DONT_CARE:
-			blk += info->reserve(info, blk, blkcnt);
-			total_blocks += chunk_header->chunk_sz;
+		case SPARSE_STREAM_RAW:
+			/* Whole blocks only, unless the chunk ends here */
+			blkcnt = min_t(u64, ss->left, len - done) / info->blksz;
+			if (!blkcnt)
+				return done;
+			ret = write_sparse_chunk_raw(ss, blkcnt, data + done,
+						     response);
+			if (!ret)
+				ret = blkcnt * info->blksz;
+			ss->left -= ret;
 			break;
-
-		case CHUNK_TYPE_CRC32:
-			if (chunk_header->total_sz !=
-			    sparse_header->chunk_hdr_sz) {
-				info->mssg("Bogus chunk size for chunk type Dont Care",
-					   response);
-				return -1;
-			}
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
+		case SPARSE_STREAM_SKIP:
+			ret = min_t(u64, ss->left, len - done);
+			ss->left -= ret;
+			break;
+		case SPARSE_STREAM_DONE:
+			/* The length is not known when writing a whole image */
+			if (len == SIZE_MAX)
+				return done;
+			printf("%s: Data after the end of the sparse image\n",
+			       __func__);
+			info->mssg("data after end of sparse image", response);
+			ret = -1;
 			break;
-
 		default:
-			printf("%s: Unknown chunk type: %x\n", __func__,
-			       chunk_header->chunk_type);
-			info->mssg("Unknown chunk type", response);
 			return -1;
 		}
+		if (ret < 0) {
+			ss->state = SPARSE_STREAM_ERROR;
+			sparse_stream_free(ss);
+			return -1;
+		}
+		if (!ret)
+			return done;
+		done += ret;
+		if ((ss->state == SPARSE_STREAM_RAW ||
+		     ss->state == SPARSE_STREAM_SKIP) && !ss->left)
+			ss->state = SPARSE_STREAM_CHUNK;
+	}
+
+	return done;
+}
+
+int sparse_stream_finish(struct sparse_stream *ss, char *response)
+{
+	struct sparse_storage *info = ss->info;
+	int ret = -1;
+
+	if (ss->state == SPARSE_STREAM_CHUNK &&
+	    ss->chunk == ss->header.total_chunks)
+		ss->state = SPARSE_STREAM_DONE;
+	if (ss->state == SPARSE_STREAM_ERROR)
+		goto out;
+	if (ss->state != SPARSE_STREAM_DONE) {
+		printf("%s: Sparse image is truncated\n", __func__);
+		info->mssg("sparse image truncated", response);
+		goto out;
 	}
+	if (flush_sparse_pending(ss, response))
+		goto out;
 
 	debug("Wrote %d blocks, expected to write %d blocks\n",
-	      total_blocks, sparse_header->total_blks);
-	printf("........ wrote %llu bytes to '%s'\n", bytes_written, part_name);
+	      ss->total_blocks, ss->header.total_blks);
+	printf("........ wrote %llu bytes to '%s'\n", ss->bytes_written,
+	       ss->part_name);
 
-	if (total_blocks != sparse_header->total_blks) {
+	if (ss->total_blocks != ss->header.total_blks) {
 		info->mssg("sparse image write failure", response);
-		return -1;
+		goto out;
 	}
+	ret = 0;
 
-	return 0;
+out:
+	sparse_stream_free(ss);
+
+	return ret;
+}
+
+int write_sparse_image(struct sparse_storage *info,
+		       const char *part_name, void *data, char *response)
+{
+	struct sparse_stream ss;
+
+	/* The chunk headers give the length of the image */
+	sparse_stream_start(&ss, info, part_name);
+	if (sparse_stream_write(&ss, data, SIZE_MAX, response) < 0)
+		return -1;
+
+	return sparse_stream_finish(&ss, response);
 }
@@ -37,6 +37,22 @@ typedef uint64_t U64;
 
 #define LZ4F_BLOCKUNCOMPRESSED_FLAG 0x80000000U
 
+int LZ4_decompress_safe(const char *source, char *dest, int inputSize,
+			int maxOutputSize)
+{
+	return LZ4_decompress_generic(source, dest, inputSize, maxOutputSize,
+				      endOnInputSize, full, 0, noDict,
+				      (BYTE *)dest, NULL, 0);
+}
+
+int LZ4_decompress_safe_partial(const char *source, char *dest, int inputSize,
+				int targetOutputSize, int maxOutputSize)
+{
+	return LZ4_decompress_generic(source, dest, inputSize, maxOutputSize,
+				      endOnInputSize, partial, targetOutputSize,
+				      noDict, (BYTE *)dest, NULL, 0);
+}
+
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 {
 	const void *end = dst + *dstn;
@@ -7,6 +7,7 @@
 #include <common.h>
 #include <fdtdec.h>
 #include <log.h>
+#include <malloc.h>
 #include <asm/types.h>
 #include <asm/byteorder.h>
 #include <linux/errno.h>
@@ -20,11 +21,6 @@
 #include <u-boot/rsa.h>
 #include <u-boot/rsa-mod-exp.h>
 
-#define UINT64_MULT32(v, multby)  (((uint64_t)(v)) * ((uint32_t)(multby)))
-
-#define get_unaligned_be32(a) fdt32_to_cpu(*(uint32_t *)a)
-#define put_unaligned_be32(a, b) (*(uint32_t *)(b) = cpu_to_fdt32(a))
-
 static inline uint64_t fdt64_to_cpup(const void *p)
 {
 	fdt64_t w;
@@ -36,40 +32,72 @@ static inline uint64_t fdt64_to_cpup(const void *p)
 /* Default public exponent for backward compatibility */
 #define RSA_DEFAULT_PUBEXP	65537
 
+/*
+ * Numbers are handled as little endian arrays of limbs. When the compiler
+ * provides a 128-bit type, a limb is 64 bits wide, which halves the number of
+ * multiply steps compared with 32-bit limbs on 64-bit CPUs. Other CPUs use
+ * 32-bit limbs, with their 32x32->64 bit multiply.
+ */
+#ifdef __SIZEOF_INT128__
+typedef uint64_t bn_limb;
+typedef unsigned __int128 bn_dlimb;
+#else
+typedef uint32_t bn_limb;
+typedef uint64_t bn_dlimb;
+#endif
+
+#define BN_LIMB_BITS	(sizeof(bn_limb) * 8)
+
+/* Window size used for exponents with many bits set */
+#define RSA_EXP_WINDOW	4
+
+/**
+ * struct mont_ctx - Montgomery arithmetic context
+ *
+ * @len:	Number of limbs in @modulus and in all numbers using it
+ * @n0inv:	-1 / modulus[0] mod 2^BN_LIMB_BITS
+ * @modulus:	Modulus, as little endian limb array
+ */
+struct mont_ctx {
+	uint len;
+	bn_limb n0inv;
+	const bn_limb *modulus;
+};
+
 /**
  * subtract_modulus() - subtract modulus from the given value
  *
- * @key:	Key containing modulus to subtract
- * @num:	Number to subtract modulus from, as little endian word array
+ * @ctx:	Context containing modulus to subtract
+ * @num:	Number to subtract modulus from, as little endian limb array
  */
-static void subtract_modulus(const struct rsa_public_key *key, uint32_t num[])
+static void subtract_modulus(const struct mont_ctx *ctx, bn_limb num[])
 {
-	int64_t acc = 0;
+	bn_limb borrow = 0;
 	uint i;
 
-	for (i = 0; i < key->len; i++) {
-		acc += (uint64_t)num[i] - key->modulus[i];
-		num[i] = (uint32_t)acc;
-		acc >>= 32;
+	for (i = 0; i < ctx->len; i++) {
+		bn_dlimb acc = (bn_dlimb)num[i] - ctx->modulus[i] - borrow;
+
+		num[i] = (bn_limb)acc;
+		borrow = (bn_limb)(acc >> BN_LIMB_BITS) & 1;
 	}
 }
 
 /**
  * greater_equal_modulus() - check if a value is >= modulus
  *
- * @key:	Key containing modulus to check
- * @num:	Number to check against modulus, as little endian word array
+ * @ctx:	Context containing modulus to check
+ * @num:	Number to check against modulus, as little endian limb array
  * Return: 0 if num < modulus, 1 if num >= modulus
  */
-static int greater_equal_modulus(const struct rsa_public_key *key,
-				 uint32_t num[])
+static int greater_equal_modulus(const struct mont_ctx *ctx, bn_limb num[])
 {
 	int i;
 
-	for (i = (int)key->len - 1; i >= 0; i--) {
-		if (num[i] < key->modulus[i])
+	for (i = (int)ctx->len - 1; i >= 0; i--) {
+		if (num[i] < ctx->modulus[i])
 			return 0;
-		if (num[i] > key->modulus[i])
+		if (num[i] > ctx->modulus[i])
 			return 1;
 	}
 
@@ -81,34 +109,41 @@ static int greater_equal_modulus(const struct rsa_public_key *key,
  *
  * Operation: montgomery result[] += a * b[] / n0inv % modulus
  *
- * @key:	RSA key
- * @result:	Place to put result, as little endian word array
+ * The multiplication by @a and the reduction are done in the same pass over
+ * the limbs.
+ *
+ * @ctx:	Montgomery context
+ * @result:	Place to put result, as little endian limb array
  * @a:		Multiplier
- * @b:		Multiplicand, as little endian word array
+ * @b:		Multiplicand, as little endian limb array
  */
-static void montgomery_mul_add_step(const struct rsa_public_key *key,
-		uint32_t result[], const uint32_t a, const uint32_t b[])
+static void montgomery_mul_add_step(const struct mont_ctx *ctx,
+				    bn_limb result[], const bn_limb a,
+				    const bn_limb b[])
 {
-	uint64_t acc_a, acc_b;
-	uint32_t d0;
+	const bn_limb *modulus = ctx->modulus;
+	const uint len = ctx->len;
+	bn_dlimb acc_a, acc_b;
+	bn_limb d0;
 	uint i;
 
-	acc_a = (uint64_t)a * b[0] + result[0];
-	d0 = (uint32_t)acc_a * key->n0inv;
-	acc_b = (uint64_t)d0 * key->modulus[0] + (uint32_t)acc_a;
-	for (i = 1; i < key->len; i++) {
-		acc_a = (acc_a >> 32) + (uint64_t)a * b[i] + result[i];
-		acc_b = (acc_b >> 32) + (uint64_t)d0 * key->modulus[i] +
-				(uint32_t)acc_a;
-		result[i - 1] = (uint32_t)acc_b;
+	acc_a = (bn_dlimb)a * b[0] + result[0];
+	d0 = (bn_limb)acc_a * ctx->n0inv;
+	acc_b = (bn_dlimb)d0 * modulus[0] + (bn_limb)acc_a;
+	for (i = 1; i < len; i++) {
+		acc_a = (acc_a >> BN_LIMB_BITS) + (bn_dlimb)a * b[i] +
+			result[i];
+		acc_b = (acc_b >> BN_LIMB_BITS) + (bn_dlimb)d0 * modulus[i] +
+			(bn_limb)acc_a;
+		result[i - 1] = (bn_limb)acc_b;
 	}
 
-	acc_a = (acc_a >> 32) + (acc_b >> 32);
+	acc_a = (acc_a >> BN_LIMB_BITS) + (acc_b >> BN_LIMB_BITS);
 
-	result[i - 1] = (uint32_t)acc_a;
+	result[i - 1] = (bn_limb)acc_a;
 
-	if (acc_a >> 32)
-		subtract_modulus(key, result);
+	if (acc_a >> BN_LIMB_BITS)
+		subtract_modulus(ctx, result);
 }
 
 /**
@@ -116,36 +151,209 @@ static void montgomery_mul_add_step(const struct rsa_public_key *key,
  *
  * Operation: montgomery result[] = a[] * b[] / n0inv % modulus
  *
- * @key:	RSA key
- * @result:	Place to put result, as little endian word array
- * @a:		Multiplier, as little endian word array
- * @b:		Multiplicand, as little endian word array
+ * @ctx:	Montgomery context
+ * @result:	Place to put result, as little endian limb array
+ * @a:		Multiplier, as little endian limb array
+ * @b:		Multiplicand, as little endian limb array
  */
-static void montgomery_mul(const struct rsa_public_key *key,
-		uint32_t result[], uint32_t a[], const uint32_t b[])
+static void montgomery_mul(const struct mont_ctx *ctx, bn_limb result[],
+			   const bn_limb a[], const bn_limb b[])
 {
 	uint i;
 
-	for (i = 0; i < key->len; ++i)
+	for (i = 0; i < ctx->len; ++i)
 		result[i] = 0;
-	for (i = 0; i < key->len; ++i)
-		montgomery_mul_add_step(key, result, a[i], b);
+	for (i = 0; i < ctx->len; ++i)
+		montgomery_mul_add_step(ctx, result, a[i], b);
+}
+
+/**
+ * montgomery_sqr() - Perform montgomery square
+ *
+ * Operation: montgomery result[] = a[] * a[] / n0inv % modulus
+ *
+ * Each cross product a[i] * a[j] appears twice in the square, so it is
+ * calculated once and the sum doubled. Together with the separate reduction
+ * pass, this needs about 1.5 * len^2 limb multiplications instead of the
+ * 2 * len^2 of montgomery_mul(). Squaring makes up nearly all of the work for
+ * usual public exponents.
+ *
+ * @ctx:	Montgomery context
+ * @result:	Place to put result, as little endian limb array
+ * @a:		Value to square, as little endian limb array
+ */
+static void montgomery_sqr(const struct mont_ctx *ctx, bn_limb result[],
+			   const bn_limb a[])
+{
+	const bn_limb *modulus = ctx->modulus;
+	const uint len = ctx->len;
+	bn_limb t[2 * len];
+	bn_limb carry, top, m;
+	bn_dlimb acc;
+	uint i, j;
+
+	/* Cross products */
+	memset(t, '\0', sizeof(t));
+	for (i = 0; i < len; i++) {
+		carry = 0;
+		for (j = i + 1; j < len; j++) {
+			acc = (bn_dlimb)a[i] * a[j] + t[i + j] + carry;
+			t[i + j] = (bn_limb)acc;
+			carry = acc >> BN_LIMB_BITS;
+		}
+		t[i + len] = carry;
+	}
+
+	/* Double them and add the squares */
+	top = 0;
+	for (i = 0; i < 2 * len; i++) {
+		bn_limb bit = t[i] >> (BN_LIMB_BITS - 1);
+
+		t[i] = t[i] << 1 | top;
+		top = bit;
+	}
+	carry = 0;
+	for (i = 0; i < len; i++) {
+		acc = (bn_dlimb)a[i] * a[i] + t[2 * i] + carry;
+		t[2 * i] = (bn_limb)acc;
+		acc = (acc >> BN_LIMB_BITS) + t[2 * i + 1];
+		t[2 * i + 1] = (bn_limb)acc;
+		carry = acc >> BN_LIMB_BITS;
+	}
+
+	/* Reduce, one limb at a time */
+	top = 0;
+	for (i = 0; i < len; i++) {
+		m = t[i] * ctx->n0inv;
+		carry = 0;
+		for (j = 0; j < len; j++) {
+			acc = (bn_dlimb)m * modulus[j] + t[i + j] + carry;
+			t[i + j] = (bn_limb)acc;
+			carry = acc >> BN_LIMB_BITS;
+		}
+		acc = (bn_dlimb)t[i + len] + carry + top;
+		t[i + len] = (bn_limb)acc;
+		top = acc >> BN_LIMB_BITS;
+	}
+
+	memcpy(result, t + len, len * sizeof(bn_limb));
+	if (top)
+		subtract_modulus(ctx, result);
+}
+
+/**
+ * mont_init() - Set up a Montgomery context for a modulus
+ *
+ * This calculates n0inv from the modulus, with Newton's iteration: each step
+ * doubles the number of correct low bits of the inverse, starting from 3
+ * bits since n * n = 1 mod 8 for any odd n.
+ *
+ * The n0inv value of the key (struct key_prop) is not used: it is only valid
+ * modulo 2^32, while n0inv here is needed modulo 2^BN_LIMB_BITS. It takes a
+ * few multiplications to calculate, which is nothing next to the
+ * exponentiation.
+ *
+ * @ctx:	Context to set up
+ * @modulus:	Modulus, as little endian limb array
+ * @len:	Number of limbs in @modulus
+ * Return: 0 if OK, -EINVAL if the modulus is even
+ */
+static int mont_init(struct mont_ctx *ctx, const bn_limb *modulus, uint len)
+{
+	bn_limb n0 = modulus[0];
+	bn_limb inv = n0;
+	uint bits;
+
+	if (!(n0 & 1)) {
+		debug("RSA modulus must be odd\n");
+		return -EINVAL;
+	}
+
+	for (bits = 3; bits < BN_LIMB_BITS; bits *= 2)
+		inv *= 2 - n0 * inv;
+
+	ctx->len = len;
+	ctx->n0inv = -inv;
+	ctx->modulus = modulus;
+
+	return 0;
+}
+
+/**
+ * mont_scale_rr() - Convert R^2 to a larger R
+ *
+ * The R^2 value of the key uses R = 2^(32 * number of 32-bit words). When the
+ * key does not fill the last limb, R for the limb array is 2^@shift times
+ * larger, so R^2 has to be multiplied by 2^(2 * @shift) modulo the modulus.
+ *
+ * @ctx:	Montgomery context
+ * @rr:		R^2 value to update, as little endian limb array
+ * @shift:	Number of bits R grows by
+ */
+static void mont_scale_rr(const struct mont_ctx *ctx, bn_limb *rr, uint shift)
+{
+	uint i, j;
+
+	for (i = 0; i < 2 * shift; i++) {
+		bn_limb carry = 0;
+
+		for (j = 0; j < ctx->len; j++) {
+			bn_limb top = rr[j] >> (BN_LIMB_BITS - 1);
+
+			rr[j] = rr[j] << 1 | carry;
+			carry = top;
+		}
+		if (carry || greater_equal_modulus(ctx, rr))
+			subtract_modulus(ctx, rr);
+	}
+}
+
+/**
+ * bn_from_bytes() - Convert a big endian byte array to a limb array
+ *
+ * @dst:	Little endian limb array of @len limbs to fill
+ * @len:	Number of limbs in @dst
+ * @src:	Big endian byte array, which must fit in @dst
+ * @size:	Number of bytes in @src
+ */
+static void bn_from_bytes(bn_limb *dst, uint len, const uint8_t *src,
+			  uint size)
+{
+	uint i;
+
+	memset(dst, '\0', len * sizeof(*dst));
+	for (i = 0; i < size; i++)
+		dst[i / sizeof(bn_limb)] |= (bn_limb)src[size - 1 - i] <<
+					    (8 * (i % sizeof(bn_limb)));
+}
+
+/**
+ * bn_to_bytes() - Convert a limb array to a big endian byte array
+ *
+ * @dst:	Big endian byte array to fill
+ * @size:	Number of bytes in @dst
+ * @src:	Little endian limb array, holding at least @size bytes
+ */
+static void bn_to_bytes(uint8_t *dst, uint size, const bn_limb *src)
+{
+	uint i;
+
+	for (i = 0; i < size; i++)
+		dst[size - 1 - i] = src[i / sizeof(bn_limb)] >>
+				    (8 * (i % sizeof(bn_limb)));
 }
 
 /**
  * num_pub_exponent_bits() - Number of bits in the public exponent
  *
- * @key:	RSA key
+ * @exponent:	Public exponent
  * @num_bits:	Storage for the number of public exponent bits
  */
-static int num_public_exponent_bits(const struct rsa_public_key *key,
-		int *num_bits)
+static int num_public_exponent_bits(uint64_t exponent, int *num_bits)
 {
-	uint64_t exponent;
 	int exponent_bits;
 	const uint max_bits = (sizeof(exponent) * 8);
 
-	exponent = key->exponent;
 	exponent_bits = 0;
 
 	if (!exponent) {
@@ -165,43 +373,112 @@ static int num_public_exponent_bits(const struct rsa_public_key *key,
 /**
  * is_public_exponent_bit_set() - Check if a bit in the public exponent is set
  *
- * @key:	RSA key
+ * @exponent:	Public exponent
  * @pos:	The bit position to check
  */
-static int is_public_exponent_bit_set(const struct rsa_public_key *key,
-		int pos)
+static int is_public_exponent_bit_set(uint64_t exponent, int pos)
+{
+	return !!(exponent & (1ULL << pos));
+}
+
+/**
+ * use_exp_window() - Check whether windowed exponentiation is cheaper
+ *
+ * Square-and-multiply needs a multiplication for each bit set after the top
+ * one. With a fixed window, there is one per window, plus those needed to
+ * fill the table of powers. The common exponents, such as 65537 or 3, have
+ * few bits set and do not use the window.
+ *
+ * @exponent:	Public exponent
+ * @bits:	Number of bits in @exponent
+ * Return: true to use a window
+ */
+static bool use_exp_window(uint64_t exponent, int bits)
 {
-	return key->exponent & (1ULL << pos);
+	int set = 0;
+	int i;
+
+	for (i = 0; i < bits; i++)
+		set += is_public_exponent_bit_set(exponent, i);
+
+	return set - 1 > (1 << RSA_EXP_WINDOW) - 2 +
+			 (bits + RSA_EXP_WINDOW - 1) / RSA_EXP_WINDOW;
+}
+
+/**
+ * pow_mod_window() - Exponentiation with a fixed window
+ *
+ * Operation: acc[] = a_scaled[] ^ exponent, all in the Montgomery domain
+ *
+ * @ctx:	Montgomery context
+ * @exponent:	Public exponent
+ * @bits:	Number of bits in @exponent
+ * @a_scaled:	Value to raise, in the Montgomery domain
+ * @acc:	Place to put result
+ * @tmp:	Scratch space for one number
+ * Return: 0 if OK, -ENOMEM if the table of powers cannot be allocated
+ */
+static int pow_mod_window(const struct mont_ctx *ctx, uint64_t exponent,
+			  int bits, const bn_limb a_scaled[], bn_limb acc[],
+			  bn_limb tmp[])
+{
+	const uint size = ctx->len * sizeof(bn_limb);
+	bn_limb *table;
+	int i, j;
+
+	/* table[i] = a ^ i for i >= 1 */
+	table = malloc(size << RSA_EXP_WINDOW);
+	if (!table)
+		return -ENOMEM;
+	memcpy(table + ctx->len, a_scaled, size);
+	for (i = 2; i < 1 << RSA_EXP_WINDOW; i++)
+		montgomery_mul(ctx, table + i * ctx->len,
+			       table + (i - 1) * ctx->len, a_scaled);
+
+	i = (bits - 1) / RSA_EXP_WINDOW * RSA_EXP_WINDOW;
+	memcpy(acc, table + (exponent >> i) * ctx->len, size);
+	for (i -= RSA_EXP_WINDOW; i >= 0; i -= RSA_EXP_WINDOW) {
+		uint win = (exponent >> i) & ((1 << RSA_EXP_WINDOW) - 1);
+
+		for (j = 0; j < RSA_EXP_WINDOW; j += 2) {
+			montgomery_sqr(ctx, tmp, acc);
+			montgomery_sqr(ctx, acc, tmp);
+		}
+		if (win) {
+			montgomery_mul(ctx, tmp, acc, table + win * ctx->len);
+			memcpy(acc, tmp, size);
+		}
+	}
+	free(table);
+
+	return 0;
 }
 
 /**
  * pow_mod() - in-place public exponentiation
  *
- * @key:	RSA key
- * @inout:	Big-endian word array containing value and result
+ * @ctx:	Montgomery context
+ * @exponent:	Public exponent
+ * @rr:		R^2 mod modulus, as little endian limb array
+ * @inout:	Little endian limb array containing value and result
  */
-static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
+static int pow_mod(const struct mont_ctx *ctx, uint64_t exponent,
+		   const bn_limb rr[], bn_limb *inout)
 {
-	uint32_t *result, *ptr;
-	uint i;
+	bn_limb *val = inout;
 	int j, k;
 
-	/* Sanity check for stack size - key->len is in 32-bit words */
-	if (key->len > RSA_MAX_KEY_BITS / 32) {
-		debug("RSA key words %u exceeds maximum %d\n", key->len,
-		      RSA_MAX_KEY_BITS / 32);
+	/* Sanity check for stack size */
+	if (ctx->len > RSA_MAX_KEY_BITS / BN_LIMB_BITS) {
+		debug("RSA key limbs %u exceeds maximum %d\n", ctx->len,
+		      (int)(RSA_MAX_KEY_BITS / BN_LIMB_BITS));
 		return -EINVAL;
 	}
 
-	uint32_t val[key->len], acc[key->len], tmp[key->len];
-	uint32_t a_scaled[key->len];
-	result = tmp;  /* Re-use location. */
+	bn_limb acc[ctx->len], tmp[ctx->len];
+	bn_limb a_scaled[ctx->len];
 
-	/* Convert from big endian byte array to little endian word array. */
-	for (i = 0, ptr = inout + key->len - 1; i < key->len; i++, ptr--)
-		val[i] = get_unaligned_be32(ptr);
-
-	if (0 != num_public_exponent_bits(key, &k))
+	if (0 != num_public_exponent_bits(exponent, &k))
 		return -EINVAL;
 
 	if (k < 2) {
@@ -210,101 +487,105 @@ static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 		return -EINVAL;
 	}
 
-	if (!is_public_exponent_bit_set(key, 0)) {
+	if (!is_public_exponent_bit_set(exponent, 0)) {
 		debug("LSB of RSA public exponent must be set.\n");
 		return -EINVAL;
 	}
 
-	/* the bit at e[k-1] is 1 by definition, so start with: C := M */
-	montgomery_mul(key, acc, val, key->rr); /* acc = a * RR / R mod n */
-	/* retain scaled version for intermediate use */
-	memcpy(a_scaled, acc, key->len * sizeof(a_scaled[0]));
-
-	for (j = k - 2; j > 0; --j) {
-		montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod n */
-
-		if (is_public_exponent_bit_set(key, j)) {
-			/* acc = tmp * val / R mod n */
-			montgomery_mul(key, acc, tmp, a_scaled);
-		} else {
-			/* e[j] == 0, copy tmp back to acc for next operation */
-			memcpy(acc, tmp, key->len * sizeof(acc[0]));
+	montgomery_mul(ctx, a_scaled, val, rr); /* a_scaled = a * RR / R mod n */
+
+	if (use_exp_window(exponent, k) &&
+	    !pow_mod_window(ctx, exponent, k, a_scaled, acc, tmp)) {
+		/* acc = acc * 1 / R mod n, leaving the Montgomery domain */
+		memset(tmp, '\0', sizeof(tmp));
+		tmp[0] = 1;
+		montgomery_mul(ctx, val, acc, tmp);
+	} else {
+		/* the bit at e[k-1] is 1 by definition, so start with: C := M */
+		memcpy(acc, a_scaled, sizeof(acc));
+
+		for (j = k - 2; j > 0; --j) {
+			/* tmp = acc^2 / R mod n */
+			montgomery_sqr(ctx, tmp, acc);
+
+			if (is_public_exponent_bit_set(exponent, j)) {
+				/* acc = tmp * val / R mod n */
+				montgomery_mul(ctx, acc, tmp, a_scaled);
+			} else {
+				/* e[j] == 0, copy tmp back to acc */
+				memcpy(acc, tmp, sizeof(acc));
+			}
 		}
-	}
 
-	/* the bit at e[0] is always 1 */
-	montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod n */
-	montgomery_mul(key, acc, tmp, val); /* acc = tmp * a / R mod M */
-	memcpy(result, acc, key->len * sizeof(result[0]));
+		/* the bit at e[0] is always 1 */
+		montgomery_sqr(ctx, tmp, acc); /* tmp = acc^2 / R mod n */
+		montgomery_mul(ctx, acc, tmp, val); /* acc = tmp * a / R mod M */
+		memcpy(val, acc, sizeof(acc));
+	}
 
 	/* Make sure result < mod; result is at most 1x mod too large. */
-	if (greater_equal_modulus(key, result))
-		subtract_modulus(key, result);
+	if (greater_equal_modulus(ctx, val))
+		subtract_modulus(ctx, val);
 
-	/* Convert to bigendian byte array */
-	for (i = key->len - 1, ptr = inout; (int)i >= 0; i--, ptr++)
-		put_unaligned_be32(result[i], ptr);
 	return 0;
 }
 
-static void rsa_convert_big_endian(uint32_t *dst, const uint32_t *src, int len)
-{
-	int i;
-
-	for (i = 0; i < len; i++)
-		dst[i] = fdt32_to_cpu(src[len - 1 - i]);
-}
-
 int rsa_mod_exp_sw(const uint8_t *sig, uint32_t sig_len,
 		struct key_prop *prop, uint8_t *out)
 {
-	struct rsa_public_key key;
+	struct mont_ctx ctx;
+	uint64_t exponent;
+	uint bytes, len;
 	int ret;
 
 	if (!prop) {
 		debug("%s: Skipping invalid prop", __func__);
 		return -EBADF;
 	}
-	key.n0inv = prop->n0inv;
-	key.len = prop->num_bits;
 
 	if (!prop->public_exponent)
-		key.exponent = RSA_DEFAULT_PUBEXP;
+		exponent = RSA_DEFAULT_PUBEXP;
 	else
-		key.exponent = fdt64_to_cpup(prop->public_exponent);
+		exponent = fdt64_to_cpup(prop->public_exponent);
 
-	if (!key.len || !prop->modulus || !prop->rr) {
+	if (!prop->num_bits || !prop->modulus || !prop->rr) {
 		debug("%s: Missing RSA key info", __func__);
 		return -EFAULT;
 	}
 
 	/* Sanity check for stack size */
-	if (key.len > RSA_MAX_KEY_BITS || key.len < RSA_MIN_KEY_BITS) {
+	if (prop->num_bits > RSA_MAX_KEY_BITS ||
+	    prop->num_bits < RSA_MIN_KEY_BITS) {
 		debug("RSA key bits %u outside allowed range %d..%d\n",
-		      key.len, RSA_MIN_KEY_BITS, RSA_MAX_KEY_BITS);
+		      prop->num_bits, RSA_MIN_KEY_BITS, RSA_MAX_KEY_BITS);
 		return -EFAULT;
 	}
-	key.len /= sizeof(uint32_t) * 8;
-	uint32_t key1[key.len], key2[key.len];
-
-	key.modulus = key1;
-	key.rr = key2;
-	rsa_convert_big_endian(key.modulus, (uint32_t *)prop->modulus, key.len);
-	rsa_convert_big_endian(key.rr, (uint32_t *)prop->rr, key.len);
-	if (!key.modulus || !key.rr) {
-		debug("%s: Out of memory", __func__);
-		return -ENOMEM;
+	/* The key is stored as whole 32-bit words */
+	bytes = prop->num_bits / 32 * sizeof(uint32_t);
+	if (sig_len != bytes) {
+		debug("%s: Signature is of incorrect length %u\n", __func__,
+		      sig_len);
+		return -EINVAL;
 	}
+	len = (bytes + sizeof(bn_limb) - 1) / sizeof(bn_limb);
+
+	bn_limb modulus[len], rr[len], val[len];
 
-	uint32_t buf[sig_len / sizeof(uint32_t)];
+	bn_from_bytes(modulus, len, prop->modulus, bytes);
+	bn_from_bytes(rr, len, prop->rr, bytes);
+	bn_from_bytes(val, len, sig, sig_len);
 
-	memcpy(buf, sig, sig_len);
+	ret = mont_init(&ctx, modulus, len);
+	if (ret)
+		return ret;
+	if (len * sizeof(bn_limb) != bytes)
+		mont_scale_rr(&ctx, rr, (len * sizeof(bn_limb) - bytes) * 8);
 
-	ret = pow_mod(&key, buf);
+	ret = pow_mod(&ctx, exponent, rr, val);
 	if (ret)
 		return ret;
 
-	memcpy(out, buf, sig_len);
+	bn_to_bytes(out, sig_len, val);
 
 	return 0;
 }
@@ -314,19 +595,19 @@ int rsa_mod_exp_sw(const uint8_t *sig, uint32_t sig_len,
  * zynq_pow_mod - in-place public exponentiation
  *
  * @keyptr:	RSA key
- * @inout:	Big-endian word array containing value and result
+ * @inout:	Little endian word array containing value and result
  * Return: 0 on successful calculation, otherwise failure error code
  *
- * FIXME: Use pow_mod() instead of zynq_pow_mod()
- *        pow_mod calculation required for zynq is bit different from
- *        pw_mod above here, hence defined zynq specific routine.
+ * The key and value are little endian arrays of 32-bit words and the public
+ * exponent is always 65537.
  */
 int zynq_pow_mod(uint32_t *keyptr, uint32_t *inout)
 {
-	u32 *result, *ptr;
-	uint i;
 	struct rsa_public_key *key;
-	u32 val[RSA2048_BYTES], acc[RSA2048_BYTES], tmp[RSA2048_BYTES];
+	struct mont_ctx ctx;
+	uint bytes, len;
+	uint i;
+	int ret;
 
 	key = (struct rsa_public_key *)keyptr;
 
@@ -336,25 +617,36 @@ int zynq_pow_mod(uint32_t *keyptr, uint32_t *inout)
 		      RSA_MAX_KEY_BITS / 32);
 		return -EINVAL;
 	}
+	bytes = key->len * sizeof(uint32_t);
+	len = (bytes + sizeof(bn_limb) - 1) / sizeof(bn_limb);
 
-	result = tmp;  /* Re-use location. */
+	bn_limb modulus[len], rr[len], val[len];
 
-	for (i = 0, ptr = inout; i < key->len; i++, ptr++)
-		val[i] = *(ptr);
+	memset(modulus, '\0', sizeof(modulus));
+	memset(rr, '\0', sizeof(rr));
+	memset(val, '\0', sizeof(val));
+	for (i = 0; i < key->len; i++) {
+		uint shift = 32 * (i % (sizeof(bn_limb) / sizeof(uint32_t)));
+		uint pos = i / (sizeof(bn_limb) / sizeof(uint32_t));
 
-	montgomery_mul(key, acc, val, key->rr);  /* axx = a * RR / R mod M */
-	for (i = 0; i < 16; i += 2) {
-		montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod M */
-		montgomery_mul(key, acc, tmp, tmp); /* acc = tmp^2 / R mod M */
+		modulus[pos] |= (bn_limb)key->modulus[i] << shift;
+		rr[pos] |= (bn_limb)key->rr[i] << shift;
+		val[pos] |= (bn_limb)inout[i] << shift;
 	}
-	montgomery_mul(key, result, acc, val);  /* result = XX * a / R mod M */
 
-	/* Make sure result < mod; result is at most 1x mod too large. */
-	if (greater_equal_modulus(key, result))
-		subtract_modulus(key, result);
+	ret = mont_init(&ctx, modulus, len);
+	if (ret)
+		return ret;
+	if (len * sizeof(bn_limb) != bytes)
+		mont_scale_rr(&ctx, rr, (len * sizeof(bn_limb) - bytes) * 8);
+
+	ret = pow_mod(&ctx, RSA_DEFAULT_PUBEXP, rr, val);
+	if (ret)
+		return ret;
 
-	for (i = 0, ptr = inout; i < key->len; i++, ptr++)
-		*ptr = result[i];
+	for (i = 0; i < key->len; i++)
+		inout[i] = val[i / (sizeof(bn_limb) / sizeof(uint32_t))] >>
+			   (32 * (i % (sizeof(bn_limb) / sizeof(uint32_t))));
 
 	return 0;
 }
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the hush parse cache
+ */
+
+#include <common.h>
+#include <cli_hush.h>
+#include <command.h>
+#include <env.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+static const char script1[] =
+	"setenv res ${res}a; for i in 1 2; do setenv res ${res}$i; done\n"
+	"if test -n ${res}; then setenv res ${res}y; else setenv res n; fi";
+static const char script2[] =
+	"setenv res ${res}b; for i in 3 4; do setenv res ${res}$i; done";
+
+/* Run the 'script' variable, starting with an empty 'res' */
+static int run_script(struct unit_test_state *uts, const char *expect)
+{
+	ut_assertok(env_set("res", NULL));
+	ut_assertok(run_command("run script", 0));
+	ut_asserteq_str(expect, env_get("res"));
+
+	return 0;
+}
+
+static int lib_test_hush_parse_cache(struct unit_test_state *uts)
+{
+	ulong hits, misses, old_hits, old_misses;
+
+	ut_assertok(env_set("script", script1));
+	ut_assertok(run_script(uts, "a12y"));
+	hush_parse_cache_stats(&old_hits, &old_misses);
+
+	/* Running it again gives the same result with nothing parsed */
+	ut_assertok(run_script(uts, "a12y"));
+	hush_parse_cache_stats(&hits, &misses);
+	ut_assert(hits > old_hits);
+	ut_asserteq(old_misses, misses);
+
+	/* Changing the variable must not run the old script */
+	ut_assertok(env_set("script", script2));
+	ut_assertok(run_script(uts, "b34"));
+	hush_parse_cache_stats(&hits, &misses);
+	ut_assert(misses > old_misses);
+
+	ut_assertok(env_set("script", script1));
+	ut_assertok(run_script(uts, "a12y"));
+
+	/* Scripts which may change IFS are not cached */
+	hush_parse_cache_stats(&old_hits, &old_misses);
+	ut_assertok(run_command("setenv IFS; setenv res c", 0));
+	ut_asserteq_str("c", env_get("res"));
+	hush_parse_cache_stats(&hits, &misses);
+	ut_asserteq(old_misses, misses);
+	ut_asserteq(old_hits, hits);
+
+	ut_assertok(env_set("script", NULL));
+	ut_assertok(env_set("res", NULL));
+
+	return 0;
+}
+LIB_TEST(lib_test_hush_parse_cache, 0);
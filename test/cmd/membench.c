@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the membench command
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <env.h>
+#include <test/ut.h>
+
+/* Declare a new mem test */
+#define MEM_TEST(_name, _flags)	UNIT_TEST(_name, _flags, mem_test)
+
+/* Check the table layout and that -e exports every result */
+static int mem_test_membench(struct unit_test_state *uts)
+{
+	ut_assertok(env_set("membench_copy", NULL));
+	ut_assertok(console_record_reset_enable());
+	ut_assertok(run_command("membench -e 100000 10000", 0));
+	ut_assert_nextline("Kernel   Rate (MB/s)");
+	ut_assert_nextlinen("copy ");
+	ut_assert_nextlinen("scale ");
+	ut_assert_nextlinen("add ");
+	ut_assert_nextlinen("triad ");
+	ut_assert_nextline("%s", "");
+	ut_assert_nextline("Working set  Latency (ns)");
+	ut_assert_nextlinen("       4 KiB");
+	ut_assert_nextlinen("       8 KiB");
+	ut_assert_nextlinen("      16 KiB");
+	ut_assert_nextlinen("      32 KiB");
+	ut_assert_nextlinen("      64 KiB");
+	ut_assert_console_end();
+
+	ut_assert(env_get_ulong("membench_copy", 10, 0) > 0);
+	ut_assert(env_get_ulong("membench_triad", 10, 0) > 0);
+	ut_assertnonnull(env_get("membench_lat_4"));
+	ut_assertnonnull(env_get("membench_lat_64"));
+
+	ut_asserteq(1, run_command("membench -e 100000 100", 0));
+
+	return 0;
+}
+MEM_TEST(mem_test_membench, UT_TESTF_CONSOLE_REC);
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the fast mtest engine
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <asm/test.h>
+#include <test/ut.h>
+
+/* Declare a new mem test */
+#define MEM_TEST(_name, _flags)	UNIT_TEST(_name, _flags, mem_test)
+
+#define DIGITS	((int)sizeof(ulong) * 2)
+#define ERR_FMT	"Mem error @ 0x%08lx: found %0*lx, expected %0*lx, bits %0*lx"
+
+/*
+ * Check that the line last read from the console ends with @tail. The rate
+ * printed for each iteration varies, so only the start and end of that line
+ * can be checked.
+ */
+static int check_line_end(struct unit_test_state *uts, const char *tail)
+{
+	int len = strlen(uts->actual_str);
+	int tail_len = strlen(tail);
+
+	ut_assert(len >= tail_len);
+	ut_asserteq_str(tail, uts->actual_str + len - tail_len);
+
+	return 0;
+}
+
+/* Run a couple of iterations over a small range, which must pass */
+static int mem_test_mtest_fast(struct unit_test_state *uts)
+{
+	ut_assertok(console_record_reset_enable());
+	ut_assertok(run_command("mtest 100000 110000 5 2", 0));
+	ut_assert_nextline("Testing 00100000 ... 00110000:");
+	ut_assert_nextlinen("Iteration:      1\rIteration:      1  seed 00000005");
+	ut_assertok(check_line_end(uts, "\rTested 2 iteration(s) with 0 errors."));
+	ut_assert_console_end();
+
+	return 0;
+}
+MEM_TEST(mem_test_mtest_fast, UT_TESTF_CONSOLE_REC);
+
+/* Flip a bit in one word and check that each test reports it */
+static int mem_test_mtest_fast_error(struct unit_test_state *uts)
+{
+	const ulong addr = 0x100040, bits = 0x10;
+	char tail[40];
+
+	sandbox_set_mtest_fault(addr, bits);
+	ut_assertok(console_record_reset_enable());
+	ut_asserteq(1, run_command("mtest 100000 110000 5 1", 0));
+	sandbox_set_mtest_fault(0, 0);
+
+	ut_assert_nextline("Testing 00100000 ... 00110000:");
+	ut_assert_nextline("Iteration:      1\r");
+
+	/* Address-in-address, plain and inverted */
+	ut_assert_nextline(ERR_FMT, addr, DIGITS, addr ^ bits, DIGITS, addr,
+			   DIGITS, bits);
+	ut_assert_nextline(ERR_FMT, addr, DIGITS, ~addr ^ bits, DIGITS, ~addr,
+			   DIGITS, bits);
+
+	/* Moving inversions with the walking bit for the first iteration */
+	ut_assert_nextline(ERR_FMT, addr, DIGITS, 1UL ^ bits, DIGITS, 1UL,
+			   DIGITS, bits);
+	ut_assert_nextline(ERR_FMT, addr, DIGITS, ~1UL ^ bits, DIGITS, ~1UL,
+			   DIGITS, bits);
+
+	/* Random data, where only the address and bits are known */
+	ut_assert_nextlinen("Mem error @ 0x%08lx: found ", addr);
+	snprintf(tail, sizeof(tail), ", bits %0*lx", DIGITS, bits);
+	ut_assertok(check_line_end(uts, tail));
+
+	ut_assert_nextlinen("Iteration:      1  seed 00000005");
+	ut_assertok(check_line_end(uts, "\rTested 1 iteration(s) with 5 errors."));
+	ut_assert_console_end();
+
+	return 0;
+}
+MEM_TEST(mem_test_mtest_fast_error, UT_TESTF_CONSOLE_REC);
@@ -193,3 +193,54 @@ static int dm_test_clk_ccf(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_clk_ccf, UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(CLK_CCF) && CONFIG_IS_ENABLED(CLK_RATE_STATS)
+/* Test the rate cache of the Common Clock Framework */
+static int dm_test_clk_ccf_rate_cache(struct unit_test_state *uts)
+{
+	struct clk_rate_stats stats, prev;
+	struct clk *clk, *pclk;
+	struct udevice *dev;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_CLK, "clk-ccf", &dev));
+
+	/* The first query reads the rate of all clocks up to the root */
+	ut_assertok(clk_get_by_id(SANDBOX_CLK_I2C_ROOT, &clk));
+	clk_reset_rate_stats();
+	ut_asserteq(60000000, clk_get_rate(clk));
+	clk_get_rate_stats(&stats);
+	ut_assert(stats.queries > 1);
+	ut_asserteq(0, stats.hits);
+
+	/* Further queries of the clock and its parents are cached */
+	prev = stats;
+	ut_asserteq(60000000, clk_get_rate(clk));
+	ut_asserteq(60000000, clk_get_parent_rate(clk));
+	clk_get_rate_stats(&stats);
+	ut_asserteq(prev.queries + 2, stats.queries);
+	ut_asserteq(prev.hits + 2, stats.hits);
+
+	/* Enabling the gate drops the rates cached below it */
+	prev = stats;
+	ut_assertok(clk_enable(clk));
+	ut_asserteq(60000000, clk_get_rate(clk));
+	clk_get_rate_stats(&stats);
+	ut_assert(stats.invalidations > prev.invalidations);
+	ut_assert(stats.queries - prev.queries > stats.hits - prev.hits);
+	ut_assertok(clk_disable(clk));
+
+	/* Re-parenting a mux drops the cached rate of the mux */
+	ut_assertok(clk_get_by_id(SANDBOX_CLK_USDHC1_SEL, &clk));
+	ut_asserteq(60000000, clk_get_rate(clk));
+	ut_assertok(clk_get_by_id(SANDBOX_CLK_PLL3_80M, &pclk));
+	clk_get_rate_stats(&prev);
+	ut_assertok(clk_set_parent(clk, pclk));
+	clk_get_rate_stats(&stats);
+	ut_assert(stats.invalidations > prev.invalidations);
+	ut_asserteq(80000000, clk_get_rate(clk));
+
+	return 0;
+}
+
+DM_TEST(dm_test_clk_ccf_rate_cache, UT_TESTF_SCAN_FDT);
+#endif
@@ -2,36 +2,165 @@
 
 #include <crypto/ecdsa-uclass.h>
 #include <dm.h>
+#include <image.h>
 #include <dm/test.h>
+#include <linux/libfdt.h>
 #include <test/ut.h>
 #include <u-boot/ecdsa.h>
 
 /*
- * Basic test of the ECDSA uclass and ecdsa_verify()
- *
- * ECDSA implementations in u-boot are hardware-dependent. Until we have a
- * software implementation that can be compiled into the sandbox, all we can
- * test is the uclass support.
- *
- * The uclass_get() test is redundant since ecdsa_verify() would also fail. We
- * run both functions in order to isolate the cause more clearly. i.e. is
- * ecdsa_verify() failing because the UCLASS is absent/broken?
+ * Test vectors were made with:
+ * openssl ecparam -name <curve> -genkey -noout -out key.pem
+ * openssl dgst -sha256 -sign key.pem -out sig.der msg.bin
+ * where msg.bin holds ecdsa_msg, with the DER signature converted to the raw
+ * (R, S) form used in FIT images.
  */
-static int dm_test_ecdsa_verify(struct unit_test_state *uts)
+static const char ecdsa_msg[] = "U-Boot ECDSA uclass test";
+
+static const u8 p256_x[] = {
+	0x1e, 0x33, 0x9f, 0x7c, 0x47, 0x05, 0x06, 0xe4,
+	0x1e, 0x1c, 0xf0, 0x1d, 0x10, 0x1b, 0x1e, 0xbd,
+	0xce, 0x0b, 0x73, 0xe6, 0x15, 0x47, 0xe9, 0x2c,
+	0xa9, 0x81, 0x94, 0xcc, 0xd0, 0x44, 0x9a, 0x35,
+};
+
+static const u8 p256_y[] = {
+	0x93, 0x96, 0xfa, 0x28, 0xf2, 0x27, 0x43, 0xe4,
+	0xdc, 0x6f, 0x4c, 0x5a, 0x40, 0x35, 0x60, 0xfe,
+	0x27, 0xa1, 0x7d, 0x80, 0x81, 0x63, 0x12, 0x2e,
+	0x0d, 0xfc, 0xf9, 0x93, 0xb3, 0xf5, 0x87, 0xb5,
+};
+
+static const u8 p256_sig[] = {
+	0x37, 0xe0, 0xd1, 0xc7, 0x21, 0xf9, 0x78, 0xd0,
+	0x1b, 0xd3, 0xd3, 0x99, 0x26, 0x84, 0x99, 0x4e,
+	0x66, 0xfa, 0x66, 0xbf, 0xcf, 0x7b, 0x2e, 0xfc,
+	0xf9, 0xfd, 0x6e, 0x81, 0xf4, 0xfd, 0x7b, 0x29,
+	0xb7, 0xfd, 0x83, 0x99, 0xf6, 0xfe, 0xf2, 0x37,
+	0x37, 0x71, 0x4c, 0x0a, 0x0c, 0x31, 0x5d, 0x1a,
+	0x7a, 0x9f, 0xe6, 0xe8, 0x20, 0xcf, 0xa9, 0x31,
+	0x19, 0x72, 0x95, 0x01, 0xa0, 0x8c, 0x0b, 0x8f,
+};
+
+static const u8 p384_x[] = {
+	0xcd, 0x07, 0xf4, 0xe3, 0x2d, 0x74, 0xa7, 0x8a,
+	0xfa, 0xda, 0x48, 0x05, 0xf5, 0xa9, 0xac, 0x76,
+	0x32, 0xe2, 0xf2, 0xcc, 0x5d, 0xdb, 0x56, 0x01,
+	0x8a, 0xf4, 0x20, 0x82, 0xb3, 0x05, 0xd8, 0xd6,
+	0x81, 0x7d, 0x49, 0xca, 0x03, 0x68, 0x65, 0x05,
+	0xc2, 0x24, 0x1d, 0x88, 0x6c, 0xe0, 0xd0, 0x4f,
+};
+
+static const u8 p384_y[] = {
+	0x29, 0x07, 0xac, 0x73, 0x2c, 0xea, 0xd9, 0x7f,
+	0x64, 0x89, 0x92, 0xe9, 0x59, 0x85, 0x0a, 0x61,
+	0x16, 0x9b, 0x9b, 0x1f, 0xe3, 0x01, 0xbc, 0x8b,
+	0x8b, 0xaa, 0xde, 0x6d, 0x2d, 0x98, 0xc5, 0xe8,
+	0xc8, 0xde, 0xce, 0x79, 0xca, 0xb5, 0x2e, 0x8e,
+	0x5f, 0x1e, 0x76, 0xf2, 0x36, 0xff, 0x32, 0xd2,
+};
+
+static const u8 p384_sig[] = {
+	0x57, 0x52, 0xbc, 0x37, 0x11, 0x42, 0xd1, 0x27,
+	0x19, 0xc1, 0x57, 0x4f, 0xeb, 0xc6, 0x6a, 0xf6,
+	0xca, 0x26, 0xd5, 0xff, 0xed, 0x22, 0xeb, 0x0b,
+	0x7e, 0x68, 0xa7, 0x74, 0x50, 0x25, 0xaa, 0xb6,
+	0x15, 0x6e, 0x26, 0x6c, 0x6e, 0x4f, 0x34, 0xfc,
+	0x16, 0x23, 0x37, 0x31, 0x65, 0xed, 0xac, 0x31,
+	0x8d, 0xe9, 0x3f, 0x08, 0x32, 0xf0, 0xcb, 0x57,
+	0x83, 0xce, 0x00, 0x93, 0xe7, 0xbd, 0x85, 0xff,
+	0xb1, 0x16, 0x68, 0x64, 0x44, 0xd3, 0x38, 0xfd,
+	0xa5, 0xd1, 0x50, 0xe3, 0x6f, 0x04, 0xa3, 0xd1,
+	0x8d, 0xec, 0x80, 0xfe, 0xcc, 0x09, 0x9e, 0xfa,
+	0x72, 0xff, 0x7b, 0x0f, 0x1f, 0x2b, 0x54, 0x6a,
+};
+
+/* Add a public key to the /signature node of @fdt */
+static int ecdsa_add_key(struct unit_test_state *uts, void *fdt,
+			 const char *name, const char *curve, const u8 *x,
+			 const u8 *y, int len)
 {
-	struct uclass *ucp;
+	int sig_node, node;
 
-	struct checksum_algo algo = {
-		.checksum_len = 256,
-	};
+	sig_node = fdt_subnode_offset(fdt, 0, FIT_SIG_NODENAME);
+	if (sig_node < 0)
+		sig_node = fdt_add_subnode(fdt, 0, FIT_SIG_NODENAME);
+	ut_assert(sig_node >= 0);
+	node = fdt_add_subnode(fdt, sig_node, name);
+	ut_assert(node >= 0);
+	ut_assertok(fdt_setprop_string(fdt, node, "ecdsa,curve", curve));
+	ut_assertok(fdt_setprop(fdt, node, "ecdsa,x-point", x, len));
+	ut_assertok(fdt_setprop(fdt, node, "ecdsa,y-point", y, len));
+
+	return 0;
+}
 
-	struct image_sign_info info = {
-		.checksum = &algo,
+/*
+ * Test ecdsa_verify() through the ECDSA uclass, which on sandbox is provided
+ * by the software verifier
+ */
+static int dm_test_ecdsa_verify(struct unit_test_state *uts)
+{
+	const int split = sizeof(ecdsa_msg) / 3;
+	struct image_region region[] = {
+		{ ecdsa_msg, split },
+		{ ecdsa_msg + split, sizeof(ecdsa_msg) - 1 - split },
 	};
+	struct image_sign_info info = { };
+	u8 sig[sizeof(p384_sig)];
+	char msg[sizeof(ecdsa_msg)];
+	struct udevice *dev;
+	int p256_node;
+	char fdt[1024];
+
+	ut_assertok(uclass_first_device_err(UCLASS_ECDSA, &dev));
+	ut_asserteq_str("ecdsa_sw", dev->driver->name);
+
+	ut_assertok(fdt_create_empty_tree(fdt, sizeof(fdt)));
+	ut_assertok(ecdsa_add_key(uts, fdt, "key-p256", "prime256v1", p256_x,
+				  p256_y, sizeof(p256_x)));
+	ut_assertok(ecdsa_add_key(uts, fdt, "key-p384", "secp384r1", p384_x,
+				  p384_y, sizeof(p384_x)));
+	/* Adding a node moves its siblings, so look this up afterwards */
+	p256_node = fdt_path_offset(fdt, "/" FIT_SIG_NODENAME "/key-p256");
+	ut_assert(p256_node > 0);
+
+	info.checksum = image_get_checksum_algo("sha256,ecdsa256");
+	ut_assertnonnull(info.checksum);
+	info.fdt_blob = fdt;
+	info.required_keynode = -1;
+
+	/* Each signature is found among the keys */
+	memcpy(sig, p256_sig, sizeof(p256_sig));
+	ut_assertok(ecdsa_verify(&info, region, ARRAY_SIZE(region), sig,
+				 sizeof(p256_sig)));
+	memcpy(sig, p384_sig, sizeof(p384_sig));
+	ut_assertok(ecdsa_verify(&info, region, ARRAY_SIZE(region), sig,
+				 sizeof(p384_sig)));
+
+	/* Only the required key is used */
+	info.required_keynode = p256_node;
+	ut_asserteq(-EINVAL, ecdsa_verify(&info, region, ARRAY_SIZE(region),
+					  sig, sizeof(p384_sig)));
+	memcpy(sig, p256_sig, sizeof(p256_sig));
+	ut_assertok(ecdsa_verify(&info, region, ARRAY_SIZE(region), sig,
+				 sizeof(p256_sig)));
+
+	/* Corrupted signature and data */
+	sig[5] ^= 0x20;
+	ut_asserteq(-EPERM, ecdsa_verify(&info, region, ARRAY_SIZE(region),
+					 sig, sizeof(p256_sig)));
+	sig[5] ^= 0x20;
+	strcpy(msg, ecdsa_msg);
+	msg[0] = 'u';
+	region[0].data = msg;
+	ut_asserteq(-EPERM, ecdsa_verify(&info, region, ARRAY_SIZE(region),
+					 sig, sizeof(p256_sig)));
 
-	ut_assertok(uclass_get(UCLASS_ECDSA, &ucp));
-	ut_assertnonnull(ucp);
-	ut_asserteq(-ENODEV, ecdsa_verify(&info, NULL, 0, NULL, 0));
+	info.required_keynode = -1;
+	memcpy(sig, p384_sig, sizeof(p384_sig));
+	ut_asserteq(-EPERM, ecdsa_verify(&info, region, ARRAY_SIZE(region),
+					 sig, sizeof(p384_sig)));
 
 	return 0;
 }
@@ -7,6 +7,8 @@
 #include <dm.h>
 #include <fastboot.h>
 #include <fb_mmc.h>
+#include <image-sparse.h>
+#include <malloc.h>
 #include <mmc.h>
 #include <part.h>
 #include <part_efi.h>
@@ -93,3 +95,101 @@ static int dm_test_fastboot_mmc_part(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_fastboot_mmc_part, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+static int fastboot_erase_msgs;
+
+static void fastboot_count_erase(const char *msg)
+{
+	if (!strcmp(msg, "erasing"))
+		fastboot_erase_msgs++;
+}
+
+/* A zero-filled sparse chunk is erased, with progress reported */
+static int dm_test_fastboot_mmc_sparse_erase(struct unit_test_state *uts)
+{
+	char response[FASTBOOT_RESPONSE_LEN] = {0};
+	char str_disk_guid[UUID_STR_LEN + 1];
+	struct blk_desc *mmc_dev_desc;
+	struct disk_partition parts[] = {
+		{
+			.start = 48,
+			.size = 1024,
+			.name = "test1",
+		},
+	};
+	const int blk_sz = 4096, fill_blks = 126;
+	sparse_header_t hdr = {
+		.magic = SPARSE_HEADER_MAGIC,
+		.major_version = 1,
+		.file_hdr_sz = sizeof(sparse_header_t),
+		.chunk_hdr_sz = sizeof(chunk_header_t),
+		.blk_sz = blk_sz,
+		.total_blks = fill_blks + 2,
+		.total_chunks = 3,
+	};
+	chunk_header_t raw = {
+		.chunk_type = CHUNK_TYPE_RAW,
+		.chunk_sz = 1,
+		.total_sz = sizeof(chunk_header_t) + blk_sz,
+	};
+	chunk_header_t fill = {
+		.chunk_type = CHUNK_TYPE_FILL,
+		.chunk_sz = fill_blks,
+		.total_sz = sizeof(chunk_header_t) + sizeof(u32),
+	};
+	int size, blks, i;
+	u8 *image, *p, *buf;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &mmc_dev_desc));
+	if (CONFIG_IS_ENABLED(RANDOM_UUID)) {
+		gen_rand_uuid_str(parts[0].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(str_disk_guid, UUID_STR_FORMAT_STD);
+	}
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+
+	/* Start with a partition full of data */
+	blks = parts[0].size;
+	buf = malloc(blks * mmc_dev_desc->blksz);
+	ut_assertnonnull(buf);
+	memset(buf, 0xa5, blks * mmc_dev_desc->blksz);
+	ut_asserteq(blks, blk_dwrite(mmc_dev_desc, parts[0].start, blks, buf));
+
+	/* RAW, FILL with zero, RAW */
+	size = sizeof(hdr) + 3 * sizeof(chunk_header_t) + 2 * blk_sz +
+	       sizeof(u32);
+	image = calloc(1, size);
+	ut_assertnonnull(image);
+	p = image;
+	memcpy(p, &hdr, sizeof(hdr));
+	p += sizeof(hdr);
+	memcpy(p, &raw, sizeof(raw));
+	memset(p + sizeof(raw), 0x11, blk_sz);
+	p += sizeof(raw) + blk_sz;
+	memcpy(p, &fill, sizeof(fill));
+	p += sizeof(fill) + sizeof(u32);
+	memcpy(p, &raw, sizeof(raw));
+	memset(p + sizeof(raw), 0x22, blk_sz);
+
+	fastboot_erase_msgs = 0;
+	fastboot_set_progress_callback(fastboot_count_erase);
+	fastboot_mmc_flash_write("test1", image, size, response);
+	fastboot_set_progress_callback(NULL);
+	free(image);
+	ut_asserteq_str("OKAY", response);
+	ut_assert(fastboot_erase_msgs > 0);
+
+	memset(buf, '\0', blks * mmc_dev_desc->blksz);
+	ut_asserteq(blks, blk_dread(mmc_dev_desc, parts[0].start, blks, buf));
+	for (i = 0; i < blk_sz; i++) {
+		ut_asserteq(0x11, buf[i]);
+		ut_asserteq(0x22, buf[(fill_blks + 1) * blk_sz + i]);
+	}
+	for (i = blk_sz; i < (fill_blks + 1) * blk_sz; i++)
+		ut_asserteq(0, buf[i]);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_fastboot_mmc_sparse_erase,
+	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -333,3 +333,44 @@ static int dm_test_i2c_reg_clrset(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_i2c_reg_clrset, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+static int dm_test_i2c_write_pages(struct unit_test_state *uts)
+{
+	const uint8_t *data = (const uint8_t *)"abcdefghijklmnopqrst";
+	struct udevice *eeprom;
+	struct udevice *dev;
+	uint8_t buf[20];
+
+	ut_assertok(i2c_get_chip_for_busnum(busnum, chip, 1, &dev));
+
+	/* Do a transfer so we can find the emulator */
+	ut_assertok(dm_i2c_read(dev, 0, buf, 5));
+	ut_assertok(uclass_first_device(UCLASS_I2C_EMUL, &eeprom));
+
+	ut_asserteq(-EINVAL, dm_i2c_write_pages(dev, 5, data, 20, 0, 10));
+	ut_asserteq(-EINVAL, dm_i2c_write_pages(dev, 5, data, 20, 12, 10));
+
+	/* Pages are 5-7, 8-15, 16-23 and 24, so the last write is at 24 */
+	ut_assertok(dm_i2c_write_pages(dev, 5, data, 20, 8, 10));
+	ut_asserteq(24, sanbox_i2c_eeprom_get_prev_offset(eeprom));
+
+	ut_assertok(dm_i2c_read(dev, 5, buf, sizeof(buf)));
+	ut_asserteq_mem(data, buf, sizeof(buf));
+
+	/* A busy chip is polled until it ACKs again after each of 3 pages */
+	sandbox_i2c_eeprom_set_busy(eeprom, 3);
+	ut_assertok(dm_i2c_write_pages(dev, 5, data + 1, 19, 8, 10));
+	ut_asserteq(3 * 3, sandbox_i2c_eeprom_get_nacks(eeprom));
+	ut_assertok(dm_i2c_read(dev, 5, buf, 19));
+	ut_asserteq_mem(data + 1, buf, 19);
+
+	/* ...and the write fails if it never does */
+	sandbox_i2c_eeprom_set_busy(eeprom, -1);
+	ut_asserteq(-ETIMEDOUT, dm_i2c_write_pages(dev, 5, data, 20, 8, 1));
+	ut_assert(sandbox_i2c_eeprom_get_nacks(eeprom) > 0);
+	ut_asserteq(5, sanbox_i2c_eeprom_get_prev_offset(eeprom));
+	sandbox_i2c_eeprom_set_busy(eeprom, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_i2c_write_pages, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
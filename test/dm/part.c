@@ -97,3 +97,61 @@ out:
 	return ret;
 }
 DM_TEST(dm_test_part, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+static int dm_test_part_by_name(struct unit_test_state *uts)
+{
+	char str_disk_guid[UUID_STR_LEN + 1];
+	struct blk_desc *mmc_dev_desc;
+	struct disk_partition info;
+	struct disk_partition parts[3] = {
+		{
+			.start = 48,
+			.size = 1,
+			.name = "test1",
+		},
+		{
+			.start = 49,
+			.size = 1,
+			.name = "test2",
+		},
+		{
+			.start = 50,
+			.size = 1,
+			.name = "test1",
+		},
+	};
+	int i;
+
+	ut_asserteq(1, blk_get_device_by_str("mmc", "1", &mmc_dev_desc));
+	if (CONFIG_IS_ENABLED(RANDOM_UUID)) {
+		for (i = 0; i < ARRAY_SIZE(parts); i++)
+			gen_rand_uuid_str(parts[i].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(str_disk_guid, UUID_STR_FORMAT_STD);
+	}
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+
+	/* The first partition with a name is found */
+	ut_asserteq(1, part_get_info_by_name(mmc_dev_desc, "test1", &info));
+	ut_asserteq(48, info.start);
+	ut_asserteq_str("test1", (char *)info.name);
+	ut_asserteq(2, part_get_info_by_name(mmc_dev_desc, "test2", &info));
+	ut_asserteq(49, info.start);
+	ut_asserteq(-ENOENT, part_get_info_by_name(mmc_dev_desc, "test", &info));
+	ut_asserteq(-ENOENT, part_get_info_by_name(mmc_dev_desc, "test3",
+						   &info));
+
+	/* A new partition table must be seen straight away */
+	strcpy((char *)parts[0].name, "test3");
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+	ut_asserteq(3, part_get_info_by_name(mmc_dev_desc, "test1", &info));
+	ut_asserteq(50, info.start);
+	ut_asserteq(1, part_get_info_by_name(mmc_dev_desc, "test3", &info));
+	ut_asserteq(48, info.start);
+	ut_assertok(part_get_info(mmc_dev_desc, 1, &info));
+	ut_asserteq_str("test3", (char *)info.name);
+
+	return 0;
+}
+DM_TEST(dm_test_part_by_name, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
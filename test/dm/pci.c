@@ -5,6 +5,8 @@
 
 #include <common.h>
 #include <dm.h>
+#include <init.h>
+#include <time.h>
 #include <asm/io.h>
 #include <asm/test.h>
 #include <dm/test.h>
@@ -376,3 +378,64 @@ static int dm_test_pci_region_multi(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_pci_region_multi, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that the uclass waits for the link of a controller before its scan */
+static int dm_test_pci_link(struct unit_test_state *uts)
+{
+	struct pci_controller *hose;
+	struct udevice *bus, *dev;
+	ulong start;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_PCI, "pci@3", &bus));
+	ut_asserteq(3, sandbox_pci_get_link_polls(bus));
+	ut_asserteq(3, dev_seq(bus));
+	ut_assertok(dm_pci_bus_find_bdf(PCI_BDF(3, 0, 0), &dev));
+
+	/* The bus is scanned once the wait times out, with no number kept */
+	start = get_timer(0);
+	ut_assertok(uclass_get_device_by_name(UCLASS_PCI, "pci@4", &bus));
+	ut_assert(get_timer(start) >= CONFIG_PCI_LINK_TIMEOUT_MS);
+	ut_assert(sandbox_pci_get_link_polls(bus) > 3);
+	ut_asserteq(4, dev_seq(bus));
+	hose = dev_get_uclass_priv(bus);
+	ut_asserteq(0, hose->reserved_busno);
+	ut_assertok(dm_pci_bus_find_bdf(PCI_BDF(4, 0, 0), &dev));
+
+	return 0;
+}
+DM_TEST(dm_test_pci_link, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/*
+ * Test that pci_init() probes all controllers before waiting for their links
+ * together, and keeps the first bus number after each of them free
+ */
+static int dm_test_pci_link_defer(struct unit_test_state *uts)
+{
+	struct pci_controller *hose;
+	struct udevice *bus, *dev;
+	ulong start;
+
+	start = get_timer(0);
+	ut_assertok(pci_init());
+	ut_assert(get_timer(start) >= CONFIG_PCI_LINK_TIMEOUT_MS);
+
+	/* Polling stops once the link is up */
+	ut_assertok(uclass_get_device_by_name(UCLASS_PCI, "pci@3", &bus));
+	ut_asserteq(3, sandbox_pci_get_link_polls(bus));
+	ut_asserteq(3, dev_seq(bus));
+	hose = dev_get_uclass_priv(bus);
+	ut_asserteq(0, hose->reserved_busno);
+	ut_assertok(dm_pci_bus_find_bdf(PCI_BDF(3, 0, 0), &dev));
+
+	/* Bus 4 was kept for pci@3 while its scan was pending */
+	ut_assertok(uclass_get_device_by_name(UCLASS_PCI, "pci@4", &bus));
+	ut_assert(sandbox_pci_get_link_polls(bus) > 3);
+	ut_asserteq(5, dev_seq(bus));
+	hose = dev_get_uclass_priv(bus);
+	ut_asserteq(0, hose->reserved_busno);
+	ut_assertok(dm_pci_bus_find_bdf(PCI_BDF(5, 0, 0), &dev));
+	ut_asserteq(-ENODEV, dm_pci_bus_find_bdf(PCI_BDF(4, 0, 0), &dev));
+
+	return 0;
+}
+DM_TEST(dm_test_pci_link_defer, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -19,6 +19,7 @@
 #include <dm/util.h>
 #include <power/pmic.h>
 #include <power/sandbox_pmic.h>
+#include <asm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -129,3 +130,97 @@ static int dm_test_power_pmic_mc34708_rw_val(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_power_pmic_mc34708_rw_val, UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(PMIC_CACHE)
+/* Test the PMIC register cache */
+static int dm_test_power_pmic_cache(struct unit_test_state *uts)
+{
+	struct udevice *dev, *emul;
+	u8 regs[4], lens[4];
+	u8 val;
+
+	ut_assertok(pmic_get("sandbox_pmic", &dev));
+
+	/* Known registers are read from the cache */
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_BUCK1_UA, 0x12));
+	val = 0x34;
+	ut_assertok(dm_i2c_write(dev, SANDBOX_PMIC_REG_BUCK1_UA, &val, 1));
+	ut_asserteq(0x12, pmic_reg_read(dev, SANDBOX_PMIC_REG_BUCK1_UA));
+	pmic_cache_invalidate(dev);
+	ut_asserteq(0x34, pmic_reg_read(dev, SANDBOX_PMIC_REG_BUCK1_UA));
+
+	/* Volatile registers are always read from the device */
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_STATUS, 0x01));
+	val = 0x02;
+	ut_assertok(dm_i2c_write(dev, SANDBOX_PMIC_REG_STATUS, &val, 1));
+	ut_asserteq(0x02, pmic_reg_read(dev, SANDBOX_PMIC_REG_STATUS));
+
+	/* Deferred writes only reach the device on sync */
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO1_UV, 0));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO1_UA, 0));
+	ut_assertok(pmic_cache_defer(dev));
+	ut_assertok(pmic_clrsetbits(dev, SANDBOX_PMIC_REG_LDO1_UV, 0, 0x05));
+	ut_assertok(pmic_clrsetbits(dev, SANDBOX_PMIC_REG_LDO1_UV, 0x0f, 0x0a));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO1_UA, 0x03));
+	ut_asserteq(0x0a, pmic_reg_read(dev, SANDBOX_PMIC_REG_LDO1_UV));
+	ut_assertok(dm_i2c_read(dev, SANDBOX_PMIC_REG_LDO1_UV, &val, 1));
+	ut_asserteq(0, val);
+
+	ut_assertok(pmic_cache_sync(dev));
+	ut_assertok(dm_i2c_read(dev, SANDBOX_PMIC_REG_LDO1_UV, &val, 1));
+	ut_asserteq(0x0a, val);
+	ut_assertok(dm_i2c_read(dev, SANDBOX_PMIC_REG_LDO1_UA, &val, 1));
+	ut_asserteq(0x03, val);
+
+	/* Pending writes reach the device before a volatile register write */
+	ut_assertok(pmic_cache_defer(dev));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO1_UV, 0x0c));
+	ut_assertok(dm_i2c_read(dev, SANDBOX_PMIC_REG_LDO1_UV, &val, 1));
+	ut_asserteq(0x0a, val);
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_STATUS, 0x04));
+	ut_assertok(dm_i2c_read(dev, SANDBOX_PMIC_REG_LDO1_UV, &val, 1));
+	ut_asserteq(0x0c, val);
+
+	/* ...and before a volatile register read */
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO1_UA, 0x07));
+	ut_asserteq(0x04, pmic_reg_read(dev, SANDBOX_PMIC_REG_STATUS));
+	ut_assertok(dm_i2c_read(dev, SANDBOX_PMIC_REG_LDO1_UA, &val, 1));
+	ut_asserteq(0x07, val);
+	ut_assertok(pmic_cache_sync(dev));
+
+	/*
+	 * Deferred writes keep their order, even to a lower register or to
+	 * the same register twice. Only writes to consecutive registers that
+	 * follow each other share a transfer.
+	 */
+	ut_assertok(i2c_emul_find(dev, &emul));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_UV, 0));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_UA, 0));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_OM, 0));
+	sandbox_i2c_pmic_get_writes(emul, regs, lens, ARRAY_SIZE(regs));
+
+	ut_assertok(pmic_cache_defer(dev));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_OM, 0x01));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_UV, 0x02));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_UA, 0x03));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_OM, 0x00));
+	ut_assertok(pmic_reg_write(dev, SANDBOX_PMIC_REG_LDO2_OM, 0x01));
+	ut_asserteq(0, sandbox_i2c_pmic_get_writes(emul, regs, lens,
+						   ARRAY_SIZE(regs)));
+	ut_assertok(pmic_cache_sync(dev));
+
+	ut_asserteq(3, sandbox_i2c_pmic_get_writes(emul, regs, lens,
+						   ARRAY_SIZE(regs)));
+	ut_asserteq(SANDBOX_PMIC_REG_LDO2_OM, regs[0]);
+	ut_asserteq(1, lens[0]);
+	ut_asserteq(SANDBOX_PMIC_REG_LDO2_UV, regs[1]);
+	ut_asserteq(3, lens[1]);
+	ut_asserteq(SANDBOX_PMIC_REG_LDO2_OM, regs[2]);
+	ut_asserteq(1, lens[2]);
+	ut_assertok(dm_i2c_read(dev, SANDBOX_PMIC_REG_LDO2_OM, &val, 1));
+	ut_asserteq(0x01, val);
+
+	return 0;
+}
+DM_TEST(dm_test_power_pmic_cache, UT_TESTF_SCAN_FDT);
+#endif
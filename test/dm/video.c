@@ -70,6 +70,10 @@ static int compress_frame_buffer(struct unit_test_state *uts,
 	void *dest;
 	int ret;
 
+	/* Copying of damaged regions is deferred until the next sync */
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		video_sync(dev, false);
+
 	destlen = priv->fb_size;
 	dest = malloc(priv->fb_size);
 	if (!dest)
@@ -191,6 +195,42 @@ static int dm_test_video_chars(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_chars, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/* Test that drawing a character only damages the character cell */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	ut_assertok(video_sync(dev, false));
+
+	vidconsole_putc_xy(con, VID_TO_POS(16), 32, 'a');
+	ut_asserteq(16, priv->damage.xstart);
+	ut_asserteq(32, priv->damage.ystart);
+	ut_asserteq(24, priv->damage.xend);
+	ut_asserteq(48, priv->damage.yend);
+
+	vidconsole_putc_xy(con, VID_TO_POS(40), 48, 'b');
+	ut_asserteq(16, priv->damage.xstart);
+	ut_asserteq(32, priv->damage.ystart);
+	ut_asserteq(48, priv->damage.xend);
+	ut_asserteq(64, priv->damage.yend);
+
+	ut_assertok(video_sync(dev, false));
+	ut_assert(priv->damage.yend <= priv->damage.ystart);
+
+	/* This also checks that the copy frame buffer has been updated */
+	ut_assert(compress_frame_buffer(uts, dev) > 0);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
+
 #ifdef CONFIG_VIDEO_ANSI
 #define ANSI_ESC "\x1b"
 /* Test handling of ANSI escape sequences */
@@ -388,6 +428,79 @@ static int dm_test_video_bmp16(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_bmp16, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+#ifdef CONFIG_VIDEO_QOI
+/* 4x2 QOI image: a row of red pixels and a row of blue pixels */
+static const u8 test_qoi[] = {
+	'q', 'o', 'i', 'f', 0, 0, 0, 4, 0, 0, 0, 2, 3, 0,
+	0xfe, 0xff, 0x00, 0x00,		/* QOI_OP_RGB: red */
+	0xc2,				/* QOI_OP_RUN: 3 more pixels */
+	0xfe, 0x00, 0x00, 0xff,		/* QOI_OP_RGB: blue */
+	0xc2,				/* QOI_OP_RUN: 3 more pixels */
+	0, 0, 0, 0, 0, 0, 0, 1,		/* end marker */
+};
+
+/* Test drawing a QOI image on a 16bpp display */
+static int dm_test_video_qoi(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev;
+	ulong dst = 0x10000;
+	u16 *line;
+
+	ut_assert(video_qoi_is_image(test_qoi));
+	ut_asserteq(sizeof(test_qoi),
+		    video_qoi_get_size(test_qoi, sizeof(test_qoi)));
+	ut_asserteq(-EAGAIN,
+		    video_qoi_get_size(test_qoi, sizeof(test_qoi) - 1));
+
+	ut_assertok(uclass_find_first_device(UCLASS_VIDEO, &dev));
+	ut_assertnonnull(dev);
+	ut_assertok(sandbox_sdl_set_bpp(dev, VIDEO_BPP16));
+	priv = dev_get_uclass_priv(dev);
+
+	memcpy(map_sysmem(dst, sizeof(test_qoi)), test_qoi, sizeof(test_qoi));
+	ut_assertok(video_qoi_display(dev, dst, 8, 4, false));
+	line = priv->fb + 4 * priv->line_length;
+	ut_asserteq(0xf800, line[8]);
+	ut_asserteq(0xf800, line[11]);
+	ut_asserteq(priv->colour_bg, line[12]);
+	line = priv->fb + 5 * priv->line_length;
+	ut_asserteq(0x001f, line[8]);
+	ut_asserteq(0x001f, line[11]);
+	ut_assert(compress_frame_buffer(uts, dev) > 0);
+
+	return 0;
+}
+DM_TEST(dm_test_video_qoi, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test drawing a QOI image on a 32bpp display */
+static int dm_test_video_qoi32(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev;
+	ulong dst = 0x10000;
+	u32 *line;
+
+	ut_assertok(uclass_find_first_device(UCLASS_VIDEO, &dev));
+	ut_assertnonnull(dev);
+	ut_assertok(sandbox_sdl_set_bpp(dev, VIDEO_BPP32));
+	priv = dev_get_uclass_priv(dev);
+
+	memcpy(map_sysmem(dst, sizeof(test_qoi)), test_qoi, sizeof(test_qoi));
+	ut_assertok(video_qoi_display(dev, dst, 8, 4, false));
+	line = priv->fb + 4 * priv->line_length;
+	ut_asserteq(0xff0000, line[8]);
+	ut_asserteq(0xff0000, line[11]);
+	line = priv->fb + 5 * priv->line_length;
+	ut_asserteq(0x0000ff, line[8]);
+	ut_asserteq(0x0000ff, line[11]);
+	ut_assert(compress_frame_buffer(uts, dev) > 0);
+
+	return 0;
+}
+DM_TEST(dm_test_video_qoi32, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
+
 /* Test drawing a 24bpp bitmap file on a 16bpp display */
 static int dm_test_video_bmp24(struct unit_test_state *uts)
 {
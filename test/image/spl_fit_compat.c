@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for selecting a FIT configuration by compatible string
+ */
+
+#include <common.h>
+#include <image.h>
+#include <asm/global_data.h>
+#include <linux/libfdt.h>
+#include <test/ut.h>
+
+/* Declare a new SPL test */
+#define SPL_TEST(_name, _flags)		UNIT_TEST(_name, _flags, spl_test)
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define FIT_SIZE	4096
+
+/*
+ * Build a FIT with two configurations. The first one does not match the
+ * device tree, but since board_fit_config_name_match() accepts anything in
+ * this test build, it is the one found without the index.
+ */
+static int make_fit(struct unit_test_state *uts, void *fit, const char *index,
+		    int index_len)
+{
+	int confs, node;
+
+	ut_assertok(fdt_create_empty_tree(fit, FIT_SIZE));
+	ut_assert(fdt_add_subnode(fit, 0, "images") >= 0);
+	confs = fdt_add_subnode(fit, 0, "configurations");
+	ut_assert(confs >= 0);
+	ut_assertok(fdt_setprop_string(fit, confs, "default", "conf-1"));
+
+	/* Added in reverse, since fdt_add_subnode() puts them first */
+	node = fdt_add_subnode(fit, confs, "conf-2");
+	ut_assert(node >= 0);
+	ut_assertok(fdt_setprop_string(fit, node, "description", "second"));
+	node = fdt_add_subnode(fit, confs, "conf-1");
+	ut_assert(node >= 0);
+	ut_assertok(fdt_setprop_string(fit, node, "description", "first"));
+
+	if (index)
+		ut_assertok(fdt_setprop(fit, confs, FIT_COMPAT_INDEX_PROP,
+					index, index_len));
+
+	return 0;
+}
+
+static int check_conf(struct unit_test_state *uts, void *fit, int node,
+		      const char *name)
+{
+	ut_assert(node >= 0);
+	ut_asserteq_str(name, fdt_get_name(fit, node, NULL));
+
+	return 0;
+}
+
+/* Look up compatible strings in the index */
+static int spl_test_fit_compat_index(struct unit_test_state *uts)
+{
+	static const char index[] = "other,board\0conf-1\0vendor,board\0conf-2";
+	static const char bad[] = "vendor,board";
+	char fit[FIT_SIZE];
+
+	ut_assertok(make_fit(uts, fit, index, sizeof(index)));
+
+	/* The first string that is in the index wins */
+	ut_assertok(check_conf(uts, fit, fit_conf_find_compat_index(fit,
+			"vendor,board\0other,board", 25), "conf-2"));
+	ut_assertok(check_conf(uts, fit, fit_conf_find_compat_index(fit,
+			"vendor,rev2\0other,board", 24), "conf-1"));
+	ut_asserteq(-ENOENT, fit_conf_find_compat_index(fit, "vendor,rev2",
+							12));
+
+	/* No index, or an entry without a configuration name */
+	ut_assertok(make_fit(uts, fit, NULL, 0));
+	ut_asserteq(-ENOENT, fit_conf_find_compat_index(fit, "vendor,board",
+							13));
+	ut_assertok(make_fit(uts, fit, bad, sizeof(bad)));
+	ut_asserteq(-EINVAL, fit_conf_find_compat_index(fit, "vendor,board",
+							13));
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_compat_index, 0);
+
+#if CONFIG_IS_ENABLED(FIT_COMPAT_SELECT)
+/* Select the configuration for the device tree of this SPL build */
+static int spl_test_fit_compat_select(struct unit_test_state *uts)
+{
+	const char *compat;
+	char index[256];
+	char fit[FIT_SIZE];
+	int len, index_len;
+
+	/* Without an index, board_fit_config_name_match() decides */
+	ut_assertok(make_fit(uts, fit, NULL, 0));
+	ut_assertok(check_conf(uts, fit, fit_find_config_node(fit), "conf-1"));
+
+	compat = fdt_getprop(gd->fdt_blob, 0, "compatible", &len);
+	ut_assertnonnull(compat);
+	len = strlen(compat) + 1;
+	ut_assert(len + sizeof("conf-2") <= sizeof(index));
+	memcpy(index, compat, len);
+	memcpy(index + len, "conf-2", sizeof("conf-2"));
+	index_len = len + sizeof("conf-2");
+
+	ut_assertok(make_fit(uts, fit, index, index_len));
+	ut_assertok(check_conf(uts, fit, fit_find_config_node(fit), "conf-2"));
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_compat_select, 0);
+#endif
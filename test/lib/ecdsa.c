@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit test for the software ECDSA verifier
+ *
+ * Test vectors were made with:
+ * openssl ecparam -name <curve> -genkey -noout -out key.pem
+ * openssl dgst -<hash> -sign key.pem -out sig.der msg.bin
+ * with the DER signature converted to the raw (R, S) form used in FIT images.
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <crypto/ecdsa-uclass.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <u-boot/ecdsa.h>
+
+static const u8 p256_x[] = {
+	0x7f, 0xb3, 0xa5, 0x9d, 0xcc, 0xcf, 0x3c, 0x2d,
+	0x05, 0x4f, 0xf5, 0xb8, 0x71, 0x58, 0x58, 0x7a,
+	0x61, 0x92, 0x3f, 0xd9, 0xa9, 0xc5, 0xc3, 0x19,
+	0x4b, 0x9c, 0xea, 0x51, 0xfb, 0x7b, 0x8e, 0xe6,
+};
+
+static const u8 p256_y[] = {
+	0xdc, 0x63, 0x6e, 0x04, 0x38, 0x8c, 0x81, 0xa0,
+	0x0f, 0x7e, 0xc4, 0xea, 0xb8, 0xcb, 0x58, 0xf3,
+	0x36, 0xb6, 0x31, 0x89, 0xf4, 0x42, 0xa9, 0x76,
+	0xb1, 0xf3, 0xd5, 0x2e, 0xb4, 0x39, 0x68, 0x28,
+};
+
+static const u8 p256_hash[] = {
+	0x55, 0x97, 0xb5, 0xff, 0x12, 0x82, 0x22, 0xa5,
+	0xbf, 0x36, 0x68, 0x1a, 0x0f, 0xb7, 0x7e, 0x96,
+	0x96, 0xa1, 0x74, 0x21, 0x9a, 0x0d, 0x10, 0xe8,
+	0xeb, 0x66, 0xe7, 0x4b, 0x40, 0x20, 0x7d, 0xc4,
+};
+
+static const u8 p256_sig[] = {
+	0x3c, 0x44, 0x52, 0xdd, 0x7e, 0xa2, 0x2b, 0x52,
+	0x49, 0x6b, 0xa2, 0x1f, 0xd4, 0x3d, 0x3a, 0xcd,
+	0xd5, 0x74, 0x9b, 0x8c, 0x74, 0x7e, 0x75, 0x62,
+	0xe8, 0x5f, 0xe4, 0xc8, 0x05, 0x40, 0x88, 0x93,
+	0xac, 0x0b, 0x89, 0x3a, 0xa7, 0x6d, 0x8b, 0xfb,
+	0xb4, 0x7f, 0x26, 0xec, 0x70, 0x7f, 0x63, 0x75,
+	0xc5, 0xc7, 0x42, 0x7c, 0xe1, 0xcb, 0xab, 0xda,
+	0x48, 0x2e, 0xf7, 0x71, 0x41, 0x5b, 0x23, 0xaf,
+};
+
+static const u8 p384_x[] = {
+	0x2e, 0x95, 0xf3, 0x49, 0xb3, 0x31, 0x11, 0x59,
+	0xe3, 0x1c, 0x3f, 0xf2, 0xb9, 0x6b, 0x88, 0xdd,
+	0x15, 0x84, 0xc6, 0x85, 0x89, 0x07, 0x52, 0x0a,
+	0x30, 0x5c, 0xd6, 0xe2, 0xe2, 0xb3, 0xf4, 0x54,
+	0x9c, 0xce, 0x3a, 0x42, 0x6f, 0x63, 0xaf, 0x31,
+	0x2f, 0x40, 0x59, 0x17, 0xba, 0x6b, 0x5f, 0x0f,
+};
+
+static const u8 p384_y[] = {
+	0xc6, 0x5f, 0x4b, 0x82, 0x6b, 0x9e, 0x06, 0x88,
+	0xd4, 0xea, 0x1c, 0x1d, 0x41, 0xcc, 0x26, 0x8e,
+	0x9d, 0x3c, 0xb2, 0x37, 0x8a, 0x0b, 0xad, 0x8e,
+	0xec, 0x30, 0x3d, 0xe4, 0x77, 0x74, 0x10, 0x02,
+	0x01, 0xba, 0x6b, 0x26, 0x23, 0xa8, 0x5c, 0xf4,
+	0x66, 0xbf, 0xd1, 0xe5, 0xbf, 0xcc, 0x05, 0xa1,
+};
+
+static const u8 p384_hash[] = {
+	0xa6, 0x78, 0xc0, 0x69, 0x87, 0xe1, 0x47, 0x2c,
+	0x62, 0x57, 0x00, 0x92, 0xaf, 0x92, 0xe4, 0xeb,
+	0x26, 0x21, 0x9a, 0x84, 0x2a, 0x25, 0xb3, 0xa9,
+	0x79, 0x79, 0xc0, 0xff, 0x23, 0x07, 0xa7, 0x30,
+	0x99, 0x38, 0x57, 0xa7, 0xba, 0x4f, 0x6a, 0xf2,
+	0x13, 0x51, 0xfe, 0x82, 0xda, 0x20, 0x3b, 0xd6,
+};
+
+static const u8 p384_sig[] = {
+	0xef, 0x12, 0x56, 0xd0, 0x07, 0xef, 0x38, 0x6b,
+	0x8b, 0x2e, 0xbc, 0xcc, 0x7e, 0x95, 0xd2, 0xf5,
+	0xff, 0xa6, 0x8d, 0xb8, 0x9f, 0x62, 0x13, 0x07,
+	0xfd, 0x4b, 0xbc, 0x43, 0xfd, 0x98, 0xa9, 0xcd,
+	0x27, 0xd5, 0x41, 0x5e, 0xba, 0xea, 0x17, 0xe3,
+	0xc5, 0xba, 0x03, 0x3f, 0xee, 0x0c, 0x81, 0xeb,
+	0xe3, 0x42, 0x50, 0x14, 0x63, 0xed, 0x63, 0x24,
+	0x48, 0x81, 0x1e, 0x4c, 0x81, 0xfe, 0x83, 0xd2,
+	0x43, 0xb3, 0x6d, 0x6a, 0xf4, 0x85, 0x74, 0x98,
+	0xd6, 0xdc, 0xe9, 0x30, 0x0a, 0x42, 0x4f, 0x39,
+	0xf7, 0x43, 0x21, 0x6f, 0x9e, 0xc6, 0xf3, 0xc3,
+	0xb5, 0xfc, 0xbf, 0x7d, 0xe6, 0x9f, 0xb4, 0xc4,
+};
+
+static const u8 p384_sha256_hash[] = {
+	0x41, 0x71, 0x3c, 0x45, 0x56, 0x69, 0x00, 0x43,
+	0xc3, 0x17, 0xb2, 0xb8, 0x5c, 0x1e, 0x00, 0xaf,
+	0xa6, 0xc3, 0x63, 0x6b, 0x61, 0xfa, 0xd7, 0x3c,
+	0xd2, 0x2b, 0xec, 0x49, 0x71, 0xc2, 0xdf, 0xe8,
+};
+
+static const u8 p384_sha256_sig[] = {
+	0xaa, 0xbb, 0x05, 0xa3, 0x7d, 0x26, 0x1f, 0x82,
+	0x16, 0xca, 0x1e, 0x77, 0x21, 0x49, 0x0b, 0x58,
+	0xaa, 0x28, 0xc9, 0x19, 0x49, 0x8e, 0x8e, 0xa8,
+	0x8e, 0x6c, 0xa8, 0xbf, 0x62, 0x35, 0x0b, 0x59,
+	0xee, 0x2d, 0x8d, 0x00, 0x33, 0x6b, 0x68, 0x5f,
+	0xa2, 0xa0, 0x72, 0x52, 0x0e, 0xf8, 0x41, 0x54,
+	0x48, 0xcd, 0xdf, 0xd8, 0x89, 0x1d, 0x6b, 0xb4,
+	0x0a, 0x97, 0x76, 0x7c, 0x5a, 0x7b, 0xc7, 0xe7,
+	0x32, 0xa3, 0xfe, 0x68, 0x2d, 0x9e, 0xbd, 0xca,
+	0x5d, 0x4c, 0xd0, 0x55, 0x02, 0x0e, 0x3a, 0x8a,
+	0x7f, 0x98, 0xe3, 0x8d, 0x8d, 0x78, 0x1b, 0x60,
+	0x31, 0xcb, 0xf3, 0xe7, 0x6f, 0x0d, 0x87, 0x47,
+};
+
+/**
+ * struct ecdsa_kat - known answer test for ECDSA verification
+ *
+ * @curve:	Curve name
+ * @bits:	Key size in bits
+ * @x:		Public key X coordinate
+ * @y:		Public key Y coordinate
+ * @hash:	Hash of the signed message
+ * @hash_len:	Length of @hash in bytes
+ * @sig:	Raw (R, S) signature, 2 * @bits / 8 bytes
+ */
+struct ecdsa_kat {
+	const char *curve;
+	uint bits;
+	const u8 *x;
+	const u8 *y;
+	const u8 *hash;
+	uint hash_len;
+	const u8 *sig;
+};
+
+static const struct ecdsa_kat ecdsa_kats[] = {
+	{ "prime256v1", 256, p256_x, p256_y, p256_hash, sizeof(p256_hash),
+	  p256_sig },
+	{ "secp384r1", 384, p384_x, p384_y, p384_hash, sizeof(p384_hash),
+	  p384_sig },
+	/* Hash shorter than the curve order */
+	{ "secp384r1", 384, p384_x, p384_y, p384_sha256_hash,
+	  sizeof(p384_sha256_hash), p384_sha256_sig },
+};
+
+static int ecdsa_kat_check(struct unit_test_state *uts,
+			   const struct ecdsa_kat *kat)
+{
+	struct ecdsa_public_key key = {
+		.curve_name = kat->curve,
+		.x = kat->x,
+		.y = kat->y,
+		.size_bits = kat->bits,
+	};
+	const uint sig_len = kat->bits / 4;
+	u8 sig[2 * ECDSA384_BYTES], hash[ECDSA384_BYTES];
+	u8 y[ECDSA384_BYTES];
+
+	memcpy(sig, kat->sig, sig_len);
+	memcpy(hash, kat->hash, kat->hash_len);
+	ut_assertok(ecdsa_verify_sw(&key, hash, kat->hash_len, sig, sig_len));
+	ut_asserteq(-EINVAL, ecdsa_verify_sw(&key, hash, kat->hash_len, sig,
+					     sig_len - 1));
+
+	/* Corrupted R, S and hash */
+	sig[1] ^= 0x10;
+	ut_asserteq(-EPERM, ecdsa_verify_sw(&key, hash, kat->hash_len, sig,
+					    sig_len));
+	sig[1] ^= 0x10;
+	sig[sig_len - 1] ^= 0x01;
+	ut_asserteq(-EPERM, ecdsa_verify_sw(&key, hash, kat->hash_len, sig,
+					    sig_len));
+	sig[sig_len - 1] ^= 0x01;
+	hash[kat->hash_len / 2] ^= 0x80;
+	ut_asserteq(-EPERM, ecdsa_verify_sw(&key, hash, kat->hash_len, sig,
+					    sig_len));
+	hash[kat->hash_len / 2] ^= 0x80;
+
+	/* Public key which is not on the curve */
+	memcpy(y, kat->y, kat->bits / 8);
+	y[4] ^= 0x01;
+	key.y = y;
+	ut_asserteq(-EINVAL, ecdsa_verify_sw(&key, hash, kat->hash_len, sig,
+					     sig_len));
+
+	return 0;
+}
+
+static int lib_ecdsa_verify_kat(struct unit_test_state *uts)
+{
+	uint i;
+
+	for (i = 0; i < ARRAY_SIZE(ecdsa_kats); i++)
+		ut_assertok(ecdsa_kat_check(uts, &ecdsa_kats[i]));
+
+	return CMD_RET_SUCCESS;
+}
+LIB_TEST(lib_ecdsa_verify_kat, 0);
+
+/* Check that the software verifier is reachable through the ECDSA uclass */
+static int lib_ecdsa_verify_uclass(struct unit_test_state *uts)
+{
+	const struct ecdsa_kat *kat = &ecdsa_kats[0];
+	struct ecdsa_public_key key = {
+		.curve_name = kat->curve,
+		.x = kat->x,
+		.y = kat->y,
+		.size_bits = kat->bits,
+	};
+	const struct ecdsa_ops *ops;
+	struct udevice *dev;
+
+	ut_assertok(uclass_first_device_err(UCLASS_ECDSA, &dev));
+	ops = device_get_ops(dev);
+	ut_assertnonnull(ops->verify);
+	ut_assertok(ops->verify(dev, &key, kat->hash, kat->hash_len, kat->sig,
+				kat->bits / 4));
+
+	return CMD_RET_SUCCESS;
+}
+LIB_TEST(lib_ecdsa_verify_uclass, 0);
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the UEFI variable store: hash index and file records
+ */
+
+#include <common.h>
+#include <efi_loader.h>
+#include <efi_variable.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+#define TEST_VARS	64
+#define ATTR_NV		(EFI_VARIABLE_NON_VOLATILE | \
+			 EFI_VARIABLE_BOOTSERVICE_ACCESS)
+
+static const efi_guid_t test_guid =
+	EFI_GUID(0x3c1d7a52, 0x9e0b, 0x4f61,
+		 0x8a, 0x2d, 0x71, 0x5e, 0xc4, 0x09, 0xb3, 0x6f);
+
+/* Names T00 to T63, enough for the index to see collisions */
+static void test_name(u16 *name, int i)
+{
+	name[0] = 'T';
+	name[1] = '0' + i / 10;
+	name[2] = '0' + i % 10;
+	name[3] = 0;
+}
+
+/* Check that variable @i holds the single byte @val, or is absent if < 0 */
+static int check_var(struct unit_test_state *uts, int i, int val)
+{
+	efi_uintn_t size = 1;
+	u16 name[4];
+	u8 data;
+
+	test_name(name, i);
+	if (val < 0) {
+		ut_assertnull(efi_var_mem_find(&test_guid, name, NULL));
+		return 0;
+	}
+	ut_asserteq(EFI_SUCCESS, efi_get_variable_mem(name, &test_guid, NULL,
+						      &size, &data, NULL));
+	ut_asserteq(1, size);
+	ut_asserteq(val, data);
+
+	return 0;
+}
+
+static int set_var(struct unit_test_state *uts, int i, u32 attr)
+{
+	u16 name[4];
+	u8 data = i;
+
+	test_name(name, i);
+	ut_asserteq(EFI_SUCCESS, efi_var_mem_ins(name, &test_guid, attr, 1,
+						 &data, 0, NULL, 0));
+
+	return 0;
+}
+
+static void del_var(int i)
+{
+	u16 name[4];
+
+	test_name(name, i);
+	efi_var_mem_del(efi_var_mem_find(&test_guid, name, NULL));
+}
+
+/* Insert and delete variables in various orders and look them all up */
+static int lib_test_efi_var_index(struct unit_test_state *uts)
+{
+	int i;
+
+	ut_asserteq(EFI_SUCCESS, efi_init_obj_list());
+
+	for (i = 0; i < TEST_VARS; i++)
+		ut_assertok(set_var(uts, i, EFI_VARIABLE_BOOTSERVICE_ACCESS));
+	for (i = 0; i < TEST_VARS; i++)
+		ut_assertok(check_var(uts, i, i));
+
+	/*
+	 * Deleting a variable moves those stored after it, and may move index
+	 * entries back along their probe sequence
+	 */
+	for (i = TEST_VARS - 1; i >= 0; i -= 3)
+		del_var(i);
+	for (i = 0; i < TEST_VARS; i++) {
+		ut_assertok(check_var(uts, i,
+				      (TEST_VARS - 1 - i) % 3 ? i : -1));
+	}
+
+	for (i = TEST_VARS - 1; i >= 0; i -= 3)
+		ut_assertok(set_var(uts, i, EFI_VARIABLE_BOOTSERVICE_ACCESS));
+	for (i = 0; i < TEST_VARS; i++)
+		ut_assertok(check_var(uts, i, i));
+
+	for (i = 0; i < TEST_VARS; i++)
+		del_var(i);
+	for (i = 0; i < TEST_VARS; i++)
+		ut_assertok(check_var(uts, i, -1));
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_var_index, 0);
+
+/* Add variable @i with @len bytes of value @val to a record */
+static u8 *add_var(u8 *p, int i, int val, int len)
+{
+	struct efi_var_entry *var = (struct efi_var_entry *)p;
+	u8 *data = (u8 *)(var->name + 4);
+
+	var->length = len;
+	var->attr = ATTR_NV;
+	var->time = 0;
+	guidcpy(&var->guid, &test_guid);
+	test_name(var->name, i);
+	memset(data, val, len);
+
+	return (u8 *)ALIGN((uintptr_t)data + len, 8);
+}
+
+/* Fill in the header of the record at @rec, which ends at @end */
+static u8 *end_record(u8 *rec, u8 *end)
+{
+	struct efi_var_file *file = (struct efi_var_file *)rec;
+
+	file->reserved = 0;
+	file->magic = EFI_VAR_FILE_MAGIC;
+	file->length = end - rec;
+	file->crc32 = crc32(0, (u8 *)file->var,
+			    file->length - sizeof(struct efi_var_file));
+
+	return end;
+}
+
+/* Replay a file made of a full snapshot followed by journal records */
+static int lib_test_efi_var_records(struct unit_test_state *uts)
+{
+	u64 buf[128] = { 0 };
+	u8 *start = (u8 *)buf;
+	u8 *rec, *end;
+	loff_t len;
+
+	ut_asserteq(EFI_SUCCESS, efi_init_obj_list());
+
+	/* Snapshot with variables 0 to 2 */
+	rec = start;
+	end = add_var(rec + sizeof(struct efi_var_file), 0, 0, 1);
+	end = add_var(end, 1, 1, 1);
+	end = add_var(end, 2, 2, 1);
+	rec = end_record(rec, end);
+
+	/* Update variable 0, delete variable 1, add variable 3 */
+	rec = end_record(rec, add_var(rec + sizeof(struct efi_var_file),
+				      0, 10, 1));
+	rec = end_record(rec, add_var(rec + sizeof(struct efi_var_file),
+				      1, 0, 0));
+	rec = end_record(rec, add_var(rec + sizeof(struct efi_var_file),
+				      3, 13, 1));
+	len = rec - start;
+
+	/* A record cut short at the end of the file is not replayed */
+	end = end_record(rec, add_var(rec + sizeof(struct efi_var_file),
+				      2, 12, 1));
+	ut_asserteq(len, efi_var_restore_records((void *)buf,
+						 end - start - 1));
+	ut_assertok(check_var(uts, 0, 10));
+	ut_assertok(check_var(uts, 1, -1));
+	ut_assertok(check_var(uts, 2, 2));
+	ut_assertok(check_var(uts, 3, 13));
+
+	/* Once complete, the last record is replayed too */
+	ut_asserteq(end - start, efi_var_restore_records((void *)buf,
+							  end - start));
+	ut_assertok(check_var(uts, 2, 12));
+
+	/* Replay stops at a record which does not match its checksum */
+	rec[sizeof(struct efi_var_file)] ^= 1;
+	ut_asserteq(len, efi_var_restore_records((void *)buf, end - start));
+
+	del_var(0);
+	del_var(2);
+	del_var(3);
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_var_records, 0);
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for fdt_find_regions(), as used to check FIT configuration signatures
+ */
+
+#include <common.h>
+#include <fdt_region.h>
+#include <malloc.h>
+#include <time.h>
+#include <linux/libfdt.h>
+#include <linux/sizes.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define FIT_TEST_CONFIGS	100
+#define FIT_TEST_SIZE		SZ_128K
+#define FIT_TEST_MAX_REGIONS	1000
+#define FIT_TEST_LOOPS		10
+
+static const char test_data[] = "fit test data";
+
+static char * const exc_prop[] = {
+	"data",
+	"data-size",
+	"data-position",
+	"data-offset"
+};
+
+/* Add an image node with a hash subnode */
+static int add_image(struct unit_test_state *uts, void *fit, const char *type,
+		     int seq)
+{
+	char name[30];
+
+	snprintf(name, sizeof(name), "%s-%d", type, seq);
+	ut_assertok(fdt_begin_node(fit, name));
+	ut_assertok(fdt_property_string(fit, "description", name));
+	ut_assertok(fdt_property(fit, "data", test_data, sizeof(test_data)));
+	ut_assertok(fdt_property_string(fit, "type", type));
+	ut_assertok(fdt_property_string(fit, "arch", "sandbox"));
+	ut_assertok(fdt_property_string(fit, "compression", "none"));
+	ut_assertok(fdt_begin_node(fit, "hash-1"));
+	ut_assertok(fdt_property_string(fit, "algo", "sha256"));
+	ut_assertok(fdt_property(fit, "value", test_data, 32));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+
+	return 0;
+}
+
+/* Create a FIT with FIT_TEST_CONFIGS configurations, each with two images */
+static int make_fit(struct unit_test_state *uts, void *fit)
+{
+	char name[30], kernel[30], fdt[30];
+	int i;
+
+	ut_assertok(fdt_create(fit, FIT_TEST_SIZE));
+	ut_assertok(fdt_finish_reservemap(fit));
+	ut_assertok(fdt_begin_node(fit, ""));
+	ut_assertok(fdt_property_string(fit, "description", "test"));
+	ut_assertok(fdt_begin_node(fit, "images"));
+	for (i = 1; i <= FIT_TEST_CONFIGS; i++) {
+		ut_assertok(add_image(uts, fit, "kernel", i));
+		ut_assertok(add_image(uts, fit, "fdt", i));
+	}
+	ut_assertok(fdt_end_node(fit));
+
+	ut_assertok(fdt_begin_node(fit, "configurations"));
+	ut_assertok(fdt_property_string(fit, "default", "conf-1"));
+	for (i = 1; i <= FIT_TEST_CONFIGS; i++) {
+		snprintf(name, sizeof(name), "conf-%d", i);
+		snprintf(kernel, sizeof(kernel), "kernel-%d", i);
+		snprintf(fdt, sizeof(fdt), "fdt-%d", i);
+		ut_assertok(fdt_begin_node(fit, name));
+		ut_assertok(fdt_property_string(fit, "kernel", kernel));
+		ut_assertok(fdt_property_string(fit, "fdt", fdt));
+		ut_assertok(fdt_begin_node(fit, "signature-1"));
+		ut_assertok(fdt_property_string(fit, "algo",
+						"sha256,rsa2048"));
+		ut_assertok(fdt_end_node(fit));
+		ut_assertok(fdt_end_node(fit));
+	}
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_finish(fit));
+
+	return 0;
+}
+
+/* Set up the list of nodes hashed by the signature of configuration @seq */
+static void get_hashed_nodes(char paths[][40], char *inc[], int seq)
+{
+	int i;
+
+	snprintf(paths[0], 40, "/");
+	snprintf(paths[1], 40, "/configurations");
+	snprintf(paths[2], 40, "/configurations/conf-%d", seq);
+	snprintf(paths[3], 40, "/images");
+	snprintf(paths[4], 40, "/images/kernel-%d", seq);
+	snprintf(paths[5], 40, "/images/kernel-%d/hash-1", seq);
+	snprintf(paths[6], 40, "/images/fdt-%d", seq);
+	snprintf(paths[7], 40, "/images/fdt-%d/hash-1", seq);
+	for (i = 0; i < 8; i++)
+		inc[i] = paths[i];
+}
+
+static bool region_covers(const struct fdt_region *region, int count,
+			  int offset)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (offset >= region[i].offset &&
+		    offset < region[i].offset + region[i].size)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Check that a node and its properties are covered by the regions, apart from
+ * the excluded ones. If @want is false, check that none of the properties are
+ * covered. The node itself still is, since its parent is included.
+ */
+static int check_node(struct unit_test_state *uts, const void *fit,
+		      const struct fdt_region *region, int count,
+		      const char *path, bool want)
+{
+	int base = fdt_off_dt_struct(fit);
+	int node, prop;
+
+	node = fdt_path_offset(fit, path);
+	ut_assert(node >= 0);
+	if (want)
+		ut_assert(region_covers(region, count, base + node));
+	fdt_for_each_property_offset(prop, fit, node) {
+		const char *name;
+
+		fdt_getprop_by_offset(fit, prop, &name, NULL);
+		ut_asserteq(want && strcmp(name, "data"),
+			    region_covers(region, count, base + prop));
+	}
+
+	return 0;
+}
+
+/* Test fdt_find_regions() with the nodes hashed by a FIT signature */
+static int lib_test_fdt_find_regions(struct unit_test_state *uts)
+{
+	struct fdt_region region[FIT_TEST_MAX_REGIONS];
+	char paths[8][40], other[40];
+	char path[200];
+	char *inc[8];
+	void *fit;
+	int seq, count, i;
+
+	fit = malloc(FIT_TEST_SIZE);
+	ut_assertnonnull(fit);
+	ut_assertok(make_fit(uts, fit));
+
+	for (seq = 1; seq <= FIT_TEST_CONFIGS; seq += 9) {
+		get_hashed_nodes(paths, inc, seq);
+		count = fdt_find_regions(fit, inc, ARRAY_SIZE(inc), exc_prop,
+					 ARRAY_SIZE(exc_prop), region,
+					 FIT_TEST_MAX_REGIONS, path,
+					 sizeof(path), 0);
+		ut_assert(count > 0);
+		ut_assert(count < FIT_TEST_MAX_REGIONS);
+
+		/* Regions must be in order and must not overlap */
+		for (i = 1; i < count; i++)
+			ut_assert(region[i].offset >= region[i - 1].offset +
+				  region[i - 1].size);
+
+		for (i = 0; i < ARRAY_SIZE(inc); i++)
+			ut_assertok(check_node(uts, fit, region, count,
+					       inc[i], true));
+
+		/* Similar names must not match, e.g. fdt-1 and fdt-10 */
+		snprintf(other, sizeof(other), "/images/fdt-%d", seq * 10);
+		if (seq * 10 <= FIT_TEST_CONFIGS)
+			ut_assertok(check_node(uts, fit, region, count, other,
+					       false));
+		snprintf(other, sizeof(other),
+			 "/configurations/conf-%d/signature-1", seq);
+		ut_assertok(check_node(uts, fit, region, count, other, false));
+	}
+
+	/* Too small a path buffer */
+	ut_asserteq(-FDT_ERR_NOSPACE,
+		    fdt_find_regions(fit, inc, ARRAY_SIZE(inc), exc_prop,
+				     ARRAY_SIZE(exc_prop), region,
+				     FIT_TEST_MAX_REGIONS, path, 10, 0));
+	free(fit);
+
+	return 0;
+}
+LIB_TEST(lib_test_fdt_find_regions, 0);
+
+/* Time finding the regions for every configuration of a large FIT */
+static int lib_test_fdt_find_regions_perf(struct unit_test_state *uts)
+{
+	struct fdt_region region[FIT_TEST_MAX_REGIONS];
+	char paths[8][40];
+	char path[200];
+	char *inc[8];
+	ulong start, duration;
+	void *fit;
+	int seq, loop;
+
+	fit = malloc(FIT_TEST_SIZE);
+	ut_assertnonnull(fit);
+	ut_assertok(make_fit(uts, fit));
+
+	start = timer_get_us();
+	for (loop = 0; loop < FIT_TEST_LOOPS; loop++) {
+		for (seq = 1; seq <= FIT_TEST_CONFIGS; seq++) {
+			get_hashed_nodes(paths, inc, seq);
+			ut_assert(fdt_find_regions(fit, inc, ARRAY_SIZE(inc),
+						   exc_prop,
+						   ARRAY_SIZE(exc_prop),
+						   region,
+						   FIT_TEST_MAX_REGIONS, path,
+						   sizeof(path), 0) > 0);
+		}
+	}
+	duration = timer_get_us() - start;
+	printf("fdt_find_regions: %d configs x %d loops, FIT size %x: %lu us\n",
+	       FIT_TEST_CONFIGS, FIT_TEST_LOOPS, fdt_totalsize(fit), duration);
+	free(fit);
+
+	return 0;
+}
+LIB_TEST(lib_test_fdt_find_regions_perf, 0);
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for writing Android sparse images piece by piece
+ */
+
+#include <common.h>
+#include <image-sparse.h>
+#include <malloc.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define BLKSZ		512
+#define SPARSE_BLKSZ	1024
+#define STORE_BLKS	16
+
+/* RAW 2, FILL 1, DONT_CARE 1, RAW 1, in sparse blocks */
+#define IMAGE_BLKS	5
+#define IMAGE_CHUNKS	4
+#define IMAGE_SIZE	(sizeof(sparse_header_t) + \
+			 4 * sizeof(chunk_header_t) + \
+			 3 * SPARSE_BLKSZ + sizeof(u32))
+#define FILL_VAL	0x5aa5c33c
+
+static u8 image[IMAGE_SIZE + 4];
+static u8 expect[STORE_BLKS * BLKSZ];
+static u8 store[STORE_BLKS * BLKSZ];
+
+static lbaint_t store_write(struct sparse_storage *info, lbaint_t blk,
+			    lbaint_t blkcnt, const void *buffer)
+{
+	memcpy(store + blk * BLKSZ, buffer, blkcnt * BLKSZ);
+
+	return blkcnt;
+}
+
+static lbaint_t store_reserve(struct sparse_storage *info, lbaint_t blk,
+			      lbaint_t blkcnt)
+{
+	return blkcnt;
+}
+
+static lbaint_t erase_blk, erase_count;
+static int erase_calls;
+
+static lbaint_t store_erase(struct sparse_storage *info, lbaint_t blk,
+			    lbaint_t blkcnt)
+{
+	memset(store + blk * BLKSZ, '\0', blkcnt * BLKSZ);
+	erase_blk = blk;
+	erase_count = blkcnt;
+	erase_calls++;
+
+	return blkcnt;
+}
+
+static void init_storage(struct sparse_storage *info)
+{
+	memset(info, '\0', sizeof(*info));
+	info->blksz = BLKSZ;
+	info->start = 0;
+	info->size = STORE_BLKS;
+	info->write = store_write;
+	info->reserve = store_reserve;
+	memset(store, 0xee, sizeof(store));
+}
+
+static u8 *add_chunk(u8 *p, u16 type, u32 blks, u32 data_sz)
+{
+	chunk_header_t chunk = {
+		.chunk_type = type,
+		.chunk_sz = blks,
+		.total_sz = sizeof(chunk_header_t) + data_sz,
+	};
+
+	memcpy(p, &chunk, sizeof(chunk));
+
+	return p + sizeof(chunk);
+}
+
+static u8 *add_header(u8 *p, u32 blks, u32 chunks)
+{
+	sparse_header_t hdr = {
+		.magic = SPARSE_HEADER_MAGIC,
+		.major_version = 1,
+		.file_hdr_sz = sizeof(sparse_header_t),
+		.chunk_hdr_sz = sizeof(chunk_header_t),
+		.blk_sz = SPARSE_BLKSZ,
+		.total_blks = blks,
+		.total_chunks = chunks,
+	};
+
+	memcpy(p, &hdr, sizeof(hdr));
+
+	return p + sizeof(hdr);
+}
+
+/* Build the image and the storage contents it should produce */
+static void make_image(void)
+{
+	u32 fill = FILL_VAL;
+	u8 *p = image;
+	int i;
+
+	memset(expect, 0xee, sizeof(expect));
+	p = add_header(p, IMAGE_BLKS, IMAGE_CHUNKS);
+
+	p = add_chunk(p, CHUNK_TYPE_RAW, 2, 2 * SPARSE_BLKSZ);
+	for (i = 0; i < 2 * SPARSE_BLKSZ; i++)
+		p[i] = i * 7 + 1;
+	memcpy(expect, p, 2 * SPARSE_BLKSZ);
+	p += 2 * SPARSE_BLKSZ;
+
+	p = add_chunk(p, CHUNK_TYPE_FILL, 1, sizeof(fill));
+	memcpy(p, &fill, sizeof(fill));
+	p += sizeof(fill);
+	for (i = 0; i < SPARSE_BLKSZ; i += sizeof(fill))
+		memcpy(expect + 2 * SPARSE_BLKSZ + i, &fill, sizeof(fill));
+
+	/* The DONT_CARE block keeps its old contents */
+	p = add_chunk(p, CHUNK_TYPE_DONT_CARE, 1, 0);
+
+	p = add_chunk(p, CHUNK_TYPE_RAW, 1, SPARSE_BLKSZ);
+	for (i = 0; i < SPARSE_BLKSZ; i++)
+		p[i] = i * 13 + 5;
+	memcpy(expect + 4 * SPARSE_BLKSZ, p, SPARSE_BLKSZ);
+	p += SPARSE_BLKSZ;
+
+	/* Trailing junk, only used by some tests */
+	memcpy(p, "junk", 4);
+}
+
+/*
+ * Feed the first @len bytes of the image to a stream in pieces, the first of
+ * @first bytes and the others of @step bytes. Data which is not used is
+ * passed again with the next piece, as fastboot does. @failed is set if
+ * sparse_stream_write() fails.
+ *
+ * Return: result of sparse_stream_finish()
+ */
+static int stream_image(size_t len, size_t first, size_t step, bool *failed)
+{
+	struct sparse_storage info;
+	struct sparse_stream ss;
+	char response[64];
+	size_t pos = 0, end = 0;
+	long ret;
+
+	init_storage(&info);
+	sparse_stream_start(&ss, &info, "test");
+	*failed = false;
+	while (end < len) {
+		end = min(len, end ? end + step : first);
+		while (pos < end) {
+			ret = sparse_stream_write(&ss, image + pos, end - pos,
+						  response);
+			if (ret < 0) {
+				*failed = true;
+				break;
+			}
+			if (!ret)
+				break;
+			pos += ret;
+		}
+		if (*failed)
+			break;
+	}
+
+	return sparse_stream_finish(&ss, response);
+}
+
+/* Split the image in two at every byte and check the result each time */
+static int lib_test_sparse_stream_split(struct unit_test_state *uts)
+{
+	ulong start = ut_check_free();
+	bool failed;
+	size_t split;
+
+	make_image();
+	for (split = 1; split < IMAGE_SIZE; split++) {
+		ut_assertok(stream_image(IMAGE_SIZE, split, IMAGE_SIZE,
+					 &failed));
+		ut_assert(!failed);
+		ut_asserteq_mem(expect, store, sizeof(store));
+	}
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream_split, 0);
+
+/* Feed the image in small pieces which split every header and block */
+static int lib_test_sparse_stream_pieces(struct unit_test_state *uts)
+{
+	static const size_t steps[] = { 1, 3, 12, 100, BLKSZ - 1, BLKSZ + 1 };
+	ulong start = ut_check_free();
+	bool failed;
+	int i;
+
+	make_image();
+	for (i = 0; i < ARRAY_SIZE(steps); i++) {
+		ut_assertok(stream_image(IMAGE_SIZE, steps[i], steps[i],
+					 &failed));
+		ut_assert(!failed);
+		ut_asserteq_mem(expect, store, sizeof(store));
+	}
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream_pieces, 0);
+
+/* A truncated image and data after the last chunk are both errors */
+static int lib_test_sparse_stream_errors(struct unit_test_state *uts)
+{
+	struct sparse_storage info;
+	ulong start = ut_check_free();
+	char response[64];
+	bool failed;
+
+	make_image();
+
+	/* Truncated in the last RAW chunk */
+	ut_asserteq(-1, stream_image(IMAGE_SIZE - 1, 100, 100, &failed));
+	ut_assert(!failed);
+
+	/* Trailing data, whether in the same piece or a later one */
+	ut_asserteq(-1, stream_image(IMAGE_SIZE + 4, 100, 100, &failed));
+	ut_assert(failed);
+	ut_asserteq(-1, stream_image(IMAGE_SIZE + 4, IMAGE_SIZE, 4, &failed));
+	ut_assert(failed);
+
+	/* A whole image in memory may be followed by anything */
+	init_storage(&info);
+	ut_assertok(write_sparse_image(&info, "test", image, response));
+	ut_asserteq_mem(expect, store, sizeof(store));
+
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream_errors, 0);
+
+/* A zero FILL chunk is erased as far as it covers whole erase groups */
+static int lib_test_sparse_stream_erase(struct unit_test_state *uts)
+{
+	struct sparse_storage info;
+	ulong start = ut_check_free();
+	char response[64];
+	u32 fill = 0;
+	u8 *p = image;
+
+	/* RAW 1, FILL 6 with zero: blocks 2-13 of the storage */
+	p = add_header(p, 7, 2);
+	p = add_chunk(p, CHUNK_TYPE_RAW, 1, SPARSE_BLKSZ);
+	memset(p, 0x3c, SPARSE_BLKSZ);
+	p += SPARSE_BLKSZ;
+	p = add_chunk(p, CHUNK_TYPE_FILL, 6, sizeof(fill));
+	memcpy(p, &fill, sizeof(fill));
+
+	memset(expect, 0xee, sizeof(expect));
+	memset(expect, 0x3c, SPARSE_BLKSZ);
+	memset(expect + SPARSE_BLKSZ, '\0', 6 * SPARSE_BLKSZ);
+
+	init_storage(&info);
+	info.erase = store_erase;
+	info.erase_blks = 4;
+	erase_calls = 0;
+	ut_assertok(write_sparse_image(&info, "test", image, response));
+	ut_asserteq_mem(expect, store, sizeof(store));
+
+	/* Blocks 2-3 and 12-13 are written, the groups between are erased */
+	ut_asserteq(1, erase_calls);
+	ut_asserteq(4, erase_blk);
+	ut_asserteq(8, erase_count);
+
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream_erase, 0);
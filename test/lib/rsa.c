@@ -3,16 +3,18 @@
  * Copyright (c) 2019 Linaro Limited
  * Author: AKASHI Takahiro
  *
- * Unit test for rsa_verify() function
+ * Unit test for rsa_verify() and rsa_mod_exp_sw() functions
  */
 
 #include <common.h>
 #include <command.h>
 #include <image.h>
+#include <time.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
 #include <u-boot/rsa.h>
+#include <u-boot/rsa-mod-exp.h>
 
 #ifdef CONFIG_RSA_VERIFY_WITH_PKEY
 /*
@@ -204,3 +206,551 @@ static int lib_rsa_verify_invalid(struct unit_test_state *uts)
 
 LIB_TEST(lib_rsa_verify_invalid, 0);
 #endif /* RSA_VERIFY_WITH_PKEY */
+
+#ifdef CONFIG_RSA_SOFTWARE_EXP
+/*
+ * Known answers for rsa_mod_exp_sw(), with random odd moduli and values:
+ * out = sig ^ e mod modulus, rr = (2 ^ (32 * words)) ^ 2 mod modulus
+ *
+ * The 2080-bit modulus does not fill a whole number of 64-bit limbs and the
+ * dense exponent uses windowed exponentiation.
+ */
+static const u8 mod2048_modulus[] = {
+	0xb1, 0xc9, 0xd4, 0xe6, 0xb0, 0x08, 0x56, 0x1a, 0x60, 0xa4, 0x68, 0x29,
+	0x55, 0x3e, 0x46, 0x61, 0xd4, 0x17, 0xb1, 0xd3, 0x17, 0x8d, 0x85, 0x93,
+	0x9c, 0x7d, 0xa0, 0x2c, 0x3f, 0x16, 0xac, 0x77, 0x11, 0x88, 0xcf, 0xc5,
+	0xab, 0x98, 0x52, 0x07, 0x7a, 0x88, 0xf0, 0x2e, 0xa1, 0x52, 0x9f, 0x3b,
+	0x69, 0x7a, 0x8d, 0x8c, 0x9f, 0x00, 0x83, 0xe2, 0x7d, 0xa3, 0xc7, 0x7a,
+	0x25, 0x35, 0xca, 0xc5, 0x86, 0x90, 0x40, 0x53, 0x87, 0xc8, 0xe6, 0x01,
+	0xb6, 0xda, 0xa4, 0x40, 0x38, 0xd6, 0x9c, 0x75, 0xd6, 0x62, 0x1f, 0x80,
+	0x80, 0x44, 0x38, 0x5d, 0xe5, 0xfc, 0x7f, 0x5c, 0x71, 0x15, 0x56, 0xcc,
+	0x93, 0x49, 0xe3, 0x88, 0x9b, 0xfc, 0x3c, 0x9e, 0x2f, 0x0b, 0x05, 0x1b,
+	0xb0, 0x95, 0xd6, 0x98, 0x0d, 0x88, 0x85, 0xe4, 0xcf, 0x69, 0x61, 0xbd,
+	0x15, 0xbe, 0x9f, 0x0c, 0x20, 0xc7, 0xd6, 0xbc, 0x82, 0x95, 0xbc, 0x5d,
+	0x3a, 0x12, 0x2b, 0x95, 0x71, 0x07, 0x7b, 0xc7, 0x60, 0x8a, 0xef, 0x14,
+	0xca, 0x75, 0x86, 0x47, 0xbc, 0x3d, 0x5a, 0x2d, 0x2f, 0x72, 0xdf, 0x18,
+	0xe1, 0x24, 0x6f, 0x57, 0xe2, 0x8e, 0x43, 0x4c, 0x85, 0x05, 0x18, 0x90,
+	0xbf, 0x11, 0x0e, 0x27, 0x9e, 0xa1, 0xeb, 0x4b, 0x8b, 0x01, 0x4d, 0xc3,
+	0x87, 0xb5, 0xd4, 0x89, 0xb9, 0x6b, 0xa8, 0x86, 0x0b, 0x10, 0x9d, 0x1b,
+	0x94, 0xd0, 0xf6, 0x9b, 0x90, 0xf5, 0xeb, 0x6c, 0x6d, 0xda, 0x2c, 0x18,
+	0x9e, 0x14, 0x53, 0x25, 0x4a, 0xf5, 0x25, 0x99, 0x62, 0x63, 0xf0, 0xdb,
+	0x2e, 0xb7, 0x49, 0xc1, 0x9b, 0x9a, 0xe9, 0x1b, 0xa9, 0x31, 0xc9, 0x42,
+	0xb6, 0x66, 0xda, 0xfe, 0x8d, 0xee, 0x31, 0x8d, 0x2b, 0x70, 0x87, 0xbd,
+	0x5b, 0xb5, 0x84, 0x92, 0x9d, 0xaf, 0xe6, 0xbe, 0xad, 0x21, 0x91, 0x46,
+	0x25, 0xee, 0x8c, 0x4d
+};
+
+static const u8 mod2048_rr[] = {
+	0x5a, 0x72, 0x48, 0xba, 0xc8, 0x69, 0x05, 0x5c, 0xcb, 0x2c, 0xf6, 0x46,
+	0xb2, 0xb0, 0x2f, 0xac, 0x30, 0xac, 0x15, 0x25, 0x91, 0x85, 0xbd, 0x25,
+	0xf3, 0x04, 0xb8, 0xde, 0xe3, 0xe6, 0xa8, 0xe2, 0x7c, 0xb0, 0x77, 0xaf,
+	0x61, 0x74, 0xe1, 0x0e, 0xe0, 0x79, 0xed, 0x09, 0x38, 0xc8, 0x30, 0xa2,
+	0x6b, 0xb1, 0xcd, 0x68, 0xb0, 0x36, 0x4b, 0x67, 0x99, 0x36, 0x08, 0xc2,
+	0x3f, 0x77, 0xb3, 0xe5, 0x40, 0xb2, 0xa7, 0x43, 0xd8, 0x78, 0x03, 0xff,
+	0x7f, 0x9e, 0x1b, 0xb7, 0xf5, 0x7d, 0xec, 0x56, 0xde, 0x67, 0x2d, 0x81,
+	0xd2, 0xb9, 0x5b, 0x0e, 0x29, 0x6f, 0xc5, 0x20, 0x32, 0x75, 0xa6, 0x45,
+	0x46, 0x83, 0xa7, 0xe5, 0x93, 0x32, 0x39, 0x08, 0x6e, 0xdd, 0x4a, 0x4e,
+	0x7d, 0x97, 0x52, 0xc1, 0x4a, 0xb3, 0x80, 0x1a, 0x75, 0x39, 0x06, 0xf5,
+	0xf4, 0xfd, 0x60, 0x98, 0x86, 0x41, 0x78, 0x87, 0xf8, 0xac, 0x6e, 0xf3,
+	0x7b, 0x41, 0x8e, 0x1e, 0x53, 0x26, 0x50, 0xfc, 0x75, 0xb0, 0xba, 0x0c,
+	0xbd, 0x18, 0x14, 0x8a, 0x55, 0xfd, 0xcc, 0xa7, 0x4a, 0xe8, 0x20, 0xe0,
+	0x3c, 0x4e, 0x91, 0xb5, 0xae, 0x2e, 0x70, 0x56, 0xf9, 0x65, 0x86, 0xc2,
+	0x58, 0xc1, 0x8b, 0x79, 0x52, 0x45, 0xc3, 0xd4, 0x5e, 0xaa, 0xfc, 0x4d,
+	0xb5, 0x3a, 0x41, 0x6d, 0xc0, 0x31, 0xc9, 0x87, 0x9c, 0x08, 0xd2, 0xa8,
+	0x89, 0x39, 0xa6, 0x31, 0x0d, 0x03, 0xb5, 0xd7, 0x67, 0x29, 0xff, 0xbe,
+	0x35, 0x2d, 0x6a, 0x3e, 0x52, 0x2f, 0xb6, 0x7b, 0xc3, 0x64, 0xd2, 0xb0,
+	0xc0, 0x6d, 0xf6, 0x8e, 0xa5, 0xb6, 0x25, 0x48, 0x92, 0xb8, 0xbd, 0x5e,
+	0x88, 0xff, 0x0b, 0x15, 0xb3, 0x15, 0x8b, 0xb6, 0x7a, 0x25, 0x17, 0xae,
+	0x93, 0x00, 0xb1, 0x94, 0x7f, 0x61, 0x71, 0x33, 0x08, 0x26, 0xb9, 0xc0,
+	0xe8, 0x95, 0x4e, 0x3c
+};
+
+static const u8 mod2048_sig[] = {
+	0x79, 0x54, 0x37, 0x5d, 0xf0, 0x0d, 0x80, 0xd0, 0x1e, 0x88, 0xb1, 0x1f,
+	0x65, 0xff, 0xfc, 0x02, 0x0c, 0x60, 0x66, 0x9f, 0x87, 0x13, 0xd7, 0x78,
+	0x5e, 0xa1, 0xcf, 0x88, 0xf9, 0x58, 0xf4, 0x5b, 0xd6, 0x4b, 0x14, 0xd5,
+	0x88, 0x9e, 0xa0, 0x4f, 0x29, 0x93, 0x8a, 0x4b, 0x9f, 0x82, 0x54, 0x80,
+	0x8a, 0xfd, 0x20, 0xf0, 0xea, 0x3d, 0x05, 0xc9, 0x96, 0x43, 0xad, 0xd9,
+	0x99, 0xac, 0xc1, 0x4e, 0x34, 0x78, 0x49, 0xa3, 0xbe, 0x36, 0x35, 0x93,
+	0x3e, 0x8e, 0x35, 0xf8, 0x64, 0x07, 0x0a, 0xf1, 0x35, 0x15, 0x08, 0xb5,
+	0xae, 0xf3, 0x18, 0x02, 0x82, 0xed, 0x38, 0xa3, 0xde, 0x54, 0xb4, 0xc8,
+	0xfd, 0x73, 0x87, 0xfd, 0xa0, 0x2f, 0x5b, 0x20, 0xdf, 0x78, 0x82, 0xd3,
+	0x72, 0x77, 0x67, 0x47, 0x89, 0x53, 0x66, 0xc1, 0xf2, 0x92, 0x93, 0xcc,
+	0xa3, 0x82, 0x8c, 0x78, 0x78, 0x5a, 0xb1, 0xa0, 0xbe, 0x0a, 0xc5, 0x23,
+	0xa3, 0xa4, 0xea, 0x5a, 0x50, 0xe6, 0x3d, 0x48, 0xd3, 0x36, 0xda, 0xb4,
+	0x44, 0x64, 0x76, 0xff, 0xe3, 0x89, 0x93, 0xb5, 0xc4, 0x68, 0x82, 0x75,
+	0xab, 0x2e, 0x8a, 0x42, 0xf6, 0xf3, 0x29, 0xc5, 0x70, 0xca, 0x15, 0x5e,
+	0x9d, 0x6f, 0xf3, 0x0e, 0x8e, 0xdd, 0x19, 0x2e, 0x20, 0xb0, 0x60, 0xc5,
+	0x6e, 0xce, 0x5c, 0xd8, 0x4b, 0x7c, 0xea, 0x37, 0xa1, 0xa3, 0x4a, 0xeb,
+	0x3c, 0xbc, 0x3a, 0x72, 0x96, 0xbc, 0x50, 0x5d, 0x12, 0x62, 0x28, 0x81,
+	0x35, 0x15, 0xa8, 0x14, 0x5d, 0x0b, 0x02, 0x34, 0x2a, 0xc1, 0x0b, 0x72,
+	0xce, 0x04, 0xd9, 0x00, 0xe8, 0x56, 0xc8, 0xd6, 0x22, 0x29, 0x20, 0x1f,
+	0x65, 0xff, 0xe0, 0xbc, 0xd7, 0x19, 0x9a, 0x29, 0x6e, 0x59, 0x84, 0xbb,
+	0x9a, 0x58, 0x6d, 0x20, 0xbf, 0x63, 0x59, 0xa4, 0x6d, 0x6a, 0x95, 0xa5,
+	0x82, 0x89, 0xb8, 0xb9
+};
+
+static const u8 mod2048_e3[] = {
+	0x95, 0x4b, 0xe6, 0x37, 0x20, 0xb1, 0x07, 0xf4, 0x05, 0x0a, 0x5b, 0x40,
+	0x40, 0xdc, 0x5b, 0x80, 0xd3, 0x0e, 0xe1, 0xa0, 0x8c, 0x35, 0x96, 0x27,
+	0xec, 0x3c, 0xf3, 0xf4, 0x94, 0xb8, 0x79, 0xf6, 0x95, 0xf3, 0x00, 0x36,
+	0x84, 0xb9, 0xb4, 0x6b, 0x7c, 0x48, 0xe3, 0x53, 0x92, 0x97, 0x65, 0xc1,
+	0x9e, 0xa1, 0x08, 0x62, 0x2c, 0x3d, 0x3c, 0x75, 0x63, 0x16, 0x19, 0x27,
+	0x90, 0x62, 0xf5, 0xfe, 0xb5, 0xd7, 0x51, 0xe6, 0x84, 0xfe, 0x6b, 0x20,
+	0xc5, 0x39, 0x95, 0xaf, 0x68, 0xc5, 0xcf, 0x91, 0xcb, 0xea, 0xf3, 0xb6,
+	0xfa, 0xbf, 0x85, 0x84, 0xa5, 0x2d, 0x1d, 0x00, 0xcf, 0x89, 0x29, 0xce,
+	0x5c, 0xdf, 0x78, 0xe4, 0x65, 0xfe, 0x10, 0xc8, 0x7d, 0x16, 0x91, 0x8f,
+	0x4e, 0x42, 0x9b, 0x24, 0x14, 0xb2, 0xbc, 0x80, 0x65, 0xfd, 0xdb, 0xcc,
+	0x03, 0x2c, 0x6b, 0xf0, 0x4b, 0x04, 0xb5, 0xa5, 0xd9, 0x7f, 0x02, 0x10,
+	0x58, 0x7f, 0x2b, 0x27, 0x48, 0x19, 0x0c, 0x4b, 0x74, 0x2f, 0x7a, 0xd4,
+	0x57, 0x77, 0xdb, 0x33, 0x8f, 0x3a, 0x56, 0x1d, 0x06, 0xfa, 0x1b, 0xbd,
+	0xef, 0x03, 0xec, 0x92, 0x1a, 0xb7, 0xd4, 0xb6, 0x57, 0x9a, 0x9d, 0x12,
+	0x58, 0x28, 0x41, 0x33, 0x2a, 0x72, 0x60, 0xfa, 0x3e, 0xde, 0x00, 0x2c,
+	0xe8, 0x9f, 0x92, 0xd4, 0xd3, 0xf8, 0x26, 0xec, 0x23, 0x67, 0x69, 0xbb,
+	0xca, 0x01, 0x5a, 0x2a, 0xbf, 0x8c, 0x1e, 0xd2, 0x80, 0x3c, 0x24, 0x74,
+	0xe4, 0x40, 0x86, 0x93, 0x21, 0xa6, 0x9b, 0x4b, 0xde, 0xaa, 0xa0, 0xc5,
+	0x74, 0x45, 0x6a, 0xc0, 0x82, 0x71, 0x11, 0x20, 0x61, 0x75, 0x88, 0x31,
+	0x3a, 0x4c, 0xd1, 0x23, 0x7f, 0x8b, 0x76, 0xcf, 0x96, 0x5d, 0x27, 0x0c,
+	0x02, 0x98, 0x95, 0x24, 0xb7, 0xd1, 0x6d, 0x6f, 0x80, 0xef, 0x43, 0xd4,
+	0x6a, 0x23, 0x81, 0xfc
+};
+
+static const u8 mod2048_e65537[] = {
+	0x89, 0x34, 0x68, 0x6e, 0xa7, 0x62, 0x99, 0x7b, 0x0c, 0x94, 0x5c, 0x8f,
+	0x1f, 0x9f, 0x0e, 0x4c, 0x94, 0x16, 0xd5, 0x3e, 0xef, 0x73, 0xe8, 0xe2,
+	0x29, 0xe6, 0x2b, 0x75, 0x22, 0xc6, 0x01, 0xb6, 0x43, 0xad, 0x98, 0x2b,
+	0x25, 0x14, 0xc9, 0xec, 0x53, 0xdd, 0xc0, 0xe8, 0x25, 0xec, 0xe3, 0x23,
+	0x12, 0x68, 0x9d, 0x09, 0xe1, 0xbe, 0x2b, 0xb4, 0xdd, 0xeb, 0x3a, 0x6b,
+	0x24, 0x64, 0xf2, 0xc5, 0xb7, 0x61, 0xda, 0x3f, 0xbf, 0x3f, 0xaa, 0x68,
+	0xbb, 0x9b, 0x01, 0xb9, 0xd0, 0xd5, 0x2b, 0x7a, 0x6d, 0x2c, 0x2c, 0x9f,
+	0xf7, 0x08, 0x00, 0x1f, 0xd7, 0x31, 0x43, 0x0f, 0xe7, 0x6c, 0x03, 0x38,
+	0xc2, 0x92, 0x64, 0x0c, 0x94, 0x16, 0x91, 0xde, 0x3b, 0x5d, 0x36, 0x8d,
+	0x48, 0x97, 0x0d, 0x19, 0x64, 0xb5, 0x42, 0x88, 0xb2, 0x84, 0xab, 0x08,
+	0xd6, 0x88, 0x59, 0x33, 0x73, 0x41, 0xcb, 0xf8, 0x89, 0x58, 0x26, 0xd0,
+	0xec, 0xc0, 0x1a, 0xfb, 0xcd, 0x39, 0x9e, 0x02, 0xe9, 0x2f, 0xf8, 0x6d,
+	0xe3, 0xd1, 0x9f, 0xdd, 0x98, 0xdc, 0xb1, 0x4d, 0xbf, 0xa2, 0xe0, 0xd0,
+	0x2b, 0x87, 0xb7, 0x52, 0xb4, 0x37, 0xc9, 0x42, 0xda, 0xde, 0xc7, 0xcc,
+	0xca, 0xa4, 0x6a, 0x0c, 0x85, 0x93, 0x6a, 0xdb, 0xd8, 0x4b, 0x65, 0xf4,
+	0xc9, 0x10, 0x96, 0xa7, 0x5f, 0xca, 0xc9, 0x5b, 0x41, 0xb8, 0x7a, 0xd9,
+	0x31, 0x8c, 0xa1, 0x1d, 0xe4, 0x4c, 0x9c, 0xa7, 0x9a, 0x5b, 0xfb, 0x4e,
+	0xea, 0xc4, 0x18, 0x82, 0xe8, 0xd8, 0x2a, 0xdb, 0x58, 0xe4, 0x93, 0x1b,
+	0x70, 0xc5, 0x5e, 0x71, 0x1a, 0xed, 0xfe, 0x42, 0x60, 0x4a, 0x99, 0x59,
+	0xcb, 0xbf, 0x11, 0x67, 0x4d, 0x86, 0xd4, 0xce, 0xf4, 0x46, 0xa3, 0x66,
+	0xbb, 0xa0, 0x97, 0xf7, 0x44, 0x20, 0xc9, 0xd9, 0xd3, 0xc1, 0xad, 0x97,
+	0xab, 0x29, 0xba, 0x4d
+};
+
+static const u8 mod2048_edense[] = {
+	0x8c, 0x13, 0x6d, 0x1c, 0x76, 0x11, 0x62, 0x8c, 0x85, 0xbf, 0xe9, 0xfc,
+	0x95, 0x53, 0xd6, 0xf8, 0x8f, 0x30, 0xf7, 0x7e, 0x3d, 0xf7, 0x25, 0x86,
+	0xfe, 0xb8, 0xab, 0x41, 0xbe, 0xc0, 0xfe, 0x57, 0xc6, 0xaa, 0x14, 0x37,
+	0x99, 0x15, 0x47, 0x42, 0xaf, 0x69, 0x39, 0x0c, 0x01, 0x22, 0xc7, 0xdd,
+	0xc9, 0x49, 0x8d, 0x7f, 0xa4, 0xde, 0xcf, 0xe7, 0xc5, 0x46, 0x49, 0xe6,
+	0x19, 0xae, 0x8d, 0xda, 0x9c, 0xe3, 0xa4, 0xfb, 0x96, 0xac, 0x25, 0x9a,
+	0x69, 0x39, 0x3a, 0x13, 0x5b, 0xe6, 0xd9, 0xaa, 0xab, 0x2a, 0x42, 0x80,
+	0xbf, 0x38, 0x91, 0x2c, 0x92, 0xbb, 0x44, 0xf6, 0xa4, 0x5b, 0x21, 0xe6,
+	0x3f, 0x5c, 0x89, 0x30, 0x7d, 0x28, 0x4b, 0x92, 0xdd, 0x7d, 0x44, 0x8c,
+	0x8d, 0x53, 0x09, 0x32, 0x06, 0xe2, 0xbf, 0xa2, 0x57, 0x3d, 0x0c, 0x73,
+	0xdb, 0x00, 0xa7, 0x84, 0xde, 0x96, 0x9d, 0xcd, 0x50, 0x8d, 0x90, 0xf6,
+	0x0d, 0x2c, 0x5f, 0xa4, 0xd7, 0xc1, 0xdf, 0xb3, 0x4e, 0xc3, 0xaa, 0xe3,
+	0xb3, 0xf3, 0x70, 0x7e, 0x58, 0xd0, 0x56, 0x90, 0xc3, 0x11, 0x92, 0x62,
+	0x41, 0x17, 0xe5, 0xbf, 0x90, 0xa6, 0x02, 0x36, 0x94, 0x96, 0xdc, 0x86,
+	0x27, 0xa5, 0xaa, 0x1b, 0xda, 0x7d, 0x24, 0xaf, 0x5e, 0x1f, 0x1f, 0xee,
+	0x4c, 0xe8, 0xa4, 0x6e, 0x9e, 0x32, 0x6f, 0xb9, 0xed, 0xb8, 0xbd, 0xef,
+	0xe7, 0x9b, 0xf9, 0x0c, 0x16, 0xb2, 0x84, 0x08, 0xd7, 0x16, 0xfd, 0x99,
+	0x02, 0x01, 0xb4, 0x68, 0x65, 0x35, 0xf8, 0xe5, 0x9c, 0x04, 0x54, 0xcc,
+	0xf8, 0xa1, 0xba, 0xd3, 0xe3, 0x41, 0x2c, 0x95, 0xdd, 0x77, 0xaf, 0xfd,
+	0x4f, 0x04, 0x7c, 0x79, 0x5b, 0xc9, 0x4c, 0xed, 0x85, 0xbb, 0xc1, 0xee,
+	0xf2, 0xcd, 0x03, 0x4e, 0xce, 0xe0, 0xf8, 0x83, 0xd4, 0x01, 0x0d, 0x31,
+	0x1d, 0x53, 0x07, 0x36
+};
+
+static const u8 mod2080_modulus[] = {
+	0xce, 0x82, 0x90, 0xa9, 0x30, 0x00, 0xe5, 0x1e, 0x77, 0x1b, 0x3e, 0x81,
+	0x05, 0xbb, 0xd5, 0x71, 0x33, 0x97, 0x69, 0xf0, 0xae, 0x03, 0x6e, 0x37,
+	0xbe, 0x49, 0xbc, 0x68, 0xd5, 0x58, 0xee, 0xeb, 0x4c, 0x0f, 0xe6, 0xa0,
+	0xaf, 0x9c, 0xce, 0x72, 0x30, 0x23, 0x05, 0x55, 0x6e, 0x15, 0xed, 0xd8,
+	0x3e, 0x44, 0xc5, 0x19, 0xbe, 0x25, 0x05, 0x1b, 0x6a, 0x14, 0x85, 0xa5,
+	0x71, 0xfb, 0xdb, 0xed, 0xba, 0x71, 0xee, 0x3a, 0x44, 0x4c, 0x08, 0x48,
+	0x51, 0x5e, 0xbb, 0x8d, 0x46, 0x04, 0xb1, 0x04, 0x6a, 0xee, 0x56, 0xd6,
+	0x01, 0x1b, 0xb7, 0x18, 0x26, 0x8e, 0x0d, 0x82, 0xc6, 0xb3, 0x31, 0xe5,
+	0x1e, 0x6d, 0x7d, 0x08, 0x1d, 0xa1, 0xfb, 0x65, 0x26, 0x73, 0x75, 0x0a,
+	0x46, 0x85, 0xb5, 0xf0, 0x63, 0x9f, 0xa2, 0x5d, 0x3d, 0xdb, 0x33, 0x91,
+	0x14, 0xa5, 0x7a, 0xb5, 0x02, 0x9a, 0x0e, 0x6e, 0x3a, 0xdb, 0x9d, 0x48,
+	0x88, 0x21, 0xad, 0x00, 0x7a, 0xce, 0x14, 0x3a, 0x99, 0x9f, 0x60, 0x50,
+	0x24, 0x96, 0xf4, 0x41, 0x23, 0x21, 0xf4, 0x3b, 0x6a, 0x34, 0x00, 0x12,
+	0x84, 0x00, 0x6c, 0x42, 0x38, 0x87, 0x30, 0x1b, 0x28, 0x24, 0x8f, 0x72,
+	0xa9, 0xa5, 0x76, 0xf7, 0x30, 0xfe, 0x16, 0xb4, 0x72, 0xa5, 0x1f, 0x5b,
+	0x50, 0x96, 0x40, 0x8f, 0x36, 0x8d, 0x1a, 0x51, 0x2c, 0x0c, 0x33, 0xcf,
+	0xf0, 0xab, 0x1c, 0x06, 0xe3, 0x33, 0x65, 0x3d, 0xaf, 0x3a, 0x66, 0xb4,
+	0x6a, 0x56, 0x03, 0x90, 0x41, 0x35, 0x86, 0xe2, 0xb9, 0xeb, 0xcd, 0xdb,
+	0x62, 0x6c, 0xa8, 0x8c, 0xe9, 0x81, 0xb9, 0xf7, 0xe1, 0xfa, 0xbb, 0x8a,
+	0x85, 0xe9, 0xa8, 0xca, 0xdb, 0xa9, 0xe3, 0x06, 0xc7, 0x57, 0x03, 0x1b,
+	0x12, 0x8a, 0x17, 0xc3, 0x4e, 0xad, 0x90, 0xd7, 0x2c, 0x09, 0x4c, 0xc9,
+	0xdf, 0xfd, 0xa4, 0xfe, 0xf1, 0xae, 0xb8, 0xe1
+};
+
+static const u8 mod2080_rr[] = {
+	0x46, 0xdd, 0xb8, 0xaf, 0x5d, 0x72, 0x94, 0x77, 0xa7, 0xa5, 0xdb, 0x00,
+	0x68, 0x84, 0x8f, 0x99, 0x8b, 0xd7, 0x3c, 0x21, 0xf8, 0xe7, 0x0d, 0xb5,
+	0x3b, 0x03, 0xc2, 0x90, 0x14, 0x63, 0xa4, 0xe5, 0xaa, 0x28, 0xb5, 0xa6,
+	0x05, 0xdf, 0x79, 0x85, 0x44, 0xa1, 0xa6, 0x6c, 0x96, 0x8d, 0x97, 0x4c,
+	0x01, 0x3b, 0x5b, 0x17, 0xf9, 0x72, 0x28, 0xc6, 0x4d, 0x7a, 0x61, 0x9b,
+	0xf9, 0xd7, 0xab, 0x2f, 0x39, 0xac, 0x72, 0x73, 0x8f, 0x5e, 0x4b, 0xd9,
+	0x70, 0x60, 0xab, 0x70, 0xb2, 0xad, 0xe5, 0x1c, 0x99, 0xff, 0xd1, 0x34,
+	0x3c, 0xb0, 0x15, 0x4b, 0x60, 0x09, 0xe2, 0xe5, 0x39, 0x66, 0x28, 0x23,
+	0x84, 0x41, 0xbe, 0xbd, 0x9f, 0x0e, 0x4a, 0xe4, 0xd7, 0x81, 0x9c, 0xd4,
+	0x95, 0x9d, 0x8b, 0x2e, 0xd3, 0x25, 0x1d, 0x4c, 0x17, 0x85, 0xd2, 0x14,
+	0x35, 0xc2, 0xd4, 0x23, 0x77, 0x94, 0xb1, 0x23, 0x2a, 0xe5, 0x8b, 0x07,
+	0x07, 0x09, 0x0a, 0xd1, 0xd9, 0x5b, 0x03, 0x4f, 0x1e, 0xf5, 0xd6, 0x3f,
+	0x1c, 0xd0, 0x9b, 0x46, 0x17, 0xfb, 0x45, 0x08, 0xd3, 0xb7, 0xba, 0x24,
+	0x25, 0x21, 0x21, 0xa5, 0x5b, 0x3c, 0xb2, 0xe3, 0x6a, 0x5f, 0x67, 0x29,
+	0xf1, 0xbe, 0x7a, 0x83, 0x47, 0x59, 0xa5, 0x00, 0xc5, 0x49, 0x03, 0x2e,
+	0x61, 0xd5, 0xeb, 0xcc, 0xb3, 0x4d, 0x09, 0x02, 0x64, 0xdb, 0x4b, 0xa5,
+	0x57, 0xbf, 0xa1, 0x7f, 0x27, 0xc3, 0x6a, 0xe9, 0xa6, 0x6d, 0xda, 0x36,
+	0x6f, 0x23, 0xb9, 0x62, 0x5f, 0x6e, 0x7d, 0xeb, 0x03, 0x25, 0xbc, 0x3b,
+	0xc1, 0x85, 0x60, 0xe3, 0x8a, 0xae, 0x37, 0x7b, 0xd8, 0xa9, 0x95, 0x3e,
+	0xc9, 0x15, 0x92, 0xa2, 0x3a, 0x16, 0xc1, 0x1d, 0x93, 0xf7, 0xd1, 0x30,
+	0xd9, 0xbd, 0xe9, 0x5c, 0x31, 0x86, 0x0c, 0x85, 0x5a, 0x9f, 0x9d, 0x93,
+	0x02, 0x0a, 0xb2, 0x5e, 0x5b, 0x0f, 0x24, 0xd0
+};
+
+static const u8 mod2080_sig[] = {
+	0x22, 0xcc, 0x70, 0x8e, 0x24, 0x5f, 0xf6, 0x50, 0xeb, 0x83, 0x2c, 0xa9,
+	0xf3, 0x24, 0x90, 0xa2, 0xab, 0x4f, 0xef, 0x6e, 0x30, 0x41, 0x18, 0xfb,
+	0xb1, 0xf2, 0x2c, 0xb9, 0x0f, 0x76, 0x4a, 0xa0, 0xc9, 0xc2, 0x09, 0xbe,
+	0xdd, 0xeb, 0xb8, 0x89, 0x2f, 0xe8, 0x8c, 0xf5, 0xba, 0x3d, 0x51, 0x5d,
+	0x29, 0xd1, 0x59, 0x09, 0xc7, 0x4a, 0x6a, 0xb0, 0xb0, 0x9a, 0x1e, 0xf1,
+	0x46, 0x27, 0x54, 0x7a, 0x28, 0x38, 0x12, 0x76, 0xd6, 0x36, 0xfa, 0xa3,
+	0x1c, 0xcf, 0x47, 0x04, 0x79, 0x8c, 0xa8, 0xc3, 0x1f, 0x58, 0xa2, 0xdd,
+	0xa3, 0x59, 0xa6, 0xac, 0x12, 0xb7, 0x15, 0xab, 0xf5, 0xac, 0x15, 0x28,
+	0x28, 0xa7, 0x55, 0x38, 0xb4, 0x84, 0xb5, 0x6d, 0x3c, 0x7b, 0x78, 0x52,
+	0xeb, 0xf0, 0x53, 0xba, 0xf1, 0x84, 0xef, 0x9e, 0xb3, 0xb0, 0xf2, 0x13,
+	0x6d, 0x49, 0x95, 0xd5, 0xa6, 0x28, 0xc5, 0x1c, 0x2f, 0x4e, 0xb4, 0xe7,
+	0x38, 0x0a, 0xac, 0xf9, 0x68, 0x0e, 0xda, 0x4c, 0x46, 0xbd, 0xf4, 0xa7,
+	0x41, 0x35, 0xe9, 0x48, 0x01, 0xf3, 0x00, 0xee, 0x23, 0xad, 0xd9, 0x64,
+	0x78, 0x1d, 0x4b, 0x26, 0xae, 0x67, 0x1f, 0x2e, 0xeb, 0x5a, 0x27, 0xd0,
+	0xec, 0xeb, 0xc6, 0x63, 0xf7, 0xac, 0xa7, 0x86, 0xc3, 0xab, 0x36, 0x33,
+	0xd6, 0x65, 0x40, 0x34, 0xab, 0x6e, 0x10, 0xe7, 0x63, 0xc0, 0x5e, 0xb1,
+	0xb6, 0xf3, 0x8f, 0x6c, 0xca, 0x46, 0x65, 0x06, 0xe4, 0xed, 0x7e, 0x49,
+	0x2b, 0x88, 0x0c, 0x32, 0xf0, 0xf7, 0x3f, 0x77, 0x17, 0xc6, 0xe1, 0x15,
+	0x42, 0x4f, 0xfc, 0x8f, 0x3a, 0x12, 0xc5, 0x3a, 0xbd, 0x76, 0xf9, 0xa5,
+	0xa4, 0x72, 0x4f, 0xbf, 0x35, 0x01, 0xd2, 0xb1, 0xd7, 0xbd, 0x71, 0x45,
+	0x92, 0x58, 0x0c, 0x0c, 0x76, 0x5c, 0xa7, 0x99, 0xcb, 0x1e, 0x7a, 0x31,
+	0xd4, 0x69, 0xd5, 0x87, 0xc8, 0x32, 0x96, 0x44
+};
+
+static const u8 mod2080_e65537[] = {
+	0x67, 0x4d, 0x09, 0xf8, 0xc5, 0x2e, 0x7f, 0x72, 0x83, 0xc6, 0x91, 0x1f,
+	0xa6, 0xe5, 0x9d, 0xdb, 0x7e, 0x4b, 0x2f, 0x04, 0xbc, 0xd2, 0x7a, 0x45,
+	0x93, 0x87, 0x74, 0x2a, 0x74, 0x10, 0x97, 0x80, 0x91, 0x82, 0x97, 0xa5,
+	0x67, 0xca, 0x60, 0xec, 0xd1, 0x97, 0xfd, 0x08, 0xed, 0x59, 0x6e, 0xde,
+	0x94, 0xc9, 0x14, 0x2b, 0x30, 0xd1, 0xe7, 0xc7, 0x4f, 0xa3, 0xce, 0x70,
+	0x61, 0x6c, 0xa2, 0x0a, 0x1f, 0xa0, 0xcf, 0x2f, 0xc7, 0x1b, 0xda, 0xfa,
+	0x6e, 0x4b, 0xbd, 0xae, 0x0a, 0xd3, 0x3c, 0x59, 0x1b, 0x80, 0x21, 0xb7,
+	0x8c, 0x46, 0x29, 0xaf, 0xb2, 0x2f, 0xee, 0x63, 0x62, 0xb2, 0xf5, 0xc4,
+	0xe2, 0xfb, 0x0c, 0x60, 0xfd, 0xb5, 0x06, 0x62, 0x7f, 0xaf, 0x90, 0xff,
+	0x4d, 0xd4, 0xec, 0xf1, 0x40, 0x94, 0x60, 0xc1, 0xc2, 0x71, 0x8a, 0x31,
+	0xde, 0xaa, 0x5a, 0x37, 0xac, 0x0e, 0x45, 0x99, 0x0e, 0x69, 0x3f, 0x17,
+	0xaf, 0x5e, 0x4c, 0xa2, 0xb1, 0x19, 0xb9, 0xa3, 0xf0, 0x3c, 0x00, 0x6c,
+	0x6e, 0xf0, 0xce, 0xe1, 0x97, 0x83, 0xba, 0xda, 0x97, 0xee, 0x99, 0x06,
+	0x23, 0x95, 0x43, 0x73, 0xde, 0xe4, 0x13, 0x24, 0x79, 0xcc, 0x86, 0x61,
+	0x32, 0x0b, 0x41, 0xfe, 0x77, 0x58, 0x0b, 0x79, 0xcb, 0xda, 0x93, 0xd3,
+	0xf9, 0x4f, 0x2d, 0xfb, 0x8c, 0x66, 0x5e, 0xb3, 0xe5, 0x8b, 0x47, 0xce,
+	0xab, 0xdf, 0x4a, 0x7a, 0x40, 0x26, 0xce, 0xbf, 0xe9, 0x81, 0x0f, 0x29,
+	0xec, 0x9e, 0x87, 0x06, 0x9b, 0x61, 0x26, 0x30, 0xed, 0x39, 0x8e, 0x37,
+	0xea, 0x94, 0x28, 0x0c, 0xab, 0x92, 0x83, 0x25, 0x3f, 0x1c, 0x9c, 0xbe,
+	0x53, 0x5e, 0xbd, 0x32, 0x58, 0x3c, 0x4c, 0xff, 0xee, 0xef, 0xae, 0x5e,
+	0xdc, 0x27, 0x7b, 0x27, 0xd7, 0x02, 0x21, 0x7c, 0xf0, 0xe4, 0xc4, 0xa8,
+	0x6c, 0xb8, 0xff, 0xcc, 0x0d, 0x55, 0x70, 0x89
+};
+
+static const u8 mod4096_modulus[] = {
+	0x86, 0x95, 0x63, 0x56, 0x73, 0xc5, 0x30, 0x45, 0xf2, 0xa9, 0xcf, 0xe5,
+	0x04, 0xba, 0xcb, 0x20, 0x36, 0x3e, 0x2c, 0x94, 0xfe, 0x66, 0xb6, 0xcd,
+	0x74, 0x9c, 0x4d, 0x87, 0xb0, 0x01, 0xb0, 0x65, 0xc5, 0x1d, 0xf2, 0x62,
+	0x0d, 0xf3, 0x12, 0x85, 0x98, 0x99, 0xf2, 0xfd, 0x16, 0xbe, 0x77, 0xc2,
+	0xb8, 0xd6, 0x5e, 0x54, 0xb1, 0x59, 0xa9, 0xe8, 0x89, 0x69, 0xae, 0x42,
+	0x7c, 0xae, 0x99, 0x8c, 0x58, 0xee, 0x85, 0xf3, 0x56, 0xd0, 0x92, 0x76,
+	0xa9, 0xaf, 0xfd, 0x48, 0xb0, 0xc2, 0x2f, 0x7d, 0x0a, 0x51, 0x2e, 0xca,
+	0x1b, 0xee, 0xca, 0x3b, 0x64, 0xab, 0xee, 0x4c, 0x34, 0x84, 0x5e, 0x88,
+	0xab, 0xe8, 0x3e, 0xbc, 0x7b, 0xcd, 0x53, 0xd4, 0x35, 0x42, 0xe1, 0x81,
+	0x3d, 0x7a, 0x57, 0x40, 0x72, 0x51, 0xbf, 0xe5, 0xf6, 0xe0, 0x0b, 0xe2,
+	0x42, 0xc7, 0x67, 0xac, 0x5b, 0xbd, 0x06, 0x5e, 0x46, 0x4d, 0xd0, 0x1d,
+	0x78, 0xe5, 0xd6, 0xbb, 0xc0, 0x28, 0x64, 0x1b, 0x56, 0xaf, 0xeb, 0x17,
+	0xcb, 0x7d, 0xb3, 0x2a, 0x22, 0x6b, 0xc4, 0x9e, 0x6b, 0xe2, 0xca, 0xc7,
+	0xe2, 0x4f, 0x10, 0xff, 0xa3, 0x6b, 0x9c, 0x5e, 0x3a, 0x5a, 0xf8, 0x87,
+	0x65, 0xaa, 0x08, 0x72, 0xfa, 0x60, 0xc0, 0x00, 0xde, 0x07, 0x1a, 0xd4,
+	0x2d, 0x46, 0xd0, 0x7a, 0xb3, 0xbc, 0x62, 0xf7, 0x11, 0x46, 0x99, 0x81,
+	0xc6, 0xe3, 0xe2, 0x2c, 0x27, 0x04, 0xd6, 0xc7, 0xeb, 0x63, 0xbd, 0x89,
+	0x34, 0xf7, 0x18, 0x19, 0xa8, 0x55, 0xed, 0x32, 0xa6, 0x0c, 0xdd, 0x8b,
+	0xd0, 0x72, 0x3c, 0x61, 0xc0, 0x39, 0x31, 0xeb, 0x1f, 0x37, 0x3d, 0xa6,
+	0x1a, 0xd9, 0x72, 0x60, 0xb2, 0x14, 0xc8, 0x97, 0xb1, 0xab, 0x9b, 0x3f,
+	0xca, 0x79, 0x01, 0xfb, 0x14, 0x56, 0xc3, 0x81, 0xe7, 0xb8, 0x3f, 0x9c,
+	0x8d, 0xae, 0xc3, 0x09, 0x42, 0x7f, 0x26, 0x43, 0xf5, 0x8e, 0x56, 0x00,
+	0x2f, 0x22, 0x95, 0x16, 0xb3, 0x85, 0x60, 0x77, 0xc0, 0x05, 0x1c, 0x8d,
+	0xe0, 0xc2, 0x8d, 0x8d, 0xb1, 0xa3, 0x09, 0x85, 0xe7, 0x1f, 0x71, 0xef,
+	0x19, 0x68, 0xb0, 0x40, 0x45, 0xdd, 0xdb, 0x15, 0x40, 0xff, 0x8d, 0xe2,
+	0x78, 0x9e, 0x65, 0x9c, 0x29, 0x81, 0xf3, 0x00, 0x99, 0x28, 0x3f, 0x6e,
+	0x94, 0x4f, 0x68, 0x7b, 0x8e, 0x6e, 0x33, 0x59, 0x7b, 0x16, 0x8b, 0x34,
+	0x81, 0xb4, 0x82, 0x79, 0x41, 0xd7, 0x7f, 0xae, 0x07, 0xec, 0xca, 0x37,
+	0x71, 0xf7, 0xd1, 0x4c, 0xf5, 0x75, 0x60, 0x3f, 0x33, 0xd6, 0xe4, 0x70,
+	0xc1, 0x32, 0x30, 0x6a, 0x8e, 0xe4, 0x56, 0x0d, 0xc2, 0x0f, 0x65, 0x5a,
+	0x17, 0x02, 0x84, 0xf7, 0x11, 0x19, 0xcb, 0x4e, 0x32, 0x3e, 0xcb, 0xe9,
+	0xf4, 0x12, 0x61, 0x84, 0xfc, 0x69, 0xe9, 0x56, 0x7b, 0xfe, 0x6a, 0xcc,
+	0xff, 0xe3, 0xa6, 0x36, 0xec, 0xa1, 0xad, 0x3f, 0x26, 0xa1, 0xee, 0xe3,
+	0x8e, 0x6c, 0x6e, 0x16, 0xe6, 0x78, 0x86, 0xd2, 0x47, 0xef, 0xa8, 0xec,
+	0xfa, 0xa9, 0xfa, 0x82, 0x95, 0x2b, 0x54, 0xd1, 0x42, 0xc3, 0xee, 0x3b,
+	0x02, 0x50, 0x53, 0xbe, 0xb6, 0xe9, 0xc4, 0x73, 0x23, 0x65, 0x19, 0x85,
+	0xcb, 0x14, 0xc3, 0x70, 0x3f, 0xaa, 0x33, 0xfb, 0xae, 0x79, 0xc7, 0xfd,
+	0x74, 0x1e, 0x9c, 0xb4, 0xc9, 0xc7, 0x19, 0x2d, 0xea, 0x1d, 0x04, 0x92,
+	0x77, 0xec, 0x59, 0x86, 0x22, 0x65, 0x87, 0x83, 0x8b, 0x1d, 0xf3, 0x0a,
+	0x57, 0x60, 0x42, 0x17, 0xc2, 0xe6, 0xe6, 0xea, 0xf4, 0x95, 0x82, 0xb4,
+	0x13, 0x0e, 0x7d, 0xe1, 0xe1, 0x17, 0xbd, 0xf4, 0xbd, 0xa2, 0xca, 0xd2,
+	0x7b, 0x6a, 0xae, 0x9d, 0x67, 0x26, 0x95, 0x22, 0x9a, 0x0b, 0xec, 0xa6,
+	0xb5, 0xb6, 0xdc, 0x7f, 0x73, 0x83, 0x49, 0x15
+};
+
+static const u8 mod4096_rr[] = {
+	0x71, 0x4e, 0x2a, 0x94, 0x74, 0xe0, 0xc6, 0xea, 0xfd, 0xef, 0xc8, 0xea,
+	0x28, 0x43, 0x53, 0xa5, 0x47, 0x3d, 0xfe, 0x45, 0xae, 0x3e, 0x40, 0x8b,
+	0x32, 0x0e, 0x7a, 0xa5, 0x98, 0x08, 0x74, 0xd2, 0xab, 0x27, 0xe6, 0x2f,
+	0xa5, 0xea, 0xf8, 0xe0, 0x44, 0xb4, 0xa6, 0x6f, 0x3a, 0x28, 0xa8, 0xc6,
+	0xb7, 0xea, 0x64, 0x23, 0xbc, 0x7e, 0x2b, 0x39, 0xe8, 0x7b, 0x46, 0xb5,
+	0xd1, 0x06, 0xb5, 0x4b, 0x5d, 0xb7, 0xe5, 0xe0, 0x7b, 0x38, 0x01, 0x59,
+	0xbc, 0x2b, 0x26, 0x8d, 0xf9, 0x1b, 0x25, 0xeb, 0x92, 0xcc, 0x35, 0x82,
+	0x27, 0x55, 0x39, 0x00, 0xaf, 0xbf, 0xc8, 0x67, 0x30, 0x2c, 0x79, 0x83,
+	0x79, 0xaf, 0x3d, 0xc2, 0x60, 0x63, 0x64, 0xc8, 0xaf, 0x24, 0xf3, 0x34,
+	0xeb, 0x86, 0xad, 0xd3, 0x27, 0x71, 0xfb, 0x09, 0xa9, 0x3f, 0x97, 0x6c,
+	0x2b, 0x10, 0xf4, 0x22, 0xe7, 0x12, 0xe3, 0xf7, 0xa4, 0x24, 0xcc, 0xc7,
+	0x01, 0xc6, 0x89, 0x1c, 0x55, 0x43, 0xa7, 0xc8, 0x77, 0x1d, 0x1e, 0x1a,
+	0x21, 0xb8, 0x73, 0x91, 0x02, 0xea, 0x69, 0x99, 0x27, 0x79, 0x64, 0x5e,
+	0xb5, 0x25, 0x10, 0xae, 0xb8, 0xed, 0x16, 0x5c, 0xbf, 0x2d, 0x6b, 0xe7,
+	0xe8, 0x4f, 0xdd, 0xbb, 0x40, 0x18, 0x7d, 0x9e, 0x81, 0xab, 0xa1, 0xed,
+	0x01, 0x41, 0x6b, 0x5c, 0x22, 0xb7, 0x79, 0x9e, 0x52, 0x0f, 0x2e, 0x37,
+	0x1d, 0xb7, 0x96, 0xca, 0x82, 0x1b, 0x9d, 0x1a, 0xab, 0x2f, 0x76, 0x44,
+	0xdc, 0xe8, 0x37, 0x94, 0x96, 0xf5, 0x38, 0xff, 0x19, 0x77, 0xad, 0x4b,
+	0x80, 0x6b, 0x26, 0x82, 0xb4, 0x9e, 0x5b, 0x1e, 0xb8, 0xa7, 0x72, 0xe7,
+	0x67, 0x89, 0xe0, 0xd9, 0x7e, 0xc7, 0x06, 0xb0, 0x7a, 0x89, 0x97, 0x76,
+	0x6e, 0x6a, 0xfc, 0x4b, 0x16, 0xbe, 0xea, 0x28, 0x06, 0xff, 0xf3, 0x75,
+	0x65, 0xaf, 0xb4, 0x7a, 0x62, 0x77, 0x09, 0x3d, 0x0e, 0x27, 0x24, 0x1f,
+	0x97, 0x52, 0x3e, 0x37, 0x40, 0xb5, 0xe1, 0xdc, 0x33, 0xe3, 0xc4, 0x53,
+	0xba, 0x77, 0x74, 0x21, 0xda, 0x00, 0x0c, 0xa6, 0xe8, 0xe7, 0x3e, 0x73,
+	0xd0, 0xf9, 0xe5, 0x6e, 0x0d, 0x78, 0x1c, 0x32, 0x9b, 0x00, 0x0a, 0x72,
+	0xb9, 0x4b, 0xc8, 0xa8, 0x42, 0xcf, 0xb1, 0x82, 0x2f, 0x88, 0xad, 0x8d,
+	0x30, 0xe2, 0x89, 0x5d, 0x92, 0x3e, 0x4d, 0xd2, 0xe3, 0x42, 0x7d, 0xd6,
+	0x39, 0xf8, 0xc2, 0x46, 0x61, 0x2d, 0x27, 0xfb, 0x23, 0x4c, 0xc7, 0x19,
+	0x62, 0x42, 0x19, 0x64, 0x5c, 0xf9, 0xbf, 0x7f, 0xda, 0xc5, 0xec, 0x4d,
+	0xc2, 0xfe, 0x2d, 0x01, 0x84, 0x63, 0x09, 0xc5, 0x0f, 0x6d, 0xde, 0x3d,
+	0xd0, 0x27, 0x83, 0x24, 0xf7, 0x21, 0x45, 0xfc, 0xe5, 0x04, 0xcc, 0xad,
+	0x5f, 0xad, 0x14, 0x97, 0x2b, 0xd4, 0xb3, 0xe4, 0xa1, 0xb7, 0x93, 0x71,
+	0x75, 0x7f, 0xf1, 0x7e, 0xe9, 0xc5, 0x64, 0xdc, 0x15, 0x98, 0xd1, 0x12,
+	0x17, 0x8e, 0x68, 0x9e, 0x40, 0x70, 0x16, 0x2d, 0x78, 0x09, 0x37, 0xf9,
+	0x38, 0xfd, 0x69, 0xe1, 0x13, 0x6d, 0xc2, 0x36, 0xcc, 0x55, 0xd4, 0xe9,
+	0x56, 0x84, 0x02, 0xe5, 0x1f, 0xf2, 0x03, 0x41, 0x8c, 0x8f, 0xbb, 0xa3,
+	0x78, 0x9e, 0xbe, 0xe6, 0xc1, 0x46, 0xed, 0x88, 0x90, 0x03, 0x4d, 0x4f,
+	0x69, 0x62, 0xa1, 0x28, 0xa6, 0x8b, 0x0f, 0xc0, 0x57, 0xe1, 0x46, 0x82,
+	0x90, 0xf0, 0xe3, 0x3e, 0x7c, 0xcf, 0x91, 0x44, 0x18, 0xc5, 0x4e, 0x5a,
+	0x97, 0x63, 0x54, 0x56, 0x79, 0xd9, 0x97, 0xd8, 0x6d, 0x92, 0x1e, 0x2c,
+	0x4d, 0x2d, 0x97, 0xcf, 0x8b, 0xcc, 0xbe, 0x42, 0x23, 0x43, 0x61, 0x52,
+	0x1d, 0xf2, 0xf6, 0x8d, 0x23, 0xb6, 0x43, 0xc3, 0x36, 0xfb, 0x7d, 0xbb,
+	0x2f, 0x1c, 0x25, 0x71, 0x72, 0x11, 0xa5, 0x01
+};
+
+static const u8 mod4096_sig[] = {
+	0x6d, 0xfd, 0xa2, 0xe7, 0xea, 0x14, 0x04, 0xab, 0x49, 0x18, 0xdd, 0x5c,
+	0x73, 0xbd, 0x3e, 0x34, 0x49, 0xc1, 0x3d, 0x87, 0x16, 0xea, 0x91, 0xf2,
+	0x48, 0xfc, 0xb2, 0x33, 0x19, 0x01, 0xee, 0x77, 0xa7, 0x57, 0xc0, 0x85,
+	0x06, 0x6d, 0xd7, 0x13, 0x5d, 0x60, 0x9f, 0xab, 0x97, 0x2a, 0xad, 0x9d,
+	0x32, 0xef, 0x66, 0xc4, 0xb5, 0x6b, 0x20, 0x83, 0x3e, 0xe3, 0x23, 0x5d,
+	0x9c, 0x3f, 0x39, 0x4f, 0x12, 0x89, 0x87, 0xc0, 0xfe, 0x93, 0xb3, 0x25,
+	0x93, 0x28, 0x65, 0xbc, 0xd5, 0x39, 0x21, 0xae, 0xe7, 0x8b, 0xff, 0xfc,
+	0xf4, 0x9f, 0x68, 0x48, 0x1c, 0x4a, 0x2c, 0x20, 0x13, 0xee, 0x0e, 0x54,
+	0x39, 0x9a, 0xc3, 0x5a, 0xf3, 0xbb, 0xc0, 0x3a, 0xd0, 0xbb, 0x0c, 0x60,
+	0x4b, 0xde, 0x86, 0xa6, 0x5c, 0xbc, 0x78, 0x85, 0x0b, 0xa8, 0xd6, 0x4b,
+	0x40, 0x40, 0x2b, 0x16, 0x74, 0x63, 0x8f, 0x08, 0x37, 0x33, 0xe6, 0x89,
+	0xed, 0x75, 0x03, 0x3c, 0xf9, 0xeb, 0x7b, 0xd7, 0xd4, 0xf7, 0xdf, 0x7a,
+	0xe7, 0x5c, 0x70, 0xe7, 0x73, 0x6b, 0x1e, 0x7a, 0x2e, 0x1a, 0x04, 0x2d,
+	0x5c, 0x6c, 0x8d, 0xe0, 0xf9, 0x1a, 0x7f, 0xa2, 0x7d, 0xb6, 0xb9, 0xe0,
+	0x01, 0x34, 0x33, 0xdd, 0xf1, 0x86, 0x7c, 0x81, 0xba, 0x8c, 0x2e, 0x60,
+	0x43, 0x34, 0xf6, 0x11, 0x20, 0x13, 0x05, 0x77, 0xe7, 0xa0, 0x90, 0xd1,
+	0x6d, 0xab, 0x8d, 0xd1, 0xd3, 0x73, 0x30, 0xfd, 0x15, 0x3a, 0xf6, 0xae,
+	0x7b, 0x71, 0x8c, 0x89, 0x3f, 0x49, 0x10, 0x13, 0x2b, 0x8e, 0x4b, 0x15,
+	0x75, 0x21, 0x09, 0x70, 0x12, 0x09, 0x6d, 0x52, 0x79, 0x4a, 0x71, 0x1f,
+	0x93, 0x3b, 0x23, 0x79, 0x8a, 0xb8, 0xb1, 0x76, 0x86, 0x5a, 0xd7, 0x2d,
+	0xc0, 0xd6, 0x08, 0x3d, 0x18, 0x35, 0xe3, 0x40, 0xd2, 0x8c, 0xaf, 0x3b,
+	0x78, 0x59, 0xf1, 0xe1, 0xd2, 0x15, 0x70, 0xc4, 0x3f, 0x5f, 0xa2, 0x09,
+	0x02, 0x32, 0x04, 0x7e, 0x3a, 0xaf, 0xd9, 0x05, 0xc3, 0x8f, 0x7a, 0x44,
+	0xdc, 0x49, 0x9b, 0xaf, 0x98, 0x82, 0x7b, 0x25, 0x5c, 0xb2, 0x74, 0x07,
+	0xbc, 0xde, 0x09, 0xfb, 0x9e, 0x5c, 0x31, 0x47, 0x90, 0x33, 0x55, 0x9a,
+	0x63, 0x0b, 0x5b, 0xef, 0x64, 0x02, 0xfa, 0x5e, 0x43, 0x01, 0xbb, 0x86,
+	0x88, 0xdc, 0xfa, 0xc9, 0x87, 0x5c, 0xb2, 0x91, 0x2a, 0x21, 0x9a, 0x7d,
+	0xc6, 0xe8, 0x56, 0x0f, 0xf2, 0x24, 0x9e, 0xaa, 0x9a, 0x4b, 0xfc, 0xad,
+	0xaa, 0x95, 0xcd, 0xe4, 0xe2, 0xd6, 0x4f, 0xf3, 0xfe, 0xb2, 0xea, 0x5f,
+	0x29, 0x07, 0x7f, 0x41, 0x5b, 0x99, 0x68, 0x8a, 0xec, 0x7d, 0xd1, 0x85,
+	0x99, 0x17, 0xf5, 0x17, 0xbf, 0x5c, 0xaa, 0xb2, 0xc2, 0xdf, 0x3c, 0xad,
+	0xca, 0x5f, 0xeb, 0xc4, 0x4a, 0x5a, 0xac, 0xe7, 0x51, 0xc9, 0x9f, 0x10,
+	0x2e, 0xde, 0xfe, 0x97, 0x65, 0xeb, 0xdb, 0x5c, 0x1a, 0x6c, 0x31, 0xbe,
+	0xac, 0xa5, 0xb7, 0x6b, 0xbc, 0xdb, 0xb2, 0x9f, 0xb1, 0x1a, 0x86, 0xad,
+	0xf8, 0x89, 0x10, 0xfc, 0x3a, 0xf2, 0x34, 0xb2, 0xb8, 0x7e, 0xc2, 0x4d,
+	0x5e, 0xe7, 0x3c, 0x9d, 0x04, 0x35, 0x99, 0x5b, 0x4f, 0x90, 0x91, 0xa2,
+	0x67, 0x5a, 0xf8, 0xcc, 0x31, 0x23, 0xc7, 0xf6, 0x60, 0xe7, 0x3c, 0xa5,
+	0xef, 0xe1, 0xdd, 0xdf, 0xeb, 0x5a, 0xe6, 0x28, 0xee, 0xee, 0xff, 0xdd,
+	0x7f, 0x4d, 0x8d, 0x1a, 0x56, 0x6d, 0x45, 0xfc, 0x61, 0x97, 0xe7, 0xf4,
+	0xb6, 0xf2, 0xd7, 0x39, 0x42, 0xb4, 0xa4, 0x5e, 0x04, 0x30, 0x60, 0x9f,
+	0xa6, 0xf3, 0x38, 0x38, 0xa6, 0x61, 0x35, 0xb4, 0x8f, 0x4f, 0xb2, 0x80,
+	0x81, 0xdd, 0x51, 0xf5, 0x8d, 0x24, 0x20, 0xc0, 0x3b, 0x35, 0xc7, 0xd0,
+	0x67, 0x33, 0x5f, 0x74, 0x8b, 0x1e, 0x5c, 0xac
+};
+
+static const u8 mod4096_e65537[] = {
+	0x61, 0x8a, 0xcb, 0x51, 0x1b, 0xda, 0xf8, 0x95, 0x90, 0x09, 0x7b, 0xcf,
+	0xe6, 0xe1, 0x0f, 0x6c, 0xef, 0xfc, 0x1e, 0x89, 0x61, 0x7c, 0x24, 0x8e,
+	0xc2, 0x68, 0x94, 0xe2, 0x77, 0x98, 0x8f, 0xae, 0x73, 0x22, 0x60, 0xfe,
+	0x5a, 0x37, 0x33, 0xf3, 0x97, 0xc6, 0x09, 0x37, 0x28, 0xb0, 0xff, 0xa1,
+	0x15, 0xe1, 0x54, 0x95, 0x91, 0x71, 0x25, 0xb3, 0x3f, 0xa1, 0xb2, 0xe6,
+	0xcd, 0x73, 0x4b, 0xeb, 0x14, 0x19, 0x4e, 0x4c, 0xab, 0x75, 0xcb, 0x4d,
+	0x73, 0x8d, 0x2d, 0xc6, 0x33, 0x81, 0x46, 0x3f, 0xd0, 0xe7, 0xc4, 0x92,
+	0x52, 0xd1, 0xb8, 0x11, 0xcf, 0xa5, 0x3b, 0x05, 0x1c, 0x4c, 0x2b, 0x15,
+	0xa2, 0x3f, 0xf6, 0xd1, 0xa4, 0xae, 0x1d, 0xbd, 0x1a, 0x6b, 0xe4, 0xfd,
+	0x50, 0x9b, 0xff, 0x91, 0xff, 0xfb, 0x94, 0x08, 0x86, 0xbb, 0xff, 0xa3,
+	0x04, 0xde, 0x6d, 0x81, 0x43, 0x88, 0xc4, 0x03, 0xe8, 0x40, 0x35, 0x1c,
+	0x44, 0xda, 0x81, 0x38, 0xf3, 0x17, 0x3c, 0x7e, 0xdf, 0x24, 0x6b, 0x72,
+	0x90, 0x7c, 0x0c, 0xc4, 0x2a, 0xeb, 0x07, 0xe1, 0x88, 0x74, 0x48, 0xaa,
+	0x83, 0x98, 0x89, 0xf7, 0x88, 0x37, 0x28, 0x7c, 0x40, 0xea, 0xf7, 0xb9,
+	0x6a, 0xdf, 0x2f, 0xf7, 0xc7, 0xc2, 0xcf, 0x74, 0xb3, 0x68, 0x3d, 0x4e,
+	0x6c, 0x57, 0x2e, 0x2e, 0x73, 0xa9, 0x9f, 0x00, 0x18, 0x2f, 0xf8, 0x12,
+	0x45, 0xb5, 0x71, 0x92, 0x00, 0x38, 0xa0, 0xb5, 0xd9, 0x53, 0xa9, 0xc6,
+	0xc0, 0x77, 0x4c, 0x6a, 0xec, 0x48, 0xfe, 0x1f, 0x84, 0x7d, 0xfc, 0x95,
+	0x8e, 0x42, 0xf3, 0x2b, 0x00, 0x33, 0xdf, 0x9b, 0xaa, 0x61, 0x24, 0x30,
+	0x9f, 0x4c, 0xed, 0x7f, 0x45, 0x65, 0x09, 0xbd, 0x7b, 0x10, 0x04, 0x61,
+	0xac, 0xf0, 0x25, 0x52, 0x76, 0xde, 0xc7, 0x38, 0xc1, 0x1b, 0xc6, 0x5f,
+	0x67, 0x28, 0x96, 0xeb, 0xca, 0x1b, 0x88, 0x1e, 0x38, 0x70, 0x8e, 0x04,
+	0x20, 0xf9, 0x59, 0x8b, 0x66, 0xff, 0x59, 0x37, 0x5e, 0xbb, 0x40, 0xbf,
+	0xbb, 0x35, 0xaf, 0x74, 0x84, 0x40, 0x97, 0x08, 0x7f, 0x53, 0x18, 0x02,
+	0x14, 0x3b, 0x48, 0x91, 0x7e, 0xee, 0xb9, 0x13, 0x28, 0xee, 0xa4, 0x45,
+	0xfe, 0xb6, 0xc7, 0xa6, 0x9a, 0xb8, 0xd1, 0xbb, 0xe7, 0x30, 0xf4, 0x9c,
+	0x00, 0x38, 0xdd, 0x0c, 0x5c, 0xae, 0xc4, 0xc3, 0xbf, 0xe9, 0x3c, 0xb9,
+	0xdf, 0x14, 0xae, 0xca, 0xcb, 0x9f, 0x31, 0x72, 0x8f, 0x0c, 0xf6, 0x02,
+	0x05, 0xbd, 0x20, 0xf8, 0x5f, 0xd8, 0x43, 0x92, 0x6c, 0x1e, 0xe0, 0x96,
+	0xa7, 0x3c, 0x0e, 0x18, 0x26, 0x2c, 0x9a, 0xcc, 0x61, 0x71, 0xfe, 0x4a,
+	0xba, 0x55, 0x34, 0xee, 0x5d, 0x21, 0x8b, 0xf8, 0x21, 0xc8, 0xad, 0x95,
+	0xbb, 0xe3, 0x06, 0x06, 0x47, 0xc7, 0x1a, 0x55, 0x24, 0x30, 0x71, 0x59,
+	0x31, 0x32, 0x8d, 0x72, 0xd1, 0x4b, 0x5d, 0xa0, 0x86, 0xd6, 0x0e, 0xde,
+	0x74, 0xe3, 0x92, 0xce, 0x28, 0xd7, 0x16, 0xc2, 0xb2, 0x16, 0x0c, 0x3a,
+	0x15, 0xba, 0x67, 0x14, 0xbe, 0xb3, 0xfc, 0xab, 0xf3, 0x26, 0x34, 0x39,
+	0xe2, 0x4c, 0x13, 0x8a, 0xcf, 0xa4, 0xc4, 0x6e, 0x08, 0x97, 0xd5, 0x8e,
+	0xc7, 0xf5, 0xaf, 0x37, 0xf8, 0xa8, 0x3a, 0xed, 0xd2, 0x8b, 0x27, 0x88,
+	0x2b, 0xa1, 0xbd, 0x55, 0x87, 0x6c, 0x0d, 0x7e, 0xec, 0xe6, 0x98, 0x73,
+	0xda, 0x7f, 0xcb, 0x8d, 0x8b, 0xc1, 0x62, 0xf3, 0xe2, 0xf9, 0xfb, 0x38,
+	0x71, 0x12, 0x68, 0x82, 0x2d, 0x72, 0xda, 0xde, 0xcb, 0xb2, 0x0e, 0xf0,
+	0xa7, 0x43, 0xdf, 0x3b, 0xa1, 0x2e, 0x58, 0x26, 0x8f, 0xbe, 0xc3, 0xba,
+	0x08, 0x65, 0x13, 0x5e, 0x25, 0x64, 0x5d, 0xea, 0xbb, 0x2f, 0x68, 0xf0,
+	0xae, 0xb4, 0x86, 0x55, 0x10, 0xf0, 0xc8, 0xc6
+};
+
+/**
+ * struct rsa_mod_exp_kat - known answer for rsa_mod_exp_sw()
+ *
+ * @bits:	Number of bits in the modulus
+ * @exponent:	Public exponent
+ * @n0inv:	-1 / modulus[0] mod 2^32
+ * @modulus:	Modulus, big endian
+ * @rr:		R^2 mod modulus, big endian
+ * @sig:	Value to raise, big endian
+ * @out:	Expected result, big endian
+ */
+struct rsa_mod_exp_kat {
+	int bits;
+	u64 exponent;
+	u32 n0inv;
+	const u8 *modulus;
+	const u8 *rr;
+	const u8 *sig;
+	const u8 *out;
+};
+
+static const struct rsa_mod_exp_kat rsa_mod_exp_kats[] = {
+	{ 2048, 3, 0x10cc737b, mod2048_modulus, mod2048_rr, mod2048_sig,
+	  mod2048_e3 },
+	{ 2048, 65537, 0x10cc737b, mod2048_modulus, mod2048_rr, mod2048_sig,
+	  mod2048_e65537 },
+	{ 2048, 0xfffffffffffffff1ULL, 0x10cc737b, mod2048_modulus,
+	  mod2048_rr, mod2048_sig, mod2048_edense },
+	{ 2080, 65537, 0xbae774df, mod2080_modulus, mod2080_rr, mod2080_sig,
+	  mod2080_e65537 },
+	{ 4096, 65537, 0x31ed41c3, mod4096_modulus, mod4096_rr, mod4096_sig,
+	  mod4096_e65537 },
+};
+
+/* Number of exponentiations timed by lib_rsa_mod_exp_bench() */
+#define RSA_BENCH_LOOPS		20
+
+static int rsa_mod_exp_check(struct unit_test_state *uts,
+			     const struct rsa_mod_exp_kat *kat)
+{
+	u8 out[RSA_MAX_KEY_BITS / 8];
+	struct key_prop prop;
+	fdt64_t exponent;
+
+	exponent = cpu_to_fdt64(kat->exponent);
+	memset(&prop, '\0', sizeof(prop));
+	prop.modulus = kat->modulus;
+	prop.rr = kat->rr;
+	prop.public_exponent = &exponent;
+	prop.exp_len = sizeof(exponent);
+	prop.n0inv = kat->n0inv;
+	prop.num_bits = kat->bits;
+
+	ut_assertok(rsa_mod_exp_sw(kat->sig, kat->bits / 8, &prop, out));
+	ut_asserteq_mem(kat->out, out, kat->bits / 8);
+
+	return 0;
+}
+
+/**
+ * lib_rsa_mod_exp_kat() - unit test for rsa_mod_exp_sw()
+ *
+ * Test rsa_mod_exp_sw() against known answers
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_mod_exp_kat(struct unit_test_state *uts)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(rsa_mod_exp_kats); i++)
+		ut_assertok(rsa_mod_exp_check(uts, &rsa_mod_exp_kats[i]));
+
+	return CMD_RET_SUCCESS;
+}
+
+LIB_TEST(lib_rsa_mod_exp_kat, 0);
+
+/**
+ * lib_rsa_mod_exp_bench() - benchmark for rsa_mod_exp_sw()
+ *
+ * Time the exponentiation done to verify an RSA-4096 signature and show the
+ * average, checking each result
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_mod_exp_bench(struct unit_test_state *uts)
+{
+	const struct rsa_mod_exp_kat *kat = &rsa_mod_exp_kats[4];
+	ulong start;
+	int i;
+
+	start = timer_get_us();
+	for (i = 0; i < RSA_BENCH_LOOPS; i++)
+		ut_assertok(rsa_mod_exp_check(uts, kat));
+	printf("rsa%d mod_exp: %lu us\n", kat->bits,
+	       (timer_get_us() - start) / RSA_BENCH_LOOPS);
+
+	return CMD_RET_SUCCESS;
+}
+
+LIB_TEST(lib_rsa_mod_exp_bench, 0);
+#endif /* RSA_SOFTWARE_EXP */
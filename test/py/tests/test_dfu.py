@@ -111,6 +111,16 @@ test_sizes_default = (
 
 first_usb_dev_port = None
 
+# The DFU buffer size and transfer sizes used with CONFIG_DFU_DEFERRED_WRITE:
+# one transfer fills the last buffer exactly, the others leave a partial
+# buffer behind or need one more byte.
+deferred_bufsiz = 64 * 1024
+deferred_sizes = (
+    3 * deferred_bufsiz - 1,
+    3 * deferred_bufsiz,
+    3 * deferred_bufsiz + 1,
+)
+
 @pytest.mark.buildconfigspec('cmd_dfu')
 @pytest.mark.requiredtool('dfu-util')
 def test_dfu(u_boot_console, env__usb_dev_port, env__dfu_config):
@@ -301,6 +311,7 @@ def test_dfu(u_boot_console, env__usb_dev_port, env__dfu_config):
     alt_setting_test_file = env__dfu_config.get('alt_id_test_file', '0')
     alt_setting_dummy_file = env__dfu_config.get('alt_id_dummy_file', '1')
 
+    restore_bufsiz = False
     ignore_cleanup_errors = True
     try:
         start_dfu()
@@ -315,6 +326,24 @@ def test_dfu(u_boot_console, env__usb_dev_port, env__dfu_config):
                 # Make the status of each sub-test obvious. If the test didn't
                 # pass, an exception was thrown so this code isn't executed.
                 u_boot_console.log.status_pass('OK')
+
+        # With deferred writes, a full buffer is written from the polling
+        # loop while the host waits in dfuDNBUSY. Use a small buffer so that
+        # this happens several times per transfer, including at the end.
+        if sizes and u_boot_console.config.buildconfig.get(
+                'config_dfu_deferred_write', 'n') == 'y':
+            stop_dfu(False)
+            u_boot_console.run_command('setenv dfu_bufsiz %#x' %
+                                       deferred_bufsiz)
+            restore_bufsiz = True
+            start_dfu()
+            for size in deferred_sizes:
+                with u_boot_console.log.section(
+                        'Deferred write, data size %d' % size):
+                    dfu_write_read_check(size)
+                    u_boot_console.log.status_pass('OK')
         ignore_cleanup_errors = False
     finally:
         stop_dfu(ignore_cleanup_errors)
+        if restore_bufsiz:
+            u_boot_console.run_command('env delete dfu_bufsiz')
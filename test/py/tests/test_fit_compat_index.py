@@ -0,0 +1,104 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+"""
+Check the compatible index added to a FIT by 'mkimage -I'
+
+The index maps each compatible string to the first configuration which
+supports it, taking the compatible strings from the configuration node if
+present, otherwise from its FDT. This test doesn't run the sandbox. It only
+checks the host tool 'mkimage'. Selecting a configuration from the index is
+covered by the SPL unit tests in test/image/spl_fit_compat.c.
+"""
+
+import pytest
+import u_boot_utils as util
+
+# Root compatible strings of each FDT image
+FDTS = {
+    'fdt-1': ['vendor,board-a', 'vendor,soc'],
+    'fdt-2': ['vendor,board-b', 'vendor,soc'],
+}
+
+ITS = '''
+/dts-v1/;
+
+/ {
+    description = "Compatible index test";
+    #address-cells = <1>;
+
+    images {
+        fdt-1 {
+            data = /incbin/("%(tempdir)s/fdt-1.dtb");
+            type = "flat_dt";
+            arch = "sandbox";
+            compression = "none";
+        };
+        fdt-2 {
+            data = /incbin/("%(tempdir)s/fdt-2.dtb");
+            type = "flat_dt";
+            arch = "sandbox";
+            compression = "none";
+        };
+    };
+
+    configurations {
+        default = "conf-1";
+        conf-1 {
+            description = "board A";
+            fdt = "fdt-1";
+        };
+        conf-2 {
+            description = "board B";
+            fdt = "fdt-2";
+        };
+        conf-3 {
+            description = "board C, same FDT as board B";
+            compatible = "vendor,board-c", "vendor,soc";
+            fdt = "fdt-2";
+        };
+    };
+};
+'''
+
+@pytest.mark.requiredtool('dtc')
+@pytest.mark.requiredtool('fdtget')
+def test_fit_compat_index(u_boot_console):
+    """Test that mkimage -I adds the expected compatible index"""
+
+    def make_fit(fname, *args):
+        util.run_and_log(cons, [mkimage, '-f', its, *args, fname])
+        return fname
+
+    def get_props(fit):
+        return util.run_and_log(
+            cons, f'fdtget -p {fit} /configurations').split()
+
+    cons = u_boot_console
+    mkimage = cons.config.build_dir + '/tools/mkimage'
+    tempdir = cons.config.result_dir
+
+    for name, compat in FDTS.items():
+        dts = f'{tempdir}/{name}.dts'
+        with open(dts, 'w') as fd:
+            fd.write('/dts-v1/;\n/ { compatible = %s; };\n' %
+                     ', '.join(f'"{c}"' for c in compat))
+        util.run_and_log(cons, f'dtc {dts} -O dtb -o {tempdir}/{name}.dtb')
+
+    its = f'{tempdir}/compat-index.its'
+    with open(its, 'w') as fd:
+        fd.write(ITS % {'tempdir': tempdir})
+
+    # Without -I there is no index
+    fit = make_fit(f'{tempdir}/no-index.fit')
+    assert 'compat-index' not in get_props(fit)
+
+    # Each string selects the first configuration that has it: 'vendor,soc'
+    # stays with conf-1 and conf-3 uses its own compatible property
+    fit = make_fit(f'{tempdir}/compat-index.fit', '-I')
+    assert 'compat-index' in get_props(fit)
+    index = util.run_and_log(
+        cons, f'fdtget {fit} /configurations compat-index').split()
+    assert index == ['vendor,board-a', 'conf-1',
+                     'vendor,soc', 'conf-1',
+                     'vendor,board-b', 'conf-2',
+                     'vendor,board-c', 'conf-3']
@@ -0,0 +1,154 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+""" Unit tests for reading files from BTRFS images made by mkfs.btrfs """
+
+import hashlib
+import os
+import random
+import shutil
+import subprocess
+import pytest
+
+BTRFS_SRC_DIR = 'btrfs_src_dir'
+
+""" Test images: each key is the image name, each value its mkfs.btrfs options.
+The compressed images store the text file in extents of at most 128KiB of
+file data, while the random file does not compress and is stored as is.
+"""
+IMAGES = {
+    'btrfs_plain' : '',
+    'btrfs_zlib' : '--compress zlib',
+    'btrfs_lzo' : '--compress lzo',
+    'btrfs_zstd' : '--compress zstd',
+}
+
+IMAGE_SIZE = 128 * 1024 * 1024
+
+# compressible file spanning several compressed extents, not sector aligned
+TEXT_SIZE = 600 * 1024 + 123
+# incompressible file, not sector aligned
+RANDOM_SIZE = 300 * 1024 + 45
+
+""" Partial reads of each large file, as (offset, length): unaligned head and
+tail, a read across the boundary of two compressed extents, one covering
+whole compressed extents with partial ones on both sides, and exactly one
+compressed extent. The end of each file is read as well.
+"""
+PARTIAL_READS = ((0x1234, 0x2345), (0x1ffff, 0x2), (0x1f001, 0x41fff),
+                 (0x40000, 0x20000))
+
+def generate_text(file_name, file_size):
+    """ Generates a file of pseudo-random text, which compresses well. """
+    words = ['btrfs', 'u-boot', 'extent', 'sector', 'inode', 'zstd', 'data']
+    rand = random.Random(0)
+    content = ''
+    while len(content) < file_size:
+        content += rand.choice(words) + ' ' + str(rand.randint(0, 9999)) + '\n'
+    with open(file_name, 'w') as file:
+        file.write(content[:file_size])
+
+def generate_random(file_name, file_size):
+    """ Generates a file of random bytes, which does not compress. """
+    rand = random.Random(1)
+    with open(file_name, 'wb') as file:
+        file.write(bytes(rand.getrandbits(8) for _ in range(file_size)))
+
+def generate_src_dir(build_dir):
+    """ Generates the source directory of the images:
+
+    btrfs_src_dir/
+    ├── random
+    ├── small
+    ├── subdir/
+    │   └── subdir-file
+    └── text
+    """
+    root = os.path.join(build_dir, BTRFS_SRC_DIR)
+    os.makedirs(root)
+
+    generate_text(os.path.join(root, 'text'), TEXT_SIZE)
+    generate_random(os.path.join(root, 'random'), RANDOM_SIZE)
+    # small enough to be stored inline
+    generate_text(os.path.join(root, 'small'), 1000)
+
+    subdir_path = os.path.join(root, 'subdir')
+    os.makedirs(subdir_path)
+    generate_text(os.path.join(subdir_path, 'subdir-file'), 5096)
+
+def make_images(build_dir):
+    """ Makes the test images with mkfs.btrfs. """
+    src = os.path.join(build_dir, BTRFS_SRC_DIR)
+    for image, opts in IMAGES.items():
+        out = os.path.join(build_dir, image)
+        with open(out, 'wb') as file:
+            file.truncate(IMAGE_SIZE)
+        subprocess.run(['mkfs.btrfs -q {} --rootdir {} {}'.format(opts, src,
+                                                                   out)],
+                       shell=True, check=True, stdout=subprocess.DEVNULL)
+
+def clean(build_dir):
+    """ Deletes the test images and their source directory. """
+    for image in IMAGES:
+        path = os.path.join(build_dir, image)
+        if os.path.exists(path):
+            os.remove(path)
+    shutil.rmtree(os.path.join(build_dir, BTRFS_SRC_DIR), ignore_errors=True)
+
+def read_src(build_dir, file):
+    """ Returns the contents of a file in the source directory. """
+    with open(os.path.join(build_dir, BTRFS_SRC_DIR, file), 'rb') as src:
+        return src.read()
+
+def check_load(u_boot_console, file, content, offset=0, length=None):
+    """ Loads part of a file and checks it against @content. """
+    if length is None:
+        length = len(content)
+        cmd = 'load host 0 $kernel_addr_r {}'.format(file)
+    else:
+        cmd = 'load host 0 $kernel_addr_r {} {:x} {:x}'.format(file, length,
+                                                              offset)
+    output = u_boot_console.run_command(cmd)
+    assert '{} bytes read'.format(length) in output
+
+    output = u_boot_console.run_command(
+        'md5sum $kernel_addr_r {:x}'.format(length))
+    expected = hashlib.md5(content[offset:offset + length]).hexdigest()
+    assert expected in output
+
+def btrfs_load(u_boot_console, build_dir):
+    """ Loads whole files and parts of them, checking them against the
+    source. """
+    for file in ('text', 'random', 'small', 'subdir/subdir-file'):
+        check_load(u_boot_console, file, read_src(build_dir, file))
+
+    for file, size in (('text', TEXT_SIZE), ('random', RANDOM_SIZE)):
+        content = read_src(build_dir, file)
+        for offset, length in PARTIAL_READS + ((size - 0x801, 0x801),):
+            check_load(u_boot_console, file, content, offset, length)
+
+    # unaligned head and tail of the inline file
+    check_load(u_boot_console, 'small', read_src(build_dir, 'small'), 123,
+               456)
+
+    output = u_boot_console.run_command('load host 0 $kernel_addr_r non-existent')
+    assert 'Failed to load' in output
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_fs_generic')
+@pytest.mark.buildconfigspec('fs_btrfs')
+@pytest.mark.requiredtool('mkfs.btrfs')
+def test_btrfs(u_boot_console):
+    """ Runs the BTRFS read tests against each image. """
+    build_dir = u_boot_console.config.build_dir
+
+    clean(build_dir)
+    try:
+        generate_src_dir(build_dir)
+        make_images(build_dir)
+
+        for image in IMAGES:
+            image_path = os.path.join(build_dir, image)
+            u_boot_console.run_command('host bind 0 {}'.format(image_path))
+            btrfs_load(u_boot_console, build_dir)
+    finally:
+        clean(build_dir)
@@ -0,0 +1,172 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+""" Unit tests for the EROFS filesystem, using images made by mkfs.erofs """
+
+import hashlib
+import os
+import random
+import shutil
+import subprocess
+import pytest
+
+EROFS_SRC_DIR = 'erofs_src_dir'
+
+""" Test images: each key is the image name, each value its mkfs.erofs options.
+The compressed images use LZ4 clusters of one block, with the compact and the
+full (legacy) index formats. With LZ4, legacy-compress also leaves out zero
+padding, so that image stores the compressed data at the start of each block.
+"""
+IMAGES = {
+    'erofs_plain' : '',
+    'erofs_lz4' : '-zlz4',
+    'erofs_lz4hc' : '-zlz4hc',
+    'erofs_lz4_legacy' : '-zlz4 -E legacy-compress',
+}
+
+# compressible file spanning many clusters
+BIG_SIZE = 300 * 1024
+
+def generate_file(file_name, file_size):
+    """ Generates a file filled with 'x'. """
+    with open(file_name, 'w') as file:
+        file.write('x' * file_size)
+
+def generate_text(file_name, file_size):
+    """ Generates a file of pseudo-random text, which compresses well. """
+    words = ['erofs', 'u-boot', 'cluster', 'block', 'inode', 'lz4', 'data']
+    rand = random.Random(0)
+    content = ''
+    while len(content) < file_size:
+        content += rand.choice(words) + ' ' + str(rand.randint(0, 9999)) + '\n'
+    with open(file_name, 'w') as file:
+        file.write(content[:file_size])
+
+def generate_src_dir(build_dir):
+    """ Generates the source directory of the images:
+
+    erofs_src_dir/
+    ├── big
+    ├── empty-dir/
+    ├── f1000
+    ├── f4096
+    ├── f5096
+    ├── subdir/
+    │   └── subdir-file
+    └── sym -> subdir
+    """
+    root = os.path.join(build_dir, EROFS_SRC_DIR)
+    os.makedirs(root)
+
+    generate_file(os.path.join(root, 'f4096'), 4096)
+    generate_file(os.path.join(root, 'f5096'), 5096)
+    generate_file(os.path.join(root, 'f1000'), 1000)
+    generate_text(os.path.join(root, 'big'), BIG_SIZE)
+
+    subdir_path = os.path.join(root, 'subdir')
+    os.makedirs(subdir_path)
+    generate_file(os.path.join(subdir_path, 'subdir-file'), 100)
+
+    os.symlink('subdir', os.path.join(root, 'sym'))
+    os.makedirs(os.path.join(root, 'empty-dir'))
+
+def make_images(build_dir):
+    """ Makes the test images with mkfs.erofs. """
+    src = os.path.join(build_dir, EROFS_SRC_DIR)
+    for image, opts in IMAGES.items():
+        out = os.path.join(build_dir, image)
+        subprocess.run(['mkfs.erofs {} {} {}'.format(opts, out, src)],
+                       shell=True, check=True, stdout=subprocess.DEVNULL)
+
+def clean(build_dir):
+    """ Deletes the test images and their source directory. """
+    for image in IMAGES:
+        path = os.path.join(build_dir, image)
+        if os.path.exists(path):
+            os.remove(path)
+    shutil.rmtree(os.path.join(build_dir, EROFS_SRC_DIR), ignore_errors=True)
+
+def original_md5sum(build_dir, file):
+    """ Returns the checksum of a file in the source directory. """
+    with open(os.path.join(build_dir, EROFS_SRC_DIR, file), 'rb') as src:
+        return hashlib.md5(src.read()).hexdigest()
+
+def erofs_ls(u_boot_console):
+    """ Lists the root, a sub-directory, a symlink and an empty directory. """
+    no_slash = u_boot_console.run_command('ls host 0')
+    slash = u_boot_console.run_command('ls host 0 /')
+    assert no_slash == slash
+
+    expected_lines = ['./', '../', 'empty-dir/', '1000   f1000',
+                      '4096   f4096', '5096   f5096',
+                      '{}   big'.format(BIG_SIZE), 'subdir/', '<SYM>   sym',
+                      '5 file(s), 4 dir(s)']
+    for line in expected_lines:
+        assert line in no_slash
+
+    output = u_boot_console.run_command('ls host 0 subdir')
+    assert '100   subdir-file' in output
+    assert '1 file(s), 2 dir(s)' in output
+
+    assert output == u_boot_console.run_command('ls host 0 sym')
+
+    output = u_boot_console.run_command('ls host 0 empty-dir')
+    assert '0 file(s), 2 dir(s)' in output
+
+    output = u_boot_console.run_command('ls host 0 non-existent')
+    assert 'file(s)' not in output
+
+def erofs_load(u_boot_console, build_dir):
+    """ Loads files of each data layout and checks them against the source. """
+    files = ['f4096', 'f5096', 'f1000', 'big', 'subdir/subdir-file',
+             'sym/subdir-file']
+    for file in files:
+        size = os.path.getsize(os.path.join(build_dir, EROFS_SRC_DIR, file))
+        output = u_boot_console.run_command(
+            'load host 0 $kernel_addr_r {}'.format(file))
+        assert '{} bytes read'.format(size) in output
+
+        output = u_boot_console.run_command(
+            'md5sum $kernel_addr_r {:x}'.format(size))
+        assert original_md5sum(build_dir, file) in output
+
+    # partial reads starting in the middle of a compressed cluster
+    with open(os.path.join(build_dir, EROFS_SRC_DIR, 'big'), 'rb') as src:
+        content = src.read()
+    for offset, length in ((0x1234, 0x2345), (0x20000, 0x1000),
+                           (BIG_SIZE - 0x800, 0x800)):
+        output = u_boot_console.run_command(
+            'load host 0 $kernel_addr_r big {:x} {:x}'.format(length, offset))
+        assert '{} bytes read'.format(length) in output
+
+        output = u_boot_console.run_command(
+            'md5sum $kernel_addr_r {:x}'.format(length))
+        expected = hashlib.md5(content[offset:offset + length]).hexdigest()
+        assert expected in output
+
+    output = u_boot_console.run_command('load host 0 $kernel_addr_r non-existent')
+    assert 'Failed to load' in output
+
+    u_boot_console.run_command('size host 0 big')
+    output = u_boot_console.run_command('printenv filesize')
+    assert 'filesize={:x}'.format(BIG_SIZE) in output
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_fs_generic')
+@pytest.mark.buildconfigspec('fs_erofs')
+@pytest.mark.requiredtool('mkfs.erofs')
+def test_erofs(u_boot_console):
+    """ Runs the EROFS tests against each image. """
+    build_dir = u_boot_console.config.build_dir
+
+    clean(build_dir)
+    try:
+        generate_src_dir(build_dir)
+        make_images(build_dir)
+
+        for image in IMAGES:
+            image_path = os.path.join(build_dir, image)
+            u_boot_console.run_command('host bind 0 {}'.format(image_path))
+            erofs_ls(u_boot_console)
+            erofs_load(u_boot_console, build_dir)
+    finally:
+        clean(build_dir)
@@ -291,6 +291,24 @@ class Bintool:
             tout.Debug(result.stderr)
         return result
 
+    def cache_id(self):
+        """Get a string identifying the version of the bintool in use
+
+        This is used as part of the key for cached output of the bintool, so
+        that a different bintool results in the output being created again.
+
+        Returns:
+            str: Identifier, made up of the path, size and modification time
+                of the bintool, or None if the bintool is missing
+        """
+        if self.name in self.missing_list:
+            return None
+        fname = tools.tool_find(self.name)
+        if not fname:
+            return None
+        stat = os.stat(fname)
+        return f'{fname}:{stat.st_size}:{stat.st_mtime_ns}'
+
     def run_cmd(self, *args, binary=False):
         """Run the bintool using command-line arguments
 
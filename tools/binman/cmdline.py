@@ -99,6 +99,12 @@ controlled by a description in the board device tree.'''
             help='Set argument value arg=value')
     build_parser.add_argument('-b', '--board', type=str,
             help='Board name to build')
+    build_parser.add_argument('--cache-dir', type=str,
+            help='Directory to cache compressed and mkimage-generated entries '
+                 'in, so they are reused when their inputs do not change')
+    build_parser.add_argument('--cache-max-size', type=int,
+            help='Maximum size of the cache in bytes (default 256MiB), kept '
+                 'by removing the least recently used entries')
     build_parser.add_argument('-d', '--dt', type=str,
             help='Configuration file (.dtb) to use')
     build_parser.add_argument('--fake-dtb', action='store_true',
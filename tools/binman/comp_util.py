@@ -7,6 +7,7 @@ import struct
 import tempfile
 
 from binman import bintool
+from binman import state
 from patman import tools
 
 LZ4 = bintool.Bintool.create('lz4')
@@ -25,6 +26,9 @@ def compress(indata, algo, with_header=True):
     This requires 'lz4' and 'lzma_alone' tools. It also requires an output
     directory to be previously set up, by calling PrepareOutputDir().
 
+    If a cache directory is set up (see state.SetCacheDir()), the compressed
+    data is taken from there when the same data was compressed before.
+
     Args:
         indata (bytes): Input data to compress
         algo (str): Algorithm to use ('none', 'lz4' or 'lzma')
@@ -35,12 +39,18 @@ def compress(indata, algo, with_header=True):
     if algo == 'none':
         return indata
     if algo == 'lz4':
-        data = LZ4.compress(indata)
+        btool = LZ4
     # cbfstool uses a very old version of lzma
     elif algo == 'lzma':
-        data = LZMA_ALONE.compress(indata)
+        btool = LZMA_ALONE
     else:
         raise ValueError("Unknown algorithm '%s'" % algo)
+    key = state.CacheKey('compress', algo, btool.cache_id(), indata)
+    data = state.CacheGet(key)
+    if data is None:
+        data = btool.compress(indata)
+        if data is not None:
+            state.CachePut(key, data)
     if with_header:
         hdr = struct.pack('<I', len(data))
         data = hdr + data
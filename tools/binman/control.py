@@ -699,6 +699,7 @@ def Binman(args):
             tools.SetToolPaths(args.toolpath)
             state.SetEntryArgs(args.entry_arg)
             state.SetThreads(args.threads)
+            state.SetCacheDir(args.cache_dir, args.cache_max_size)
 
             images = PrepareImagesAndDtbs(dtb_fname, args.image,
                                           args.update_fdt, use_expanded)
@@ -715,6 +716,9 @@ def Binman(args):
                                        allow_missing=args.allow_missing,
                                        allow_fake_blobs=args.fake_ext_blobs)
 
+            state.CacheShowStats()
+            state.CachePrune()
+
             # Write the updated FDTs to our output files
             for dtb_item in state.GetAllFdts():
                 tools.WriteFile(dtb_item._fname, dtb_item.GetContents())
@@ -7,8 +7,10 @@
 
 from collections import defaultdict, OrderedDict
 import libfdt
+import os
 
 from binman.entry import Entry, EntryArg
+from binman import state
 from dtoc import fdt_util
 from dtoc.fdt import Fdt
 from patman import tools
@@ -245,11 +247,6 @@ class Entry_fit(Entry):
         """
         # self._BuildInput() either returns bytes or raises an exception.
         data = self._BuildInput(self._fdt)
-        uniq = self.GetUniqueName()
-        input_fname = tools.GetOutputFilename('%s.itb' % uniq)
-        output_fname = tools.GetOutputFilename('%s.fit' % uniq)
-        tools.WriteFile(input_fname, data)
-        tools.WriteFile(output_fname, data)
 
         args = {}
         ext_offset = self._fit_props.get('fit,external-offset')
@@ -258,9 +255,23 @@ class Entry_fit(Entry):
                 'external': True,
                 'pad': fdt_util.fdt32_to_cpu(ext_offset.value)
                 }
+        key = state.CacheKey('fit', self.mkimage.cache_id(),
+                             os.environ.get('SOURCE_DATE_EPOCH', ''),
+                             repr(sorted(args.items())), data)
+        cached = state.CacheGet(key)
+        if cached is not None:
+            self.SetContents(cached)
+            return True
+
+        uniq = self.GetUniqueName()
+        input_fname = tools.GetOutputFilename('%s.itb' % uniq)
+        output_fname = tools.GetOutputFilename('%s.fit' % uniq)
+        tools.WriteFile(input_fname, data)
+        tools.WriteFile(output_fname, data)
         if self.mkimage.run(reset_timestamp=True, output_fname=output_fname,
                             **args) is not None:
             self.SetContents(tools.ReadFile(output_fname))
+            state.CachePut(key, self.data)
         else:
             # Bintool is missing; just use empty data as the output
             self.record_missing_bintool(self.mkimage)
@@ -6,8 +6,10 @@
 #
 
 from collections import OrderedDict
+import os
 
 from binman.entry import Entry
+from binman import state
 from dtoc import fdt_util
 from patman import tools
 
@@ -47,6 +49,14 @@ class Entry_mkimage(Entry):
             if not entry.ObtainContents():
                 return False
             data += entry.GetData()
+        key = state.CacheKey('mkimage', self.mkimage.cache_id(),
+                             os.environ.get('SOURCE_DATE_EPOCH', ''),
+                             *self._args, *state.CacheFileArgs(self._args),
+                             data)
+        cached = state.CacheGet(key)
+        if cached is not None:
+            self.SetContents(cached)
+            return True
         uniq = self.GetUniqueName()
         input_fname = tools.GetOutputFilename('mkimage.%s' % uniq)
         tools.WriteFile(input_fname, data)
@@ -54,6 +64,7 @@ class Entry_mkimage(Entry):
         if self.mkimage.run_cmd('-d', input_fname, *self._args,
                                 output_fname) is not None:
             self.SetContents(tools.ReadFile(output_fname))
+            state.CachePut(key, self.data)
         else:
             # Bintool is missing; just use the input data as the output
             self.record_missing_bintool(self.mkimage)
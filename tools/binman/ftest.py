@@ -311,7 +311,7 @@ class TestFunctional(unittest.TestCase):
                     use_expanded=False, verbosity=None, allow_missing=False,
                     allow_fake_blobs=False, extra_indirs=None, threads=None,
                     test_section_timeout=False, update_fdt_in_elf=None,
-                    force_missing_bintools=''):
+                    force_missing_bintools='', cache_dir=None):
         """Run binman with a given test file
 
         Args:
@@ -342,6 +342,8 @@ class TestFunctional(unittest.TestCase):
             update_fdt_in_elf: Value to pass with --update-fdt-in-elf=xxx
             force_missing_tools (str): comma-separated list of bintools to
                 regard as missing
+            cache_dir (str): Directory to use for the entry cache (None to
+                disable caching)
 
         Returns:
             int return code, 0 on success
@@ -380,6 +382,8 @@ class TestFunctional(unittest.TestCase):
             args += ['--force-missing-bintools', force_missing_bintools]
         if update_fdt_in_elf:
             args += ['--update-fdt-in-elf', update_fdt_in_elf]
+        if cache_dir:
+            args += ['--cache-dir', cache_dir]
         if images:
             for image in images:
                 args += ['-i', image]
@@ -436,7 +440,8 @@ class TestFunctional(unittest.TestCase):
 
     def _DoReadFileDtb(self, fname, use_real_dtb=False, use_expanded=False,
                        map=False, update_dtb=False, entry_args=None,
-                       reset_dtbs=True, extra_indirs=None, threads=None):
+                       reset_dtbs=True, extra_indirs=None, threads=None,
+                       cache_dir=None):
         """Run binman and return the resulting image
 
         This runs binman with a given test file and then reads the resulting
@@ -465,6 +470,8 @@ class TestFunctional(unittest.TestCase):
             extra_indirs: Extra input directories to add using -I
             threads: Number of threads to use (None for default, 0 for
                 single-threaded)
+            cache_dir: Directory to use for the entry cache (None to disable
+                caching)
 
         Returns:
             Tuple:
@@ -490,7 +497,7 @@ class TestFunctional(unittest.TestCase):
             retcode = self._DoTestFile(fname, map=map, update_dtb=update_dtb,
                     entry_args=entry_args, use_real_dtb=use_real_dtb,
                     use_expanded=use_expanded, extra_indirs=extra_indirs,
-                    threads=threads)
+                    threads=threads, cache_dir=cache_dir)
             self.assertEqual(0, retcode)
             out_dtb_fname = tools.GetOutputFilename('u-boot.dtb.out')
 
@@ -5101,5 +5108,150 @@ fdt         fdtmap                Extract the devicetree blob from the fdtmap
                       str(e.exception))
 
 
+    def _CheckCache(self, fname, btool, func):
+        """Build an image twice with a cache, checking the second is cached
+
+        Args:
+            fname (str): Device-tree source filename to use
+            btool (Bintool): Bintool which must not be used the second time
+            func (str): Name of the method of btool which must not be called
+        """
+        cache_dir = os.path.join(self._indir, 'cache')
+        try:
+            data = self._DoReadFileDtb(fname, cache_dir=cache_dir)[0]
+            self.assertEqual(0, state.cache_hits)
+            self.assertEqual(1, state.cache_misses)
+
+            with unittest.mock.patch.object(btool, func,
+                                            side_effect=ValueError('cached')):
+                cached = self._DoReadFileDtb(fname, cache_dir=cache_dir)[0]
+            self.assertEqual(data, cached)
+            self.assertEqual(1, state.cache_hits)
+            self.assertEqual(0, state.cache_misses)
+        finally:
+            shutil.rmtree(cache_dir)
+            state.SetCacheDir(None)
+
+    def testCacheCompress(self):
+        """Test that compressed data is taken from the cache"""
+        self._CheckLz4()
+        self._CheckCache('083_compress.dts', comp_util.LZ4, 'compress')
+
+    def testCacheMkimage(self):
+        """Test that the output of mkimage is taken from the cache"""
+        self._CheckCache('156_mkimage.dts', bintool.Bintool, 'run_cmd')
+
+    def testCacheFit(self):
+        """Test that a FIT is taken from the cache"""
+        self._CheckCache('161_fit.dts', bintool.Bintool, 'run_cmd')
+
+    def testCacheMissingBintool(self):
+        """Test that nothing is cached when a bintool is missing"""
+        cache_dir = os.path.join(self._indir, 'cache')
+        try:
+            with test_util.capture_sys_output() as (_, stderr):
+                self._DoTestFile('156_mkimage.dts', cache_dir=cache_dir,
+                                 force_missing_bintools='mkimage')
+            self.assertEqual(0, state.cache_hits)
+            self.assertEqual(0, state.cache_misses)
+            self.assertEqual([], os.listdir(cache_dir))
+        finally:
+            shutil.rmtree(cache_dir)
+            state.SetCacheDir(None)
+
+    def testCacheKey(self):
+        """Test the keys used for the cache"""
+        self.assertIsNone(state.CacheKey('test', b'data'))
+        cache_dir = os.path.join(self._indir, 'cache')
+        try:
+            state.SetCacheDir(cache_dir)
+            key = state.CacheKey('test', b'data')
+            self.assertEqual(64, len(key))
+            self.assertNotEqual(key, state.CacheKey('testd', b'ata'))
+            self.assertIsNone(state.CacheKey('test', None))
+            self.assertIsNone(state.CacheGet(key))
+            state.CachePut(key, b'output')
+            self.assertEqual(b'output', state.CacheGet(key))
+        finally:
+            shutil.rmtree(cache_dir)
+            state.SetCacheDir(None)
+
+    def testCacheFileArgs(self):
+        """Test that files named in tool arguments are part of the key"""
+        cache_dir = os.path.join(self._indir, 'cache')
+        cfg_fname = os.path.join(self._indir, 'cache.cfg')
+        try:
+            state.SetCacheDir(cache_dir)
+            tools.WriteFile(cfg_fname, b'BOOT_FROM sd')
+            args = ['-n', cfg_fname, '-T', 'imximage']
+            self.assertEqual([cfg_fname, b'BOOT_FROM sd'],
+                             state.CacheFileArgs(args))
+            key = state.CacheKey('mkimage', *args, *state.CacheFileArgs(args))
+
+            tools.WriteFile(cfg_fname, b'BOOT_FROM spi')
+            self.assertNotEqual(key, state.CacheKey(
+                'mkimage', *args, *state.CacheFileArgs(args)))
+        finally:
+            os.remove(cfg_fname)
+            shutil.rmtree(cache_dir)
+            state.SetCacheDir(None)
+
+    def testCachePrune(self):
+        """Test that the least recently used cache entries are removed"""
+        cache_dir = os.path.join(self._indir, 'cache')
+        try:
+            state.SetCacheDir(cache_dir, 250)
+            keys = [state.CacheKey('test', b'%d' % i) for i in range(3)]
+            for seq, key in enumerate(keys):
+                state.CachePut(key, tools.GetBytes(seq, 100))
+                os.utime(state._CacheFname(key), ns=(seq * 10**9,) * 2)
+
+            # Use the oldest entry, so the second one is removed instead
+            self.assertIsNotNone(state.CacheGet(keys[0]))
+            state.CachePrune()
+            self.assertIsNotNone(state.CacheGet(keys[0]))
+            self.assertIsNone(state.CacheGet(keys[1]))
+            self.assertIsNotNone(state.CacheGet(keys[2]))
+        finally:
+            shutil.rmtree(cache_dir)
+            state.SetCacheDir(None)
+
+    def testCachePruneTmp(self):
+        """Test that only stale temporary cache files are removed"""
+        cache_dir = os.path.join(self._indir, 'cache')
+        try:
+            state.SetCacheDir(cache_dir, 0)
+            subdir = os.path.join(cache_dir, 'ab')
+            os.makedirs(subdir)
+            new_tmp = os.path.join(subdir, '.tmpnew')
+            old_tmp = os.path.join(subdir, '.tmpold')
+            tools.WriteFile(new_tmp, b'new')
+            tools.WriteFile(old_tmp, b'old')
+            os.utime(old_tmp, ns=(0, 0))
+
+            # Even with a zero-sized cache, a file being written is kept
+            state.CachePrune()
+            self.assertTrue(os.path.exists(new_tmp))
+            self.assertFalse(os.path.exists(old_tmp))
+        finally:
+            shutil.rmtree(cache_dir)
+            state.SetCacheDir(None)
+
+    def testCacheGetRemoved(self):
+        """Test a cache entry removed by another binman while reading it"""
+        cache_dir = os.path.join(self._indir, 'cache')
+        try:
+            state.SetCacheDir(cache_dir)
+            key = state.CacheKey('test', b'data')
+            state.CachePut(key, b'output')
+            with unittest.mock.patch.object(tools, 'ReadFile',
+                                            side_effect=FileNotFoundError):
+                self.assertIsNone(state.CacheGet(key))
+            self.assertEqual(1, state.cache_misses)
+        finally:
+            shutil.rmtree(cache_dir)
+            state.SetCacheDir(None)
+
+
 if __name__ == "__main__":
     unittest.main()
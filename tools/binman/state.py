@@ -8,6 +8,7 @@
 from collections import defaultdict
 import hashlib
 import re
+import tempfile
 import time
 import threading
 
@@ -63,6 +64,27 @@ allow_entry_contraction = False
 # Number of threads to use for binman (None means machine-dependent)
 num_threads = None
 
+# Directory holding the persistent cache of built entry contents (None if
+# caching is disabled)
+cache_dir = None
+
+# Default maximum total size of the files in the cache directory, in bytes.
+# The least recently used files are removed at the end of a build to stay below
+# the maximum.
+CACHE_MAX_SIZE = 256 << 20
+cache_max_size = CACHE_MAX_SIZE
+
+# Temporary files written by CachePut() are left alone by CachePrune() until
+# they are this old (in seconds), since another binman instance may still be
+# writing them. Older ones were left behind by an instance that was killed.
+CACHE_TMP_MAX_AGE = 60 * 60
+
+# Number of cache lookups which found / did not find the data, and a lock to
+# protect them, since entries may be built in parallel
+cache_hits = 0
+cache_misses = 0
+cache_lock = threading.Lock()
+
 
 class Timing:
     """Holds information about an operation that is being timed
@@ -469,6 +491,171 @@ def GetThreads():
     """
     return num_threads
 
+def SetCacheDir(dirname, max_size=None):
+    """Set the directory to use for the persistent entry cache
+
+    Args:
+        dirname: Directory to use (created if needed), or None to disable
+            caching
+        max_size: Maximum size of the cache in bytes, or None for the default
+    """
+    global cache_dir, cache_max_size, cache_hits, cache_misses
+
+    if dirname:
+        os.makedirs(dirname, exist_ok=True)
+    cache_dir = dirname
+    cache_max_size = CACHE_MAX_SIZE if max_size is None else max_size
+    cache_hits = 0
+    cache_misses = 0
+
+def GetCacheDir():
+    """Get the directory used for the persistent entry cache
+
+    Returns:
+        Directory name, or None if caching is disabled
+    """
+    return cache_dir
+
+def CacheKey(*parts):
+    """Work out the key to use for some cached data
+
+    The key is a hash of everything which affects the data, typically the
+    name of the operation, the tool used and the input data. Each part is
+    length-prefixed so that different splits of the same bytes cannot collide.
+
+    Args:
+        parts: Parts of the key, each bytes or str; None values are ignored
+
+    Returns:
+        str: key (a hex digest), or None if caching is disabled or any part is
+            None
+    """
+    if not cache_dir or None in parts:
+        return None
+    md = hashlib.sha256()
+    for part in parts:
+        if isinstance(part, str):
+            part = part.encode('utf-8')
+        md.update(b'%d:' % len(part))
+        md.update(part)
+    return md.hexdigest()
+
+def CacheFileArgs(args):
+    """Get the contents of the files named in a list of tool arguments
+
+    Tools such as mkimage read further input from files named in their
+    arguments (e.g. '-n imximage.cfg'), so the contents of these files must be
+    part of the cache key, not just their names.
+
+    Args:
+        args (list of str): Arguments passed to the tool
+
+    Returns:
+        list of bytes: Name and contents of each argument which is an existing
+            file, in order
+    """
+    parts = []
+    for arg in args:
+        if arg and os.path.isfile(arg):
+            parts += [arg, tools.ReadFile(arg)]
+    return parts
+
+def _CacheFname(key):
+    return os.path.join(cache_dir, key[:2], key)
+
+def CacheGet(key):
+    """Look up some data in the cache
+
+    Args:
+        key: Key returned by CacheKey(), or None
+
+    Returns:
+        bytes: cached data, or None if not found
+    """
+    global cache_hits, cache_misses
+
+    if not key:
+        return None
+    fname = _CacheFname(key)
+    try:
+        data = tools.ReadFile(fname)
+        # Mark it as recently used, so CachePrune() keeps it
+        os.utime(fname)
+    except FileNotFoundError:
+        # Not there, or just removed by CachePrune() in another instance
+        data = None
+    with cache_lock:
+        if data is None:
+            cache_misses += 1
+        else:
+            cache_hits += 1
+    tout.Debug("Cache %s: %s" % ('miss' if data is None else 'hit', key))
+    return data
+
+def CachePut(key, data):
+    """Add some data to the cache
+
+    The file is written under a temporary name and then renamed, so that
+    several binman instances can safely share the same cache directory.
+
+    Args:
+        key: Key returned by CacheKey(), or None
+        data: Data to store
+    """
+    if not key:
+        return
+    fname = _CacheFname(key)
+    os.makedirs(os.path.dirname(fname), exist_ok=True)
+    fd, tmpname = tempfile.mkstemp(dir=os.path.dirname(fname),
+                                   prefix='.tmp')
+    with os.fdopen(fd, 'wb') as fout:
+        fout.write(data)
+    os.replace(tmpname, fname)
+
+def _CacheRemove(path):
+    try:
+        os.remove(path)
+    except FileNotFoundError:
+        pass
+
+def CachePrune():
+    """Remove the least recently used files until the cache is small enough
+
+    Files in use by another binman instance may be removed, but since they are
+    only ever replaced as a whole, the worst case is a cache miss. Temporary
+    files are skipped while another instance may still be writing them, and
+    removed once they are older than CACHE_TMP_MAX_AGE.
+    """
+    if not cache_dir:
+        return
+    files = []
+    total = 0
+    tmp_limit = time.time_ns() - CACHE_TMP_MAX_AGE * 10**9
+    for dirpath, _, fnames in os.walk(cache_dir):
+        for fname in fnames:
+            path = os.path.join(dirpath, fname)
+            try:
+                stat = os.stat(path)
+            except FileNotFoundError:
+                continue
+            if fname.startswith('.tmp'):
+                if stat.st_mtime_ns < tmp_limit:
+                    _CacheRemove(path)
+                continue
+            files.append((stat.st_mtime_ns, stat.st_size, path))
+            total += stat.st_size
+    for _, size, path in sorted(files):
+        if total <= cache_max_size:
+            break
+        _CacheRemove(path)
+        total -= size
+    tout.Debug('Cache: %d bytes in use' % total)
+
+def CacheShowStats():
+    """Show how well the cache worked for this build"""
+    if cache_dir:
+        tout.Info('Cache: %d hits, %d misses' % (cache_hits, cache_misses))
+
 def GetTiming(name):
     """Get the timing info for a particular operation
 
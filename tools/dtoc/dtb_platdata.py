@@ -49,6 +49,17 @@ TYPE_NAMES = {
     fdt.Type.INT64: 'fdt64_t',
 }
 
+# Order in which struct members are placed in compact structs. Members with
+# the largest alignment come first, so that no padding is needed between
+# members, whether pointers are 32 or 64 bits wide. Phandles use rank 2.
+MEMBER_RANK = {
+    fdt.Type.INT64: 0,
+    fdt.Type.STRING: 1,
+    fdt.Type.INT: 2,
+    fdt.Type.BYTE: 3,
+    fdt.Type.BOOL: 3,
+}
+
 STRUCT_PREFIX = 'dtd_'
 VAL_PREFIX = 'dtv_'
 
@@ -170,8 +181,10 @@ class DtbPlatdata():
             the selected devices (see _valid_node), in alphabetical order
         _instantiate: Instantiate devices so they don't need to be bound at
             run-time
+        _compact: Order struct members to avoid padding, instead of by name
     """
-    def __init__(self, scan, dtb_fname, include_disabled, instantiate=False):
+    def __init__(self, scan, dtb_fname, include_disabled, instantiate=False,
+                 compact=False):
         self._scan = scan
         self._fdt = None
         self._dtb_fname = dtb_fname
@@ -185,6 +198,7 @@ class DtbPlatdata():
         self._basedir = None
         self._valid_uclasses = None
         self._instantiate = instantiate
+        self._compact = compact
 
     def setup_output_dirs(self, output_dirs):
         """Set up the output directories
@@ -578,7 +592,7 @@ class DtbPlatdata():
         # Output the struct definition
         for name in sorted(structs):
             self.out('struct %s%s {\n' % (STRUCT_PREFIX, name))
-            for pname in sorted(structs[name]):
+            for pname in self.get_struct_members(name, self._compact):
                 prop = structs[name][pname]
                 info = self.get_phandle_argc(prop, structs[name])
                 if info:
@@ -596,6 +610,101 @@ class DtbPlatdata():
                 self.out(';\n')
             self.out('};\n')
 
+    def get_member_layout(self, prop, struct_name, ptr_size):
+        """Get the layout of a struct member
+
+        Args:
+            prop (fdt.Prop): Prop holding the member information
+            struct_name (str): Name of struct, only used for raising an error
+            ptr_size (int): Size of a pointer in bytes
+
+        Returns:
+            tuple:
+                int: Rank of the member, used to order compact structs
+                int: Size of the member in bytes
+                int: Alignment of the member in bytes
+        """
+        info = self.get_phandle_argc(prop, struct_name)
+        if info:
+            # struct phandle_<n>_arg is a uint followed by n ints
+            return 2, 4 * (1 + info.max_args) * len(info.args), 4
+        if prop.type == fdt.Type.INT64:
+            size = 8
+        elif prop.type == fdt.Type.STRING:
+            size = ptr_size
+        elif prop.type == fdt.Type.INT:
+            size = 4
+        else:
+            size = 1
+        count = len(prop.value) if isinstance(prop.value, list) else 1
+        return MEMBER_RANK[prop.type], size * count, size
+
+    def get_struct_members(self, struct_name, compact):
+        """Get the names of the members of a struct, in order
+
+        Args:
+            struct_name (str): Name of struct (without the 'dtd_' prefix)
+            compact (bool): True to order the members to avoid padding, False
+                to order them by name
+
+        Returns:
+            list of str: Property names of the members
+        """
+        struct = self._struct_data[struct_name]
+        if not compact:
+            return sorted(struct)
+        return sorted(struct, key=lambda pname: (
+            self.get_member_layout(struct[pname], struct_name, 8)[0], pname))
+
+    def get_struct_size(self, struct_name, compact, ptr_size):
+        """Work out the size of a struct, following the usual C ABI rules
+
+        Args:
+            struct_name (str): Name of struct (without the 'dtd_' prefix)
+            compact (bool): True to use the compact member order
+            ptr_size (int): Size of a pointer in bytes
+
+        Returns:
+            int: Size of the struct in bytes
+        """
+        struct = self._struct_data[struct_name]
+        offset = 0
+        max_align = 1
+        for pname in self.get_struct_members(struct_name, compact):
+            _, size, align = self.get_member_layout(struct[pname], struct_name,
+                                                    ptr_size)
+            offset = (offset + align - 1) // align * align + size
+            max_align = max(max_align, align)
+        return (offset + max_align - 1) // max_align * max_align
+
+    def show_size_report(self):
+        """Show the space taken by the platform data for each struct
+
+        This shows the size of the dtd_... structs and the total taken by all
+        nodes using them, for 32-bit and 64-bit pointers, both with members
+        ordered by name and in compact order.
+        """
+        counts = collections.Counter(
+            node.struct_name for node in self._valid_nodes)
+        print('Platform data size in bytes (32-bit/64-bit pointers):')
+        print('%-30s %5s %15s %15s' % ('struct', 'nodes', 'by name',
+                                       'compact'))
+        totals = [0] * 4
+        for name in sorted(self._struct_data):
+            sizes = [self.get_struct_size(name, compact, ptr_size) *
+                     counts[name] for compact in [False, True]
+                     for ptr_size in [4, 8]]
+            totals = [total + size for total, size in zip(totals, sizes)]
+            print('%-30s %5d %15s %15s' %
+                  (STRUCT_PREFIX + name, counts[name],
+                   '%d/%d' % tuple(sizes[:2]), '%d/%d' % tuple(sizes[2:])))
+        print('%-30s %5d %15s %15s' %
+              ('total', len(self._valid_nodes), '%d/%d' % tuple(totals[:2]),
+               '%d/%d' % tuple(totals[2:])))
+        print('Compact structs %s %d/%d bytes' %
+              ('save' if self._compact else 'would save',
+               totals[0] - totals[2], totals[1] - totals[3]))
+
     def _output_list(self, node, prop):
         """Output the C code for a devicetree property that holds a list
 
@@ -1150,7 +1259,7 @@ OUTPUT_FILES_INST = {
 
 def run_steps(args, dtb_file, include_disabled, output, output_dirs, phase,
               instantiate, warning_disabled=False, drivers_additional=None,
-              basedir=None, scan=None):
+              basedir=None, scan=None, compact=False, size_report=False):
     """Run all the steps of the dtoc tool
 
     Args:
@@ -1173,6 +1282,9 @@ def run_steps(args, dtb_file, include_disabled, output, output_dirs, phase,
             grandparent of this file's directory
         scan (src_src.Scanner): Scanner from a previous run. This can help speed
             up tests. Use None for normal operation
+        compact (bool): True to order struct members to avoid padding, rather
+            than by name
+        size_report (bool): True to show the size of the platform data
 
     Returns:
         DtbPlatdata object
@@ -1191,7 +1303,8 @@ def run_steps(args, dtb_file, include_disabled, output, output_dirs, phase,
         do_process = True
     else:
         do_process = False
-    plat = DtbPlatdata(scan, dtb_file, include_disabled, instantiate)
+    plat = DtbPlatdata(scan, dtb_file, include_disabled, instantiate,
+                       compact)
     plat.scan_dtb()
     plat.scan_tree(add_root=instantiate)
     plat.prepare_nodes()
@@ -1224,6 +1337,8 @@ def run_steps(args, dtb_file, include_disabled, output, output_dirs, phase,
         outfile.method(plat)
     plat.finish_output()
 
+    if size_report:
+        plat.show_size_report()
     if not warning_disabled:
         scan.show_warnings()
     return plat
@@ -79,6 +79,8 @@ parser.add_argument('-B', '--build-dir', type=str, default='b',
         help='Directory containing the build output')
 parser.add_argument('-c', '--c-output-dir', action='store',
                   help='Select output directory for C files')
+parser.add_argument('--compact', action='store_true', default=False,
+                  help='Order struct members to avoid padding, not by name')
 parser.add_argument('-C', '--h-output-dir', action='store',
                   help='Select output directory for H files (defaults to --c-output-di)')
 parser.add_argument('-d', '--dtb-file', action='store',
@@ -93,6 +95,8 @@ parser.add_argument('-p', '--phase', type=str,
                   help='set phase of U-Boot this invocation is for (spl/tpl)')
 parser.add_argument('-P', '--processes', type=int,
                   help='set number of processes to use for running tests')
+parser.add_argument('-s', '--size-report', action='store_true', default=False,
+                  help='Show the size of the generated platform data')
 parser.add_argument('-t', '--test', action='store_true', dest='test',
                   default=False, help='run tests')
 parser.add_argument('-T', '--test-coverage', action='store_true',
@@ -112,4 +116,5 @@ else:
     dtb_platdata.run_steps(args.files, args.dtb_file, args.include_disabled,
                            args.output,
                            [args.c_output_dir, args.h_output_dir],
-                           args.phase, instantiate=args.instantiate)
+                           args.phase, instantiate=args.instantiate,
+                           compact=args.compact, size_report=args.size_report)
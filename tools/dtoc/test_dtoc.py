@@ -1455,6 +1455,70 @@ U_BOOT_DRVINFO(test3) = {
             "Node 'spl-test' (parent '/') reg property has 3 cells which is not a multiple of na + ns = 1 + 1)",
             str(exc.exception))
 
+    def test_compact(self):
+        """Test output of compact structs and the size report"""
+        dtb_file = get_dtb_file('dtoc_test_simple.dts')
+        output = tools.GetOutputFilename('output')
+        with test_util.capture_sys_output() as (stdout, _):
+            dtb_platdata.run_steps(
+                ['struct'], dtb_file, False, output, [], None, False,
+                warning_disabled=True, scan=copy_scan(), compact=True,
+                size_report=True)
+        data = tools.ReadFile(output, binary=False)
+        self._check_strings(HEADER + '''
+struct dtd_sandbox_i2c {
+};
+struct dtd_sandbox_pmic {
+\tfdt32_t\t\treg[1];
+\tbool\t\tlow_power;
+};
+struct dtd_sandbox_spl_test {
+\tconst char *\tacpi_name;
+\tconst char *\tstringarray[3];
+\tconst char *\tstringval;
+\tfdt32_t\t\tint64val[2];
+\tfdt32_t\t\tintarray[3];
+\tfdt32_t\t\tintval;
+\tfdt32_t\t\tmaybe_empty_int[1];
+\tbool\t\tboolval;
+\tunsigned char\tbytearray[3];
+\tunsigned char\tbyteval;
+\tunsigned char\tlongbytearray[9];
+\tunsigned char\tnotstring[5];
+};
+''', data)
+        self.assertEqual('''Platform data size in bytes (32-bit/64-bit pointers):
+struct                         nodes         by name         compact
+dtd_sandbox_i2c                    1             0/0             0/0
+dtd_sandbox_pmic                   1             8/8             8/8
+dtd_sandbox_spl_test               3         228/288         204/264
+total                              5         236/296         212/272
+Compact structs save 24/24 bytes
+''', stdout.getvalue())
+
+        # Without compact structs, the report shows the possible saving
+        with test_util.capture_sys_output() as (stdout, _):
+            dtb_platdata.run_steps(
+                ['struct'], dtb_file, False, output, [], None, False,
+                warning_disabled=True, scan=copy_scan(), size_report=True)
+        self._check_strings(self.struct_text,
+                            tools.ReadFile(output, binary=False))
+        self.assertIn('Compact structs would save 24/24 bytes',
+                      stdout.getvalue())
+
+    def test_compact_sizes(self):
+        """Test struct sizes with phandles and 64-bit values"""
+        output = tools.GetOutputFilename('output')
+        plat = self.run_test(['struct'], get_dtb_file('dtoc_test_phandle.dts'),
+                             output)
+        self.assertEqual(48, plat.get_struct_size('source', True, 4))
+        self.assertEqual(4, plat.get_struct_size('target', True, 8))
+
+        plat = self.run_test(['struct'], get_dtb_file('dtoc_test_addr64.dts'),
+                             output)
+        self.assertEqual(16, plat.get_struct_size('test1', True, 4))
+        self.assertEqual(32, plat.get_struct_size('test3', True, 8))
+
     def test_add_prop(self):
         """Test that a subequent node can add a new property to a struct"""
         dtb_file = get_dtb_file('dtoc_test_add_prop.dts')
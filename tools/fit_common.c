@@ -23,6 +23,9 @@
 #include <image.h>
 #include <u-boot/crc.h>
 
+/* Size of the buffer used to copy files when the kernel cannot do it */
+#define COPY_BUF_SIZE	(64 * 1024)
+
 int fit_verify_header(unsigned char *ptr, int image_size,
 			struct image_tool_params *params)
 {
@@ -120,12 +123,56 @@ err:
 	return -1;
 }
 
+int copy_fd_range(int fd_src, off_t src_off, int fd_dst, off_t dst_off,
+		  size_t len)
+{
+	void *buf;
+	ssize_t size;
+	int ret = -1;
+
+#ifdef __linux__
+	/* Let the kernel move the data, without passing it through here */
+	while (len) {
+		size = copy_file_range(fd_src, &src_off, fd_dst, &dst_off, len,
+				       0);
+		if (size <= 0)
+			break;
+		len -= size;
+	}
+	if (!len)
+		return 0;
+#endif
+
+	buf = malloc(COPY_BUF_SIZE);
+	if (!buf) {
+		printf("Can't allocate buffer to copy file\n");
+		return -1;
+	}
+	if (lseek(fd_src, src_off, SEEK_SET) < 0 ||
+	    lseek(fd_dst, dst_off, SEEK_SET) < 0)
+		goto out;
+
+	while (len) {
+		size = read(fd_src, buf, len < COPY_BUF_SIZE ? len :
+			    COPY_BUF_SIZE);
+		if (size <= 0)
+			goto out;
+		if (write(fd_dst, buf, size) != size)
+			goto out;
+		len -= size;
+	}
+	ret = 0;
+
+out:
+	free(buf);
+
+	return ret;
+}
+
 int copyfile(const char *src, const char *dst)
 {
 	int fd_src = -1, fd_dst = -1;
-	void *buf = NULL;
-	ssize_t size;
-	size_t count;
+	struct stat sbuf;
 	int ret = -1;
 
 	fd_src = open(src, O_RDONLY);
@@ -134,35 +181,22 @@ int copyfile(const char *src, const char *dst)
 		goto out;
 	}
 
+	if (fstat(fd_src, &sbuf) < 0) {
+		printf("Can't stat file %s (%s)\n", src, strerror(errno));
+		goto out;
+	}
+
 	fd_dst = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0666);
 	if (fd_dst < 0) {
 		printf("Can't open file %s (%s)\n", dst, strerror(errno));
 		goto out;
 	}
 
-	buf = calloc(1, 512);
-	if (!buf) {
-		printf("Can't allocate buffer to copy file\n");
+	if (copy_fd_range(fd_src, 0, fd_dst, 0, sbuf.st_size)) {
+		printf("Can't copy file %s to %s\n", src, dst);
 		goto out;
 	}
 
-	while (1) {
-		size = read(fd_src, buf, 512);
-		if (size < 0) {
-			printf("Can't read file %s\n", src);
-			goto out;
-		}
-		if (!size)
-			break;
-
-		count = size;
-		size = write(fd_dst, buf, count);
-		if (size < 0) {
-			printf("Can't write file %s\n", dst);
-			goto out;
-		}
-	}
-
 	ret = 0;
 
  out:
@@ -170,8 +204,6 @@ int copyfile(const char *src, const char *dst)
 		close(fd_src);
 	if (fd_dst >= 0)
 		close(fd_dst);
-	if (buf)
-		free(buf);
 
 	return ret;
 }
@@ -42,7 +42,7 @@ int mmap_fdt(const char *cmdname, const char *fname, size_t size_inc,
 /**
  * copyfile() - Copy a file
  *
- * This uses read()/write() to copy file @src to file @dst
+ * This uses copy_fd_range() to copy file @src to file @dst
  *
  * If @dst exists, it is overwritten and truncated to the correct size.
  *
@@ -52,6 +52,23 @@ int mmap_fdt(const char *cmdname, const char *fname, size_t size_inc,
  */
 int copyfile(const char *src, const char *dst);
 
+/**
+ * copy_fd_range() - Copy part of one file into another
+ *
+ * On Linux this uses copy_file_range() so that the data does not need to
+ * pass through user space. Otherwise, or if the kernel cannot copy between
+ * these files, it falls back to read()/write() with a small buffer.
+ *
+ * @fd_src: File to read from
+ * @src_off: Offset in @fd_src to start reading at
+ * @fd_dst: File to write to
+ * @dst_off: Offset in @fd_dst to start writing at
+ * @len: Number of bytes to copy
+ * @return 0 if OK, -1 on error
+ */
+int copy_fd_range(int fd_src, off_t src_off, int fd_dst, off_t dst_off,
+		  size_t len);
+
 /**
  * summary_show() - Show summary information about the signing process
  *
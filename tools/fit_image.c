@@ -22,14 +22,47 @@
 #include <version.h>
 #include <u-boot/crc.h>
 
+/*
+ * Extra space given to the FDTs for hashes and signatures. If this is not
+ * enough, the space is doubled and the processing is repeated.
+ */
+#define FIT_SIZE_INC_START	(64 * 1024)
+#define FIT_SIZE_INC_MAX	(4 * 1024 * 1024)
+
 static image_header_t header;
 
+/**
+ * fit_trim_size() - Work out how much of an expanded FDT is really used
+ *
+ * Packs the FDT and returns the size the file should be truncated to, so
+ * that the extra space added by mmap_fdt() is removed again. The FDT is never
+ * made smaller than the file was originally.
+ *
+ * @blob:	FDT to pack
+ * @orig_size:	Original size of the file containing @blob
+ * Return: new size of the file
+ */
+static off_t fit_trim_size(void *blob, off_t orig_size)
+{
+	off_t size;
+
+	fdt_pack(blob);
+	size = fdt_totalsize(blob);
+	if (size < orig_size) {
+		fdt_set_totalsize(blob, orig_size);
+		size = orig_size;
+	}
+
+	return size;
+}
+
 static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
 			     const char *tmpfile)
 {
 	int tfd, destfd = 0;
 	void *dest_blob = NULL;
-	off_t destfd_size = 0;
+	off_t destfd_size = 0, dest_new_size = 0;
+	off_t new_size = 0;
 	struct stat sbuf;
 	void *ptr;
 	int ret = 0;
@@ -59,6 +92,10 @@ static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
 		ret = fit_set_timestamp(ptr, 0, time);
 	}
 
+	/* This reads the FDT images, so must come before they are encrypted */
+	if (!ret && params->compat_index)
+		ret = fit_add_compat_index(ptr);
+
 	if (!ret) {
 		ret = fit_cipher_data(params->keydir, dest_blob, ptr,
 				      params->comment,
@@ -78,13 +115,31 @@ static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
 						&params->summary);
 	}
 
+	if (!ret)
+		new_size = fit_trim_size(ptr, sbuf.st_size - size_inc);
+	/* keydest is not restored between attempts, so always trim it */
+	if (dest_blob)
+		dest_new_size = fit_trim_size(dest_blob,
+					      destfd_size - size_inc);
+
 	if (dest_blob) {
 		munmap(dest_blob, destfd_size);
+		if (dest_new_size && ftruncate(destfd, dest_new_size)) {
+			fprintf(stderr, "%s: Can't truncate %s: %s\n",
+				params->cmdname, params->keydest,
+				strerror(errno));
+			ret = -EIO;
+		}
 		close(destfd);
 	}
 
 err_keydest:
 	munmap(ptr, sbuf.st_size);
+	if (new_size && ftruncate(tfd, new_size)) {
+		fprintf(stderr, "%s: Can't truncate %s: %s\n",
+			params->cmdname, tmpfile, strerror(errno));
+		ret = -EIO;
+	}
 	close(tfd);
 	return ret;
 }
@@ -428,100 +483,201 @@ err_buf:
 }
 
 /**
- * fit_extract_data() - Move all data outside the FIT
+ * struct fit_ext_data - Image data to be placed outside the FIT
+ *
+ * @offset:	Offset of the data in the original FIT file
+ * @size:	Size of the data in bytes
+ */
+struct fit_ext_data {
+	off_t offset;
+	int size;
+};
+
+/**
+ * fit_copy_metadata() - Copy a FIT, leaving out the image data
+ *
+ * This creates a copy of the FIT in which the 'data' property of each image
+ * is empty, so that only the metadata needs to be held in memory. The
+ * position and size of the data which was left out are recorded in @ext, in
+ * the order in which the images appear.
+ *
+ * @fit:	FIT to copy, which must have the standard block order
+ * @images:	Offset of the /images node in @fit
+ * @ext:	Returns the position of the data of each image
+ * @countp:	Returns the number of entries in @ext
+ * @extra:	Number of bytes of free space to add to the copy
+ * Return: allocated copy of the FIT, or NULL on error
+ */
+static void *fit_copy_metadata(const void *fit, int images,
+			       struct fit_ext_data *ext, int *countp, int extra)
+{
+	const struct fdt_property *prop;
+	const char *src = fit;
+	int pos, removed, count;
+	char *buf, *dst;
+	int node, len;
+
+	if (fdt_off_mem_rsvmap(fit) > fdt_off_dt_struct(fit) ||
+	    fdt_off_dt_struct(fit) + fdt_size_dt_struct(fit) >
+	    fdt_off_dt_strings(fit))
+		return NULL;
+
+	removed = 0;
+	fdt_for_each_subnode(node, fit, images) {
+		prop = fdt_get_property(fit, node, FIT_DATA_PROP, &len);
+		if (prop)
+			removed += ALIGN(len, FDT_TAGSIZE);
+	}
+
+	buf = calloc(1, fdt_totalsize(fit) - removed + extra);
+	if (!buf)
+		return NULL;
+
+	dst = buf;
+	pos = 0;
+	removed = 0;
+	count = 0;
+	fdt_for_each_subnode(node, fit, images) {
+		struct fdt_property *copy;
+		int start;
+
+		prop = fdt_get_property(fit, node, FIT_DATA_PROP, &len);
+		if (!prop)
+			continue;
+		start = (const char *)prop->data - src;
+		memcpy(dst, src + pos, start - pos);
+		dst += start - pos;
+		copy = (struct fdt_property *)(buf + ((const char *)prop - src) -
+					       removed);
+		copy->len = cpu_to_fdt32(0);
+
+		ext[count].offset = start;
+		ext[count].size = len;
+		count++;
+		pos = start + ALIGN(len, FDT_TAGSIZE);
+		removed += ALIGN(len, FDT_TAGSIZE);
+	}
+	memcpy(dst, src + pos, fdt_totalsize(fit) - pos);
+
+	fdt_set_size_dt_struct(buf, fdt_size_dt_struct(fit) - removed);
+	fdt_set_off_dt_strings(buf, fdt_off_dt_strings(fit) - removed);
+	fdt_set_totalsize(buf, fdt_totalsize(fit) - removed);
+	if (fdt_open_into(buf, buf, fdt_totalsize(buf) + extra)) {
+		free(buf);
+		return NULL;
+	}
+	*countp = count;
+
+	return buf;
+}
+
+/**
+ * fit_extract_data() - Move the image data so it is external to the FIT
  *
- * This takes a normal FIT file and removes all the 'data' properties from it.
- * The data is placed in an area after the FIT so that it can be accessed
- * using an offset into that area. The 'data' properties turn into
- * 'data-offset' properties.
+ * A new file is written containing the FIT metadata followed by the data of
+ * each image, which is copied straight from the old file. The image data is
+ * never read into memory, so this works for very large FITs. The 'data'
+ * properties turn into 'data-offset' properties, giving the position of the
+ * data in the area after the FIT, or into 'data-position' properties if an
+ * absolute offset was given with -p.
  *
  * This function cannot cope with FITs with 'data-offset' properties. All
  * data must be in 'data' properties on entry.
+ *
+ * @params:	mkimage parameters
+ * @fname:	FIT file to process; this is replaced by the new file
+ * Return: 0 if OK, -ve on error
  */
 static int fit_extract_data(struct image_tool_params *params, const char *fname)
 {
+	struct fit_ext_data *ext = NULL;
+	char *outname = NULL;
 	void *buf = NULL;
-	int buf_ptr;
-	int fit_size, new_size;
-	int fd;
+	off_t buf_ptr;
+	int new_size;
+	int fd, outfd = -1;
 	struct stat sbuf;
 	void *fdt;
 	int ret;
 	int images;
 	int node;
-	int image_number;
+	int image_number, count;
 	int align_size;
+	int i;
 
 	align_size = params->bl_len ? params->bl_len : 4;
-	fd = mmap_fdt(params->cmdname, fname, 0, &fdt, &sbuf, false, false);
+	fd = mmap_fdt(params->cmdname, fname, 0, &fdt, &sbuf, false, true);
 	if (fd < 0)
 		return -EIO;
-	fit_size = fdt_totalsize(fdt);
 
 	images = fdt_path_offset(fdt, FIT_IMAGES_PATH);
 	if (images < 0) {
 		debug("%s: Cannot find /images node: %d\n", __func__, images);
 		ret = -EINVAL;
-		goto err_munmap;
+		goto err;
 	}
 	image_number = fdtdec_get_child_count(fdt, images);
 
+	ext = calloc(image_number + 1, sizeof(*ext));
+	if (!ext) {
+		ret = -ENOMEM;
+		goto err;
+	}
+
 	/*
-	 * Allocate space to hold the image data we will extract,
-	 * extral space allocate for image alignment to prevent overflow.
+	 * Each image gains up to three properties (plus their names) and the
+	 * FIT is padded to the alignment
 	 */
-	buf = calloc(1, fit_size + (align_size * image_number));
+	buf = fit_copy_metadata(fdt, images, ext, &count,
+				image_number * 64 + 256 + align_size);
 	if (!buf) {
 		ret = -ENOMEM;
-		goto err_munmap;
+		goto err;
 	}
-	buf_ptr = 0;
 
-	for (node = fdt_first_subnode(fdt, images);
+	buf_ptr = 0;
+	i = 0;
+	for (node = fdt_first_subnode(buf, images);
 	     node >= 0;
-	     node = fdt_next_subnode(fdt, node)) {
-		const char *data;
-		int len;
-
-		data = fdt_getprop(fdt, node, FIT_DATA_PROP, &len);
-		if (!data)
+	     node = fdt_next_subnode(buf, node)) {
+		if (!fdt_getprop(buf, node, FIT_DATA_PROP, NULL))
 			continue;
-		memcpy(buf + buf_ptr, data, len);
-		debug("Extracting data size %x\n", len);
+		debug("Extracting data size %x\n", ext[i].size);
 
-		ret = fdt_delprop(fdt, node, FIT_DATA_PROP);
+		ret = fdt_delprop(buf, node, FIT_DATA_PROP);
 		if (ret) {
 			ret = -EPERM;
-			goto err_munmap;
+			goto err;
 		}
 		if (params->external_offset > 0) {
 			/* An external offset positions the data absolutely. */
-			fdt_setprop_u32(fdt, node, FIT_DATA_POSITION_PROP,
-					params->external_offset + buf_ptr);
+			ret = fdt_setprop_u32(buf, node, FIT_DATA_POSITION_PROP,
+					      params->external_offset +
+					      buf_ptr);
 		} else {
-			fdt_setprop_u32(fdt, node, FIT_DATA_OFFSET_PROP,
-					buf_ptr);
+			ret = fdt_setprop_u32(buf, node, FIT_DATA_OFFSET_PROP,
+					      buf_ptr);
 		}
-		fdt_setprop_u32(fdt, node, FIT_DATA_SIZE_PROP, len);
-		buf_ptr += ALIGN(len, align_size);
+		if (!ret)
+			ret = fdt_setprop_u32(buf, node, FIT_DATA_SIZE_PROP,
+					      ext[i].size);
+		if (ret) {
+			ret = -ENOSPC;
+			goto err;
+		}
+		buf_ptr += ALIGN(ext[i].size, align_size);
+		i++;
 	}
 
 	/* Pack the FDT and place the data after it */
-	fdt_pack(fdt);
+	fdt_pack(buf);
 
-	new_size = fdt_totalsize(fdt);
+	new_size = fdt_totalsize(buf);
 	new_size = ALIGN(new_size, align_size);
-	fdt_set_totalsize(fdt, new_size);
-	debug("Size reduced from %x to %x\n", fit_size, fdt_totalsize(fdt));
-	debug("External data size %x\n", buf_ptr);
-	munmap(fdt, sbuf.st_size);
-
-	if (ftruncate(fd, new_size)) {
-		debug("%s: Failed to truncate file: %s\n", __func__,
-		      strerror(errno));
-		ret = -EIO;
-		goto err;
-	}
+	fdt_set_totalsize(buf, new_size);
+	debug("Size reduced from %x to %x\n", fdt_totalsize(fdt),
+	      fdt_totalsize(buf));
+	debug("External data size %lx\n", (ulong)buf_ptr);
 
 	/* Check if an offset for the external data was set. */
 	if (params->external_offset > 0) {
@@ -532,29 +688,68 @@ static int fit_extract_data(struct image_tool_params *params, const char *fname)
 			ret = -EINVAL;
 			goto err;
 		}
+	}
+
+	outname = malloc(strlen(fname) + 5);
+	if (!outname) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	sprintf(outname, "%s.ext", fname);
+	outfd = open(outname, O_RDWR | O_CREAT | O_TRUNC | O_BINARY,
+		     sbuf.st_mode & 0777);
+	if (outfd < 0) {
+		fprintf(stderr, "%s: Can't open %s: %s\n", params->cmdname,
+			outname, strerror(errno));
+		ret = -EIO;
+		goto err;
+	}
+	if (write(outfd, buf, new_size) != new_size) {
+		debug("%s: Failed to write FIT to file %s\n", __func__,
+		      strerror(errno));
+		ret = -EIO;
+		goto err;
+	}
+	if (params->external_offset > 0)
 		new_size = params->external_offset;
+
+	/* Copy the data across, leaving zeroes in the alignment gaps */
+	buf_ptr = 0;
+	for (i = 0; i < count; i++) {
+		if (copy_fd_range(fd, ext[i].offset, outfd, new_size + buf_ptr,
+				  ext[i].size)) {
+			debug("%s: Failed to write external data to file %s\n",
+			      __func__, strerror(errno));
+			ret = -EIO;
+			goto err;
+		}
+		buf_ptr += ALIGN(ext[i].size, align_size);
 	}
-	if (lseek(fd, new_size, SEEK_SET) < 0) {
-		debug("%s: Failed to seek to end of file: %s\n", __func__,
+	if (ftruncate(outfd, new_size + buf_ptr)) {
+		debug("%s: Failed to truncate file: %s\n", __func__,
 		      strerror(errno));
 		ret = -EIO;
 		goto err;
 	}
-	if (write(fd, buf, buf_ptr) != buf_ptr) {
-		debug("%s: Failed to write external data to file %s\n",
-		      __func__, strerror(errno));
+	if (rename(outname, fname)) {
+		fprintf(stderr, "%s: Can't rename %s to %s: %s\n",
+			params->cmdname, outname, fname, strerror(errno));
 		ret = -EIO;
 		goto err;
 	}
-	free(buf);
-	close(fd);
-	return 0;
+	ret = 0;
 
-err_munmap:
-	munmap(fdt, sbuf.st_size);
 err:
-	free(buf);
+	if (outfd >= 0) {
+		close(outfd);
+		if (ret)
+			unlink(outname);
+	}
+	munmap(fdt, sbuf.st_size);
 	close(fd);
+	free(outname);
+	free(buf);
+	free(ext);
 	return ret;
 }
 
@@ -734,13 +929,13 @@ static int fit_handle_file(struct image_tool_params *params)
 	 * Set hashes for images in the blob. Unfortunately we may need more
 	 * space in either FDT, so keep trying until we succeed.
 	 *
-	 * Note: this is pretty inefficient for signing, since we must
-	 * calculate the signature every time. It would be better to calculate
-	 * all the data and then store it in a separate step. However, this
-	 * would be considerably more complex to implement. Generally a few
-	 * steps of this loop is enough to sign with several keys.
+	 * Each attempt calculates all hashes and signatures again, so start
+	 * with plenty of space and double it when it runs out. The space that
+	 * is not used is removed again afterwards. In practice the first
+	 * attempt is nearly always enough.
 	 */
-	for (size_inc = 0; size_inc < 64 * 1024; size_inc += 1024) {
+	for (size_inc = FIT_SIZE_INC_START; size_inc <= FIT_SIZE_INC_MAX;
+	     size_inc *= 2) {
 		if (copyfile(bakfile, tmpfile) < 0) {
 			printf("Can't copy %s to %s\n", bakfile, tmpfile);
 			ret = -EIO;
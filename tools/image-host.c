@@ -13,6 +13,204 @@
 #include <fdt_region.h>
 #include <image.h>
 #include <version.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* Upper limit on the number of threads used to hash images */
+#define FIT_HASH_MAX_THREADS	32
+
+/**
+ * struct fit_hash_job - Hash of an image, calculated ahead of time
+ *
+ * Node offsets change as hash values are added to the FIT, so the job is
+ * identified by the names of the image and hash nodes instead.
+ *
+ * @image_name:	Name of the image node
+ * @node_name:	Name of the hash subnode
+ * @algo:	Hash algorithm to use
+ * @data:	Image data to hash
+ * @size:	Size of the data in bytes
+ * @value:	Calculated hash value
+ * @value_len:	Length of @value in bytes
+ * @ret:	0 if @value is valid, -ve on error
+ */
+struct fit_hash_job {
+	char *image_name;
+	char *node_name;
+	char *algo;
+	const void *data;
+	size_t size;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+	int ret;
+};
+
+/**
+ * struct fit_hash_jobs - List of hash jobs for a FIT
+ *
+ * @job:	Array of jobs
+ * @count:	Number of jobs in @job
+ * @next:	Next job to be picked up by a worker thread
+ * @lock:	Protects @next
+ */
+static struct fit_hash_jobs {
+	struct fit_hash_job *job;
+	int count;
+	int next;
+	pthread_mutex_t lock;
+} fit_hash_jobs = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void *fit_hash_worker(void *arg)
+{
+	struct fit_hash_jobs *jobs = arg;
+	struct fit_hash_job *job;
+	int idx;
+
+	for (;;) {
+		pthread_mutex_lock(&jobs->lock);
+		idx = jobs->next++;
+		pthread_mutex_unlock(&jobs->lock);
+		if (idx >= jobs->count)
+			break;
+		job = &jobs->job[idx];
+		job->ret = calculate_hash(job->data, job->size, job->algo,
+					  job->value, &job->value_len);
+	}
+
+	return NULL;
+}
+
+static void fit_hash_jobs_free(struct fit_hash_jobs *jobs)
+{
+	int i;
+
+	for (i = 0; i < jobs->count; i++) {
+		free(jobs->job[i].image_name);
+		free(jobs->job[i].node_name);
+		free(jobs->job[i].algo);
+	}
+	free(jobs->job);
+	jobs->job = NULL;
+	jobs->count = 0;
+	jobs->next = 0;
+}
+
+/**
+ * fit_hash_jobs_run() - Hash all images of a FIT in parallel
+ *
+ * Collects the data of every hash subnode of every image and calculates the
+ * hash values using a pool of threads, one per online CPU. The values are
+ * picked up later by fit_image_process_hash(), which stores them in the FIT.
+ *
+ * Any hash node which cannot be handled here (e.g. image data is missing) is
+ * simply skipped, so that fit_image_process_hash() reports the error as
+ * before.
+ *
+ * @jobs:		List of jobs to fill in
+ * @fit:		FIT to process
+ * @images_noffset:	Offset of the /images node
+ */
+static void fit_hash_jobs_run(struct fit_hash_jobs *jobs, const void *fit,
+			      int images_noffset)
+{
+	pthread_t threads[FIT_HASH_MAX_THREADS];
+	int image_noffset, noffset;
+	int nthreads, count, i;
+	long ncpus;
+
+	count = 0;
+	fdt_for_each_subnode(image_noffset, fit, images_noffset) {
+		fdt_for_each_subnode(noffset, fit, image_noffset) {
+			if (!strncmp(fit_get_name(fit, noffset, NULL),
+				     FIT_HASH_NODENAME,
+				     strlen(FIT_HASH_NODENAME)))
+				count++;
+		}
+	}
+	if (count < 2)
+		return;
+	jobs->job = calloc(count, sizeof(*jobs->job));
+	if (!jobs->job)
+		return;
+
+	fdt_for_each_subnode(image_noffset, fit, images_noffset) {
+		const char *image_name;
+		const void *data;
+		size_t size;
+
+		if (fit_image_get_data(fit, image_noffset, &data, &size))
+			continue;
+		image_name = fit_get_name(fit, image_noffset, NULL);
+		fdt_for_each_subnode(noffset, fit, image_noffset) {
+			const char *node_name = fit_get_name(fit, noffset,
+							     NULL);
+			struct fit_hash_job *job;
+			const char *algo;
+
+			if (strncmp(node_name, FIT_HASH_NODENAME,
+				    strlen(FIT_HASH_NODENAME)) ||
+			    fit_image_hash_get_algo(fit, noffset, &algo))
+				continue;
+			job = &jobs->job[jobs->count];
+			job->image_name = strdup(image_name);
+			job->node_name = strdup(node_name);
+			job->algo = strdup(algo);
+			job->data = data;
+			job->size = size;
+			job->ret = -EAGAIN;
+			jobs->count++;
+			if (!job->image_name || !job->node_name || !job->algo) {
+				fit_hash_jobs_free(jobs);
+				return;
+			}
+		}
+	}
+
+	ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	nthreads = ncpus > 0 ? ncpus : 1;
+	if (nthreads > jobs->count)
+		nthreads = jobs->count;
+	if (nthreads > FIT_HASH_MAX_THREADS)
+		nthreads = FIT_HASH_MAX_THREADS;
+	/* The calling thread is one of the workers */
+	for (i = 0; i < nthreads - 1; i++) {
+		if (pthread_create(&threads[i], NULL, fit_hash_worker, jobs))
+			break;
+	}
+	/* Whatever the threads did not get to is done here */
+	fit_hash_worker(jobs);
+	while (i--)
+		pthread_join(threads[i], NULL);
+}
+
+/**
+ * fit_hash_jobs_find() - Find a hash value calculated by fit_hash_jobs_run()
+ *
+ * @image_name:	Name of the image node
+ * @node_name:	Name of the hash subnode
+ * @algo:	Hash algorithm required
+ * Return: job containing the hash value, or NULL if none
+ */
+static struct fit_hash_job *fit_hash_jobs_find(const char *image_name,
+					       const char *node_name,
+					       const char *algo)
+{
+	struct fit_hash_jobs *jobs = &fit_hash_jobs;
+	int i;
+
+	for (i = 0; i < jobs->count; i++) {
+		struct fit_hash_job *job = &jobs->job[i];
+
+		if (!job->ret && !strcmp(job->image_name, image_name) &&
+		    !strcmp(job->node_name, node_name) &&
+		    !strcmp(job->algo, algo))
+			return job;
+	}
+
+	return NULL;
+}
 
 /**
  * fit_set_hash_value - set hash value in requested has node
@@ -61,6 +259,7 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		int noffset, const void *data, size_t size)
 {
 	uint8_t value[FIT_MAX_HASH_LEN];
+	struct fit_hash_job *job;
 	const char *node_name;
 	int value_len;
 	const char *algo;
@@ -74,7 +273,11 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		return -ENOENT;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	job = fit_hash_jobs_find(image_name, node_name, algo);
+	if (job) {
+		memcpy(value, job->value, job->value_len);
+		value_len = job->value_len;
+	} else if (calculate_hash(data, size, algo, value, &value_len)) {
 		printf("Unsupported hash algorithm (%s) for '%s' hash node in '%s' image node\n",
 		       algo, node_name, image_name);
 		return -EPROTONOSUPPORT;
@@ -1111,6 +1314,127 @@ static int fit_config_add_verification_data(const char *keydir,
 	return 0;
 }
 
+/**
+ * fit_config_get_compat() - Get the compatible strings for a configuration
+ *
+ * This follows fit_conf_find_compat(): a 'compatible' property in the
+ * configuration node is used if present, otherwise the root compatible
+ * property of its (uncompressed) FDT image.
+ *
+ * @fit:	FIT to check
+ * @noffset:	Offset of the configuration node
+ * @lenp:	Returns length of the string list
+ * Return: string list, or NULL if none
+ */
+static const char *fit_config_get_compat(const void *fit, int noffset,
+					 int *lenp)
+{
+	const char *compat, *fdt_name;
+	const void *fdt;
+	int fdt_noffset;
+	size_t size;
+
+	compat = fdt_getprop(fit, noffset, "compatible", lenp);
+	if (compat)
+		return compat;
+
+	fdt_name = fdt_getprop(fit, noffset, FIT_FDT_PROP, NULL);
+	if (!fdt_name)
+		return NULL;
+	fdt_noffset = fit_image_get_node(fit, fdt_name);
+	if (fdt_noffset < 0 ||
+	    !fit_image_check_comp(fit, fdt_noffset, IH_COMP_NONE) ||
+	    fit_image_get_data_and_size(fit, fdt_noffset, &fdt, &size) ||
+	    fdt_check_header(fdt))
+		return NULL;
+
+	return fdt_getprop(fdt, 0, "compatible", lenp);
+}
+
+/**
+ * fit_compat_index_find() - Check if a compatible string is in the index
+ *
+ * @index:	Index, a list of pairs of compatible and configuration names
+ * @len:	Length of @index in bytes
+ * @compat:	Compatible string to look for
+ * Return: true if found
+ */
+static bool fit_compat_index_find(const char *index, int len,
+				  const char *compat)
+{
+	const char *end = index + len;
+
+	while (index < end) {
+		if (!strcmp(index, compat))
+			return true;
+		index += strlen(index) + 1;
+		index += strlen(index) + 1;
+	}
+
+	return false;
+}
+
+int fit_add_compat_index(void *fit)
+{
+	int confs_noffset, noffset;
+	char *index = NULL;
+	int index_len = 0;
+	int ret;
+
+	confs_noffset = fdt_path_offset(fit, FIT_CONFS_PATH);
+	if (confs_noffset < 0)
+		return 0;
+
+	/*
+	 * Record each compatible string with the first configuration that
+	 * has it, which is the one that fit_conf_find_compat() would pick
+	 */
+	fdt_for_each_subnode(noffset, fit, confs_noffset) {
+		const char *compat, *conf_name;
+		int len, str_len, name_len;
+		char *new_index;
+
+		compat = fit_config_get_compat(fit, noffset, &len);
+		if (!compat)
+			continue;
+		conf_name = fit_get_name(fit, noffset, NULL);
+		name_len = strlen(conf_name) + 1;
+		for (; len > 0; len -= str_len, compat += str_len) {
+			str_len = strnlen(compat, len) + 1;
+			if (str_len > len)
+				break;
+			if (fit_compat_index_find(index, index_len, compat))
+				continue;
+			new_index = realloc(index,
+					    index_len + str_len + name_len);
+			if (!new_index) {
+				free(index);
+				return -ENOMEM;
+			}
+			index = new_index;
+			memcpy(index + index_len, compat, str_len);
+			memcpy(index + index_len + str_len, conf_name,
+			       name_len);
+			index_len += str_len + name_len;
+		}
+	}
+	if (!index)
+		return 0;
+
+	ret = fdt_setprop(fit, confs_noffset, FIT_COMPAT_INDEX_PROP, index,
+			  index_len);
+	free(index);
+	if (ret == -FDT_ERR_NOSPACE)
+		return -ENOSPC;
+	if (ret) {
+		fprintf(stderr, "Can't add compatible index: %s\n",
+			fdt_strerror(ret));
+		return -EIO;
+	}
+
+	return 0;
+}
+
 int fit_cipher_data(const char *keydir, void *keydest, void *fit,
 		    const char *comment, int require_keys,
 		    const char *engine_id, const char *cmdname)
@@ -1154,7 +1478,7 @@ int fit_add_verification_data(const char *keydir, const char *keyfile,
 {
 	int images_noffset, confs_noffset;
 	int noffset;
-	int ret;
+	int ret = 0;
 
 	/* Find images parent node offset */
 	images_noffset = fdt_path_offset(fit, FIT_IMAGES_PATH);
@@ -1164,6 +1488,12 @@ int fit_add_verification_data(const char *keydir, const char *keyfile,
 		return images_noffset;
 	}
 
+	/*
+	 * Hashing the images is by far the most expensive part for large
+	 * FITs, so do it for all images at once, in parallel
+	 */
+	fit_hash_jobs_run(&fit_hash_jobs, fit, images_noffset);
+
 	/* Process its subnodes, print out component images details */
 	for (noffset = fdt_first_subnode(fit, images_noffset);
 	     noffset >= 0;
@@ -1176,8 +1506,11 @@ int fit_add_verification_data(const char *keydir, const char *keyfile,
 				fit, noffset, comment, require_keys, engine_id,
 				cmdname, algo_name);
 		if (ret)
-			return ret;
+			break;
 	}
+	fit_hash_jobs_free(&fit_hash_jobs);
+	if (ret)
+		return ret;
 
 	/* If there are no keys, we can't sign configurations */
 	if (!IMAGE_ENABLE_SIGN || !(keydir || keyfile))
@@ -86,6 +86,7 @@ struct image_tool_params {
 	int bl_len;		/* Block length in byte for external data */
 	const char *engine_id;	/* Engine to use for signing */
 	bool reset_timestamp;	/* Reset the timestamp on an existing image */
+	bool compat_index;	/* Add a compatible index to configurations */
 	struct image_summary summary;	/* results of signing process */
 };
 